@@ -0,0 +1,149 @@
+#ifndef BENCH_FIXTURES_H
+#define BENCH_FIXTURES_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace MusicBench {
+
+// 分位数（q 取 0-1），就地部分排序 values；空时返回 0
+inline double percentile(std::vector<double>& values, double q) {
+    if (values.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(q * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(rank), values.end());
+    return values[rank];
+}
+
+// 系统临时目录下的唯一目录 musicplayer_bench_<tag>_<时间戳>，析构时连同内容一起删除
+class TempDirectory {
+public:
+    explicit TempDirectory(const std::string& tag) {
+        namespace fs = std::filesystem;
+        root_ = fs::temp_directory_path() / ("musicplayer_bench_" + tag + "_" + std::to_string(
+            std::chrono::steady_clock::now().time_since_epoch().count()));
+        fs::create_directories(root_);
+    }
+
+    ~TempDirectory() {
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    TempDirectory(const TempDirectory&) = delete;
+    TempDirectory& operator=(const TempDirectory&) = delete;
+
+    const std::filesystem::path& path() const { return root_; }
+    std::string file(const std::string& name) const { return (root_ / name).string(); }
+
+private:
+    std::filesystem::path root_;
+};
+
+// 基准中创建的 MusicPlayer 共用的波形缓存目录，不写入用户的缓存目录。
+// 目录在首次调用时创建、进程退出时删除，须在使用它的静态播放器之前调用
+inline const std::string& benchWaveformDirectory() {
+    static TempDirectory dir("waveforms");
+    static const std::string path = dir.path().string();
+    return path;
+}
+
+// 16 位 PCM WAV 的 44 字节文件头，dataBytes 为其后 PCM 数据的字节数
+inline std::string wavHeader(uint32_t rate, uint16_t channels, uint32_t dataBytes) {
+    std::string out = "RIFF";
+    auto le = [&out](uint32_t v, int bytes) {
+        for (int i = 0; i < bytes; i++) out += static_cast<char>((v >> (8 * i)) & 0xFF);
+    };
+    le(36 + dataBytes, 4);
+    out += "WAVEfmt ";
+    le(16, 4);
+    le(1, 2);
+    le(channels, 2);
+    le(rate, 4);
+    le(rate * channels * 2, 4);
+    le(channels * 2u, 2);
+    le(16, 2);
+    out += "data";
+    le(dataBytes, 4);
+    return out;
+}
+
+// 写入 seconds 秒的 16 位 WAV；sample(i) 返回第 i 帧的值（满幅为 ±1），各声道相同
+template <typename Sample>
+void writeWav(const std::string& path, double seconds, uint32_t rate, uint16_t channels, Sample&& sample) {
+    size_t frames = static_cast<size_t>(seconds * rate);
+    std::string wav = wavHeader(rate, channels, static_cast<uint32_t>(frames * channels * 2));
+    wav.reserve(wav.size() + frames * channels * 2);
+    for (size_t i = 0; i < frames; i++) {
+        auto s = static_cast<uint16_t>(static_cast<int16_t>(sample(i) * 32767.0));
+        for (uint16_t c = 0; c < channels; c++) {
+            wav += static_cast<char>(s & 0xFF);
+            wav += static_cast<char>(s >> 8);
+        }
+    }
+    std::ofstream(path, std::ios::binary).write(wav.data(), static_cast<std::streamsize>(wav.size()));
+}
+
+// 正弦 WAV：frequency Hz，峰值 amplitude（满幅为 1）
+inline void writeSineWav(const std::string& path, double seconds, uint32_t rate, uint16_t channels,
+                         double frequency = 440.0, double amplitude = 0.25) {
+    const double step = 2.0 * 3.14159265358979323846 * frequency / rate;
+    writeWav(path, seconds, rate, channels, [=](size_t i) { return amplitude * std::sin(step * i); });
+}
+
+// 临时目录中的合成曲库：artists 个艺术家目录，每个含 albums 个专辑目录，
+// 每个专辑 tracks 首曲目（只有 ID3v2 头与一个 MPEG 帧头，足以通过内容嗅探）和一个封面；另有一个指回根目录的符号链接环
+class SyntheticLibrary {
+public:
+    SyntheticLibrary(const std::string& tag, int artists, int albums, int tracks)
+        : dir_(tag), root_(dir_.path()), artists_(artists), albums_(albums), tracks_(tracks) {
+        namespace fs = std::filesystem;
+        for (int a = 0; a < artists; a++) {
+            for (int b = 0; b < albums; b++) {
+                fs::path album = fs::path(albumPath(a, b));
+                fs::create_directories(album);
+                for (int t = 0; t < tracks; t++) {
+                    std::ofstream track(album / ("track" + std::to_string(t) + ".mp3"), std::ios::binary);
+                    static const char kHead[] = { 'I', 'D', '3', 3, 0, 0, 0, 0, 0, 0,
+                                                  '\xFF', '\xFB', '\x90', '\x64' };
+                    track.write(kHead, sizeof(kHead));
+                }
+                std::ofstream(album / "cover.jpg");
+            }
+        }
+        std::error_code ec;
+        fs::create_directory_symlink(root_, root_ / "artist0" / "loop", ec);
+    }
+
+    SyntheticLibrary(const SyntheticLibrary&) = delete;
+    SyntheticLibrary& operator=(const SyntheticLibrary&) = delete;
+
+    std::string path() const { return root_.string(); }
+
+    std::string albumPath(int artist, int album) const {
+        return (root_ / ("artist" + std::to_string(artist)) /
+                ("album" + std::to_string(album))).string();
+    }
+
+    int artists() const { return artists_; }
+    int albums() const { return albums_; }
+    int tracksPerAlbum() const { return tracks_; }
+    int trackCount() const { return artists_ * albums_ * tracks_; }
+    int fileCount() const { return artists_ * albums_ * (tracks_ + 1); }
+
+private:
+    TempDirectory dir_;
+    std::filesystem::path root_;
+    int artists_;
+    int albums_;
+    int tracks_;
+};
+
+} // namespace MusicBench
+
+#endif // BENCH_FIXTURES_H
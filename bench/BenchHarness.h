@@ -0,0 +1,113 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace MusicBench {
+
+// 基准函数：执行 iterations 次被测操作，返回处理的条目数（样本、曲目等）
+using BenchFn = std::function<double(uint64_t iterations)>;
+
+struct BenchEntry {
+    std::string name;
+    std::string unit;   // 吞吐量单位，如 "samples"
+    BenchFn fn;
+};
+
+struct BenchResult {
+    std::string name;
+    std::string unit;
+    uint64_t iterations = 0;
+    double seconds = 0.0;
+    double items = 0.0;
+
+    double nsPerIteration() const { return seconds * 1e9 / iterations; }
+    double itemsPerSecond() const { return items / seconds; }
+};
+
+inline std::vector<BenchEntry>& benchRegistry() {
+    static std::vector<BenchEntry> entries;
+    return entries;
+}
+
+inline void registerBenchmark(const std::string& name, const std::string& unit, BenchFn fn) {
+    benchRegistry().push_back({ name, unit, std::move(fn) });
+}
+
+// 静态注册器
+struct BenchRegistrar {
+    explicit BenchRegistrar(const std::function<void()>& registerFn) {
+        registerFn();
+    }
+};
+
+// 防止编译器优化掉被测结果
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+// 基准附带的正确性核对（精度指标、校验和等）：不满足时输出一行 "# CHECK FAILED" 并计数，
+// main 在全部基准运行完后以非零状态退出
+inline size_t& benchCheckFailures() {
+    static size_t failures = 0;
+    return failures;
+}
+
+// format 为 printf 格式的说明
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 2, 3)))
+#endif
+inline bool benchCheck(bool ok, const char* format, ...) {
+    if (!ok) {
+        benchCheckFailures()++;
+        std::va_list args;
+        va_start(args, format);
+        std::printf("# CHECK FAILED: ");
+        std::vprintf(format, args);
+        std::printf("\n");
+        va_end(args);
+    }
+    return ok;
+}
+
+// 自动校准迭代次数，使单个基准至少运行 minSeconds 秒
+inline BenchResult runBenchmark(const BenchEntry& entry, double minSeconds) {
+    using Clock = std::chrono::steady_clock;
+    BenchResult result;
+    result.name = entry.name;
+    result.unit = entry.unit;
+    // 预热一次，使惰性初始化（如构造测试数据）不计入校准
+    entry.fn(1);
+    uint64_t iterations = 1;
+    while (true) {
+        auto start = Clock::now();
+        double items = entry.fn(iterations);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= minSeconds || iterations >= (1ULL << 40)) {
+            result.iterations = iterations;
+            result.seconds = seconds;
+            result.items = items;
+            return result;
+        }
+        // 按已测耗时估算所需次数，至少翻倍
+        double scale = seconds > 0 ? minSeconds * 1.2 / seconds : 10.0;
+        uint64_t next = static_cast<uint64_t>(iterations * std::min(scale, 100.0));
+        iterations = std::max(next, iterations * 2);
+    }
+}
+
+} // namespace MusicBench
+
+#endif // BENCH_HARNESS_H
@@ -0,0 +1,161 @@
+#ifndef BENCH_REPORT_H
+#define BENCH_REPORT_H
+
+#include "BenchHarness.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace MusicBench {
+
+// 一个基准多次运行后的汇总：以吞吐量的中位数为准，同时记录最小与最大值
+struct BenchSummary {
+    BenchResult median;
+    double minItemsPerSecond = 0.0;
+    double maxItemsPerSecond = 0.0;
+    int repetitions = 0;
+    double baselineItemsPerSecond = 0.0;    // 0 表示基线中没有此项
+
+    // 相对基线的吞吐量变化（+0.05 表示快 5%）
+    double change() const {
+        return baselineItemsPerSecond > 0 ? median.itemsPerSecond() / baselineItemsPerSecond - 1.0 : 0.0;
+    }
+};
+
+inline BenchSummary summarize(std::vector<BenchResult> runs) {
+    std::sort(runs.begin(), runs.end(), [](const BenchResult& a, const BenchResult& b) {
+        return a.itemsPerSecond() < b.itemsPerSecond();
+    });
+    BenchSummary summary;
+    summary.median = runs[runs.size() / 2];
+    summary.minItemsPerSecond = runs.front().itemsPerSecond();
+    summary.maxItemsPerSecond = runs.back().itemsPerSecond();
+    summary.repetitions = static_cast<int>(runs.size());
+    return summary;
+}
+
+// 运行环境，写入 JSON 以便比较时确认两次结果可比
+struct BenchContext {
+    std::string date;
+    std::string compiler;
+    std::string buildType;
+    std::string simd;
+    unsigned threads = 0;
+    double minSeconds = 0.0;
+    int repetitions = 0;
+};
+
+inline std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+inline std::string jsonNumber(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.6g", v);
+    return buf;
+}
+
+// 每个基准一行，便于 diff 与 grep；readBaseline 按此格式读取
+inline bool writeJson(const std::string& path, const BenchContext& context,
+                      const std::vector<BenchSummary>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "{\n  \"schema\": 1,\n  \"context\": {\"date\": \"" << jsonEscape(context.date)
+        << "\", \"compiler\": \"" << jsonEscape(context.compiler)
+        << "\", \"build_type\": \"" << jsonEscape(context.buildType)
+        << "\", \"simd\": \"" << jsonEscape(context.simd)
+        << "\", \"hardware_threads\": " << context.threads
+        << ", \"min_time\": " << jsonNumber(context.minSeconds)
+        << ", \"repetitions\": " << context.repetitions << "},\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchSummary& s = results[i];
+        const BenchResult& r = s.median;
+        out << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"unit\": \"" << jsonEscape(r.unit)
+            << "\", \"iterations\": " << r.iterations
+            << ", \"ns_per_iter\": " << jsonNumber(r.nsPerIteration())
+            << ", \"items_per_second\": " << jsonNumber(r.itemsPerSecond())
+            << ", \"items_per_second_min\": " << jsonNumber(s.minItemsPerSecond)
+            << ", \"items_per_second_max\": " << jsonNumber(s.maxItemsPerSecond);
+        if (s.baselineItemsPerSecond > 0) {
+            out << ", \"baseline_items_per_second\": " << jsonNumber(s.baselineItemsPerSecond)
+                << ", \"change\": " << jsonNumber(s.change());
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+namespace ReportDetail {
+
+// 从 key 之后读取 JSON 字符串值
+inline bool stringField(const std::string& line, const char* key, std::string& value) {
+    size_t pos = line.find(std::string("\"") + key + "\":");
+    if (pos == std::string::npos) return false;
+    pos = line.find('"', pos + std::char_traits<char>::length(key) + 3);
+    if (pos == std::string::npos) return false;
+    value.clear();
+    for (size_t i = pos + 1; i < line.size(); i++) {
+        char c = line[i];
+        if (c == '"') return true;
+        if (c == '\\' && i + 1 < line.size()) {
+            char e = line[++i];
+            value += e == 'n' ? '\n' : e == 't' ? '\t' : e;
+        } else {
+            value += c;
+        }
+    }
+    return false;
+}
+
+inline bool numberField(const std::string& line, const char* key, double& value) {
+    size_t pos = line.find(std::string("\"") + key + "\":");
+    if (pos == std::string::npos) return false;
+    const char* start = line.c_str() + pos + std::char_traits<char>::length(key) + 3;
+    char* end = nullptr;
+    value = std::strtod(start, &end);
+    return end != start;
+}
+
+} // namespace ReportDetail
+
+// 读取 writeJson 写出的结果：基准名 → 吞吐量
+inline bool readBaseline(const std::string& path, std::map<std::string, double>& baseline) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string name;
+        double itemsPerSecond = 0.0;
+        if (ReportDetail::stringField(line, "name", name) &&
+            ReportDetail::numberField(line, "items_per_second", itemsPerSecond)) {
+            baseline[name] = itemsPerSecond;
+        }
+    }
+    return true;
+}
+
+} // namespace MusicBench
+
+#endif // BENCH_REPORT_H
@@ -0,0 +1,266 @@
+#include "BenchFixtures.h"
+#include "BenchHarness.h"
+#include "CommandProcessor.h"
+#include "EventLoop.h"
+#include "NativeAudioPlayer.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+// 丢弃输出但保留格式化开销的流缓冲
+class DiscardBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// 基线：旧的拆分方式，清理输入时复制整行，再经 istringstream 逐个分配参数
+std::vector<std::string> istringstreamParse(const std::string& input) {
+    std::vector<std::string> tokens;
+    std::string cleanInput = input;
+    cleanInput.erase(std::remove(cleanInput.begin(), cleanInput.end(), '\r'), cleanInput.end());
+    if (cleanInput.size() >= 3 && (unsigned char)cleanInput[0] == 0xEF &&
+        (unsigned char)cleanInput[1] == 0xBB && (unsigned char)cleanInput[2] == 0xBF) {
+        cleanInput = cleanInput.substr(3);
+    }
+    size_t start = cleanInput.find_first_not_of(" \t");
+    if (start != std::string::npos) {
+        cleanInput = cleanInput.substr(start);
+    }
+    std::istringstream iss(cleanInput);
+    std::string token;
+    while (iss >> token) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+// 基线：旧的 if-else 链，按声明顺序逐个比较命令名
+CommandId linearFind(std::string_view name) {
+    for (const auto& command : CommandDetail::kCommands) {
+        if (command.name == name) return command.id;
+    }
+    return CommandId::Unknown;
+}
+
+const size_t kTracks = 100000;
+
+// 10 万首曲目的播放器（原生引擎、空输出端，不加载任何文件）
+MusicPlayer& player() {
+    static const std::string& waveforms = benchWaveformDirectory();
+    static MusicPlayer p(std::make_unique<NativeAudioPlayer>());
+    static bool filled = false;
+    if (!filled) {
+        filled = true;
+        p.setWaveformCacheDirectory(waveforms);
+        Playlist& playlist = p.getPlaylist();
+        playlist.reserve(kTracks);
+        for (size_t i = 0; i < kTracks; i++) {
+            std::string dir = "/srv/music/Artist " + std::to_string(i / 500 % 200) + "/Album " +
+                              std::to_string(i / 500) + "/";
+            std::string name = std::to_string(i % 500 + 1) + " - Track Title " + std::to_string(i) + ".flac";
+            playlist.addTrack(dir, name, std::string_view(), "Artist " + std::to_string(i / 500 % 200),
+                              180.0f + static_cast<float>(i % 60), true);
+        }
+    }
+    return p;
+}
+
+// 交互会话中常见、且不触发文件读取的命令
+const std::vector<std::string>& commandLines() {
+    static const std::vector<std::string> lines = {
+        "vol 40", "vol+", "vol-", "loop", "status", "list", "list 5000 20", "gapless",
+        "xfade 2.5", "st", "  \xEF\xBB\xBFlist 70000 20\r", "memory", "loop", "vol 75", "unknown-command",
+        "gapless", "xfade 0", "loop",
+    };
+    return lines;
+}
+
+// 无效编号（0 与超出列表的编号）不移除曲目，报告 "Invalid track number"
+void checkInvalidRemove() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    MusicPlayer p(std::make_unique<NativeAudioPlayer>());
+    p.setWaveformCacheDirectory(benchWaveformDirectory());
+    p.getPlaylist().addTrack("/srv/music/Album/1 - First.flac");
+    p.getPlaylist().addTrack("/srv/music/Album/2 - Second.flac");
+    for (const char* line : { "remove 0", "remove 3" }) {
+        std::ostringstream out;
+        processCommandLine(p, line, out);
+        benchCheck(out.str() == "Invalid track number\n" && p.getPlaylist().size() == 2,
+                   "command: '%s' on 2 tracks printed '%s' and left %zu tracks", line, out.str().c_str(),
+                   p.getPlaylist().size());
+    }
+}
+
+// 非有限或超出范围的淡变时长报告用法，不改变当前设置
+void checkInvalidCrossfade() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    MusicPlayer p(std::make_unique<NativeAudioPlayer>());
+    p.setWaveformCacheDirectory(benchWaveformDirectory());
+    p.setCrossfade(2.0f);
+    for (const char* line : { "xfade inf", "xfade nan", "xfade 1e6", "xfade -1" }) {
+        std::ostringstream out;
+        processCommandLine(p, line, out);
+        benchCheck(out.str().rfind("Usage: xfade", 0) == 0 && p.getCrossfade() == 2.0f,
+                   "command: '%s' printed '%s' and left crossfade at %.1fs", line, out.str().c_str(),
+                   p.getCrossfade());
+    }
+}
+
+// 移除当前曲目后，下一次前进落到被移除曲目的后继上，不跳过它
+void checkRemoveCurrent() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    const char* names[] = { "a", "b", "c", "d" };
+    // {当前位置, 移除的编号, 前进后应播放的曲目}
+    const struct { size_t current; const char* line; const char* next; } cases[] = {
+        { 1, "remove 2", "c" }, { 0, "remove 1", "b" }, { 3, "remove 1", "b" }, { 2, "remove 1", "d" },
+        { 3, "remove 4", "a" },
+    };
+    for (const auto& c : cases) {
+        MusicPlayer p(std::make_unique<NativeAudioPlayer>());
+        p.setWaveformCacheDirectory(benchWaveformDirectory());
+        Playlist& playlist = p.getPlaylist();
+        for (const char* name : names) playlist.addTrack(std::string("/srv/music/Album/") + name + ".flac");
+        playlist.jumpTo(c.current);
+        std::ostringstream out;
+        processCommandLine(p, c.line, out);
+        playlist.next();
+        std::string next = playlist.getCurrentTrack() ? playlist.getCurrentTrack()->filepath() : std::string();
+        benchCheck(next == std::string("/srv/music/Album/") + c.next + ".flac",
+                   "command: '%s' while playing position %zu advanced to '%s', expected '%s'", c.line,
+                   c.current + 1, next.c_str(), c.next);
+    }
+}
+
+// 事件循环由后端唤醒：空闲时等待上限为 1 秒，曲目结束后仍应立即切到下一首，而不是等到下一次超时
+void checkEventWake() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    TempDirectory dir("event_wake");
+    const double kSeconds = 0.3;
+    MusicPlayer p(std::make_unique<NativeAudioPlayer>());
+    p.setWaveformCacheDirectory(benchWaveformDirectory());
+    for (const char* name : { "a.wav", "b.wav" }) {
+        writeSineWav(dir.file(name), kSeconds, 44100, 2);
+        p.getPlaylist().addTrack(dir.path().string() + "/", name, name, std::string_view(), kSeconds, true);
+    }
+    p.update();     // 元数据游标越过已读取的曲目后没有后台任务
+    benchCheck(p.getEventWake() && p.getUpdateInterval() >= 1.0f,
+               "event loop: idle native player waits %.3f s between updates", p.getUpdateInterval());
+    std::mutex mutex;
+    PlayerEventLoop loop(p, mutex);
+    loop.start();
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        p.playCurrentTrack();
+    }
+    double elapsed = 0.0;
+    for (int advanced = 0; !advanced && elapsed < 3.0;) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::lock_guard<std::mutex> lock(mutex);
+        advanced = p.getPlaylist().getCurrentIndex() == 1;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    loop.stop();
+    benchCheck(elapsed < kSeconds + 0.15, "event loop: a %.1f s track advanced after %.3f s", kSeconds, elapsed);
+}
+
+BenchRegistrar registerCommand([]() {
+    registerBenchmark("command/parse/string-view", "commands", [](uint64_t iterations) {
+        const auto& lines = commandLines();
+        size_t tokens = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            for (const std::string& line : lines) tokens += tokenizeCommand(line).size();
+        }
+        doNotOptimize(tokens);
+        return static_cast<double>(iterations * lines.size());
+    });
+
+    registerBenchmark("command/parse/istringstream", "commands", [](uint64_t iterations) {
+        const auto& lines = commandLines();
+        size_t tokens = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            for (const std::string& line : lines) tokens += istringstreamParse(line).size();
+        }
+        doNotOptimize(tokens);
+        return static_cast<double>(iterations * lines.size());
+    });
+
+    // 命令名到编号：编译期完美哈希与逐个比较（全部命令名及一个未知命令）
+    for (int hashed = 0; hashed < 2; hashed++) {
+        registerBenchmark(hashed ? "command/dispatch/perfect-hash" : "command/dispatch/linear", "lookups",
+                          [hashed](uint64_t iterations) {
+            std::vector<std::string> names;
+            for (const auto& command : CommandDetail::kCommands) names.emplace_back(command.name);
+            names.emplace_back("unknown-command");
+            size_t sum = 0;
+            for (uint64_t i = 0; i < iterations; i++) {
+                for (const std::string& name : names) {
+                    sum += static_cast<size_t>(hashed ? findCommand(name) : linearFind(name));
+                }
+            }
+            doNotOptimize(sum);
+            return static_cast<double>(iterations * names.size());
+        });
+    }
+
+    // 解析并执行，输出经完整格式化后丢弃
+    registerBenchmark("command/process", "commands", [](uint64_t iterations) {
+        checkInvalidRemove();
+        checkRemoveCurrent();
+        checkInvalidCrossfade();
+        checkEventWake();
+        MusicPlayer& p = player();
+        const auto& lines = commandLines();
+        DiscardBuffer buffer;
+        std::ostream out(&buffer);
+        for (uint64_t i = 0; i < iterations; i++) {
+            for (const std::string& line : lines) processCommandLine(p, line, out);
+        }
+        return static_cast<double>(iterations * lines.size());
+    });
+
+    registerBenchmark("player/status-string", "strings", [](uint64_t iterations) {
+        MusicPlayer& p = player();
+        size_t chars = 0;
+        for (uint64_t i = 0; i < iterations; i++) chars += p.getStatusString().size();
+        doNotOptimize(chars);
+        return static_cast<double>(iterations);
+    });
+
+    // 播放列表显示：当前曲目附近一页与随机位置的一页（各 20 行）
+    registerBenchmark("player/playlist-page", "rows", [](uint64_t iterations) {
+        MusicPlayer& p = player();
+        const size_t kRows = 20;
+        uint32_t state = 7;
+        size_t chars = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            state = state * 1664525u + 1013904223u;
+            chars += p.getPlaylistPageAroundCurrent(kRows).size();
+            chars += p.getPlaylistPage(state % kTracks, kRows).size();
+        }
+        doNotOptimize(chars);
+        return static_cast<double>(iterations * 2 * kRows);
+    });
+});
+
+} // namespace
@@ -0,0 +1,256 @@
+#include "BenchFixtures.h"
+#include "BenchHarness.h"
+#include "ControlServer.h"
+#include "NativeAudioPlayer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+// 服务端：原生引擎（空输出端）与 1000 首曲目，监听临时目录中的套接字；tag 区分同一进程中的多个服务端
+struct ControlFixture {
+    explicit ControlFixture(const std::string& tag = "")
+        : waveforms(benchWaveformDirectory()), player(std::make_unique<NativeAudioPlayer>()),
+          server(player, mutex) {
+        player.setWaveformCacheDirectory(waveforms);
+        Playlist& playlist = player.getPlaylist();
+        for (int i = 0; i < 1000; i++) {
+            playlist.addTrack("/srv/music/Album " + std::to_string(i / 10) + "/",
+                              std::to_string(i % 10 + 1) + " - Track " + std::to_string(i) + ".flac",
+                              std::string_view(), "Artist " + std::to_string(i / 100), 200.0f, true);
+        }
+        path = (std::filesystem::temp_directory_path() /
+                ("musicplayer_bench_" + std::to_string(::getpid()) + tag + ".sock")).string();
+        if (!server.start(path)) {
+            std::fprintf(stderr, "control server: %s\n", server.lastError().c_str());
+            std::exit(2);
+        }
+    }
+
+    std::string waveforms;      // 先于播放器取得，缓存目录在播放器之后删除
+    MusicPlayer player;
+    std::mutex mutex;
+    ControlServer server;
+    std::string path;
+};
+
+ControlFixture& fixture() {
+    static ControlFixture f;
+    return f;
+}
+
+// 阻塞式客户端：发送命令，按结束行 "." 计数读取响应
+class Client {
+public:
+    explicit Client(const std::string& path) {
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+        if (fd_ < 0 || ::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::perror("connect");
+            std::exit(2);
+        }
+    }
+
+    ~Client() { ::close(fd_); }
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    void send(const std::string& data) {
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t n = ::write(fd_, data.data() + done, data.size() - done);
+            if (n <= 0) {
+                std::perror("write");
+                std::exit(2);
+            }
+            done += static_cast<size_t>(n);
+        }
+    }
+
+    // 有尚未读取的数据（不阻塞）
+    bool hasData() const {
+        pollfd p{ fd_, POLLIN, 0 };
+        return pos_ < buffer_.size() || ::poll(&p, 1, 0) > 0;
+    }
+
+    void awaitResponses(size_t count) {
+        while (true) {
+            size_t nl;
+            while (count > 0 && (nl = buffer_.find('\n', pos_)) != std::string::npos) {
+                if (nl == pos_ + 1 && buffer_[pos_] == '.') count--;
+                pos_ = nl + 1;
+            }
+            if (count == 0) return;
+            buffer_.erase(0, pos_);
+            pos_ = 0;
+            char buf[65536];
+            ssize_t n = ::read(fd_, buf, sizeof(buf));
+            if (n <= 0) {
+                std::fprintf(stderr, "control server closed the connection\n");
+                std::exit(2);
+            }
+            buffer_.append(buf, static_cast<size_t>(n));
+        }
+    }
+
+private:
+    int fd_ = -1;
+    std::string buffer_;
+    size_t pos_ = 0;
+};
+
+const char* const kCommands[] = { "vol 50\n", "st\n", "list 500 5\n" };
+const size_t kCommandKinds = sizeof(kCommands) / sizeof(kCommands[0]);
+
+// 固定速率负载：8 个客户端合计每秒 10000 条命令，持续 1 秒。
+// 延迟同时按实际发送时刻与计划发送时刻计算（后者包含排队，不受协同遗漏影响）
+void reportRateTest() {
+    static bool reported = false;
+    if (reported) return;
+    reported = true;
+    const int kClients = 8;
+    const double kRate = 10000.0;
+    const auto kDuration = std::chrono::seconds(1);
+    const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(kClients / kRate));
+    std::vector<std::vector<double>> service(kClients), scheduled(kClients);
+    auto start = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < kClients; c++) {
+        threads.emplace_back([&, c]() {
+            Client client(fixture().path);
+            // 各客户端错开发送时刻
+            auto next = start + interval * c / kClients;
+            for (size_t i = 0; next < start + kDuration; i++, next += interval) {
+                std::this_thread::sleep_until(next);
+                auto sent = std::chrono::steady_clock::now();
+                client.send(kCommands[(i + static_cast<size_t>(c)) % kCommandKinds]);
+                client.awaitResponses(1);
+                auto done = std::chrono::steady_clock::now();
+                service[c].push_back(std::chrono::duration<double, std::micro>(done - sent).count());
+                scheduled[c].push_back(std::chrono::duration<double, std::micro>(done - next).count());
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    std::vector<double> all, allScheduled;
+    for (int c = 0; c < kClients; c++) {
+        all.insert(all.end(), service[c].begin(), service[c].end());
+        allScheduled.insert(allScheduled.end(), scheduled[c].begin(), scheduled[c].end());
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double maxUs = *std::max_element(all.begin(), all.end());
+    std::printf("# control: %zu commands from %d clients in %.2fs (%.0f/s): p50 %.0f us, p99 %.0f us, max %.0f us; "
+                "from scheduled send p99 %.0f us\n",
+                all.size(), kClients, elapsed, static_cast<double>(all.size()) / elapsed,
+                percentile(all, 0.50), percentile(all, 0.99), maxUs, percentile(allScheduled, 0.99));
+}
+
+// 一个客户端 load -r 扫描期间，另一个客户端的命令应照常得到响应（扫描不占用事件循环）
+void checkScanDoesNotBlock() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    SyntheticLibrary library("control_scan", 30, 10, 10);
+    ControlFixture server("_scan");
+    Client loader(server.path);
+    Client other(server.path);
+    loader.send("load -r " + library.path() + "\nst\n");
+    size_t served = 0;
+    while (!loader.hasData()) {
+        other.send("st\n");
+        other.awaitResponses(1);
+        served++;
+    }
+    loader.awaitResponses(2);
+    benchCheck(served >= 2, "control: only %zu commands from another client were served during load -r", served);
+    size_t tracks = server.player.getPlaylist().size();
+    benchCheck(tracks == 1000 + 3000, "control: load -r over the socket left %zu tracks, expected 4000", tracks);
+}
+
+// 订阅推送的曲目事件按曲目识别：在当前曲目之前插入不推送，移除当前曲目时推送
+void checkTrackEvents() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    MusicPlayer player(std::make_unique<NativeAudioPlayer>());
+    player.setWaveformCacheDirectory(benchWaveformDirectory());
+    Playlist& playlist = player.getPlaylist();
+    for (const char* name : { "a", "b", "c" }) playlist.addTrack(std::string("/srv/music/Album/") + name + ".flac");
+    playlist.jumpTo(1);
+    PlayerSnapshot before = takePlayerSnapshot(player);
+    playlist.insertTrack(0, "/srv/music/Album/x.flac");
+    PlayerSnapshot after = takePlayerSnapshot(player);
+    std::string events;
+    appendStateEvents(player, &before, after, events);
+    benchCheck(events.empty(), "control: insert before the current track pushed '%s'", events.c_str());
+    playlist.removeTrack(static_cast<size_t>(after.position));
+    PlayerSnapshot removed = takePlayerSnapshot(player);
+    appendStateEvents(player, &after, removed, events);
+    benchCheck(events.rfind("! track ", 0) == 0, "control: removing the current track pushed '%s'", events.c_str());
+}
+
+BenchRegistrar registerControl([]() {
+    // 单个客户端逐条发送并等待响应
+    registerBenchmark("control/roundtrip", "commands", [](uint64_t iterations) {
+        reportRateTest();
+        checkScanDoesNotBlock();
+        checkTrackEvents();
+        Client client(fixture().path);
+        for (uint64_t i = 0; i < iterations; i++) {
+            client.send(kCommands[i % kCommandKinds]);
+            client.awaitResponses(1);
+        }
+        return static_cast<double>(iterations);
+    });
+
+    // 单个客户端一次写入 64 条命令再读取全部响应
+    registerBenchmark("control/pipelined", "commands", [](uint64_t iterations) {
+        const size_t kDepth = 64;
+        std::string batch;
+        for (size_t i = 0; i < kDepth; i++) batch += kCommands[i % kCommandKinds];
+        Client client(fixture().path);
+        for (uint64_t i = 0; i < iterations; i++) {
+            client.send(batch);
+            client.awaitResponses(kDepth);
+        }
+        return static_cast<double>(iterations * kDepth);
+    });
+
+    // 256 个连接各发 4 条命令，服务端在各连接之间轮转
+    registerBenchmark("control/clients-256", "commands", [](uint64_t iterations) {
+        const size_t kClientsCount = 256;
+        const size_t kDepth = 4;
+        std::string batch;
+        for (size_t i = 0; i < kDepth; i++) batch += kCommands[i % kCommandKinds];
+        std::vector<std::unique_ptr<Client>> clients;
+        for (size_t c = 0; c < kClientsCount; c++) clients.push_back(std::make_unique<Client>(fixture().path));
+        for (uint64_t i = 0; i < iterations; i++) {
+            for (auto& client : clients) client->send(batch);
+            for (auto& client : clients) client->awaitResponses(kDepth);
+        }
+        return static_cast<double>(iterations * kClientsCount * kDepth);
+    });
+});
+
+} // namespace
+#endif
@@ -0,0 +1,40 @@
+#include "BenchHarness.h"
+#include "Crossfade.h"
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+// 每次迭代混合一个 1024 帧的 44.1 kHz 立体声块；吞吐量以“音频秒/秒”报告，
+// 其倒数即一路淡变占用的单核比例（例如 1e4 倍实时为 0.01%）
+const size_t kFrames = 1024;
+const uint16_t kChannels = 2;
+const double kRate = 44100.0;
+
+BenchRegistrar registerCrossfade([]() {
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2,
+                                 SimdLevel::AVX2, SimdLevel::NEON };
+    for (SimdLevel level : levels) {
+        if (!simdLevelSupported(level)) continue;
+        registerBenchmark(std::string("crossfade/mix/") + simdLevelName(level), "audio-sec",
+                          [level](uint64_t iterations) {
+            CrossfadeKernels::MixFn mix = CrossfadeKernels::select(level);
+            std::vector<float> incoming(kFrames * kChannels, 0.25f);
+            std::vector<float> outgoing(kFrames * kChannels, -0.25f);
+            // 3 秒的淡变，逐块推进并循环
+            const float step = 1.0f / static_cast<float>(3.0 * kRate);
+            float t = 0.0f;
+            for (uint64_t i = 0; i < iterations; i++) {
+                mix(incoming.data(), outgoing.data(), kFrames, kChannels, t, step, 1.0f);
+                t += step * kFrames;
+                if (t >= 1.0f) t = 0.0f;
+                doNotOptimize(incoming[0]);
+            }
+            return static_cast<double>(iterations * kFrames) / kRate;
+        });
+    }
+});
+
+} // namespace
@@ -0,0 +1,706 @@
+#include "BenchHarness.h"
+#include "FlacDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+const size_t kReadFrames = 4096;
+const double kPi = 3.14159265358979323846;
+
+const SimdLevel kLevels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+
+// 高位优先的位写入器
+class BitWriter {
+public:
+    void put(uint32_t value, unsigned bits) {
+        if (bits == 0) return;
+        if (bits < 32) value &= (1u << bits) - 1;
+        acc_ = (acc_ << bits) | value;
+        pending_ += bits;
+        while (pending_ >= 8) {
+            pending_ -= 8;
+            out_ += static_cast<char>(acc_ >> pending_);
+        }
+    }
+
+    void putSigned(int32_t value, unsigned bits) { put(static_cast<uint32_t>(value), bits); }
+
+    void putUnary(uint32_t zeros) {
+        for (; zeros >= 32; zeros -= 32) put(0, 32);
+        put(1, zeros + 1);
+    }
+
+    void putRice(int32_t value, unsigned k) {
+        uint32_t u = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+        putUnary(u >> k);
+        put(u, k);
+    }
+
+    void align() {
+        if (pending_) put(0, 8 - pending_);
+    }
+
+    std::string& bytes() { return out_; }
+
+private:
+    std::string out_;
+    uint64_t acc_ = 0;
+    unsigned pending_ = 0;
+};
+
+// 按规范写出 FLAC 的简单编码器：固定块长，逐子帧在 CONSTANT / VERBATIM / FIXED 0-4 / LPC 中取最短，
+// 立体声在独立、左/侧、侧/右、中/侧中取最短，Rice 分区阶与参数按精确位数选择；写入 STREAMINFO MD5 与 SEEKTABLE
+class FlacEncoder {
+public:
+    FlacEncoder(uint32_t rate, uint16_t channels, uint32_t bps, unsigned lpcOrder, unsigned precision)
+        : rate_(rate), channels_(channels), bps_(bps), lpcOrder_(lpcOrder), precision_(precision) {}
+
+    static constexpr uint32_t kBlockSize = 4096;
+
+    std::string encode(const std::vector<int32_t>& interleaved) {
+        uint64_t frames = interleaved.size() / channels_;
+        std::string audio;
+        std::vector<std::pair<uint64_t, uint64_t>> seekPoints;
+        std::vector<int32_t> planar;
+        for (uint64_t start = 0, number = 0; start < frames; start += kBlockSize, number++) {
+            uint32_t n = static_cast<uint32_t>(std::min<uint64_t>(kBlockSize, frames - start));
+            if (start % (10ULL * rate_) < kBlockSize) seekPoints.emplace_back(start, audio.size());
+            planar.resize(static_cast<size_t>(n) * channels_);
+            for (uint32_t i = 0; i < n; i++) {
+                for (uint16_t c = 0; c < channels_; c++) {
+                    planar[c * static_cast<size_t>(n) + i] = interleaved[(start + i) * channels_ + c];
+                }
+            }
+            audio += encodeFrame(planar.data(), n, number);
+        }
+
+        Md5 md5;
+        size_t width = (bps_ + 7) / 8;
+        std::string raw;
+        raw.reserve(interleaved.size() * width);
+        for (int32_t v : interleaved) {
+            for (size_t b = 0; b < width; b++) raw += static_cast<char>(static_cast<uint32_t>(v) >> (8 * b));
+        }
+        md5.update(raw.data(), raw.size());
+        unsigned char digest[16];
+        md5.finish(digest);
+
+        BitWriter head;
+        for (char ch : std::string("fLaC")) head.put(static_cast<unsigned char>(ch), 8);
+        head.put(0, 1);
+        head.put(0, 7);
+        head.put(34, 24);
+        head.put(kBlockSize, 16);
+        head.put(kBlockSize, 16);
+        head.put(0, 24);
+        head.put(0, 24);
+        head.put(rate_, 20);
+        head.put(channels_ - 1u, 3);
+        head.put(bps_ - 1, 5);
+        head.put(static_cast<uint32_t>(frames >> 32), 4);
+        head.put(static_cast<uint32_t>(frames), 32);
+        for (unsigned char b : digest) head.put(b, 8);
+        head.put(1, 1);
+        head.put(3, 7);
+        head.put(static_cast<uint32_t>(seekPoints.size() * 18), 24);
+        for (const auto& point : seekPoints) {
+            head.put(static_cast<uint32_t>(point.first >> 32), 32);
+            head.put(static_cast<uint32_t>(point.first), 32);
+            head.put(static_cast<uint32_t>(point.second >> 32), 32);
+            head.put(static_cast<uint32_t>(point.second), 32);
+            head.put(kBlockSize, 16);
+        }
+        return head.bytes() + audio;
+    }
+
+private:
+    std::string encodeFrame(const int32_t* planar, uint32_t n, uint64_t number) {
+        // 立体声按各组合的估计位数选择声道编码方式
+        uint8_t assignment = static_cast<uint8_t>(channels_ - 1);
+        std::vector<int32_t> side, mid;
+        if (channels_ == 2) {
+            const int32_t* l = planar;
+            const int32_t* r = planar + n;
+            side.resize(n);
+            mid.resize(n);
+            for (uint32_t i = 0; i < n; i++) {
+                side[i] = l[i] - r[i];
+                mid[i] = (l[i] + r[i]) >> 1;
+            }
+            uint64_t cl = roughCost(l, n), cr = roughCost(r, n), cs = roughCost(side.data(), n),
+                     cm = roughCost(mid.data(), n);
+            uint64_t best = cl + cr;
+            if (cl + cs < best) { best = cl + cs; assignment = 8; }
+            if (cs + cr < best) { best = cs + cr; assignment = 9; }
+            if (cm + cs < best) { assignment = 10; }
+        }
+
+        BitWriter w;
+        w.put(0xFFF8, 16);
+        uint32_t blockCode = n == kBlockSize ? 12 : 7;
+        w.put(blockCode, 4);
+        w.put(rate_ == 44100 ? 9 : rate_ == 48000 ? 10 : rate_ == 22050 ? 6 : 0, 4);
+        w.put(assignment, 4);
+        w.put(bps_ == 16 ? 4 : bps_ == 24 ? 6 : bps_ == 8 ? 1 : 0, 3);
+        w.put(0, 1);
+        putUtf8(w, number);
+        if (blockCode == 7) w.put(n - 1, 16);
+        w.put(SeekScan::crc8(reinterpret_cast<const unsigned char*>(w.bytes().data()), w.bytes().size()), 8);
+
+        for (uint16_t c = 0; c < channels_; c++) {
+            const int32_t* x = planar + c * static_cast<size_t>(n);
+            uint32_t bps = bps_;
+            if ((assignment == 8 && c == 1) || (assignment == 9 && c == 0) || (assignment == 10 && c == 1)) {
+                x = side.data();
+                bps++;
+            } else if (assignment == 10 && c == 0) {
+                x = mid.data();
+            }
+            encodeSubframe(w, x, n, bps);
+        }
+        w.align();
+        uint16_t crc = flacCrc16(reinterpret_cast<const unsigned char*>(w.bytes().data()), w.bytes().size());
+        w.put(crc, 16);
+        return w.bytes();
+    }
+
+    static void putUtf8(BitWriter& w, uint64_t v) {
+        if (v < 0x80) {
+            w.put(static_cast<uint32_t>(v), 8);
+            return;
+        }
+        unsigned extra = v < 0x800 ? 1 : v < 0x10000 ? 2 : v < 0x200000 ? 3 : v < 0x4000000 ? 4 : 5;
+        w.put((0xFF00u >> (extra + 1)) | static_cast<uint32_t>(v >> (6 * extra)), 8);
+        for (unsigned i = extra; i-- > 0;) w.put(0x80 | static_cast<uint32_t>((v >> (6 * i)) & 0x3F), 8);
+    }
+
+    // 二阶固定预测残差的绝对值和，用于选择立体声编码方式
+    static uint64_t roughCost(const int32_t* x, uint32_t n) {
+        uint64_t sum = 0;
+        for (uint32_t i = 2; i < n; i++) sum += static_cast<uint64_t>(std::llabs(int64_t(x[i]) - 2 * int64_t(x[i - 1]) + x[i - 2]));
+        return sum;
+    }
+
+    struct Candidate {
+        uint32_t type = 1;              // 子帧类型码
+        uint64_t bits = ~0ULL;
+        std::vector<int32_t> residual;  // 下标与样本对齐，从 order 起有效
+        std::vector<int32_t> coeffs;
+        unsigned precision = 0;
+        int shift = 0;
+        unsigned partitionOrder = 0;
+        std::vector<unsigned> params;
+    };
+
+    void encodeSubframe(BitWriter& w, const int32_t* input, uint32_t n, uint32_t bps) {
+        bool constant = true;
+        uint32_t any = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            constant = constant && input[i] == input[0];
+            any |= static_cast<uint32_t>(input[i]);
+        }
+        if (constant) {
+            w.put(0, 1);
+            w.put(0, 6);
+            w.put(0, 1);
+            w.putSigned(input[0], bps);
+            return;
+        }
+        unsigned wasted = 0;
+        while (!(any & 1)) {
+            any >>= 1;
+            wasted++;
+        }
+        std::vector<int32_t> shifted(input, input + n);
+        for (int32_t& v : shifted) v >>= wasted;
+        const int32_t* x = shifted.data();
+        bps -= wasted;
+
+        Candidate best;
+        best.bits = static_cast<uint64_t>(n) * bps;
+        Candidate trial;
+        for (unsigned order = 0; order <= 4 && order < n; order++) {
+            trial.type = 8 + order;
+            trial.residual.assign(n, 0);
+            for (uint32_t i = order; i < n; i++) {
+                int64_t p = 0;
+                if (order == 1) p = x[i - 1];
+                else if (order == 2) p = 2 * int64_t(x[i - 1]) - x[i - 2];
+                else if (order == 3) p = 3 * (int64_t(x[i - 1]) - x[i - 2]) + x[i - 3];
+                else if (order == 4) p = 4 * (int64_t(x[i - 1]) + x[i - 3]) - 6 * int64_t(x[i - 2]) - x[i - 4];
+                trial.residual[i] = static_cast<int32_t>(x[i] - p);
+            }
+            trial.bits = order * bps + chooseRice(trial, n, order);
+            if (trial.bits < best.bits) std::swap(best, trial);
+        }
+        if (lpcOrder_ > 0 && n > lpcOrder_ && makeLpc(x, n, bps, trial)) {
+            trial.bits = lpcOrder_ * (bps + trial.precision) + 9 + chooseRice(trial, n, lpcOrder_);
+            if (trial.bits < best.bits) std::swap(best, trial);
+        }
+
+        w.put(0, 1);
+        w.put(best.type, 6);
+        w.put(wasted ? 1 : 0, 1);
+        if (wasted) w.putUnary(wasted - 1);
+        if (best.type == 1) {
+            for (uint32_t i = 0; i < n; i++) w.putSigned(x[i], bps);
+            return;
+        }
+        unsigned order = best.type >= 32 ? best.type - 31 : best.type - 8;
+        for (unsigned i = 0; i < order; i++) w.putSigned(x[i], bps);
+        if (best.type >= 32) {
+            w.put(best.precision - 1, 4);
+            w.putSigned(best.shift, 5);
+            for (int32_t c : best.coeffs) w.putSigned(c, best.precision);
+        }
+        bool wide = false;
+        for (unsigned k : best.params) wide = wide || k > 14;
+        w.put(wide ? 1 : 0, 2);
+        w.put(best.partitionOrder, 4);
+        uint32_t per = n >> best.partitionOrder;
+        for (uint32_t p = 0, i = order; p < best.params.size(); p++) {
+            unsigned k = best.params[p];
+            w.put(k, wide ? 5 : 4);
+            for (uint32_t end = (p + 1) * per; i < end; i++) w.putRice(best.residual[i], k);
+        }
+    }
+
+    // Welch 窗自相关 + Levinson-Durbin 求预测系数，按 precision 位量化（误差反馈）
+    bool makeLpc(const int32_t* x, uint32_t n, uint32_t bps, Candidate& c) const {
+        unsigned order = lpcOrder_;
+        std::vector<double> windowed(n);
+        for (uint32_t i = 0; i < n; i++) {
+            double t = (2.0 * i - (n - 1)) / (n + 1);
+            windowed[i] = x[i] * (1.0 - t * t);
+        }
+        std::vector<double> autoc(order + 1, 0.0);
+        for (unsigned lag = 0; lag <= order; lag++) {
+            for (uint32_t i = lag; i < n; i++) autoc[lag] += windowed[i] * windowed[i - lag];
+        }
+        if (autoc[0] <= 0.0) return false;
+        autoc[0] *= 1.0 + 1e-9;
+        std::vector<double> a(order, 0.0), prev;
+        double err = autoc[0];
+        for (unsigned i = 0; i < order; i++) {
+            double r = autoc[i + 1];
+            for (unsigned j = 0; j < i; j++) r -= a[j] * autoc[i - j];
+            r /= err;
+            prev = a;
+            a[i] = r;
+            for (unsigned j = 0; j < i; j++) a[j] = prev[j] - r * prev[i - 1 - j];
+            err *= 1.0 - r * r;
+            if (err <= 0.0) return false;
+        }
+
+        double cmax = 0.0;
+        for (double v : a) cmax = std::max(cmax, std::fabs(v));
+        if (cmax <= 0.0) return false;
+        int exponent = 0;
+        std::frexp(cmax, &exponent);
+        int shift = static_cast<int>(precision_) - 1 - exponent;
+        if (shift < 0) return false;
+        shift = std::min(shift, 15);
+        int32_t qmax = (1 << (precision_ - 1)) - 1;
+        c.type = 31 + order;
+        c.precision = precision_;
+        c.shift = shift;
+        c.coeffs.assign(order, 0);
+        double carry = 0.0;
+        for (unsigned j = 0; j < order; j++) {
+            carry += a[j] * std::ldexp(1.0, shift);
+            long q = std::lround(carry);
+            q = std::max<long>(-qmax - 1, std::min<long>(qmax, q));
+            c.coeffs[j] = static_cast<int32_t>(q);
+            carry -= static_cast<double>(q);
+        }
+        c.residual.assign(n, 0);
+        for (uint32_t i = order; i < n; i++) {
+            int64_t sum = 0;
+            for (unsigned j = 0; j < order; j++) sum += static_cast<int64_t>(c.coeffs[j]) * x[i - 1 - j];
+            int64_t r = x[i] - (sum >> shift);
+            if (r > (1 << 30) || r < -(1 << 30)) return false;
+            c.residual[i] = static_cast<int32_t>(r);
+        }
+        (void)bps;
+        return true;
+    }
+
+    // 选择 Rice 分区阶与各分区参数，返回残差部分的位数（含方法与参数字段）
+    static uint64_t chooseRice(Candidate& c, uint32_t n, unsigned order) {
+        uint64_t bestBits = ~0ULL;
+        for (unsigned po = 0; po <= 6; po++) {
+            uint32_t per = n >> po;
+            if ((per << po) != n || per < order) break;
+            std::vector<unsigned> params;
+            uint64_t bits = 6;
+            for (uint32_t p = 0, i = order; p < (1u << po); p++) {
+                uint32_t end = (p + 1) * per;
+                uint64_t sum = 0;
+                uint32_t begin = i;
+                for (uint32_t j = begin; j < end; j++) {
+                    sum += (static_cast<uint32_t>(c.residual[j]) << 1) ^ static_cast<uint32_t>(c.residual[j] >> 31);
+                }
+                uint32_t count = end - begin;
+                unsigned guess = 0;
+                while (count && (static_cast<uint64_t>(count) << (guess + 1)) <= sum) guess++;
+                unsigned bestK = 0;
+                uint64_t bestCost = ~0ULL;
+                for (unsigned k = guess > 0 ? guess - 1 : 0; k <= std::min(guess + 1, 30u); k++) {
+                    uint64_t cost = 0;
+                    for (uint32_t j = begin; j < end; j++) {
+                        uint32_t u = (static_cast<uint32_t>(c.residual[j]) << 1) ^ static_cast<uint32_t>(c.residual[j] >> 31);
+                        cost += (u >> k) + 1 + k;
+                    }
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestK = k;
+                    }
+                }
+                params.push_back(bestK);
+                bits += 5 + bestCost;
+                i = end;
+            }
+            if (bits < bestBits) {
+                bestBits = bits;
+                c.partitionOrder = po;
+                c.params = params;
+            }
+        }
+        return bestBits;
+    }
+
+    uint32_t rate_;
+    uint16_t channels_;
+    uint32_t bps_;
+    unsigned lpcOrder_;
+    unsigned precision_;
+};
+
+// 类似音乐的合成信号：每 0.5 秒换一组带包络的泛音，加少量噪声；间隔出现静音段
+std::vector<int32_t> synthesize(uint32_t rate, uint16_t channels, uint32_t bps, double seconds, unsigned wasted) {
+    size_t frames = static_cast<size_t>(seconds * rate);
+    std::vector<int32_t> out(frames * channels);
+    double full = std::ldexp(1.0, static_cast<int>(bps) - 1) - 1.0;
+    uint32_t state = 2463534242u;
+    auto noise = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return static_cast<double>(state) / 4294967296.0 - 0.5;
+    };
+    static const double kNotes[] = { 220.0, 246.9, 261.6, 293.7, 329.6, 349.2, 392.0, 440.0 };
+    for (size_t i = 0; i < frames; i++) {
+        double t = static_cast<double>(i) / rate;
+        size_t segment = static_cast<size_t>(t * 2.0);
+        double local = t * 2.0 - static_cast<double>(segment);
+        bool silent = segment % 23 == 22;
+        double base = kNotes[(segment * 5) % 8];
+        double envelope = std::exp(-3.0 * local) * 0.6;
+        for (uint16_t c = 0; c < channels; c++) {
+            double v = 0.0;
+            if (!silent) {
+                for (int h = 1; h <= 4; h++) {
+                    v += std::sin(2.0 * kPi * base * h * (1.0 + 0.002 * c) * t) / h;
+                }
+                v = v * envelope + 0.002 * noise();
+            }
+            auto q = static_cast<int32_t>(std::lround(std::max(-1.0, std::min(1.0, v)) * full));
+            out[i * channels + c] = static_cast<int32_t>(static_cast<uint32_t>(q >> wasted) << wasted);
+        }
+    }
+    return out;
+}
+
+// 测试曲目：16 位立体声（主基准）、24 位立体声（64 位累加路径）、低 4 位为 0 的单声道（wasted bits）
+struct TrackSpec {
+    const char* name;
+    uint32_t rate;
+    uint16_t channels;
+    uint32_t bps;
+    double seconds;
+    unsigned wasted;
+    unsigned lpcOrder;
+    unsigned precision;
+};
+
+const TrackSpec kTracks[] = {
+    { "16bit", 44100, 2, 16, 30.0, 0, 8, 12 },
+    { "24bit", 48000, 2, 24, 10.0, 0, 12, 15 },
+    { "mono", 22050, 1, 16, 10.0, 4, 8, 12 },
+};
+
+struct Track {
+    TrackSpec spec;
+    std::string path;
+    std::vector<int32_t> pcm;
+    size_t bytes = 0;
+};
+
+class Corpus {
+public:
+    Corpus() {
+        namespace fs = std::filesystem;
+        root_ = fs::temp_directory_path() / ("musicplayer_bench_flac_" + std::to_string(
+            std::chrono::steady_clock::now().time_since_epoch().count()));
+        fs::create_directories(root_);
+        for (const TrackSpec& spec : kTracks) {
+            Track track;
+            track.spec = spec;
+            track.pcm = synthesize(spec.rate, spec.channels, spec.bps, spec.seconds, spec.wasted);
+            std::string bytes = FlacEncoder(spec.rate, spec.channels, spec.bps, spec.lpcOrder, spec.precision)
+                                    .encode(track.pcm);
+            track.bytes = bytes.size();
+            track.path = (root_ / (std::string(spec.name) + ".flac")).string();
+            std::ofstream(track.path, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            tracks_.push_back(std::move(track));
+        }
+    }
+
+    ~Corpus() {
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    const std::vector<Track>& tracks() const { return tracks_; }
+
+private:
+    std::filesystem::path root_;
+    std::vector<Track> tracks_;
+};
+
+const Corpus& corpus() {
+    static Corpus c;
+    return c;
+}
+
+WorkStealingPool& pool() {
+    static WorkStealingPool p;
+    return p;
+}
+
+// 解码整首曲目，返回帧数；out 非空时保存输出
+uint64_t decodeAll(FlacDecoder& decoder, std::vector<float>* out) {
+    std::vector<float> buffer(kReadFrames * decoder.getChannels());
+    uint64_t total = 0;
+    while (size_t n = decoder.read(buffer.data(), kReadFrames)) {
+        if (out) out->insert(out->end(), buffer.begin(), buffer.begin() + n * decoder.getChannels());
+        total += n;
+    }
+    return total;
+}
+
+const char* md5StatusName(FlacMd5Status status) {
+    switch (status) {
+        case FlacMd5Status::Match: return "match";
+        case FlacMd5Status::Mismatch: return "MISMATCH";
+        case FlacMd5Status::Unchecked: break;
+    }
+    return "unchecked";
+}
+
+// 各曲目：参考解码（标量单流）、SIMD 单流与帧并行三种输出逐样本比较，MD5 核对，随机定位后的样本与整曲解码比较；
+// 任何一项不一致都记为核对失败
+void reportCorrectness() {
+    static bool reported = false;
+    if (reported) return;
+    reported = true;
+    for (const Track& track : corpus().tracks()) {
+        const TrackSpec& spec = track.spec;
+        std::vector<float> reference, simd, parallel;
+        FlacMd5Status status[3];
+        for (int mode = 0; mode < 3; mode++) {
+            FlacDecoder decoder;
+            decoder.setVerifyMd5(true);
+            decoder.setSimdLevel(mode == 0 ? SimdLevel::Scalar : hostSimdLevel());
+            if (mode == 2) decoder.setParallel(&pool());
+            if (!benchCheck(decoder.open(track.path), "flac %s: failed to open", spec.name)) return;
+            decodeAll(decoder, mode == 0 ? &reference : mode == 1 ? &simd : &parallel);
+            status[mode] = decoder.getMd5Status();
+        }
+
+        // 与编码前的整数样本逐个比较
+        size_t exact = 0;
+        double scale = std::ldexp(1.0, static_cast<int>(spec.bps) - 1);
+        for (size_t i = 0; i < reference.size() && i < track.pcm.size(); i++) {
+            if (static_cast<int32_t>(std::lround(reference[i] * scale)) == track.pcm[i]) exact++;
+        }
+
+        FlacDecoder decoder;
+        decoder.open(track.path);
+        uint32_t state = 97531;
+        int seekExact = 0;
+        const int kSeeks = 50;
+        std::vector<float> buffer(kReadFrames * spec.channels);
+        for (int s = 0; s < kSeeks; s++) {
+            state = state * 1664525u + 1013904223u;
+            uint64_t frame = state % decoder.getTotalFrames();
+            decoder.seek(frame);
+            size_t n = decoder.read(buffer.data(), kReadFrames);
+            bool ok = decoder.tell() == frame + n && n > 0;
+            for (size_t i = 0; ok && i < n * spec.channels; i++) ok = buffer[i] == reference[frame * spec.channels + i];
+            seekExact += ok;
+        }
+
+        std::printf("# flac: %s %u Hz %u ch %u bit, %.1f s, ratio %.2f; md5 reference %s, %s %s, parallel %s; "
+                    "%zu/%zu samples exact; simd %s, parallel %s; %d/%d seeks exact\n",
+                    spec.name, spec.rate, spec.channels, spec.bps, spec.seconds,
+                    static_cast<double>(track.pcm.size() * ((spec.bps + 7) / 8)) / static_cast<double>(track.bytes),
+                    md5StatusName(status[0]), simdLevelName(hostSimdLevel()), md5StatusName(status[1]),
+                    md5StatusName(status[2]), exact, track.pcm.size(), simd == reference ? "identical" : "DIFFERS",
+                    parallel == reference ? "identical" : "DIFFERS", seekExact, kSeeks);
+        const char* modes[3] = { "reference", "simd", "parallel" };
+        for (int mode = 0; mode < 3; mode++) {
+            benchCheck(status[mode] == FlacMd5Status::Match, "flac %s: %s decode md5 %s", spec.name, modes[mode],
+                       md5StatusName(status[mode]));
+        }
+        benchCheck(reference.size() == track.pcm.size() && exact == track.pcm.size(),
+                   "flac %s: %zu/%zu samples exact", spec.name, exact, track.pcm.size());
+        benchCheck(simd == reference, "flac %s: simd output differs from the reference", spec.name);
+        benchCheck(parallel == reference, "flac %s: parallel output differs from the reference", spec.name);
+        benchCheck(seekExact == kSeeks, "flac %s: %d/%d seeks exact", spec.name, seekExact, kSeeks);
+    }
+}
+
+// LPC 内核的测试块：8 阶、4096 样本；wide 时为 12 阶 15 位系数（24 位流走 64 位累加的情形）
+struct LpcBlock {
+    explicit LpcBlock(bool wide)
+        : order(wide ? 12 : 8), shift(wide ? 14 : 11), residual(kSize), out(kSize + 12) {
+        static const int32_t kCoeffs[8] = { 3010, -2210, 1180, -420, 190, -95, 40, -12 };
+        static const int32_t kWideCoeffs[12] = { 24080, -17680, 9440, -3360, 1520, -760, 320, -96, 48, -24, 12, -6 };
+        std::copy(wide ? kWideCoeffs : kCoeffs, (wide ? kWideCoeffs : kCoeffs) + order, coeffs);
+        uint32_t state = 12345;
+        for (int32_t& r : residual) {
+            state = state * 1664525u + 1013904223u;
+            r = static_cast<int32_t>(state >> (wide ? 12 : 20)) - (wide ? (1 << 19) : 2048);
+        }
+    }
+
+    void run(FlacKernels::LpcFn lpc) {
+        std::fill(out.begin() + order, out.end(), 0);
+        lpc(residual.data(), out.data(), kSize, coeffs, order, shift);
+        doNotOptimize(out[kSize - 1]);
+    }
+
+    static constexpr size_t kSize = 4096;
+    unsigned order;
+    int shift;
+    int32_t coeffs[12] = {};
+    std::vector<int32_t> residual, out;
+};
+
+// 取若干轮中最快的一次（秒），减少调度干扰
+template <typename Fn>
+double fastest(int rounds, Fn&& fn) {
+    double best = 1e30;
+    for (int r = 0; r < rounds; r++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+// 按本机指令集选出的路径不应比标量参考慢（留 5% 计时误差）：LPC 内核逐级比较，整曲解码逐曲目比较
+const double kSimdTolerance = 1.05;
+
+void checkKernelSpeed() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    for (bool wide : { false, true }) {
+        LpcBlock block(wide);
+        auto kernel = [wide](SimdLevel level) { return wide ? FlacKernels::selectWide(level) : FlacKernels::select(level); };
+        FlacKernels::LpcFn chosen = kernel(hostSimdLevel());
+        auto time = [&block](FlacKernels::LpcFn lpc) {
+            return fastest(200, [&block, lpc]() { block.run(lpc); });
+        };
+        double chosenSeconds = time(chosen);
+        for (SimdLevel level : kLevels) {
+            if (!simdLevelSupported(level) || kernel(level) == chosen) continue;
+            double seconds = time(kernel(level));
+            benchCheck(chosenSeconds <= seconds * kSimdTolerance,
+                       "flac: %s lpc kernel for %s (%.1f us) is slower than the %s one (%.1f us)",
+                       wide ? "64-bit" : "32-bit", simdLevelName(hostSimdLevel()), chosenSeconds * 1e6,
+                       simdLevelName(level), seconds * 1e6);
+        }
+    }
+}
+
+void checkDecodeSpeed() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    if (hostSimdLevel() == SimdLevel::Scalar) return;
+    for (const Track& track : corpus().tracks()) {
+        double seconds[2] = { 1e30, 1e30 };
+        // 两种路径交替运行，机器负载的变化对两边影响相同
+        for (int round = 0; round < 5; round++) {
+            for (int mode = 0; mode < 2; mode++) {
+                seconds[mode] = std::min(seconds[mode], fastest(1, [&track, mode]() {
+                    FlacDecoder decoder;
+                    decoder.setSimdLevel(mode == 0 ? SimdLevel::Scalar : hostSimdLevel());
+                    if (decoder.open(track.path)) decodeAll(decoder, nullptr);
+                }));
+            }
+        }
+        benchCheck(seconds[1] <= seconds[0] * kSimdTolerance,
+                   "flac %s: %s decode (%.2f ms) is slower than the scalar reference (%.2f ms)", track.spec.name,
+                   simdLevelName(hostSimdLevel()), seconds[1] * 1e3, seconds[0] * 1e3);
+    }
+}
+
+BenchRegistrar registerFlac([]() {
+    // LPC 恢复内核：32 位累加（16 位流）与 64 位累加（24 位流）
+    for (bool wide : { false, true }) {
+        for (SimdLevel level : kLevels) {
+            if (!simdLevelSupported(level)) continue;
+            std::string name = std::string(wide ? "flac/lpc-wide/" : "flac/lpc/") + simdLevelName(level);
+            registerBenchmark(name, "samples", [level, wide](uint64_t iterations) {
+                checkKernelSpeed();
+                FlacKernels::LpcFn lpc = wide ? FlacKernels::selectWide(level) : FlacKernels::select(level);
+                LpcBlock block(wide);
+                for (uint64_t i = 0; i < iterations; i++) block.run(lpc);
+                return static_cast<double>(iterations * (LpcBlock::kSize - block.order));
+            });
+        }
+    }
+
+    // 整曲解码：单位为音频秒，吞吐量即实时倍数。reference 为标量单流路径
+    for (const TrackSpec& spec : kTracks) {
+        std::string name = spec.name;
+        for (int mode = 0; mode < 3; mode++) {
+            static const char* kModes[] = { "reference", "simd", "parallel" };
+            registerBenchmark("flac/decode/" + name + "/" + kModes[mode], "audio-sec", [name, mode](uint64_t iterations) {
+                reportCorrectness();
+                checkDecodeSpeed();
+                const Track* track = nullptr;
+                for (const Track& t : corpus().tracks()) {
+                    if (name == t.spec.name) track = &t;
+                }
+                double seconds = 0.0;
+                for (uint64_t i = 0; i < iterations; i++) {
+                    FlacDecoder decoder;
+                    decoder.setSimdLevel(mode == 0 ? SimdLevel::Scalar : hostSimdLevel());
+                    if (mode == 2) decoder.setParallel(&pool());
+                    if (!track || !decoder.open(track->path)) return 0.0;
+                    seconds += static_cast<double>(decodeAll(decoder, nullptr)) / decoder.getSampleRate();
+                }
+                return seconds;
+            });
+        }
+    }
+});
+
+} // namespace
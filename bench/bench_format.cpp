@@ -0,0 +1,315 @@
+#include "AudioSink.h"
+#include "BenchFixtures.h"
+#include "BenchHarness.h"
+#include "DecoderFactory.h"
+#include "LibraryScanner.h"
+#include "WavDecoder.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+// 基线：旧的扩展名判断，每个文件名分配一个小写副本再逐个比较
+bool lowercaseCopyIsAudio(const std::string& filename) {
+    size_t lastDot = filename.find_last_of('.');
+    if (lastDot == std::string::npos) return false;
+    std::string ext = filename.substr(lastDot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".mp3" || ext == ".wav" || ext == ".ogg" ||
+           ext == ".flac" || ext == ".m4a" || ext == ".wma";
+}
+
+// 典型曲库目录中的文件名：多数是音频，夹杂封面、歌词与播放列表
+const std::vector<std::string>& fileNames() {
+    static const std::vector<std::string> names = []() {
+        static const char* kSuffixes[] = { ".mp3", ".flac", ".FLAC", ".m4a", ".ogg", ".wav",
+                                           ".jpg", ".lrc", ".cue", ".Mp3", ".txt", ".wma" };
+        std::vector<std::string> out;
+        for (int i = 0; i < 1024; i++) {
+            out.push_back("0" + std::to_string(i % 20) + " - Some Artist - Track Title " +
+                          std::to_string(i) + kSuffixes[(i * 7) % 12]);
+        }
+        return out;
+    }();
+    return names;
+}
+
+std::string id3Header(uint32_t bodySize) {
+    std::string out = "ID3";
+    out += '\x03';
+    out += '\0';
+    out += '\0';
+    for (int shift = 21; shift >= 0; shift -= 7) out += static_cast<char>((bodySize >> shift) & 0x7F);
+    return out;
+}
+
+// 128 kbit/s、44.1 kHz 的 MPEG-1 Layer III 帧（417 字节，载荷为 0）
+std::string mpegFrames(int count) {
+    std::string out;
+    for (int i = 0; i < count; i++) {
+        std::string frame(417, '\0');
+        frame[0] = '\xFF';
+        frame[1] = '\xFB';
+        frame[2] = '\x90';
+        frame[3] = '\x64';
+        out += frame;
+    }
+    return out;
+}
+
+// 0.1 秒静音的 44.1 kHz 立体声 WAV
+std::string wavFile() {
+    const uint32_t bytes = 4410 * 4;
+    return wavHeader(44100, 2, bytes) + std::string(bytes, '\0');
+}
+
+struct SampleFile {
+    const char* name;
+    std::string content;
+    AudioFormat expected;
+};
+
+// 各种格式的文件头，以及扩展名与内容不符的文件
+std::vector<SampleFile> sampleFiles() {
+    std::string flac = "fLaC";
+    flac += std::string("\x80\0\0\x22", 4);
+    flac.append(34, '\0');
+    std::string mp4(4, '\0');
+    mp4[3] = 24;
+    mp4 += "ftypM4A ";
+    mp4.append(12, '\0');
+    std::string asf = std::string("\x30\x26\xB2\x75\x8E\x66\xCF\x11\xA6\xD9\x00\xAA\x00\x62\xCE\x6C", 16);
+    asf.append(32, '\0');
+    std::string ogg = "OggS";
+    ogg.append(60, '\0');
+    return {
+        { "tagged.mp3", id3Header(200) + std::string(200, '\0') + mpegFrames(4), AudioFormat::Mp3 },
+        { "bare.mp3", mpegFrames(8), AudioFormat::Mp3 },
+        { "padded.mp3", std::string(100, '\0') + mpegFrames(8), AudioFormat::Mp3 },
+        { "track.flac", flac, AudioFormat::Flac },
+        { "art.flac", id3Header(8000) + std::string(8000, '\0') + flac, AudioFormat::Flac },
+        { "track.wav", wavFile(), AudioFormat::Wav },
+        { "track.ogg", ogg, AudioFormat::Ogg },
+        { "track.m4a", mp4, AudioFormat::Mp4 },
+        { "track.wma", asf, AudioFormat::Wma },
+        { "actually-wav.flac", wavFile(), AudioFormat::Wav },
+        { "lyrics.mp3", "[00:01.00] la la la\n[00:02.00] la la\n", AudioFormat::Unknown },
+        { "cover.flac", std::string("\xFF\xD8\xFF\xE0\0\x10JFIF", 10) + std::string(500, '\0'), AudioFormat::Unknown },
+        { "empty.ogg", "", AudioFormat::Unknown },
+    };
+}
+
+class SampleDirectory {
+public:
+    SampleDirectory() {
+        namespace fs = std::filesystem;
+        root_ = fs::temp_directory_path() / ("musicplayer_bench_format_" + std::to_string(
+            std::chrono::steady_clock::now().time_since_epoch().count()));
+        fs::create_directories(root_);
+        files_ = sampleFiles();
+        for (const SampleFile& file : files_) {
+            std::ofstream(root_ / file.name, std::ios::binary).write(file.content.data(),
+                                                                    static_cast<std::streamsize>(file.content.size()));
+        }
+    }
+
+    ~SampleDirectory() {
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    std::string path() const { return root_.string(); }
+    std::string pathOf(const SampleFile& file) const { return (root_ / file.name).string(); }
+    const std::vector<SampleFile>& files() const { return files_; }
+
+private:
+    std::filesystem::path root_;
+    std::vector<SampleFile> files_;
+};
+
+SampleDirectory& samples() {
+    static SampleDirectory dir;
+    return dir;
+}
+
+SyntheticLibrary& library() {
+    static SyntheticLibrary lib("format", 16, 8, 12);
+    return lib;
+}
+
+WorkStealingPool& pool() {
+    static WorkStealingPool p(1);
+    return p;
+}
+
+// 嗅探结果与预期不符的文件；扫描接受与拒绝的数目；WAV 内容的 .flac 能否由注册表打开
+void reportCorrectness() {
+    static bool reported = false;
+    if (reported) return;
+    reported = true;
+    size_t mismatches = 0;
+    for (const SampleFile& file : samples().files()) {
+        AudioFormat got = sniffAudioFile(samples().pathOf(file)).format;
+        if (got != file.expected) {
+            std::printf("# format: %s sniffed as %s, expected %s\n", file.name,
+                        audioFormatName(got), audioFormatName(file.expected));
+            mismatches++;
+        }
+    }
+    LibraryScanner scanner(pool());
+    ScanResult result = scanner.scan(samples().path());
+    std::unique_ptr<AudioDecoder> mislabeled = openAudioDecoder(samples().path() + "/actually-wav.flac");
+    std::printf("# format: %zu sample files, %zu sniffed wrong; scan kept %zu, rejected %zu; "
+                "WAV named .flac %s\n", samples().files().size(), mismatches, result.stats.tracks,
+                result.stats.rejected, mislabeled ? "opened" : "FAILED to open");
+}
+
+// WAV 输出端：渲染方写入的周期由写出线程落盘，关闭后文件应包含全部样本（缓冲区容量之内不丢弃）
+void checkWavSink() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    const size_t kPeriod = 512;
+    const size_t kPeriods = 100;
+    TempDirectory dir("wav_sink");
+    std::string path = dir.file("out.wav");
+    auto sample = [](size_t i) { return static_cast<float>(i % 397) / 397.0f - 0.5f; };
+    std::vector<float> period(kPeriod * 2);
+    WavFileAudioSink sink(path);
+    if (!benchCheck(sink.open(44100, 2, kPeriod), "wav sink: cannot open %s", path.c_str())) return;
+    for (size_t p = 0; p < kPeriods; p++) {
+        for (size_t i = 0; i < period.size(); i++) period[i] = sample(p * period.size() + i);
+        sink.write(period.data(), kPeriod);
+    }
+    sink.close();
+    benchCheck(sink.getDroppedFrames() == 0, "wav sink: dropped %llu frames",
+               static_cast<unsigned long long>(sink.getDroppedFrames()));
+
+    std::unique_ptr<AudioDecoder> decoder = openAudioDecoder(path);
+    if (!benchCheck(decoder != nullptr, "wav sink: output does not open")) return;
+    std::vector<float> decoded(kPeriod * kPeriods * 2 + 2);
+    size_t frames = decoder->read(decoded.data(), kPeriod * kPeriods + 1);
+    size_t exact = 0;
+    for (size_t i = 0; i < frames * 2; i++) {
+        exact += std::lround(decoded[i] * 32768.0f) == static_cast<long>(sample(i) * 32767.0f);
+    }
+    benchCheck(frames == kPeriod * kPeriods && exact == frames * 2,
+               "wav sink: %zu frames written back, %zu/%zu samples exact", frames, exact, frames * 2);
+}
+
+// 流式 WAV 解码器：fmt 块大小超出文件时直接拒绝（不按声明的大小分配），带扩展字节的 fmt 块照常打开
+void checkWavFmtSize() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    TempDirectory dir("wav_fmt");
+    auto setLE32 = [](std::string& wav, size_t at, uint32_t v) {
+        for (int i = 0; i < 4; i++) wav[at + i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+    };
+    std::string huge = wavHeader(44100, 2, 56);
+    setLE32(huge, 16, 0xFFFFFF00u);
+    huge.resize(100, '\0');
+    std::string extended = wavHeader(44100, 2, 16);
+    setLE32(extended, 16, 18);
+    extended.insert(36, 2, '\0');
+    extended.resize(extended.size() + 16, '\0');
+    const struct { const char* name; const std::string& data; bool opens; } cases[] = {
+        { "huge-fmt.wav", huge, false }, { "extended-fmt.wav", extended, true },
+    };
+    for (const auto& c : cases) {
+        std::string path = dir.file(c.name);
+        std::ofstream(path, std::ios::binary).write(c.data.data(), static_cast<std::streamsize>(c.data.size()));
+        WavDecoder decoder;
+        auto start = std::chrono::steady_clock::now();
+        bool opened = decoder.open(path);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        bool expected = opened == c.opens &&
+                        (!opened || (decoder.getSampleRate() == 44100 && decoder.getTotalFrames() == 4));
+        benchCheck(expected, "wav: %s %s (%.1f ms)", c.name, opened ? "opened" : "was rejected", ms);
+        benchCheck(ms < 50.0, "wav: opening %s took %.1f ms", c.name, ms);
+    }
+}
+
+BenchRegistrar registerFormat([]() {
+    registerBenchmark("format/extension/perfect-hash", "names", [](uint64_t iterations) {
+        const auto& names = fileNames();
+        size_t audio = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            for (const std::string& name : names) audio += hasAudioExtension(name);
+        }
+        doNotOptimize(audio);
+        return static_cast<double>(iterations * names.size());
+    });
+
+    registerBenchmark("format/extension/lowercase-copy", "names", [](uint64_t iterations) {
+        const auto& names = fileNames();
+        size_t audio = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            for (const std::string& name : names) audio += lowercaseCopyIsAudio(name);
+        }
+        doNotOptimize(audio);
+        return static_cast<double>(iterations * names.size());
+    });
+
+    // 内存中的文件头识别
+    registerBenchmark("format/sniff/memory", "files", [](uint64_t iterations) {
+        reportCorrectness();
+        checkWavSink();
+        checkWavFmtSize();
+        const auto& files = samples().files();
+        size_t known = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            for (const SampleFile& file : files) {
+                const auto* head = reinterpret_cast<const unsigned char*>(file.content.data());
+                known += sniffAudioFormat(head, std::min(file.content.size(), kSniffBytes)) != AudioFormat::Unknown;
+            }
+        }
+        doNotOptimize(known);
+        return static_cast<double>(iterations * files.size());
+    });
+
+    // 打开解码器前的格式判断：读取文件头嗅探与命中格式缓存
+    for (int cached = 0; cached < 2; cached++) {
+        registerBenchmark(cached ? "format/probe/cached" : "format/probe/sniff", "files", [cached](uint64_t iterations) {
+            std::vector<std::string> paths;
+            for (const SampleFile& file : samples().files()) paths.push_back(samples().pathOf(file));
+            size_t known = 0;
+            for (uint64_t i = 0; i < iterations; i++) {
+                for (const std::string& path : paths) {
+                    AudioFormat format = cached ? probeAudioFormat(path) : sniffAudioFile(path).format;
+                    known += format != AudioFormat::Unknown;
+                }
+            }
+            doNotOptimize(known);
+            return static_cast<double>(iterations * paths.size());
+        });
+    }
+
+    // 扫描时嗅探内容的代价：与只按扩展名过滤比较
+    for (int sniff = 0; sniff < 2; sniff++) {
+        registerBenchmark(sniff ? "format/scan/sniff" : "format/scan/extension-only", "files", [sniff](uint64_t iterations) {
+            LibraryScanner scanner(pool());
+            ScanOptions options;
+            options.sniffContent = sniff != 0;
+            double entries = 0;
+            for (uint64_t i = 0; i < iterations; i++) {
+                ScanResult result = scanner.scan(library().path(), options);
+                entries += static_cast<double>(result.stats.entries);
+                doNotOptimize(result.stats.tracks);
+            }
+            return entries;
+        });
+    }
+});
+
+} // namespace
@@ -0,0 +1,56 @@
+#include "BenchHarness.h"
+#include "GainStage.h"
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+// 每次迭代处理一个 1024 帧立体声缓冲区
+const size_t kFrames = 1024;
+const uint16_t kChannels = 2;
+
+BenchRegistrar registerGain([]() {
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2,
+                                 SimdLevel::AVX2, SimdLevel::NEON };
+    for (SimdLevel level : levels) {
+        if (!simdLevelSupported(level)) continue;
+        std::string isa = simdLevelName(level);
+
+        registerBenchmark("gain/constant/" + isa, "samples", [level](uint64_t iterations) {
+            GainKernels::KernelSet k = GainKernels::select(level);
+            std::vector<float> buf(kFrames * kChannels, 0.25f);
+            for (uint64_t i = 0; i < iterations; i++) {
+                // 交替使用互逆的 2 的幂，避免样本逐渐衰减为非规格化数
+                k.constant(buf.data(), buf.size(), (i & 1) ? 0.5f : 2.0f);
+                doNotOptimize(buf[0]);
+            }
+            return static_cast<double>(iterations * buf.size());
+        });
+
+        registerBenchmark("gain/ramp/" + isa, "samples", [level](uint64_t iterations) {
+            GainKernels::KernelSet k = GainKernels::select(level);
+            std::vector<float> buf(kFrames * kChannels, 0.25f);
+            for (uint64_t i = 0; i < iterations; i++) {
+                k.ramp(buf.data(), kFrames, kChannels, 1.0f, (i & 1) ? 1e-7f : -1e-7f);
+                doNotOptimize(buf[0]);
+            }
+            return static_cast<double>(iterations * buf.size());
+        });
+
+        // 完整增益级：每个缓冲区都改变一次目标，始终处于斜坡中
+        registerBenchmark("gain/stage-ramping/" + isa, "samples", [level](uint64_t iterations) {
+            GainStage stage(1.0f, 4096, level);
+            std::vector<float> buf(kFrames * kChannels, 0.25f);
+            for (uint64_t i = 0; i < iterations; i++) {
+                stage.setTarget((i & 1) ? 0.999f : 1.001f);
+                stage.process(buf.data(), kFrames, kChannels);
+                doNotOptimize(buf[0]);
+            }
+            return static_cast<double>(iterations * buf.size());
+        });
+    }
+});
+
+} // namespace
@@ -0,0 +1,134 @@
+#include "BenchFixtures.h"
+#include "BenchHarness.h"
+#include "LibraryIndex.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+// 磁盘上的合成曲库及其索引文件
+struct IndexedLibrary {
+    SyntheticLibrary tree;
+    std::string indexPath;
+    size_t tracks = 0;
+
+    // fakeTracksPerAlbum > 0 时不在磁盘上创建曲目文件，只把虚构的曲目写入索引：
+    // 加载时只验证目录，这样无需创建百万个文件即可测量百万曲目索引的加载
+    IndexedLibrary(const std::string& tag, int artists, int albums, int tracksPerAlbum,
+                   int fakeTracksPerAlbum, WorkStealingPool& pool)
+        : tree(tag, artists, albums, tracksPerAlbum) {
+        LibraryScanner scanner(pool);
+        ScanOptions options;
+        options.fileStats = true;
+        ScanResult result = scanner.scan(tree.path(), options);
+        for (auto& dir : result.directories) {
+            for (int t = 0; t < fakeTracksPerAlbum; t++) {
+                if (dir.path.find("album") == std::string::npos) break;
+                ScannedFile file;
+                file.name = "track" + std::to_string(t) + ".flac";
+                file.size = 30000000 + t;
+                file.mtimeNs = 1700000000000000000LL + t;
+                dir.files.push_back(std::move(file));
+            }
+        }
+        Library library;
+        library.addScan(tree.path(), result);
+        tracks = library.trackCount();
+        indexPath = tree.path() + ".idx";
+        library.save(indexPath);
+    }
+
+    ~IndexedLibrary() {
+        std::remove(indexPath.c_str());
+    }
+};
+
+WorkStealingPool& pool() {
+    static WorkStealingPool p;
+    return p;
+}
+
+IndexedLibrary& small() {
+    static IndexedLibrary lib("library", 100, 10, 12, 0, pool());
+    return lib;
+}
+
+IndexedLibrary& million() {
+    static IndexedLibrary lib("library1m", 40, 50, 0, 500, pool());
+    return lib;
+}
+
+double loadIndex(IndexedLibrary& lib, uint64_t iterations, bool toPlaylist) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        Library library;
+        library.load(lib.indexPath, pool());
+        if (toPlaylist) {
+            Playlist playlist;
+            library.appendTo(playlist);
+            doNotOptimize(playlist.size());
+        }
+        doNotOptimize(library.trackCount());
+    }
+    return static_cast<double>(iterations * lib.tracks);
+}
+
+// 百万曲目索引打开耗时的拆分：映射与验证目录、加入播放列表（重建列式存储）；目标为合计 100 ms 以内。
+// 以进程内第一次打开为准：之后的打开复用分配器已经缺页换入的内存，比真实启动快
+void reportMillion() {
+    static bool reported = false;
+    if (reported) return;
+    reported = true;
+    IndexedLibrary& lib = million();
+    auto start = std::chrono::steady_clock::now();
+    Library library;
+    library.load(lib.indexPath, pool());
+    auto mapped = std::chrono::steady_clock::now();
+    Playlist playlist;
+    library.appendTo(playlist);
+    auto end = std::chrono::steady_clock::now();
+    doNotOptimize(playlist.size());
+    double mapMs = std::chrono::duration<double, std::milli>(mapped - start).count();
+    double appendMs = std::chrono::duration<double, std::milli>(end - mapped).count();
+    double total = mapMs + appendMs;
+    std::printf("# library: first open of a %zu-track index: map + validate %.1f ms, into the playlist %.1f ms, "
+                "total %.1f ms (target 100 ms: %s)\n",
+                lib.tracks, mapMs, appendMs, total, total < 100.0 ? "met" : "MISSED");
+}
+
+BenchRegistrar registerLibrary([]() {
+    // 冷启动：递归扫描（含文件大小与时间）后加入播放列表
+    registerBenchmark("library/cold-rescan", "tracks", [](uint64_t iterations) {
+        IndexedLibrary& lib = small();
+        LibraryScanner scanner(pool());
+        ScanOptions options;
+        options.fileStats = true;
+        for (uint64_t i = 0; i < iterations; i++) {
+            ScanResult result = scanner.scan(lib.tree.path(), options);
+            Playlist playlist;
+            playlist.addTracks(result.paths());
+            doNotOptimize(playlist.size());
+        }
+        return static_cast<double>(iterations * lib.tracks);
+    });
+
+    // 映射索引、验证目录修改时间并加入播放列表
+    registerBenchmark("library/index-load", "tracks", [](uint64_t iterations) {
+        return loadIndex(small(), iterations, true);
+    });
+
+    registerBenchmark("library/index-map-1M", "tracks", [](uint64_t iterations) {
+        return loadIndex(million(), iterations, false);
+    });
+
+    registerBenchmark("library/index-load-1M", "tracks", [](uint64_t iterations) {
+        reportMillion();
+        return loadIndex(million(), iterations, true);
+    });
+});
+
+} // namespace
@@ -0,0 +1,191 @@
+#include "BenchFixtures.h"
+#include "BenchHarness.h"
+#include "LoudnessPipeline.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+// 内核基准每次迭代处理一个 4096 帧立体声块；吞吐量以“音频秒/秒”报告
+const size_t kFrames = 4096;
+const uint16_t kChannels = 2;
+const uint32_t kRate = 44100;
+const double kPi = 3.14159265358979323846;
+
+const SimdLevel kLevels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+
+// 立体声正弦，amplitudeDb 为每声道的峰值电平
+void appendTone(std::vector<float>& out, uint32_t rate, double freq, double amplitudeDb,
+                double seconds, double phase = 0.0) {
+    double amplitude = std::pow(10.0, amplitudeDb / 20.0);
+    size_t frames = static_cast<size_t>(seconds * rate);
+    size_t start = out.size() / kChannels;
+    for (size_t i = 0; i < frames; i++) {
+        float x = static_cast<float>(amplitude * std::sin(2.0 * kPi * freq * (start + i) / rate + phase));
+        out.push_back(x);
+        out.push_back(x);
+    }
+}
+
+LoudnessResult measure(const std::vector<float>& samples, uint32_t rate) {
+    LoudnessMeter meter;
+    meter.reset(rate, kChannels);
+    // 以不规则的块长度输入，覆盖跨块的分段与过采样
+    size_t frames = samples.size() / kChannels;
+    for (size_t pos = 0; pos < frames; pos += 1237) {
+        size_t n = std::min<size_t>(1237, frames - pos);
+        meter.process(samples.data() + pos * kChannels, n);
+    }
+    return meter.result();
+}
+
+// 精度检查（首次运行响度基准时输出一次），信号取自 EBU Tech 3341 的测试用例：
+// 1 kHz 立体声正弦 -23 dBFS 应读 -23.0 LUFS；-36/-23/-36 dBFS 的分段信号经门限后同样为 -23.0；
+// fs/4、相位 45° 的满幅正弦样本峰值为 -3 dBFS，真峰值应为 0 dBTP（Tech 3341 允许 +0.2/-0.4 dB）
+void reportAccuracy() {
+    static bool reported = false;
+    if (reported) return;
+    reported = true;
+    for (uint32_t rate : { 44100u, 48000u }) {
+        std::vector<float> tone;
+        appendTone(tone, rate, 1000.0, -23.0, 20.0);
+        std::vector<float> gated;
+        appendTone(gated, rate, 1000.0, -36.0, 10.0);
+        appendTone(gated, rate, 1000.0, -23.0, 60.0);
+        appendTone(gated, rate, 1000.0, -36.0, 10.0);
+        std::vector<float> peak;
+        appendTone(peak, rate, rate / 4.0, 0.0, 2.0, kPi / 4.0);
+        LoudnessResult peakResult = measure(peak, rate);
+        std::printf("# loudness %u Hz: 1 kHz -23 dBFS reads %.2f LUFS, gated -36/-23/-36 reads %.2f LUFS; "
+                    "fs/4 45deg sine: sample peak -3.01 dBFS, true peak %.2f dBTP\n",
+                    rate, measure(tone, rate).integrated, measure(gated, rate).integrated,
+                    peakResult.truePeakDb());
+    }
+}
+
+std::vector<float> noiseBlock() {
+    std::vector<float> in(kFrames * kChannels);
+    uint32_t state = 12345;
+    for (float& x : in) {
+        state = state * 1664525u + 1013904223u;
+        x = static_cast<float>(static_cast<int32_t>(state)) * (0.25f / 2147483648.0f);
+    }
+    return in;
+}
+
+// 临时目录中的 16 位立体声 WAV 曲目，每首电平不同
+class WavTracks {
+public:
+    WavTracks(int count, double seconds) : dir_("loudness"), seconds_(seconds) {
+        for (int n = 0; n < count; n++) {
+            std::string path = dir_.file("track" + std::to_string(n) + ".wav");
+            double amplitude = std::pow(10.0, -(6.0 + n % 20) / 20.0);
+            writeSineWav(path, seconds, kRate, kChannels, 220.0 + 40.0 * n, amplitude);
+            paths_.push_back(path);
+        }
+    }
+
+    const std::vector<std::string>& paths() const { return paths_; }
+    double seconds() const { return seconds_; }
+
+private:
+    TempDirectory dir_;
+    std::vector<std::string> paths_;
+    double seconds_;
+};
+
+WavTracks& tracks() {
+    static WavTracks t(32, 30.0);
+    return t;
+}
+
+BenchRegistrar registerLoudness([]() {
+    for (SimdLevel level : kLevels) {
+        if (!simdLevelSupported(level)) continue;
+        registerBenchmark(std::string("loudness/kweight/") + simdLevelName(level), "audio-sec",
+                          [level](uint64_t iterations) {
+            reportAccuracy();
+            LoudnessKernels::KernelSet kernels = LoudnessKernels::select(level);
+            Biquad shelf, highPass;
+            kWeightingFilters(kRate, shelf, highPass);
+            std::vector<float> in = noiseBlock();
+            float state[4 * LoudnessKernels::kMaxChannels] = {};
+            float sums[LoudnessKernels::kMaxChannels] = {};
+            for (uint64_t i = 0; i < iterations; i++) {
+                kernels.kWeight(in.data(), kFrames, kChannels, shelf, highPass, state, sums);
+                doNotOptimize(sums[0]);
+            }
+            return static_cast<double>(iterations * kFrames) / kRate;
+        });
+
+        // 单声道 4 倍过采样，立体声需要两次
+        registerBenchmark(std::string("loudness/truepeak/") + simdLevelName(level), "audio-sec",
+                          [level](uint64_t iterations) {
+            LoudnessKernels::KernelSet kernels = LoudnessKernels::select(level);
+            auto bank = PolyphaseFilterBank::get(kRate, kRate * 4, ResamplerQuality::Fast);
+            std::vector<float> in = noiseBlock();
+            in.resize(kFrames + bank->taps);
+            float peak = 0.0f;
+            for (uint64_t i = 0; i < iterations; i++) {
+                peak = std::max(peak, kernels.truePeak(in.data(), kFrames, bank->coefficients.data(),
+                                                       bank->phases, bank->taps));
+                doNotOptimize(peak);
+            }
+            return static_cast<double>(iterations * kFrames) / kRate;
+        });
+
+        // 完整的立体声测量：K 计权 + 分段 + 两个声道的真峰值
+        registerBenchmark(std::string("loudness/meter/") + simdLevelName(level), "audio-sec",
+                          [level](uint64_t iterations) {
+            LoudnessMeter meter(level);
+            meter.reset(kRate, kChannels);
+            std::vector<float> in = noiseBlock();
+            for (uint64_t i = 0; i < iterations; i++) {
+                meter.process(in.data(), kFrames);
+            }
+            doNotOptimize(meter.result().integrated);
+            return static_cast<double>(iterations * kFrames) / kRate;
+        });
+    }
+
+    // 端到端：解码 + 测量，曲目在共享线程池上并行，提交方式与播放器的事件循环相同
+    registerBenchmark("loudness/pipeline", "tracks", [](uint64_t iterations) {
+        static bool reported = false;
+        WorkStealingPool pool;
+        const auto& paths = tracks().paths();
+        auto start = std::chrono::steady_clock::now();
+        double done = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            LoudnessPipeline pipeline(pool, 4 * pool.size());
+            size_t next = 0;
+            size_t finished = 0;
+            while (finished < paths.size()) {
+                while (next < paths.size() && pipeline.available() > 0) {
+                    pipeline.submit(next, paths[next]);
+                    next++;
+                }
+                finished += pipeline.drain([](LoudnessAnalysis& a) { doNotOptimize(a.result.integrated); });
+                std::this_thread::yield();
+            }
+            done += static_cast<double>(paths.size());
+        }
+        if (!reported) {
+            reported = true;
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::printf("# loudness pipeline: %.0f tracks/min (%.0fx realtime) on %zu threads, %zu tracks of %.0f s\n",
+                        done * 60.0 / seconds, done * tracks().seconds() / seconds, pool.size(),
+                        paths.size(), tracks().seconds());
+        }
+        return done;
+    });
+});
+
+} // namespace
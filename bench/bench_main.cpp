@@ -0,0 +1,154 @@
+#include "BenchHarness.h"
+#include "BenchReport.h"
+#include "Instrumentation.h"
+#include "Simd.h"
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MusicBench;
+
+namespace {
+
+BenchContext hostContext(double minSeconds, int repetitions) {
+    BenchContext context;
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    context.date = date;
+#if defined(__clang__)
+    context.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    context.compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    context.compiler = "msvc " + std::to_string(_MSC_VER);
+#endif
+#ifdef NDEBUG
+    context.buildType = "release";
+#else
+    context.buildType = "debug";
+#endif
+    context.simd = MusicApp::simdLevelName(MusicApp::hostSimdLevel());
+    context.threads = std::thread::hardware_concurrency();
+    context.minSeconds = minSeconds;
+    context.repetitions = repetitions;
+    return context;
+}
+
+const char* const kUsage =
+    "usage: musicplayer_bench [filter] [--min-time seconds] [--repetitions N] [--json file]\n"
+    "                         [--baseline file] [--threshold percent]\n";
+
+// 数值选项：整个参数须是 [min, max] 内的数字，否则报告用法错误并以状态 2 退出
+template <typename T>
+T parseOption(const char* option, const char* text, T min, T max) {
+    T value{};
+    const char* end = text + std::strlen(text);
+    auto result = std::from_chars(text, end, value);
+    if (text == end || result.ec != std::errc() || result.ptr != end || !(value >= min && value <= max)) {
+        std::fprintf(stderr, "invalid value for %s: '%s'\n%s", option, text, kUsage);
+        std::exit(2);
+    }
+    return value;
+}
+
+} // namespace
+
+// 用法: musicplayer_bench [过滤子串] [--min-time 秒] [--repetitions N] [--json 文件]
+//                         [--baseline 文件] [--threshold 百分比]
+// 指定基线时，吞吐量比基线低 threshold（默认 10%）以上的基准记为回退，进程返回 1
+// 基准附带的正确性核对（benchCheck）失败时返回 3；选项未知、选项值无效或文件无法读写时返回 2
+int main(int argc, char* argv[]) {
+    MUSICAPP_STATS_THREAD();
+    std::string filter;
+    std::string jsonPath;
+    std::string baselinePath;
+    double minSeconds = 0.25;
+    int repetitions = 1;
+    double threshold = 10.0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minSeconds = parseOption(argv[i], argv[i + 1], 0.0, 3600.0);
+            i++;
+        } else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = parseOption(argv[i], argv[i + 1], 1, 1000);
+            i++;
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = parseOption(argv[i], argv[i + 1], 0.0, 100.0);
+            i++;
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            std::fputs(kUsage, stdout);
+            return 0;
+        } else if (argv[i][0] == '-' || !filter.empty()) {
+            // 未知选项、缺少值的选项或第二个过滤子串：不把它当作过滤条件静默运行
+            const char* what = argv[i][0] == '-' ? "unknown or incomplete option" : "unexpected argument";
+            std::fprintf(stderr, "%s '%s'\n%s", what, argv[i], kUsage);
+            return 2;
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baselinePath.empty() && !readBaseline(baselinePath, baseline)) {
+        std::fprintf(stderr, "cannot read baseline %s\n", baselinePath.c_str());
+        return 2;
+    }
+
+    std::printf("%-40s %12s %14s %18s%s\n", "benchmark", "iterations", "ns/iter", "throughput",
+                baseline.empty() ? "" : "    vs baseline");
+    std::vector<BenchSummary> results;
+    size_t regressions = 0;
+    for (const auto& entry : benchRegistry()) {
+        if (!filter.empty() && entry.name.find(filter) == std::string::npos) continue;
+        std::vector<BenchResult> runs;
+        for (int rep = 0; rep < repetitions; rep++) {
+            runs.push_back(runBenchmark(entry, minSeconds));
+        }
+        BenchSummary s = summarize(std::move(runs));
+        const BenchResult& r = s.median;
+        std::printf("%-40s %12llu %14.1f %14.3e %s/s", r.name.c_str(),
+                    static_cast<unsigned long long>(r.iterations), r.nsPerIteration(),
+                    r.itemsPerSecond(), r.unit.c_str());
+        if (repetitions > 1) {
+            std::printf("  (±%.1f%%)", 50.0 * (s.maxItemsPerSecond - s.minItemsPerSecond) / r.itemsPerSecond());
+        }
+        auto it = baseline.find(r.name);
+        if (it != baseline.end() && it->second > 0) {
+            s.baselineItemsPerSecond = it->second;
+            bool regressed = s.change() * 100.0 < -threshold;
+            regressions += regressed;
+            std::printf("  %+6.1f%%%s", s.change() * 100.0, regressed ? "  REGRESSION" : "");
+        } else if (!baseline.empty()) {
+            std::printf("  (new)");
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+        results.push_back(s);
+    }
+
+    if (!jsonPath.empty() && !writeJson(jsonPath, hostContext(minSeconds, repetitions), results)) {
+        std::fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+        return 2;
+    }
+    if (benchCheckFailures() > 0) {
+        std::printf("%zu correctness check(s) failed\n", benchCheckFailures());
+        return 3;
+    }
+    if (regressions > 0) {
+        std::printf("%zu benchmark(s) regressed by more than %.1f%% against %s\n", regressions, threshold,
+                    baselinePath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include "BenchFixtures.h"
+#include "BenchHarness.h"
+#include "MetadataPipeline.h"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+void putBE32(std::string& out, uint32_t v) {
+    out += static_cast<char>(v >> 24);
+    out += static_cast<char>(v >> 16);
+    out += static_cast<char>(v >> 8);
+    out += static_cast<char>(v);
+}
+
+void putLE32(std::string& out, uint32_t v) {
+    out += static_cast<char>(v);
+    out += static_cast<char>(v >> 8);
+    out += static_cast<char>(v >> 16);
+    out += static_cast<char>(v >> 24);
+}
+
+// ID3v2.3 标签 + Xing 帧 + 恒定码率帧
+std::string makeMp3(int n, size_t audioBytes) {
+    auto frame = [](const char* id, const std::string& text) {
+        std::string f(id, 4);
+        putBE32(f, static_cast<uint32_t>(text.size() + 1));
+        f += std::string(2, '\0');
+        f += '\3';
+        return f + text;
+    };
+    std::string body = frame("TIT2", "Track " + std::to_string(n)) + frame("TPE1", "Artist " + std::to_string(n % 50));
+    body += std::string(1024, '\0');    // 填充
+    uint32_t size = static_cast<uint32_t>(body.size());
+    std::string out("ID3\3\0\0", 6);
+    out += static_cast<char>((size >> 21) & 0x7F);
+    out += static_cast<char>((size >> 14) & 0x7F);
+    out += static_cast<char>((size >> 7) & 0x7F);
+    out += static_cast<char>(size & 0x7F);
+    out += body;
+
+    std::string mpeg("\xFF\xFB\x90\x00", 4);    // MPEG-1 Layer III 128kbps 44.1kHz，帧长 417
+    mpeg.resize(417, '\0');
+    std::string xing = mpeg;
+    xing.replace(36, 12, std::string("Xing\0\0\0\1", 8) + std::string("\0\0\x10\0", 4));
+    out += xing;
+    while (out.size() < audioBytes) out += mpeg;
+    return out;
+}
+
+// STREAMINFO + 较大的 PICTURE 占位块 + Vorbis 注释；samples 为 0 时取 180-239 秒
+std::string makeFlac(int n, size_t audioBytes, uint32_t rate = 44100, uint64_t samples = 0) {
+    std::string out = "fLaC";
+    out += std::string("\x00\x00\x00\x22", 4);
+    std::string info(34, '\0');
+    if (samples == 0) samples = uint64_t(rate) * (180 + n % 60);
+    info[10] = static_cast<char>(rate >> 12);
+    info[11] = static_cast<char>(rate >> 4);
+    info[12] = static_cast<char>(((rate & 0xF) << 4) | (1 << 1));
+    info[13] = static_cast<char>((15 << 4) | ((samples >> 32) & 0xF));
+    for (int i = 0; i < 4; i++) info[14 + i] = static_cast<char>(samples >> (24 - 8 * i));
+    out += info;
+    out += std::string("\x06\x00\x20\x00", 4) + std::string(0x2000, '\0');
+    std::string comments;
+    putLE32(comments, 6);
+    comments += "vendor";
+    putLE32(comments, 2);
+    std::string title = "TITLE=Track " + std::to_string(n);
+    std::string artist = "ARTIST=Artist " + std::to_string(n % 50);
+    putLE32(comments, static_cast<uint32_t>(title.size()));
+    comments += title;
+    putLE32(comments, static_cast<uint32_t>(artist.size()));
+    comments += artist;
+    out += static_cast<char>(0x84);
+    out += static_cast<char>(comments.size() >> 16);
+    out += static_cast<char>(comments.size() >> 8);
+    out += static_cast<char>(comments.size());
+    out += comments;
+    out.resize(std::max(out.size(), audioBytes), '\0');
+    return out;
+}
+
+// 临时目录中带标签的合成曲目（MP3 与 FLAC 各半）
+class TaggedFiles {
+public:
+    TaggedFiles(int count, size_t audioBytes) {
+        namespace fs = std::filesystem;
+        root_ = fs::temp_directory_path() / ("musicplayer_bench_metadata_" + std::to_string(
+            std::chrono::steady_clock::now().time_since_epoch().count()));
+        fs::create_directories(root_);
+        for (int i = 0; i < count; i++) {
+            bool mp3 = i % 2 == 0;
+            std::string path = (root_ / ("track" + std::to_string(i) + (mp3 ? ".mp3" : ".flac"))).string();
+            std::string data = mp3 ? makeMp3(i, audioBytes) : makeFlac(i, audioBytes);
+            std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+            paths_.push_back(path);
+        }
+    }
+
+    ~TaggedFiles() {
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    const std::vector<std::string>& paths() const { return paths_; }
+
+private:
+    std::filesystem::path root_;
+    std::vector<std::string> paths_;
+};
+
+TaggedFiles& files() {
+    static TaggedFiles f(256, 1024 * 1024);
+    return f;
+}
+
+// 采样率过低或时长过长的 STREAMINFO 记为未知时长，不写入播放列表与曲库索引
+void checkImplausibleDurations() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    TempDirectory dir("metadata_duration");
+    const struct { uint32_t rate; uint64_t samples; float expected; } cases[] = {
+        { 44100, 44100ull * 200, 200.0f }, { 1, (1ull << 36) - 1, 0.0f }, { 44100, (1ull << 36) - 1, 0.0f },
+    };
+    for (const auto& c : cases) {
+        std::string path = dir.file("track.flac");
+        std::string data = makeFlac(0, 0, c.rate, c.samples);
+        std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+        TrackMetadata meta;
+        readTrackMetadata(path, meta);
+        benchCheck(meta.duration == c.expected,
+                   "metadata: FLAC at %u Hz with %llu samples read as %.1f s, expected %.1f s", c.rate, static_cast<unsigned long long>(c.samples), meta.duration, c.expected);
+    }
+}
+
+BenchRegistrar registerMetadata([]() {
+    registerBenchmark("metadata/read", "tracks", [](uint64_t iterations) {
+        checkImplausibleDurations();
+        double tracks = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            for (const auto& path : files().paths()) {
+                TrackMetadata meta;
+                readTrackMetadata(path, meta);
+                doNotOptimize(meta.duration);
+            }
+            tracks += static_cast<double>(files().paths().size());
+        }
+        return tracks;
+    });
+
+    // 有界流水线：提交端与播放器的事件循环一样，只在有空位时提交并取回结果
+    registerBenchmark("metadata/pipeline", "tracks", [](uint64_t iterations) {
+        WorkStealingPool pool;
+        double tracks = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            MetadataPipeline pipeline(pool);
+            const auto& paths = files().paths();
+            size_t next = 0;
+            size_t done = 0;
+            while (done < paths.size()) {
+                while (next < paths.size() && pipeline.available() > 0) {
+                    pipeline.submit(next, paths[next]);
+                    next++;
+                }
+                done += pipeline.drain([](MetadataResult& r) { doNotOptimize(r.metadata.duration); });
+                std::this_thread::yield();
+            }
+            tracks += static_cast<double>(paths.size());
+        }
+        return tracks;
+    });
+
+    // 对照：读入整个文件（解码获取时长的下限开销）
+    registerBenchmark("metadata/whole-file", "tracks", [](uint64_t iterations) {
+        double tracks = 0;
+        std::vector<char> buffer(1 << 20);
+        for (uint64_t i = 0; i < iterations; i++) {
+            for (const auto& path : files().paths()) {
+                std::ifstream in(path, std::ios::binary);
+                while (in.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || in.gcount() > 0) {
+                    doNotOptimize(buffer[0]);
+                }
+            }
+            tracks += static_cast<double>(files().paths().size());
+        }
+        return tracks;
+    });
+});
+
+} // namespace
@@ -0,0 +1,423 @@
+#include "BenchHarness.h"
+#include "Playlist.h"
+#include "PlaylistRenderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+const size_t kDirectories = 2000;
+const size_t kTracksPerDirectory = 500;
+const size_t kArtists = 1000;
+
+// 合成的百万曲目：2000 个专辑目录，每个 500 首，标题取文件名主干（与扫描结果相同）
+struct SyntheticTracks {
+    std::vector<std::string> directories;
+    std::vector<std::string> names;
+    std::vector<std::string> artists;
+
+    SyntheticTracks() {
+        for (size_t d = 0; d < kDirectories; d++) {
+            directories.push_back("/srv/music/Artist " + std::to_string(d % kArtists) +
+                                  "/Album " + std::to_string(d) + "/");
+        }
+        for (size_t t = 0; t < kTracksPerDirectory; t++) {
+            names.push_back(std::to_string(t + 1) + " - Track Title " + std::to_string(t) + ".flac");
+        }
+        for (size_t a = 0; a < kArtists; a++) {
+            artists.push_back("Artist " + std::to_string(a));
+        }
+    }
+
+    size_t size() const { return directories.size() * names.size(); }
+
+    // 按目录顺序的前 limit 首
+    template <typename Fn>
+    void forEach(Fn&& fn, size_t limit = SIZE_MAX) const {
+        size_t count = 0;
+        for (size_t d = 0; d < directories.size(); d++) {
+            for (const auto& name : names) {
+                if (count++ == limit) return;
+                fn(directories[d], name, artists[d % kArtists], 180.0f + static_cast<float>(d % 60));
+            }
+        }
+    }
+};
+
+const SyntheticTracks& synthetic() {
+    static SyntheticTracks tracks;
+    return tracks;
+}
+
+void fillPlaylist(Playlist& playlist, size_t count = SIZE_MAX) {
+    const SyntheticTracks& src = synthetic();
+    playlist.reserve(std::min(count, src.size()));
+    src.forEach([&playlist](const std::string& dir, const std::string& name,
+                            const std::string& artist, float duration) {
+        playlist.addTrack(dir, name, std::string_view(), artist, duration, true);
+    }, count);
+}
+
+// 对照：原先的 std::vector<TrackInfo> 布局
+void fillLegacy(std::vector<TrackInfo>& tracks) {
+    const SyntheticTracks& src = synthetic();
+    tracks.reserve(src.size());
+    src.forEach([&tracks](const std::string& dir, const std::string& name,
+                          const std::string& artist, float duration) {
+        TrackInfo info(dir + name);
+        info.artist = artist;
+        info.duration = duration;
+        tracks.push_back(std::move(info));
+    });
+}
+
+size_t heapBytes(const std::string& s) {
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+}
+
+const Playlist& playlist() {
+    static Playlist p;
+    static bool filled = false;
+    if (!filled) {
+        fillPlaylist(p);
+        filled = true;
+        TrackStoreMemory m = p.memoryUsage();
+        std::printf("# TrackStore: %zu tracks, %.1f bytes/track (columns %.1f, strings %.1f, tables %.1f)\n",
+                    m.tracks, m.bytesPerTrack(), double(m.columns) / m.tracks, double(m.strings) / m.tracks,
+                    double(m.directories + m.artists) / m.tracks);
+    }
+    return p;
+}
+
+// 各规模的共享列表（1k / 100k / 1M），首次使用时填充
+const size_t kScales[] = { 1000, 100000, 1000000 };
+
+Playlist& scaledPlaylist(size_t count) {
+    static Playlist lists[3];
+    size_t slot = count == kScales[0] ? 0 : count == kScales[1] ? 1 : 2;
+    if (lists[slot].isEmpty()) fillPlaylist(lists[slot], count);
+    return lists[slot];
+}
+
+std::string scaleName(size_t count) {
+    return count >= 1000000 ? std::to_string(count / 1000000) + "M" : std::to_string(count / 1000) + "k";
+}
+
+const std::vector<TrackInfo>& legacy() {
+    static std::vector<TrackInfo> tracks;
+    if (tracks.empty()) {
+        fillLegacy(tracks);
+        size_t bytes = tracks.capacity() * sizeof(TrackInfo) + tracks.size() * sizeof(size_t);
+        for (const auto& t : tracks) {
+            bytes += heapBytes(t.filepath) + heapBytes(t.title) + heapBytes(t.artist);
+        }
+        std::printf("# vector<TrackInfo>: %zu tracks, %.1f bytes/track (excluding allocator overhead)\n",
+                    tracks.size(), double(bytes) / tracks.size());
+    }
+    return tracks;
+}
+
+// 随机修改：插入、移除、移动各占三分之一，始终在列表中间位置
+template <typename Insert, typename Remove, typename Move>
+double mutate(size_t count, size_t& size, Insert&& insert, Remove&& remove, Move&& move) {
+    std::mt19937 rng(3);
+    for (size_t k = 0; k < count; k++) {
+        size_t a = rng() % size;
+        size_t b = rng() % size;
+        switch (k % 3) {
+            case 0: insert(a); size++; break;
+            case 1: remove(a); size--; break;
+            default: move(a, b); break;
+        }
+    }
+    return static_cast<double>(count);
+}
+
+// 对照：原先的 getPlaylistString，整个列表逐行写入 stringstream
+std::string legacyPlaylistString(const Playlist& p) {
+    std::stringstream ss;
+    ss << "\n=== Playlist ===\n";
+    size_t i = 0;
+    for (TrackView track : p.getTracks()) {
+        ss << (static_cast<int>(i) == p.getCurrentIndex() ? " > " : "   ");
+        ss << "[" << (i + 1) << "] " << track.title();
+        if (!track.artist().empty()) ss << " - " << track.artist();
+        if (track.duration() > 0.0f) {
+            int total = static_cast<int>(track.duration());
+            std::stringstream time;
+            time << std::setfill('0') << std::setw(2) << total / 60 << ":" << std::setfill('0') << std::setw(2)
+                 << total % 60;
+            ss << " (" << time.str() << ")";
+        }
+        ss << "\n";
+        i++;
+    }
+    return ss.str();
+}
+
+// 文件头给出的异常时长（超大、无穷、NaN）显示为 --:--，正常时长照常格式化
+void checkRenderDurations() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    const struct { float duration; const char* expected; } cases[] = {
+        { 754.0f, " (12:34)" }, { 6.87e10f, " (--:--)" }, { INFINITY, " (--:--)" }, { NAN, "" },
+    };
+    for (const auto& c : cases) {
+        Playlist p;
+        p.addTrack("/srv/music/", "track.flac", "track", std::string_view(), c.duration, true);
+        PlaylistRenderer renderer;
+        const std::string& text = renderer.render(p, 0, 1);
+        std::string row = text.substr(text.find("] track") + 7);
+        benchCheck(row == std::string(c.expected) + "\n", "playlist: duration %g rendered as '%s'",
+                   static_cast<double>(c.duration), row.c_str());
+    }
+}
+
+BenchRegistrar registerPlaylist([]() {
+    registerBenchmark("playlist/append-1M", "tracks", [](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            Playlist p;
+            fillPlaylist(p);
+            doNotOptimize(p.size());
+        }
+        return static_cast<double>(iterations * synthetic().size());
+    });
+
+    registerBenchmark("playlist/append-1M-legacy", "tracks", [](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            std::vector<TrackInfo> tracks;
+            fillLegacy(tracks);
+            doNotOptimize(tracks.size());
+        }
+        return static_cast<double>(iterations * synthetic().size());
+    });
+
+    // 顺序遍历：累计时长与标题长度（列表显示、搜索等的访问模式）
+    registerBenchmark("playlist/iterate", "tracks", [](uint64_t iterations) {
+        const Playlist& p = playlist();
+        for (uint64_t i = 0; i < iterations; i++) {
+            double total = 0;
+            size_t chars = 0;
+            for (TrackView track : p.getTracks()) {
+                total += track.duration();
+                chars += track.title().size() + track.artist().size();
+            }
+            doNotOptimize(total);
+            doNotOptimize(chars);
+        }
+        return static_cast<double>(iterations * p.size());
+    });
+
+    registerBenchmark("playlist/iterate-legacy", "tracks", [](uint64_t iterations) {
+        const auto& tracks = legacy();
+        for (uint64_t i = 0; i < iterations; i++) {
+            double total = 0;
+            size_t chars = 0;
+            for (const auto& track : tracks) {
+                total += track.duration;
+                chars += track.title.size() + track.artist.size();
+            }
+            doNotOptimize(total);
+            doNotOptimize(chars);
+        }
+        return static_cast<double>(iterations * tracks.size());
+    });
+
+    // 随机按下标取曲目并拼出完整路径（加载播放时的访问模式）
+    registerBenchmark("playlist/lookup", "lookups", [](uint64_t iterations) {
+        const Playlist& p = playlist();
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<size_t> pick(0, p.size() - 1);
+        const size_t kLookups = 100000;
+        for (uint64_t i = 0; i < iterations; i++) {
+            size_t chars = 0;
+            for (size_t k = 0; k < kLookups; k++) {
+                chars += p.getTrack(pick(rng))->filepath().size();
+            }
+            doNotOptimize(chars);
+        }
+        return static_cast<double>(iterations * kLookups);
+    });
+
+    // 同上，列表中间插入一首后：前缀之后的位置经过顺序序列，读取较多时展开为数组
+    registerBenchmark("playlist/lookup-edited", "lookups", [](uint64_t iterations) {
+        static Playlist p;
+        if (p.isEmpty()) {
+            fillPlaylist(p);
+            p.insertTrack(p.size() / 2, "/srv/music/Inserted/track.flac");
+        }
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<size_t> pick(0, p.size() - 1);
+        const size_t kLookups = 100000;
+        for (uint64_t i = 0; i < iterations; i++) {
+            size_t chars = 0;
+            for (size_t k = 0; k < kLookups; k++) {
+                chars += p.getTrack(pick(rng))->filepath().size();
+            }
+            doNotOptimize(chars);
+        }
+        return static_cast<double>(iterations * kLookups);
+    });
+
+    registerBenchmark("playlist/lookup-legacy", "lookups", [](uint64_t iterations) {
+        const auto& tracks = legacy();
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<size_t> pick(0, tracks.size() - 1);
+        const size_t kLookups = 100000;
+        for (uint64_t i = 0; i < iterations; i++) {
+            size_t chars = 0;
+            for (size_t k = 0; k < kLookups; k++) {
+                std::string path = tracks[pick(rng)].filepath;
+                chars += path.size();
+            }
+            doNotOptimize(chars);
+        }
+        return static_cast<double>(iterations * kLookups);
+    });
+
+    // 百万曲目中随机位置的一页（20 行）：定位 O(log n)，之后逐行取后继，不做堆分配
+    registerBenchmark("playlist/render-page", "rows", [](uint64_t iterations) {
+        static Playlist p;
+        if (p.isEmpty()) {
+            fillPlaylist(p);
+            p.moveTrack(0, p.size() / 2);   // 触发尾部缓冲区并入顺序序列
+        }
+        checkRenderDurations();
+        PlaylistRenderer renderer;
+        std::mt19937 rng(9);
+        const size_t kRows = 20;
+        for (uint64_t i = 0; i < iterations; i++) {
+            doNotOptimize(renderer.render(p, rng() % p.size(), kRows).size());
+        }
+        return static_cast<double>(iterations * kRows);
+    });
+
+    registerBenchmark("playlist/render-all", "rows", [](uint64_t iterations) {
+        const Playlist& p = playlist();
+        PlaylistRenderer renderer;
+        for (uint64_t i = 0; i < iterations; i++) {
+            doNotOptimize(renderer.render(p, 0, p.size()).size());
+        }
+        return static_cast<double>(iterations * p.size());
+    });
+
+    registerBenchmark("playlist/render-all-legacy", "rows", [](uint64_t iterations) {
+        const Playlist& p = playlist();
+        for (uint64_t i = 0; i < iterations; i++) {
+            doNotOptimize(legacyPlaylistString(p).size());
+        }
+        return static_cast<double>(iterations * p.size());
+    });
+
+    // 百万曲目、随机模式下的插入/移除/移动：两种顺序都是 O(log n)，随机顺序不重排
+    registerBenchmark("playlist/mutate-shuffled-1M", "edits", [](uint64_t iterations) {
+        Playlist p;
+        fillPlaylist(p);
+        p.setShuffle(true);
+        size_t size = p.size();
+        const size_t kEdits = 30000;
+        double edits = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            edits += mutate(kEdits, size,
+                            [&p](size_t at) { p.insertTrack(at, "/srv/music/Inserted/track.flac"); },
+                            [&p](size_t at) { p.removeTrack(at); },
+                            [&p](size_t from, size_t to) { p.moveTrack(from, to); });
+        }
+        doNotOptimize(p.getCurrentIndex());
+        return edits;
+    });
+
+    // 对照：原先的下标数组，每次修改后重建并重新洗牌随机顺序
+    registerBenchmark("playlist/mutate-shuffled-1M-legacy", "edits", [](uint64_t iterations) {
+        std::vector<uint32_t> order(synthetic().size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = static_cast<uint32_t>(i);
+        std::vector<size_t> shuffled;
+        std::mt19937 rng(5);
+        auto reshuffle = [&]() {
+            shuffled.clear();
+            for (size_t i = 0; i < order.size(); i++) shuffled.push_back(i);
+            std::shuffle(shuffled.begin(), shuffled.end(), rng);
+        };
+        size_t size = order.size();
+        const size_t kEdits = 30;
+        double edits = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            edits += mutate(kEdits, size,
+                            [&](size_t at) { order.insert(order.begin() + at, 0); reshuffle(); },
+                            [&](size_t at) { order.erase(order.begin() + at); reshuffle(); },
+                            [&](size_t from, size_t to) {
+                                uint32_t id = order[from];
+                                order.erase(order.begin() + from);
+                                order.insert(order.begin() + to, id);
+                            });
+        }
+        doNotOptimize(shuffled.size());
+        return edits;
+    });
+
+    // 不同规模下的基本操作：追加、移除（移除后再追加一首以保持规模）、重新洗牌与随机顺序下的下一曲；
+    // 同一规模的后三项共用一个列表，洗牌与下一曲在随机模式下进行
+    for (size_t count : kScales) {
+        std::string scale = scaleName(count);
+        registerBenchmark("playlist/add/" + scale, "tracks", [count](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                Playlist p;
+                fillPlaylist(p, count);
+                doNotOptimize(p.size());
+            }
+            return static_cast<double>(iterations * count);
+        });
+
+        registerBenchmark("playlist/remove/" + scale, "edits", [count](uint64_t iterations) {
+            Playlist& p = scaledPlaylist(count);
+            std::mt19937 rng(11);
+            const size_t kEdits = 1000;
+            for (uint64_t i = 0; i < iterations; i++) {
+                for (size_t k = 0; k < kEdits; k++) {
+                    p.removeTrack(rng() % p.size());
+                    p.addTrack("/srv/music/Replacement/track.flac");
+                }
+            }
+            doNotOptimize(p.size());
+            return static_cast<double>(iterations * kEdits);
+        });
+
+        registerBenchmark("playlist/shuffle/" + scale, "tracks", [count](uint64_t iterations) {
+            Playlist& p = scaledPlaylist(count);
+            if (!p.isShuffleEnabled()) p.setShuffle(true);
+            for (uint64_t i = 0; i < iterations; i++) {
+                p.shuffle();
+                doNotOptimize(p.getCurrentIndex());
+            }
+            return static_cast<double>(iterations * p.size());
+        });
+
+        registerBenchmark("playlist/next/" + scale, "steps", [count](uint64_t iterations) {
+            Playlist& p = scaledPlaylist(count);
+            if (!p.isShuffleEnabled()) p.setShuffle(true);
+            const size_t kSteps = 10000;
+            size_t chars = 0;
+            for (uint64_t i = 0; i < iterations; i++) {
+                for (size_t k = 0; k < kSteps; k++) {
+                    p.next();
+                    chars += p.getCurrentTrack()->title().size();
+                }
+            }
+            doNotOptimize(chars);
+            return static_cast<double>(iterations * kSteps);
+        });
+    }
+});
+
+} // namespace
@@ -0,0 +1,169 @@
+#include "BenchFixtures.h"
+#include "BenchHarness.h"
+#include "DecoderFactory.h"
+#include "Prefetcher.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+const uint32_t kRate = 44100;
+const size_t kTracks = 4;
+
+// 四首 30 秒 44.1 kHz 立体声 WAV（各约 5 MiB），代表播放列表中接下来的几首
+class PrefetchCorpus {
+public:
+    PrefetchCorpus() : dir_("prefetch") {
+        for (size_t n = 0; n < kTracks; n++) {
+            std::string path = dir_.file("track" + std::to_string(n) + ".wav");
+            writeSineWav(path, 30.0, kRate, 2, 220.0 + 55.0 * n);
+            paths_.push_back(path);
+        }
+    }
+
+    const std::vector<std::string>& paths() const { return paths_; }
+    std::string directory() const { return dir_.path().string(); }
+
+private:
+    TempDirectory dir_;
+    std::vector<std::string> paths_;
+};
+
+PrefetchCorpus& corpus() {
+    static PrefetchCorpus c;
+    return c;
+}
+
+// 把文件逐出页缓存，模拟从未读过（或已被挤出缓存）的曲目；不支持时返回 false
+bool evict(const std::string& path) {
+#if defined(POSIX_FADV_DONTNEED)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    ::fdatasync(fd);
+    bool ok = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    ::close(fd);
+    return ok;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+// 播放器切歌时的关键路径：打开解码器并解出第一秒
+double loadFirstSecond(const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    auto decoder = openAudioDecoder(path);
+    if (!decoder) return 0.0;
+    std::vector<float> buffer(kRate * decoder->getChannels());
+    size_t frames = decoder->read(buffer.data(), kRate);
+    doNotOptimize(frames);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 冷启动与预取后的加载耗时，以及节流后的预读速率
+void reportPrefetch() {
+    static bool reported = false;
+    if (reported) return;
+    reported = true;
+    const auto& paths = corpus().paths();
+    if (!evict(paths[0])) {
+        std::printf("# prefetch: page cache eviction unsupported here, cold loads not measured\n");
+        return;
+    }
+    double cold = 0.0;
+    for (const auto& path : paths) {
+        evict(path);
+        cold += loadFirstSecond(path);
+    }
+
+    PrefetchConfig config;
+    config.lookahead = kTracks;
+    config.maxBytesPerSecond = 64e6;
+    double warm = 0.0;
+    double warmSeconds = 0.0;
+    PrefetchStats stats;
+    {
+        Prefetcher prefetcher(config);
+        for (const auto& path : paths) evict(path);
+        auto start = std::chrono::steady_clock::now();
+        prefetcher.setUpcoming(paths);
+        while (prefetcher.getStats().warmed < kTracks) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        warmSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (const auto& path : paths) {
+            PrefetchState state = prefetcher.claim(path);
+            double seconds = loadFirstSecond(path);
+            prefetcher.recordLoad(state, seconds);
+            warm += seconds;
+        }
+        stats = prefetcher.getStats();
+    }
+    std::printf("# prefetch: load + first second, cold %.2f ms, prefetched %.2f ms (%.1fx), hit rate %.0f%%\n",
+                cold * 1000.0 / kTracks, warm * 1000.0 / kTracks, warm > 0 ? cold / warm : 0.0,
+                stats.hitRate() * 100.0);
+    std::printf("# prefetch: warmed %zu tracks (%.1f MiB) in %.0f ms at a %.0f MB/s cap -> %.1f MB/s\n",
+                kTracks, stats.bytes / 1048576.0, warmSeconds * 1000.0, config.maxBytesPerSecond / 1e6,
+                stats.bytes / warmSeconds / 1e6);
+}
+
+// 已预热的记录只在完整读到开头后产生，离开预读目标后即被忘掉：
+// 读取失败的路径（目录可以打开但不能读取）不报告为已预热，不再是目标的已预热曲目加载时记为冷启动
+void checkWarmRecords() {
+    static bool checked = false;
+    if (checked) return;
+    checked = true;
+    const auto& paths = corpus().paths();
+    PrefetchConfig config;
+    config.maxBytesPerSecond = 0;
+    Prefetcher prefetcher(config);
+    std::string unreadable = corpus().directory();
+    prefetcher.setUpcoming({ unreadable, paths[0] });
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while ((prefetcher.getStats().warmed < 1 || prefetcher.getStats().failed < 1) &&
+           std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    PrefetchState failed = prefetcher.claim(unreadable);
+    benchCheck(failed != PrefetchState::Warm, "prefetch: unreadable path reported as warm");
+    prefetcher.setUpcoming({ paths[1] });
+    PrefetchState dropped = prefetcher.claim(paths[0]);
+    benchCheck(dropped == PrefetchState::Cold, "prefetch: track no longer upcoming still reported as %s",
+               dropped == PrefetchState::Warm ? "warm" : "pending");
+}
+
+BenchRegistrar registerPrefetch([]() {
+    // 每次迭代加载一首曲目并解出第一秒；cold 先逐出页缓存，warm 为预取完成后的状态
+    registerBenchmark("prefetch/load/cold", "loads", [](uint64_t iterations) {
+        checkWarmRecords();
+        reportPrefetch();
+        const auto& paths = corpus().paths();
+        for (uint64_t i = 0; i < iterations; i++) {
+            const std::string& path = paths[i % paths.size()];
+            evict(path);
+            doNotOptimize(loadFirstSecond(path));
+        }
+        return static_cast<double>(iterations);
+    });
+    registerBenchmark("prefetch/load/warm", "loads", [](uint64_t iterations) {
+        reportPrefetch();
+        const auto& paths = corpus().paths();
+        for (uint64_t i = 0; i < iterations; i++) {
+            doNotOptimize(loadFirstSecond(paths[i % paths.size()]));
+        }
+        return static_cast<double>(iterations);
+    });
+});
+
+} // namespace
@@ -0,0 +1,162 @@
+#include "BenchHarness.h"
+#include "Resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+// 每次迭代处理一个 4096 帧立体声块；吞吐量以“音频秒/秒”报告，即单核实时倍数
+const size_t kFrames = 4096;
+const uint16_t kChannels = 2;
+const double kPi = 3.14159265358979323846;
+
+struct Ratio {
+    const char* label;
+    uint32_t src;
+    uint32_t dst;
+};
+
+const Ratio kRatios[] = {
+    { "44k1-48k", 44100, 48000 },
+    { "48k-44k1", 48000, 44100 },
+    { "96k-44k1", 96000, 44100 },
+};
+
+const ResamplerQuality kQualities[] = {
+    ResamplerQuality::Fast, ResamplerQuality::Balanced, ResamplerQuality::Best,
+};
+
+// 单声道正弦经过完整的流式路径（分块输入 + flush），返回输出
+std::vector<float> resampleTone(ResamplerQuality quality, uint32_t src, uint32_t dst, double freq) {
+    Resampler resampler(quality);
+    resampler.reset(src, dst, 1);
+    std::vector<float> in(src);
+    for (size_t i = 0; i < in.size(); i++) {
+        in[i] = static_cast<float>(0.5 * std::sin(2.0 * kPi * freq * i / src));
+    }
+    std::vector<float> out;
+    for (size_t pos = 0; pos < in.size(); pos += 1000) {
+        resampler.process(in.data() + pos, std::min<size_t>(1000, in.size() - pos), out);
+    }
+    resampler.flush(out);
+    return out;
+}
+
+// 在输出的中段拟合 freq 处的正弦：返回相对输入幅度的增益与拟合残差（dB）
+void fitTone(const std::vector<float>& out, uint32_t rate, double freq, double& gainDb, double& residualDb) {
+    size_t begin = out.size() / 5;
+    size_t end = out.size() - out.size() / 5;
+    double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+    for (size_t i = begin; i < end; i++) {
+        double s = std::sin(2.0 * kPi * freq * i / rate);
+        double c = std::cos(2.0 * kPi * freq * i / rate);
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        ys += out[i] * s;
+        yc += out[i] * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (ys * cc - yc * sc) / det;
+    double b = (yc * ss - ys * sc) / det;
+    double error = 0.0;
+    for (size_t i = begin; i < end; i++) {
+        double e = out[i] - a * std::sin(2.0 * kPi * freq * i / rate) - b * std::cos(2.0 * kPi * freq * i / rate);
+        error += e * e;
+    }
+    double rms = std::sqrt(error / (end - begin));
+    gainDb = 20.0 * std::log10(std::sqrt(a * a + b * b) / 0.5);
+    residualDb = 20.0 * std::log10(std::max(rms * std::sqrt(2.0) / 0.5, 1e-12));
+}
+
+double levelDb(const std::vector<float>& out) {
+    size_t begin = out.size() / 5;
+    size_t end = out.size() - out.size() / 5;
+    double energy = 0.0;
+    for (size_t i = begin; i < end; i++) energy += static_cast<double>(out[i]) * out[i];
+    return 20.0 * std::log10(std::max(std::sqrt(energy / (end - begin)) * std::sqrt(2.0) / 0.5, 1e-12));
+}
+
+// 精度检查（首次运行重采样基准时输出一次）：
+// 升采样 44.1k -> 48k 时通带内各频率的增益起伏与残差（镜像 + 噪声）；
+// 降采样 96k -> 44.1k 时阻带内各频率混叠到输出的最大电平。
+// 各预设须达到设计指标：阻带衰减不低于凯撒窗设计值 1 dB 以上，残差低于设计值 3 dB 以内，
+// 通带起伏不超过设计起伏的两倍（float 运算下至少留 0.0001 dB）
+void reportAccuracy() {
+    static bool reported = false;
+    if (reported) return;
+    reported = true;
+    for (ResamplerQuality quality : kQualities) {
+        auto up = PolyphaseFilterBank::get(44100, 48000, quality);
+        double ripple = 0.0;
+        double residual = -300.0;
+        for (int k = 1; k <= 24; k++) {
+            double freq = up->passband * k / 24.0;
+            std::vector<float> out = resampleTone(quality, 44100, 48000, freq);
+            double gainDb, residualDb;
+            fitTone(out, 48000, freq, gainDb, residualDb);
+            ripple = std::max(ripple, std::fabs(gainDb));
+            residual = std::max(residual, residualDb);
+        }
+
+        auto down = PolyphaseFilterBank::get(96000, 44100, quality);
+        double alias = -300.0;
+        for (int k = 0; k <= 24; k++) {
+            double freq = down->stopband + (47000.0 - down->stopband) * k / 24.0;
+            alias = std::max(alias, levelDb(resampleTone(quality, 96000, 44100, freq)));
+        }
+
+        std::printf("# resample %-8s: passband %.0f Hz ripple %.4f dB, residual %.1f dB; "
+                    "stopband from %.0f Hz rejected %.1f dB; latency %u frames\n",
+                    resamplerQualityName(quality), up->passband, ripple, residual, down->stopband,
+                    -alias, up->taps / 2);
+        double designDb = resamplerPreset(quality).attenuationDb;
+        double rippleLimit = std::max(2.0 * 20.0 * std::log10(1.0 + std::pow(10.0, -designDb / 20.0)), 1e-4);
+        const char* name = resamplerQualityName(quality);
+        benchCheck(-alias >= designDb - 1.0, "resample %s: stopband rejection %.1f dB, design %.0f dB",
+                   name, -alias, designDb);
+        benchCheck(residual <= -(designDb - 3.0), "resample %s: passband residual %.1f dB, design -%.0f dB",
+                   name, residual, designDb);
+        benchCheck(ripple <= rippleLimit, "resample %s: passband ripple %.5f dB, limit %.5f dB",
+                   name, ripple, rippleLimit);
+    }
+}
+
+BenchRegistrar registerResample([]() {
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2,
+                                 SimdLevel::AVX2, SimdLevel::NEON };
+    for (ResamplerQuality quality : kQualities) {
+        for (const Ratio& ratio : kRatios) {
+            for (SimdLevel level : levels) {
+                if (!simdLevelSupported(level)) continue;
+                std::string name = std::string("resample/") + resamplerQualityName(quality) + "/" +
+                                   ratio.label + "/" + simdLevelName(level);
+                registerBenchmark(name, "audio-sec", [quality, ratio, level](uint64_t iterations) {
+                    reportAccuracy();
+                    Resampler resampler(quality, level);
+                    resampler.reset(ratio.src, ratio.dst, kChannels);
+                    std::vector<float> in(kFrames * kChannels);
+                    for (size_t i = 0; i < in.size(); i++) {
+                        in[i] = static_cast<float>(0.25 * std::sin(0.01 * i));
+                    }
+                    std::vector<float> out;
+                    out.reserve(kFrames * kChannels * 4);
+                    for (uint64_t i = 0; i < iterations; i++) {
+                        out.clear();
+                        resampler.process(in.data(), kFrames, out);
+                        doNotOptimize(out.data());
+                    }
+                    return static_cast<double>(iterations * kFrames) / ratio.src;
+                });
+            }
+        }
+    }
+});
+
+} // namespace
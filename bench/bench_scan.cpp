@@ -0,0 +1,58 @@
+#include "BenchFixtures.h"
+#include "BenchHarness.h"
+#include "LibraryScanner.h"
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+SyntheticLibrary& library() {
+    static SyntheticLibrary lib("scan", 32, 8, 12);
+    return lib;
+}
+
+BenchRegistrar registerScan([]() {
+    std::vector<size_t> threadCounts{ 1, 2, 4 };
+    size_t hostThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (std::find(threadCounts.begin(), threadCounts.end(), hostThreads) == threadCounts.end()) {
+        threadCounts.push_back(hostThreads);
+    }
+    for (size_t threads : threadCounts) {
+        registerBenchmark("scan/recursive/j" + std::to_string(threads), "files",
+                          [threads](uint64_t iterations) {
+            WorkStealingPool pool(threads);
+            LibraryScanner scanner(pool);
+            double entries = 0;
+            for (uint64_t i = 0; i < iterations; i++) {
+                ScanResult result = scanner.scan(library().path());
+                entries += static_cast<double>(result.stats.entries);
+                doNotOptimize(result.directories.size());
+            }
+            return entries;
+        });
+    }
+
+    // 基线：旧的单层 loadFromDirectory 逐个专辑目录调用
+    registerBenchmark("scan/loadFromDirectory", "files", [](uint64_t iterations) {
+        SyntheticLibrary& lib = library();
+        double entries = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            Playlist playlist;
+            for (int a = 0; a < lib.artists(); a++) {
+                for (int b = 0; b < lib.albums(); b++) {
+                    playlist.loadFromDirectory(lib.albumPath(a, b));
+                }
+            }
+            entries += lib.fileCount();
+            doNotOptimize(playlist.size());
+        }
+        return entries;
+    });
+});
+
+} // namespace
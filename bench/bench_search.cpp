@@ -0,0 +1,103 @@
+#include "BenchHarness.h"
+#include "Playlist.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+const size_t kDirectories = 2000;
+const size_t kTracksPerDirectory = 500;
+const size_t kArtists = 1000;
+
+const char* const kWords[] = {
+    "love", "night", "blue", "song", "dream", "rock", "fire", "rain", "star", "heart",
+    "summer", "winter", "river", "road", "home", "light", "dance", "city", "moon", "sun",
+    "golden", "silver", "ocean", "sky", "wild", "young", "lost", "free", "time", "world",
+    "midnight", "morning", "shadow", "angel", "storm", "paradise", "memory", "echo", "fever", "sugar",
+};
+
+// 百万曲目：标题由随机单词组成，文件名带曲目号，艺术家与专辑目录共用
+void fillPlaylist(Playlist& playlist) {
+    std::mt19937 rng(42);
+    const size_t words = sizeof(kWords) / sizeof(kWords[0]);
+    playlist.reserve(kDirectories * kTracksPerDirectory);
+    for (size_t d = 0; d < kDirectories; d++) {
+        std::string artist = "Artist " + std::to_string(d % kArtists);
+        std::string dir = "/srv/music/" + artist + "/Album " + std::to_string(d) + "/";
+        for (size_t t = 0; t < kTracksPerDirectory; t++) {
+            std::string title;
+            for (int w = 0; w < 3; w++) {
+                if (w) title += ' ';
+                title += kWords[rng() % words];
+            }
+            title += ' ';
+            title += std::to_string(rng() % 100000);
+            std::string name = std::to_string(t + 1) + " - " + title + ".flac";
+            playlist.addTrack(dir, name, std::string_view(), artist, 200.0f, true);
+        }
+    }
+}
+
+Playlist& playlist() {
+    static Playlist p;
+    if (p.isEmpty()) {
+        fillPlaylist(p);
+        auto start = std::chrono::steady_clock::now();
+        p.find("warm up", 1);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("# search index: %zu tracks, built in %.0f ms, %.1f bytes/track\n", p.size(),
+                    seconds * 1000.0, static_cast<double>(p.searchMemoryUsage()) / p.size());
+    }
+    return p;
+}
+
+// 对照：逐曲目核对标题、艺术家与完整路径
+size_t linearScan(const Playlist& p, const std::string& query) {
+    std::string needle = SearchText::foldString(query);
+    size_t matches = 0;
+    for (TrackView track : p.getTracks()) {
+        if (SearchText::contains(track.title(), needle) || SearchText::contains(track.artist(), needle) ||
+            SearchText::contains(track.filepath(), needle)) {
+            matches++;
+        }
+    }
+    return matches;
+}
+
+const char* const kQueries[][2] = {
+    { "rare", "angel fire 88400" },     // 罕见的标题片段
+    { "common", "midnight" },           // 约 7% 的曲目
+    { "artist", "artist 42" },          // 艺术家表命中，再按列筛选
+    { "path", "album 17/3" },           // 跨过目录分隔符
+    { "approximate", "paradsie" },      // 拼写错误，精确匹配为空后近似匹配
+};
+
+BenchRegistrar registerSearch([]() {
+    for (const auto& q : kQueries) {
+        std::string label = q[0];
+        std::string query = q[1];
+        registerBenchmark("search/find-" + label, "queries", [query](uint64_t iterations) {
+            Playlist& p = playlist();
+            for (uint64_t i = 0; i < iterations; i++) {
+                SearchMatches m = p.find(query, 20);
+                doNotOptimize(m.total);
+            }
+            return static_cast<double>(iterations);
+        });
+        registerBenchmark("search/linear-" + label, "queries", [query](uint64_t iterations) {
+            const Playlist& p = playlist();
+            for (uint64_t i = 0; i < iterations; i++) {
+                doNotOptimize(linearScan(p, query));
+            }
+            return static_cast<double>(iterations);
+        });
+    }
+});
+
+} // namespace
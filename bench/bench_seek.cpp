@@ -0,0 +1,337 @@
+#include "BenchFixtures.h"
+#include "BenchHarness.h"
+#include "SeekIndex.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+// 合成语料：每种格式 kTracks 首 kSeconds 秒的 44.1kHz 立体声曲目，帧长 / 页长随机，
+// 载荷是随机字节（不含同步字），生成时记录每一帧 / 页的真实偏移与样本位置，用于核对定位结果
+const int kTracks = 3;
+const uint32_t kRate = 44100;
+const uint64_t kSeconds = 180;
+const uint64_t kTotalFrames = kSeconds * kRate;
+const size_t kSeeksPerTrack = 1000;
+
+struct Rng {
+    uint32_t state;
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+    uint32_t range(uint32_t lo, uint32_t hi) { return lo + next() % (hi - lo + 1); }
+};
+
+void putBE(std::string& out, uint64_t v, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) out += static_cast<char>(v >> (8 * i));
+}
+
+void putLE(std::string& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) out += static_cast<char>(v >> (8 * i));
+}
+
+void appendRandom(std::string& out, Rng& rng, size_t n, unsigned char avoid) {
+    for (size_t i = 0; i < n; i++) {
+        auto c = static_cast<unsigned char>(rng.next());
+        out += static_cast<char>(c == avoid ? c - 1 : c);
+    }
+}
+
+struct Track {
+    std::string path;
+    std::vector<SeekPoint> truth;   // 每一帧 / 页：样本位置与偏移
+    uint64_t leading = 0;
+};
+
+// VBR MP3：ID3v2 + 带 LAME 标签的 Info 帧 + 码率随机的 Layer III 帧 + ID3v1
+std::string makeMp3(Rng& rng, Track& track) {
+    std::string out = "ID3";
+    out += '\x03';
+    out += '\0';
+    out += '\0';
+    putBE(out, 0x0000087F, 4);          // syncsafe 1023
+    out.append(1023, '\0');
+
+    std::string info = "\xFF\xFB\x90\x00";
+    info.append(32, '\0');
+    info += "Info";
+    putBE(info, 0x0F, 4);
+    info.append(4 + 4 + 100 + 4, '\0');
+    info += "LAME3.100";
+    info.append(12, '\0');
+    putBE(info, (576u << 12) | 1200u, 3);   // 编码器延迟 576，尾部填充 1200
+    info.resize(417, '\0');
+    out += info;
+    track.leading = 576 + 529;
+
+    uint64_t frames = (kTotalFrames + track.leading + 1200 - 529) / 1152;
+    for (uint64_t k = 0; k < frames; k++) {
+        unsigned char header[4] = { 0xFF, 0xFB, 0, 0 };
+        header[2] = static_cast<unsigned char>((rng.range(5, 14) << 4) | (rng.range(0, 1) << 1));
+        Metadata::MpegFrameHeader h;
+        Metadata::parseMpegHeader(header, h);
+        track.truth.push_back(SeekPoint{ k * 1152, out.size() });
+        out.append(reinterpret_cast<const char*>(header), 4);
+        appendRandom(out, rng, h.frameBytes - 4, 0);
+    }
+    out += "TAG";
+    out.append(125, '\0');
+    return out;
+}
+
+void putUtf8(std::string& out, uint64_t n) {
+    if (n < 0x80) {
+        out += static_cast<char>(n);
+    } else if (n < 0x800) {
+        out += static_cast<char>(0xC0 | (n >> 6));
+        out += static_cast<char>(0x80 | (n & 0x3F));
+    } else {
+        out += static_cast<char>(0xE0 | (n >> 12));
+        out += static_cast<char>(0x80 | ((n >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (n & 0x3F));
+    }
+}
+
+// FLAC：固定块长 4096（最后一帧较短），可选每 10 秒一点的 SEEKTABLE
+std::string makeFlac(Rng& rng, Track& track, bool seekTable) {
+    std::string frames;
+    uint64_t count = (kTotalFrames + 4095) / 4096;
+    for (uint64_t k = 0; k < count; k++) {
+        uint64_t block = std::min<uint64_t>(4096, kTotalFrames - k * 4096);
+        std::string header = "\xFF\xF8";
+        header += static_cast<char>(block == 4096 ? 0xC9 : 0x79);
+        header += '\x18';
+        putUtf8(header, k);
+        if (block != 4096) putBE(header, block - 1, 2);
+        header += static_cast<char>(SeekScan::crc8(reinterpret_cast<const unsigned char*>(header.data()),
+                                                   header.size()));
+        track.truth.push_back(SeekPoint{ k * 4096, frames.size() });
+        frames += header;
+        appendRandom(frames, rng, rng.range(2000, 9000), 0xFF);
+    }
+
+    std::string out = "fLaC";
+    uint64_t points = seekTable ? kSeconds / 10 : 0;
+    out += static_cast<char>(points ? 0x00 : 0x80);
+    putBE(out, 34, 3);
+    putBE(out, 4096, 2);
+    putBE(out, 4096, 2);
+    putBE(out, 0, 6);
+    putBE(out, (static_cast<uint64_t>(kRate) << 44) | (1ull << 41) | (15ull << 36) | kTotalFrames, 8);
+    out.append(16, '\0');
+    if (points) {
+        out += static_cast<char>(0x83);
+        putBE(out, points * 18, 3);
+        for (uint64_t p = 0; p < points; p++) {
+            const SeekPoint& frame = track.truth[p * 10 * kRate / 4096];
+            putBE(out, frame.frame, 8);
+            putBE(out, frame.offset, 8);
+            putBE(out, 4096, 2);
+        }
+    }
+    for (SeekPoint& point : track.truth) point.offset += out.size();
+    return out + frames;
+}
+
+void putOggPage(std::string& out, uint32_t serial, uint32_t sequence, uint64_t granule, char type,
+                const std::vector<std::string>& packets) {
+    std::string page = "OggS";
+    page += '\0';
+    page += type;
+    putLE(page, granule, 8);
+    putLE(page, serial, 4);
+    putLE(page, sequence, 4);
+    putLE(page, 0, 4);
+    std::string lacing;
+    std::string body;
+    for (const std::string& packet : packets) {
+        size_t n = packet.size();
+        for (; n >= 255; n -= 255) lacing += '\xFF';
+        lacing += static_cast<char>(n);
+        body += packet;
+    }
+    page += static_cast<char>(lacing.size());
+    page += lacing;
+    page += body;
+    uint32_t crc = SeekScan::oggCrc(reinterpret_cast<const unsigned char*>(page.data()), page.size());
+    for (int i = 0; i < 4; i++) page[22 + i] = static_cast<char>(crc >> (8 * i));
+    out += page;
+}
+
+// Ogg Vorbis：标识头页、注释与设置头页，之后每页一个长度随机的音频包
+std::string makeOgg(Rng& rng, Track& track) {
+    const uint32_t serial = 0x5EEC;
+    std::string out;
+    track.truth.push_back(SeekPoint{ 0, 0 });
+    std::string id = "\x01vorbis";
+    putLE(id, 0, 4);
+    id += '\x02';
+    putLE(id, kRate, 4);
+    putLE(id, 0, 12);
+    id += "\xB8\x01";
+    putOggPage(out, serial, 0, 0, 0x02, { id });
+    std::string comments = "\x03vorbis";
+    putLE(comments, 0, 8);
+    comments += '\x01';
+    putOggPage(out, serial, 1, 0, 0x00, { comments, "\x05vorbis" + std::string(200, '\x11') });
+
+    uint64_t granule = 0;
+    for (uint32_t sequence = 2; granule < kTotalFrames; sequence++) {
+        granule = std::min<uint64_t>(kTotalFrames, granule + rng.range(2048, 8192));
+        std::string packet;
+        appendRandom(packet, rng, rng.range(3000, 8000), 'O');
+        track.truth.push_back(SeekPoint{ granule, out.size() });
+        putOggPage(out, serial, sequence, granule, granule == kTotalFrames ? 0x04 : 0x00, { packet });
+    }
+    return out;
+}
+
+enum class Kind { Mpeg, Flac, FlacSeekTable, Ogg };
+
+const Kind kKinds[] = { Kind::Mpeg, Kind::Flac, Kind::FlacSeekTable, Kind::Ogg };
+
+const char* kindName(Kind kind) {
+    switch (kind) {
+        case Kind::Mpeg: return "mpeg";
+        case Kind::Flac: return "flac";
+        case Kind::FlacSeekTable: return "flac-seektable";
+        case Kind::Ogg: return "ogg";
+    }
+    return "";
+}
+
+class SeekCorpus {
+public:
+    SeekCorpus() {
+        namespace fs = std::filesystem;
+        root_ = fs::temp_directory_path() / ("musicplayer_bench_seek_" + std::to_string(
+            std::chrono::steady_clock::now().time_since_epoch().count()));
+        fs::create_directories(root_);
+        Rng rng{ 2024 };
+        for (Kind kind : kKinds) {
+            for (int n = 0; n < kTracks; n++) {
+                Track track;
+                std::string data = kind == Kind::Mpeg ? makeMp3(rng, track)
+                                 : kind == Kind::Ogg ? makeOgg(rng, track)
+                                                     : makeFlac(rng, track, kind == Kind::FlacSeekTable);
+                track.path = (root_ / (std::string(kindName(kind)) + std::to_string(n))).string();
+                std::ofstream(track.path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+                tracks_[static_cast<int>(kind)].push_back(std::move(track));
+            }
+        }
+    }
+
+    ~SeekCorpus() {
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    const std::vector<Track>& tracks(Kind kind) const { return tracks_[static_cast<int>(kind)]; }
+
+private:
+    std::filesystem::path root_;
+    std::vector<Track> tracks_[4];
+};
+
+SeekCorpus& corpus() {
+    static SeekCorpus c;
+    return c;
+}
+
+// 定位结果是否精确：偏移处确为一帧 / 页的开头，且其样本位置加 skip 等于目标
+bool exact(const Track& track, const SeekIndex& index, uint64_t frame, const SeekTarget& target) {
+    auto it = std::lower_bound(track.truth.begin(), track.truth.end(), target.offset,
+                               [](const SeekPoint& p, uint64_t offset) { return p.offset < offset; });
+    return it != track.truth.end() && it->offset == target.offset &&
+           it->frame + target.skip == frame + index.leadingFrames();
+}
+
+// 首次运行时对每种格式输出一次：新建索引后在每首曲目上随机定位 kSeeksPerTrack 次的延迟分位数
+// （含二分的文件读取）、精确定位的比例与最多需要解码丢弃的音频，对照从文件开头顺序读到目标的延迟
+void reportLatency(Kind kind) {
+    static bool reported[4] = {};
+    if (reported[static_cast<int>(kind)]) return;
+    reported[static_cast<int>(kind)] = true;
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> latencies;
+    std::vector<double> linear;
+    size_t exactCount = 0;
+    uint64_t reads = 0;
+    uint64_t maxSkip = 0;
+    Rng rng{ 7 };
+    for (const Track& track : corpus().tracks(kind)) {
+        SeekIndex index;
+        Metadata::SourceFile file;
+        if (!file.open(track.path) || !index.build(file)) continue;
+        for (size_t i = 0; i < kSeeksPerTrack; i++) {
+            uint64_t frame = (static_cast<uint64_t>(rng.next()) << 8 | rng.next() % 256) % index.totalFrames();
+            auto start = Clock::now();
+            SeekTarget target = index.locate(file, frame);
+            latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            exactCount += exact(track, index, frame, target);
+            reads += target.reads;
+            maxSkip = std::max(maxSkip, target.skip);
+            if (i % 20 == 0) {
+                // 无索引时至少要从头读到目标位置
+                auto it = std::upper_bound(track.truth.begin(), track.truth.end(), frame + index.leadingFrames(),
+                                           [](uint64_t f, const SeekPoint& p) { return f < p.frame; });
+                uint64_t bytes = it == track.truth.begin() ? 0 : (it - 1)->offset;
+                std::vector<unsigned char> block(64 * 1024);
+                start = Clock::now();
+                for (uint64_t pos = 0; pos < bytes; pos += block.size()) file.readAt(pos, block.data(), block.size());
+                linear.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            }
+        }
+    }
+    size_t seeks = latencies.size();
+    std::printf("# seek %s: p50 %.1f us, p99 %.1f us over %zu seeks (%.2f reads/seek), %zu/%zu sample-accurate, "
+                "max decode-and-discard %.0f ms | linear read to target: p50 %.0f us, p99 %.0f us\n",
+                kindName(kind), percentile(latencies, 0.5), percentile(latencies, 0.99), seeks,
+                seeks ? static_cast<double>(reads) / seeks : 0.0, exactCount, seeks,
+                maxSkip * 1000.0 / kRate, percentile(linear, 0.5), percentile(linear, 0.99));
+    benchCheck(exactCount == seeks, "seek %s: %zu/%zu seeks sample-accurate", kindName(kind), exactCount, seeks);
+}
+
+BenchRegistrar registerSeek([]() {
+    for (Kind kind : kKinds) {
+        // 建立索引：MPEG 扫描全部帧头，FLAC 读元数据块，Ogg 读首页与末页
+        registerBenchmark(std::string("seek/index/") + kindName(kind), "tracks", [kind](uint64_t iterations) {
+            const auto& tracks = corpus().tracks(kind);
+            for (uint64_t i = 0; i < iterations; i++) {
+                SeekIndex index;
+                if (!index.build(tracks[i % tracks.size()].path)) return 0.0;
+                doNotOptimize(index.totalFrames());
+            }
+            return static_cast<double>(iterations);
+        });
+
+        // 索引已稳定后的随机定位
+        registerBenchmark(std::string("seek/locate/") + kindName(kind), "seeks", [kind](uint64_t iterations) {
+            reportLatency(kind);
+            const Track& track = corpus().tracks(kind)[0];
+            static std::shared_ptr<const SeekIndex> indexes[4];
+            auto& index = indexes[static_cast<int>(kind)];
+            if (!index) index = SeekIndex::get(track.path);
+            Metadata::SourceFile file;
+            if (!index || !file.open(track.path)) return 0.0;
+            Rng rng{ 99 };
+            for (uint64_t i = 0; i < iterations; i++) {
+                SeekTarget target = index->locate(file, (static_cast<uint64_t>(rng.next()) * 8) % index->totalFrames());
+                doNotOptimize(target.offset);
+            }
+            return static_cast<double>(iterations);
+        });
+    }
+});
+
+} // namespace
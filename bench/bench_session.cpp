@@ -0,0 +1,173 @@
+#include "BenchFixtures.h"
+#include "BenchHarness.h"
+#include "CommandProcessor.h"
+#include "SessionManager.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+const size_t kSessions = 256;
+
+// 会话播放的曲目：两首与引擎同为 44.1 kHz（零拷贝路径），两首 48 kHz（经重采样），各 20 秒立体声。
+// 不预先构建波形缓存：测量的就是 --sessions 的会话路径
+class SessionCorpus {
+public:
+    SessionCorpus() : dir_("session") {
+        const uint32_t rates[] = { 44100, 48000, 44100, 48000 };
+        for (int n = 0; n < 4; n++) {
+            std::string path = dir_.file("track" + std::to_string(n) + ".wav");
+            writeSineWav(path, 20.0, rates[n], 2, 220.0 + 55.0 * n);
+            paths_.push_back(path);
+        }
+    }
+
+    const std::vector<std::string>& paths() const { return paths_; }
+    std::string root() const { return dir_.path().string(); }
+    std::string waveformDirectory() const { return dir_.file("waveforms"); }
+
+private:
+    TempDirectory dir_;
+    std::vector<std::string> paths_;
+};
+
+SessionCorpus& corpus() {
+    static SessionCorpus c;
+    return c;
+}
+
+// threads 个工作线程上的 kSessions 个会话，各自循环播放全部曲目（错开起始曲目），输出到空输出端
+std::unique_ptr<SessionManager> makeHost(size_t threads) {
+    auto manager = std::make_unique<SessionManager>(NativeEngineConfig(), threads);
+    const auto& paths = corpus().paths();
+    for (size_t i = 0; i < kSessions; i++) {
+        auto session = manager->create("zone" + std::to_string(i));
+        std::lock_guard<std::mutex> lock(session->mutex());
+        MusicPlayer& player = session->player();
+        player.setWaveformCacheDirectory(corpus().waveformDirectory());
+        for (const auto& path : paths) player.getPlaylist().addTrack(path);
+        player.setLoopMode(LoopMode::All);
+        player.jumpTo(i % paths.size());
+        // 从曲目中段开始，避免所有会话在同一周期切歌
+        player.seek(static_cast<float>(i % 64) * 0.3f);
+    }
+    // 预热：取回元数据，环形缓冲区首次填满
+    for (int i = 0; i < 20; i++) manager->tick();
+    return manager;
+}
+
+// 线程数：1、2、4…直到硬件线程数
+std::vector<size_t> threadCounts() {
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> counts;
+    for (size_t n = 1; n < hardware; n *= 2) counts.push_back(n);
+    counts.push_back(hardware);
+    return counts;
+}
+
+// 各线程数下离线渲染 1 秒：实时流数 = 渲染的音频秒数 / 墙钟秒数，每线程实时流数应基本不随线程数下降
+void reportScaling() {
+    static bool reported = false;
+    if (reported) return;
+    reported = true;
+    double single = 0.0;
+    for (size_t threads : threadCounts()) {
+        auto host = makeHost(threads);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t ticks = 0;
+        double elapsed = 0.0;
+        do {
+            host->tick();
+            ticks++;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (elapsed < 1.0);
+        double streams = static_cast<double>(ticks * kSessions) * host->tickSeconds() / elapsed;
+        if (threads == 1) single = streams;
+        std::printf("# session: %zu sessions on %zu threads: %.0f realtime streams (%.0f per thread, "
+                    "%.2fx of 1 thread), tick %.2f ms of %.1f ms\n",
+                    kSessions, threads, streams, streams / threads, single > 0 ? streams / single : 0.0,
+                    elapsed / ticks * 1000.0, host->tickSeconds() * 1000.0);
+    }
+}
+
+// 调度器在 1 个工作线程上实时运行时，控制台持会话锁执行 "@all load -r <目录>"：
+// 扫描任务与各会话的调度任务共用这一个线程，调度任务不得阻塞在会话锁上，否则两边互等
+void reportCommandsWhileRunning() {
+    static bool reported = false;
+    if (reported) return;
+    reported = true;
+    const size_t sessions = 3;
+    SessionManager host(NativeEngineConfig(), 1);
+    for (size_t i = 0; i < sessions; i++) {
+        auto session = host.create(std::to_string(i + 1));
+        std::lock_guard<std::mutex> lock(session->mutex());
+        session->player().setWaveformCacheDirectory(corpus().waveformDirectory());
+        for (const auto& path : corpus().paths()) session->player().getPlaylist().addTrack(path);
+        session->player().setLoopMode(LoopMode::All);
+        session->player().play();
+    }
+    host.start();
+    // 连续执行 1 秒，覆盖约 20 个调度周期
+    std::atomic<bool> done{false};
+    size_t rounds = 0;
+    std::thread console([&]() {
+        std::string command = "load -r " + corpus().root();
+        auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (std::chrono::steady_clock::now() < until) {
+            for (const auto& session : host.sessions()) {
+                std::ostringstream out;
+                std::unique_lock<std::mutex> lock(session->mutex());
+                processCommand(session->player(), tokenizeCommand(command), lock, out);
+                session->player().getPlaylist().clear();
+            }
+            rounds++;
+        }
+        done = true;
+    });
+    auto start = std::chrono::steady_clock::now();
+    while (!done && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    if (!done) {
+        // 线程已互等，无法正常退出
+        benchCheck(false, "session: @all load -r on a 1-thread pool did not finish within 10 s (deadlock)");
+        std::fflush(stdout);
+        std::_Exit(3);
+    }
+    console.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    host.stop();
+    SessionHostStats stats = host.getStats();
+    std::printf("# session: %zu x @all load -r on %zu sessions sharing 1 thread with the running scheduler: "
+                "%.0f ms, %llu ticks\n", rounds, sessions, seconds * 1000.0,
+                static_cast<unsigned long long>(stats.ticks));
+}
+
+BenchRegistrar registerSession([]() {
+    // 每次迭代为全部会话渲染一个调度周期；吞吐量以“音频秒/秒”报告，即可实时承载的流数
+    for (size_t threads : threadCounts()) {
+        registerBenchmark("session/tick/threads-" + std::to_string(threads), "audio-sec",
+                          [threads](uint64_t iterations) {
+            reportCommandsWhileRunning();
+            reportScaling();
+            static std::unique_ptr<SessionManager> host;
+            if (!host || host->getWorkerPool().size() != threads) {
+                host.reset();
+                host = makeHost(threads);
+            }
+            for (uint64_t i = 0; i < iterations; i++) host->tick();
+            return static_cast<double>(iterations * kSessions) * host->tickSeconds();
+        });
+    }
+});
+
+} // namespace
@@ -0,0 +1,101 @@
+#include "BenchHarness.h"
+#include "Instrumentation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+// 每次操作的纳秒数：重复 n 次取最快的一轮
+template <typename Fn>
+double nsPerOp(Fn&& fn, uint64_t n) {
+    double best = 1e9;
+    for (int round = 0; round < 5; round++) {
+        auto start = std::chrono::steady_clock::now();
+        fn(n);
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n);
+    }
+    return best;
+}
+
+// 探针开销的拆分：两次读取时间戳与写入直方图。目标为每个探针 20 ns 以内；
+// 时间戳读取的代价取决于宿主（虚拟机上 TSC 读取可能被截获），不满足时如实报告
+void reportProbeCost() {
+    static bool reported = false;
+    if (reported) return;
+    reported = true;
+    if (!Stats::kProbesEnabled) return;
+    const uint64_t n = 2000000;
+    double probe = nsPerOp([](uint64_t count) {
+        for (uint64_t i = 0; i < count; i++) {
+            MUSICAPP_PROBE(Seek);
+            doNotOptimize(i);
+        }
+    }, n);
+    double clock = nsPerOp([](uint64_t count) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            uint64_t start = Stats::ticks();
+            total += Stats::ticks() - start;
+        }
+        doNotOptimize(total);
+    }, n);
+    double record = nsPerOp([](uint64_t count) {
+        for (uint64_t i = 0; i < count; i++) Stats::tlsBlock->record(Stats::Probe::Seek, 40 + (i & 63));
+    }, n);
+    std::printf("# stats: probe %.1f ns = timestamps %.1f ns + histogram %.1f ns; target < 20 ns per probe: %s\n",
+                probe, clock, record, probe < 20.0 ? "met" : "MISSED");
+}
+
+// 探针本身的开销：空作用域计时一次、计数一次；编译时关闭计时探针则前者接近空循环
+BenchRegistrar registerStats([]() {
+    registerBenchmark("stats/probe", "probes", [](uint64_t iterations) {
+        reportProbeCost();
+        for (uint64_t i = 0; i < iterations; i++) {
+            MUSICAPP_PROBE(Seek);
+            doNotOptimize(i);
+        }
+        return static_cast<double>(iterations);
+    });
+
+    // 探针中两次读取时间戳的部分（虚拟机上 TSC 读取可能被截获，明显变慢）
+    registerBenchmark("stats/clock", "pairs", [](uint64_t iterations) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            uint64_t start = Stats::ticks();
+            total += Stats::ticks() - start;
+        }
+        doNotOptimize(total);
+        return static_cast<double>(iterations);
+    });
+
+    // 写入直方图（总和与一个格子），不含时间戳
+    registerBenchmark("stats/record", "records", [](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) Stats::tlsBlock->record(Stats::Probe::Seek, 40 + (i & 63));
+        return static_cast<double>(iterations);
+    });
+
+    registerBenchmark("stats/counter", "counts", [](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            MUSICAPP_COUNT(UnderrunFrames, 1);
+            doNotOptimize(i);
+        }
+        return static_cast<double>(iterations);
+    });
+
+    // 汇总所有线程块并计算分位数
+    registerBenchmark("stats/snapshot", "snapshots", [](uint64_t iterations) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            Stats::Snapshot snap = Stats::Registry::instance().snapshot();
+            total += snap.probes[static_cast<size_t>(Stats::Probe::Seek)].count;
+        }
+        doNotOptimize(total);
+        return static_cast<double>(iterations);
+    });
+});
+
+} // namespace
@@ -0,0 +1,124 @@
+#include "BenchFixtures.h"
+#include "BenchHarness.h"
+#include "WaveformRenderer.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace MusicApp;
+using namespace MusicBench;
+
+namespace {
+
+const size_t kFrames = 4096;
+const uint16_t kChannels = 2;
+const uint32_t kRate = 44100;
+const double kSeconds = 180.0;
+const double kPi = 3.14159265358979323846;
+
+const SimdLevel kLevels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+
+// 临时目录中的一首 3 分钟 16 位立体声 WAV（幅度缓慢起伏的正弦）与它的波形缓存目录
+class WavTrack {
+public:
+    WavTrack() : dir_("waveform"), path_(dir_.file("track.wav")) {
+        writeWav(path_, kSeconds, kRate, kChannels, [](size_t i) {
+            double envelope = 0.5 + 0.45 * std::sin(2.0 * kPi * 0.1 * i / kRate);
+            return envelope * std::sin(2.0 * kPi * 220.0 * i / kRate);
+        });
+    }
+
+    const std::string& path() const { return path_; }
+    std::string cacheDirectory() const { return dir_.file("cache"); }
+
+private:
+    TempDirectory dir_;
+    std::string path_;
+};
+
+WavTrack& track() {
+    static WavTrack t;
+    return t;
+}
+
+const WaveformPyramid& pyramid() {
+    static WaveformPyramid p = []() {
+        WaveformPyramid result;
+        auto decoder = openAudioDecoder(track().path());
+        if (decoder) WaveformBuilder().build(*decoder, result);
+        return result;
+    }();
+    return p;
+}
+
+BenchRegistrar registerWaveform([]() {
+    for (SimdLevel level : kLevels) {
+        if (!simdLevelSupported(level)) continue;
+        registerBenchmark(std::string("waveform/minmax/") + simdLevelName(level), "audio-sec",
+                          [level](uint64_t iterations) {
+            PeakKernels::MinMaxFn minMax = PeakKernels::select(level);
+            std::vector<float> in(kFrames * kChannels);
+            uint32_t state = 12345;
+            for (float& x : in) {
+                state = state * 1664525u + 1013904223u;
+                x = static_cast<float>(static_cast<int32_t>(state)) * (1.0f / 2147483648.0f);
+            }
+            for (uint64_t i = 0; i < iterations; i++) {
+                float lo = 0.0f, hi = 0.0f;
+                minMax(in.data(), in.size(), lo, hi);
+                doNotOptimize(lo);
+                doNotOptimize(hi);
+            }
+            return static_cast<double>(iterations * kFrames) / kRate;
+        });
+    }
+
+    // 解码 + 归约 + 建层，单线程
+    registerBenchmark("waveform/build", "audio-sec", [](uint64_t iterations) {
+        static bool reported = false;
+        double seconds = 0.0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            auto decoder = openAudioDecoder(track().path());
+            WaveformPyramid result;
+            if (!decoder || !WaveformBuilder().build(*decoder, result)) return 0.0;
+            seconds += result.seconds();
+            if (!reported) {
+                reported = true;
+                std::printf("# waveform: %.0f s track -> %zu levels, %zu bytes in memory\n",
+                            result.seconds(), result.levels.size(), result.memoryBytes());
+            }
+        }
+        return seconds;
+    });
+
+    // 72 列 x 9 行的整曲渲染与 20 秒窗口渲染交替进行
+    registerBenchmark("waveform/render", "renders", [](uint64_t iterations) {
+        WaveformRenderer renderer;
+        const WaveformPyramid& p = pyramid();
+        for (uint64_t i = 0; i < iterations; i++) {
+            double position = static_cast<double>(i % 160) + 10.0;
+            const std::string& out = (i & 1) ? renderer.render(p, position - 10.0, position + 10.0, position, 72, 9)
+                                             : renderer.render(p, 0.0, p.seconds(), position, 72, 9);
+            doNotOptimize(out.size());
+        }
+        return static_cast<double>(iterations);
+    });
+
+    // 从缓存文件读回金字塔（含源文件的大小与修改时间校验）
+    registerBenchmark("waveform/load", "loads", [](uint64_t iterations) {
+        WorkStealingPool pool;
+        WaveformCache cache(pool, track().cacheDirectory());
+        cache.submit(track().path(), false);
+        while (cache.outstanding() > 0) cache.drain([](WaveformBuild&) {});
+        for (uint64_t i = 0; i < iterations; i++) {
+            WaveformPyramid loaded;
+            if (!cache.load(track().path(), loaded)) return 0.0;
+            doNotOptimize(loaded.totalFrames);
+        }
+        return static_cast<double>(iterations);
+    });
+});
+
+} // namespace
@@ -0,0 +1,120 @@
+#ifndef AUDIO_DECODER_H
+#define AUDIO_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace MusicApp {
+
+// 原始 PCM 样本编码
+enum class PcmEncoding {
+    Unknown,
+    Int16,
+    Int24,
+    Int32,
+    Float32
+};
+
+// 原始 PCM 样本片段，直接指向解码器内部存储（如内存映射的文件）
+struct PcmSpan {
+    const unsigned char* data = nullptr;
+    size_t frames = 0;
+    PcmEncoding encoding = PcmEncoding::Unknown;
+};
+
+// 每个样本的字节数
+inline size_t pcmBytesPerSample(PcmEncoding encoding) {
+    switch (encoding) {
+        case PcmEncoding::Int16: return 2;
+        case PcmEncoding::Int24: return 3;
+        case PcmEncoding::Int32: return 4;
+        case PcmEncoding::Float32: return 4;
+        case PcmEncoding::Unknown: break;
+    }
+    return 0;
+}
+
+inline uint16_t readLE16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t readLE32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// 将原始 PCM 样本转换为浮点
+inline void convertPcmSamples(const unsigned char* src, PcmEncoding encoding,
+                              size_t count, float* out) {
+    switch (encoding) {
+        case PcmEncoding::Int16:
+            for (size_t i = 0; i < count; i++) {
+                int16_t v = static_cast<int16_t>(readLE16(src + i * 2));
+                out[i] = v * (1.0f / 32768.0f);
+            }
+            break;
+        case PcmEncoding::Int24:
+            for (size_t i = 0; i < count; i++) {
+                const unsigned char* p = src + i * 3;
+                int32_t v = static_cast<int32_t>(
+                    (static_cast<uint32_t>(p[0]) << 8) |
+                    (static_cast<uint32_t>(p[1]) << 16) |
+                    (static_cast<uint32_t>(p[2]) << 24)) >> 8;
+                out[i] = v * (1.0f / 8388608.0f);
+            }
+            break;
+        case PcmEncoding::Int32:
+            for (size_t i = 0; i < count; i++) {
+                int32_t v = static_cast<int32_t>(readLE32(src + i * 4));
+                out[i] = static_cast<float>(v * (1.0 / 2147483648.0));
+            }
+            break;
+        case PcmEncoding::Float32:
+            std::memcpy(out, src, count * sizeof(float));
+            break;
+        case PcmEncoding::Unknown:
+            break;
+    }
+}
+
+// 音频解码器抽象基类
+// 输出为交错的 32 位浮点样本，范围 [-1, 1]
+class AudioDecoder {
+public:
+    virtual ~AudioDecoder() = default;
+
+    // 打开音频文件
+    virtual bool open(const std::string& filepath) = 0;
+
+    // 格式信息
+    virtual uint32_t getSampleRate() const = 0;
+    virtual uint16_t getChannels() const = 0;
+    virtual uint64_t getTotalFrames() const = 0;
+
+    // 解码最多 frames 帧到 out，返回实际帧数；0 表示流结束
+    virtual size_t read(float* out, size_t frames) = 0;
+
+    // 定位到指定帧
+    virtual bool seek(uint64_t frame) = 0;
+
+    // 当前解码位置（帧）
+    virtual uint64_t tell() const = 0;
+
+    // 零拷贝读取：返回指向内部存储的最多 frames 帧原始样本并前移位置
+    // 不支持零拷贝的解码器返回 false，调用方改用 read()
+    virtual bool readSpan(size_t frames, PcmSpan& span) {
+        (void)frames;
+        (void)span;
+        return false;
+    }
+    virtual bool supportsSpans() const { return false; }
+
+    // 经由中间缓冲区拷贝的原始字节总数（零拷贝路径为 0）
+    virtual uint64_t getBytesCopied() const { return 0; }
+};
+
+} // namespace MusicApp
+
+#endif // AUDIO_DECODER_H
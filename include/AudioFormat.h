@@ -0,0 +1,384 @@
+#ifndef AUDIO_FORMAT_H
+#define AUDIO_FORMAT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MusicApp {
+
+// 音频容器格式，按文件内容识别
+enum class AudioFormat : uint8_t {
+    Unknown,
+    Wav,
+    Flac,
+    Mp3,
+    Ogg,
+    Mp4,
+    Wma,
+    Count
+};
+
+inline const char* audioFormatName(AudioFormat format) {
+    static const char* const kNames[] = { "unknown", "wav", "flac", "mp3", "ogg", "mp4", "wma" };
+    return kNames[static_cast<size_t>(format) < static_cast<size_t>(AudioFormat::Count)
+                  ? static_cast<size_t>(format) : 0];
+}
+
+namespace Metadata {
+
+inline uint32_t readSyncsafe32(const unsigned char* p) {
+    return ((p[0] & 0x7Fu) << 21) | ((p[1] & 0x7Fu) << 14) | ((p[2] & 0x7Fu) << 7) | (p[3] & 0x7Fu);
+}
+
+// ID3v2 标签总长度（含头部与可选尾部），不是 ID3v2 时返回 0
+inline uint64_t id3v2Size(const unsigned char* p, size_t len) {
+    if (len < 10 || std::memcmp(p, "ID3", 3) != 0 || p[3] == 0xFF || p[4] == 0xFF) return 0;
+    uint64_t size = 10 + readSyncsafe32(p + 6);
+    if (p[5] & 0x10) size += 10;    // 尾部
+    return size;
+}
+
+struct MpegFrameHeader {
+    uint32_t bitrate = 0;       // bit/s
+    uint32_t sampleRate = 0;
+    uint32_t samplesPerFrame = 0;
+    uint32_t frameBytes = 0;
+    uint32_t sideInfoBytes = 0;
+};
+
+inline bool parseMpegHeader(const unsigned char* p, MpegFrameHeader& h) {
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) return false;
+    int versionBits = (p[1] >> 3) & 3;      // 0: 2.5, 2: 2, 3: 1
+    int layerBits = (p[1] >> 1) & 3;        // 1: III, 2: II, 3: I
+    int bitrateIndex = p[2] >> 4;
+    int rateIndex = (p[2] >> 2) & 3;
+    bool padding = (p[2] >> 1) & 1;
+    bool mono = (p[3] >> 6) == 3;
+    if (versionBits == 1 || layerBits == 0 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) {
+        return false;
+    }
+    static const uint16_t kBitrates[2][3][15] = {
+        {   // MPEG-1: I, II, III
+            { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448 },
+            { 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384 },
+            { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 } },
+        {   // MPEG-2/2.5: I, II, III
+            { 0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256 },
+            { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },
+            { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 } } };
+    static const uint32_t kRates[3] = { 44100, 48000, 32000 };
+    bool mpeg1 = versionBits == 3;
+    int layer = 4 - layerBits;              // 1, 2, 3
+    h.bitrate = kBitrates[mpeg1 ? 0 : 1][layer - 1][bitrateIndex] * 1000u;
+    h.sampleRate = kRates[rateIndex] >> (mpeg1 ? 0 : (versionBits == 2 ? 1 : 2));
+    if (layer == 1) {
+        h.samplesPerFrame = 384;
+        h.frameBytes = (12 * h.bitrate / h.sampleRate + padding) * 4;
+    } else {
+        h.samplesPerFrame = (layer == 3 && !mpeg1) ? 576 : 1152;
+        h.frameBytes = h.samplesPerFrame / 8 * h.bitrate / h.sampleRate + padding;
+    }
+    h.sideInfoBytes = layer != 3 ? 0 : mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17);
+    return h.frameBytes > 4;
+}
+
+} // namespace Metadata
+
+namespace FormatDetail {
+
+// 扩展名的完美哈希：至多 4 个字符按小端装入 32 位（只把 A-Z 折成小写），
+// 乘法取高 3 位落入 8 个槽位；表在编译期生成并校验无冲突，查找不分配内存
+struct ExtensionSlot {
+    uint32_t key;
+    AudioFormat format;
+};
+
+constexpr uint32_t kExtensionMultiplier = 0x11A25BFBu;
+constexpr unsigned kExtensionSlotBits = 3;
+
+constexpr uint32_t foldChar(unsigned char c) {
+    return c + ((static_cast<unsigned>(c - 'A') < 26u) << 5);
+}
+
+constexpr uint32_t extensionKey(const char* s, size_t len) {
+    uint32_t key = 0;
+    for (size_t i = 0; i < len; i++) key |= foldChar(static_cast<unsigned char>(s[i])) << (8 * i);
+    return key;
+}
+
+constexpr uint32_t extensionSlot(uint32_t key) {
+    return (key * kExtensionMultiplier) >> (32 - kExtensionSlotBits);
+}
+
+struct ExtensionName {
+    const char* name;
+    size_t len;
+    AudioFormat format;
+};
+
+constexpr ExtensionName kExtensions[] = {
+    { "mp3", 3, AudioFormat::Mp3 },
+    { "wav", 3, AudioFormat::Wav },
+    { "ogg", 3, AudioFormat::Ogg },
+    { "flac", 4, AudioFormat::Flac },
+    { "m4a", 3, AudioFormat::Mp4 },
+    { "wma", 3, AudioFormat::Wma },
+};
+
+using ExtensionTable = std::array<ExtensionSlot, size_t(1) << kExtensionSlotBits>;
+
+constexpr ExtensionTable buildExtensionTable() {
+    ExtensionTable table{};
+    for (const auto& ext : kExtensions) {
+        uint32_t key = extensionKey(ext.name, ext.len);
+        table[extensionSlot(key)] = ExtensionSlot{ key, ext.format };
+    }
+    return table;
+}
+
+constexpr bool extensionTableIsPerfect() {
+    ExtensionTable table = buildExtensionTable();
+    for (const auto& ext : kExtensions) {
+        const ExtensionSlot& slot = table[extensionSlot(extensionKey(ext.name, ext.len))];
+        if (slot.key != extensionKey(ext.name, ext.len) || slot.format != ext.format) return false;
+    }
+    return true;
+}
+
+static_assert(extensionTableIsPerfect(), "extension hash has collisions; pick another multiplier");
+
+constexpr ExtensionTable kExtensionTable = buildExtensionTable();
+
+inline bool matchesAt(const unsigned char* p, size_t len, size_t offset, const char* magic, size_t n) {
+    return offset + n <= len && std::memcmp(p + offset, magic, n) == 0;
+}
+
+} // namespace FormatDetail
+
+// 按文件名的扩展名给出预期格式（不区分大小写，不分配内存）；不是音频扩展名时返回 Unknown
+inline AudioFormat formatFromExtension(std::string_view filename) {
+    size_t dot = filename.find_last_of('.');
+    if (dot == std::string_view::npos) return AudioFormat::Unknown;
+    size_t len = filename.size() - dot - 1;
+    if (len < 3 || len > 4) return AudioFormat::Unknown;
+    uint32_t key = FormatDetail::extensionKey(filename.data() + dot + 1, len);
+    const FormatDetail::ExtensionSlot& slot = FormatDetail::kExtensionTable[FormatDetail::extensionSlot(key)];
+    return slot.key == key ? slot.format : AudioFormat::Unknown;
+}
+
+// 是否带有音频扩展名（扫描时的第一道过滤，内容再由 sniffAudioFile 确认）
+inline bool hasAudioExtension(std::string_view filename) {
+    return formatFromExtension(filename) != AudioFormat::Unknown;
+}
+
+// 嗅探时读取的文件头长度
+constexpr size_t kSniffBytes = 4096;
+
+// 按文件头部的魔数识别格式。ID3v2 标签后的内容不在 head 中时，
+// afterTag 给出标签之后的 4 个字节（为空表示未读取）
+inline AudioFormat sniffAudioFormat(const unsigned char* head, size_t len,
+                                    const unsigned char* afterTag = nullptr) {
+    using FormatDetail::matchesAt;
+    uint64_t tagSize = Metadata::id3v2Size(head, len);
+    if (tagSize > 0) {
+        // ID3v2 标签后可能是 FLAC，否则视为 MP3
+        const unsigned char* magic = tagSize + 4 <= len ? head + tagSize : afterTag;
+        return magic && std::memcmp(magic, "fLaC", 4) == 0 ? AudioFormat::Flac : AudioFormat::Mp3;
+    }
+    if (matchesAt(head, len, 0, "fLaC", 4)) return AudioFormat::Flac;
+    if (matchesAt(head, len, 0, "RIFF", 4) && matchesAt(head, len, 8, "WAVE", 4)) return AudioFormat::Wav;
+    if (matchesAt(head, len, 0, "OggS", 4)) return AudioFormat::Ogg;
+    if (matchesAt(head, len, 4, "ftyp", 4)) return AudioFormat::Mp4;
+    static const unsigned char kAsfGuid[16] = { 0x30, 0x26, 0xB2, 0x75, 0x8E, 0x66, 0xCF, 0x11,
+                                                0xA6, 0xD9, 0x00, 0xAA, 0x00, 0x62, 0xCE, 0x6C };
+    if (len >= 16 && std::memcmp(head, kAsfGuid, 16) == 0) return AudioFormat::Wma;
+
+    // 无标签的 MPEG 音频：文件头内第一个帧头，且下一帧（若在 head 内）也必须是有效帧头
+    for (size_t i = 0; i + 4 <= len; i++) {
+        const unsigned char* sync = static_cast<const unsigned char*>(std::memchr(head + i, 0xFF, len - 3 - i));
+        if (!sync) break;
+        i = static_cast<size_t>(sync - head);
+        Metadata::MpegFrameHeader h;
+        if (!Metadata::parseMpegHeader(sync, h)) continue;
+        size_t next = i + h.frameBytes;
+        Metadata::MpegFrameHeader h2;
+        if (next + 4 <= len && !Metadata::parseMpegHeader(head + next, h2)) continue;
+        return AudioFormat::Mp3;
+    }
+    return AudioFormat::Unknown;
+}
+
+// 嗅探结果及嗅探时的文件大小与修改时间
+struct SniffResult {
+    AudioFormat format = AudioFormat::Unknown;
+    bool opened = false;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+};
+
+namespace FormatDetail {
+
+#ifdef _WIN32
+inline bool readFileAt(HANDLE file, uint64_t offset, unsigned char* buf, size_t len, size_t& got) {
+    OVERLAPPED ov = {};
+    ov.Offset = static_cast<DWORD>(offset);
+    ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD n = 0;
+    if (!ReadFile(file, buf, static_cast<DWORD>(len), &n, &ov)) return false;
+    got = n;
+    return true;
+}
+#else
+inline size_t preadFull(int fd, unsigned char* buf, size_t len, uint64_t offset) {
+    size_t total = 0;
+    while (total < len) {
+        ssize_t n = ::pread(fd, buf + total, len - total, static_cast<off_t>(offset + total));
+        if (n <= 0) break;
+        total += static_cast<size_t>(n);
+    }
+    return total;
+}
+
+// 已打开的文件：一次 fstat 与一次文件头读取；ID3v2 标签超出文件头时再读 4 字节
+inline SniffResult sniffFd(int fd) {
+    SniffResult result;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return result;
+    result.opened = true;
+    result.size = static_cast<uint64_t>(st.st_size);
+#ifdef __APPLE__
+    result.mtimeNs = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    result.mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    unsigned char head[kSniffBytes];
+    size_t got = preadFull(fd, head, sizeof(head), 0);
+    unsigned char afterTag[4];
+    const unsigned char* extra = nullptr;
+    uint64_t tagSize = Metadata::id3v2Size(head, got);
+    if (tagSize > 0 && tagSize + 4 > got && preadFull(fd, afterTag, 4, tagSize) == 4) {
+        extra = afterTag;
+    }
+    result.format = sniffAudioFormat(head, got, extra);
+    return result;
+}
+#endif
+
+} // namespace FormatDetail
+
+// 按路径嗅探文件格式
+inline SniffResult sniffAudioFile(const std::string& path) {
+#ifdef _WIN32
+    SniffResult result;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return result;
+    BY_HANDLE_FILE_INFORMATION info;
+    if (GetFileInformationByHandle(file, &info)) {
+        result.opened = true;
+        result.size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+        uint64_t ticks = (static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) |
+                         info.ftLastWriteTime.dwLowDateTime;
+        result.mtimeNs = static_cast<int64_t>(ticks * 100);
+        unsigned char head[kSniffBytes];
+        size_t got = 0;
+        FormatDetail::readFileAt(file, 0, head, sizeof(head), got);
+        unsigned char afterTag[4];
+        const unsigned char* extra = nullptr;
+        uint64_t tagSize = Metadata::id3v2Size(head, got);
+        size_t tail = 0;
+        if (tagSize > 0 && tagSize + 4 > got &&
+            FormatDetail::readFileAt(file, tagSize, afterTag, 4, tail) && tail == 4) {
+            extra = afterTag;
+        }
+        result.format = sniffAudioFormat(head, got, extra);
+    }
+    CloseHandle(file);
+    return result;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return SniffResult();
+    SniffResult result = FormatDetail::sniffFd(fd);
+    ::close(fd);
+    return result;
+#endif
+}
+
+#ifndef _WIN32
+// 相对目录 fd 嗅探，扫描时不必拼接完整路径
+inline SniffResult sniffAudioFileAt(int dirFd, const char* name) {
+    int fd = ::openat(dirFd, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return SniffResult();
+    SniffResult result = FormatDetail::sniffFd(fd);
+    ::close(fd);
+    return result;
+}
+#endif
+
+// 进程内的逐文件格式缓存：扫描时写入，打开解码器时按路径查询，
+// 文件大小或修改时间变化后失效。直接映射的定长槽位，按路径哈希覆盖，内存有上限
+class AudioFormatCache {
+public:
+    static AudioFormatCache& shared() {
+        static AudioFormatCache cache;
+        return cache;
+    }
+
+    bool lookup(const std::string& path, uint64_t size, int64_t mtimeNs, AudioFormat& format) {
+        size_t h = std::hash<std::string>()(path);
+        Slot& slot = slots_[h & (kSlots - 1)];
+        std::lock_guard<std::mutex> lock(stripes_[h & (kStripes - 1)]);
+        if (slot.hash != h || slot.size != size || slot.mtimeNs != mtimeNs || slot.path != path) {
+            return false;
+        }
+        format = slot.format;
+        return true;
+    }
+
+    void store(const std::string& path, const SniffResult& sniffed) {
+        size_t h = std::hash<std::string>()(path);
+        Slot& slot = slots_[h & (kSlots - 1)];
+        std::lock_guard<std::mutex> lock(stripes_[h & (kStripes - 1)]);
+        slot.hash = h;
+        slot.path = path;
+        slot.size = sniffed.size;
+        slot.mtimeNs = sniffed.mtimeNs;
+        slot.format = sniffed.format;
+    }
+
+private:
+    static constexpr size_t kSlots = size_t(1) << 15;
+    static constexpr size_t kStripes = 64;
+
+    struct Slot {
+        size_t hash = 0;
+        std::string path;
+        uint64_t size = 0;
+        int64_t mtimeNs = 0;
+        AudioFormat format = AudioFormat::Unknown;
+    };
+
+    AudioFormatCache() : slots_(new Slot[kSlots]) {}
+
+    std::unique_ptr<Slot[]> slots_;
+    std::mutex stripes_[kStripes];
+};
+
+} // namespace MusicApp
+
+#endif // AUDIO_FORMAT_H
@@ -3,9 +3,13 @@
 
 #include <string>
 #include <functional>
+#include <cstdint>
+#include "EventQueue.h"
 
 namespace MusicApp {
 
+class EventWake;
+
 // 播放状态枚举
 enum class PlayState {
     Stopped,
@@ -20,6 +24,9 @@ enum class LoopMode {
     All         // 列表循环
 };
 
+// 交叉淡变时长上限（秒）
+constexpr float kMaxCrossfadeSeconds = 30.0f;
+
 // 音频播放器抽象基类
 class AudioPlayer {
 public:
@@ -53,8 +60,47 @@ public:
     using EndCallback = std::function<void()>;
     virtual void setOnEndCallback(EndCallback callback) = 0;
     
-    // 更新状态（需要在主循环中调用）
+    // 更新状态：分发后端事件或轮询设备状态（由事件循环线程周期调用）
     virtual void update() = 0;
+    
+    // 事件循环调用 update() 的间隔（秒）；推送事件的后端返回一个音频缓冲周期
+    virtual float getUpdateInterval() const { return 0.05f; }
+    
+    // 推送事件的后端在推送需要及时处理的事件（结束、切换、错误）后触发的唤醒，事件循环阻塞等待它；
+    // 返回 nullptr 的后端由事件循环按 getUpdateInterval() 轮询。唤醒归后端所有，与后端同寿命
+    virtual EventWake* getEventWake() { return nullptr; }
+    
+    // 设置后端事件回调（错误、播放位置等）
+    using EventCallback = std::function<void(const PlayerEvent&)>;
+    virtual void setOnEventCallback(EventCallback callback) { (void)callback; }
+    
+    // 无缝播放：提前打开并预解码下一首，当前曲目结束时在同一音频回调内切换
+    // trackGain 为切换后使用的曲目增益；不支持无缝播放的后端返回 false
+    virtual bool queueNext(const std::string& filepath, float trackGain = 1.0f) {
+        (void)filepath;
+        (void)trackGain;
+        return false;
+    }
+    virtual void clearQueuedNext() {}
+    virtual std::string getQueuedNext() const { return ""; }
+    
+    // 交叉淡变：当前曲目的最后 seconds 秒与预载曲目的开头按等功率曲线叠加，0 表示关闭；
+    // 时长限制在 0 到 kMaxCrossfadeSeconds 之间，非有限值视为 0
+    // 切换回调在淡变开始时触发；不支持的后端返回 false
+    virtual bool setCrossfade(float seconds) { (void)seconds; return false; }
+    
+    // 曲目增益（线性，响度归一化用），与音量相乘作用于当前曲目；不支持的后端返回 false
+    virtual bool setTrackGain(float gain) { (void)gain; return false; }
+    
+    // 设置无缝切换到预载曲目后的回调
+    using TransitionCallback = std::function<void()>;
+    virtual void setOnTransitionCallback(TransitionCallback callback) { (void)callback; }
+    
+    // 最近一次曲目切换的间隙（样本帧数），-1 表示尚未切换过或后端不支持统计
+    virtual int64_t getLastGapFrames() const { return -1; }
+    
+    // 后端诊断信息（缓冲、拷贝量等），不支持的后端返回空字符串
+    virtual std::string getDiagnostics() const { return ""; }
 };
 
 } // namespace MusicApp
@@ -0,0 +1,204 @@
+#ifndef AUDIO_SINK_H
+#define AUDIO_SINK_H
+
+#include "Instrumentation.h"
+#include "RingBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace MusicApp {
+
+// 音频输出端抽象基类
+// write 在渲染线程中调用，实现不得分配内存
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    // 打开输出端 (采样率, 声道数, 单次写入的最大帧数)
+    virtual bool open(uint32_t sampleRate, uint16_t channels, size_t maxFrames) = 0;
+
+    // 写入交错的浮点样本 (frames 帧)
+    virtual void write(const float* samples, size_t frames) = 0;
+
+    virtual void close() = 0;
+
+    // 输出端是否自身按设备时钟阻塞；否则由引擎按实时节奏调度
+    virtual bool isClocked() const { return false; }
+
+    // 因输出跟不上而丢弃的帧数
+    virtual uint64_t getDroppedFrames() const { return 0; }
+};
+
+// 丢弃所有输出的空输出端（用于无声卡的服务器）
+class NullAudioSink : public AudioSink {
+public:
+    bool open(uint32_t, uint16_t, size_t) override {
+        framesWritten_ = 0;
+        return true;
+    }
+
+    void write(const float*, size_t frames) override {
+        framesWritten_ += frames;
+    }
+
+    void close() override {}
+
+    uint64_t getFramesWritten() const { return framesWritten_; }
+
+private:
+    uint64_t framesWritten_ = 0;
+};
+
+// 写入 16 位 PCM WAV 文件的输出端。
+// write 只把样本转换成 16 位写入 SPSC 环形缓冲区（约 2 秒），文件由写出线程写入，渲染线程不做文件 I/O；
+// 磁盘停顿超过缓冲区的长度时丢弃整个周期并计数，不阻塞渲染线程
+class WavFileAudioSink : public AudioSink {
+public:
+    static constexpr double kBufferSeconds = 2.0;
+
+    explicit WavFileAudioSink(const std::string& path) : path_(path) {}
+
+    ~WavFileAudioSink() override {
+        close();
+    }
+
+    bool open(uint32_t sampleRate, uint16_t channels, size_t maxFrames) override {
+        close();
+        file_ = std::fopen(path_.c_str(), "wb");
+        if (!file_) return false;
+        sampleRate_ = sampleRate;
+        channels_ = channels;
+        dataBytes_ = 0;
+        droppedFrames_.store(0, std::memory_order_relaxed);
+        size_t frames = std::max(maxFrames * 4, static_cast<size_t>(sampleRate * kBufferSeconds));
+        ring_.reset(frames * channels);
+        chunk_.assign(std::min<size_t>(ring_.capacity(), 65536), 0);
+        writeHeader();
+        running_ = true;
+        writer_ = std::thread(&WavFileAudioSink::writeLoop, this);
+        return true;
+    }
+
+    void write(const float* samples, size_t frames) override {
+        if (!file_) return;
+        size_t count = frames * channels_;
+        if (ring_.writeAvailable() < count) {
+            droppedFrames_.fetch_add(frames, std::memory_order_relaxed);
+            return;
+        }
+        int16_t* first;
+        size_t firstLen;
+        int16_t* second;
+        size_t secondLen;
+        ring_.prepareWrite(count, first, firstLen, second, secondLen);
+        convert(samples, first, firstLen);
+        convert(samples + firstLen, second, secondLen);
+        ring_.commitWrite(count);
+    }
+
+    void close() override {
+        if (file_) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                running_ = false;
+            }
+            cv_.notify_one();
+            writer_.join();
+            // 回填 RIFF 与 data 块长度
+            writeHeader();
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+
+    uint64_t getDroppedFrames() const override {
+        return droppedFrames_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static void convert(const float* samples, int16_t* out, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            float s = std::max(-1.0f, std::min(1.0f, samples[i]));
+            out[i] = static_cast<int16_t>(s * 32767.0f);
+        }
+    }
+
+    // 写出线程：渲染线程不通知条件变量，按固定间隔轮询缓冲区；关闭时写完剩余数据
+    void writeLoop() {
+        MUSICAPP_STATS_THREAD();
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            lock.unlock();
+            drain();
+            lock.lock();
+            cv_.wait_for(lock, std::chrono::milliseconds(10), [this]() { return !running_; });
+        }
+        lock.unlock();
+        drain();
+    }
+
+    void drain() {
+        while (size_t n = ring_.read(chunk_.data(), chunk_.size())) {
+            std::fwrite(chunk_.data(), sizeof(int16_t), n, file_);
+            dataBytes_ += static_cast<uint32_t>(n * sizeof(int16_t));
+        }
+    }
+
+    void writeHeader() {
+        std::fseek(file_, 0, SEEK_SET);
+        uint16_t blockAlign = static_cast<uint16_t>(channels_ * 2);
+        uint32_t byteRate = sampleRate_ * blockAlign;
+        std::fwrite("RIFF", 1, 4, file_);
+        writeLE32(36 + dataBytes_);
+        std::fwrite("WAVEfmt ", 1, 8, file_);
+        writeLE32(16);
+        writeLE16(1);  // PCM
+        writeLE16(channels_);
+        writeLE32(sampleRate_);
+        writeLE32(byteRate);
+        writeLE16(blockAlign);
+        writeLE16(16);
+        std::fwrite("data", 1, 4, file_);
+        writeLE32(dataBytes_);
+        std::fseek(file_, 0, SEEK_END);
+    }
+
+    void writeLE16(uint16_t v) {
+        unsigned char b[2] = { static_cast<unsigned char>(v),
+                               static_cast<unsigned char>(v >> 8) };
+        std::fwrite(b, 1, 2, file_);
+    }
+
+    void writeLE32(uint32_t v) {
+        unsigned char b[4] = { static_cast<unsigned char>(v),
+                               static_cast<unsigned char>(v >> 8),
+                               static_cast<unsigned char>(v >> 16),
+                               static_cast<unsigned char>(v >> 24) };
+        std::fwrite(b, 1, 4, file_);
+    }
+
+    std::string path_;
+    std::FILE* file_ = nullptr;
+    uint32_t sampleRate_ = 0;
+    uint16_t channels_ = 0;
+    uint32_t dataBytes_ = 0;            // 只由写出线程更新，关闭时在其退出后读取
+    SpscRingBuffer<int16_t> ring_;      // 生产者：渲染线程；消费者：写出线程
+    std::vector<int16_t> chunk_;
+    std::atomic<uint64_t> droppedFrames_{0};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_ = false;
+    std::thread writer_;
+};
+
+} // namespace MusicApp
+
+#endif // AUDIO_SINK_H
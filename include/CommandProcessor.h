@@ -0,0 +1,697 @@
+#ifndef COMMAND_PROCESSOR_H
+#define COMMAND_PROCESSOR_H
+
+#include "Instrumentation.h"
+#include "LibraryScanner.h"
+#include "MusicPlayer.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace MusicApp {
+
+// 交互命令的解析与执行；主程序的输入循环与基准测试共用
+
+// 命令列表
+inline void printHelp(std::ostream& out) {
+    out << R"(
+=== Music Player Commands ===
+  play, p          - Play/Resume
+  pause, pa        - Pause
+  stop, s          - Stop
+  next, n          - Next track
+  prev, pr         - Previous track
+  
+  seek <seconds>   - Seek to position
+  ff               - Fast forward 10s
+  rw               - Rewind 10s
+  
+  vol <0-100>      - Set volume
+  vol+ / vol-      - Volume up/down
+  
+  loop             - Toggle loop mode (Off/All/Single)
+  shuffle          - Toggle shuffle mode
+  gapless          - Toggle gapless playback
+  xfade <seconds>  - Crossfade into the next track (0-30, 0 = off)
+  normalize [on|off]
+                   - Loudness-normalize analyzed tracks
+  analyze          - Start/resume loudness analysis, or show progress
+  analyze stop     - Stop loudness analysis (resumable)
+  wave [seconds]   - Draw the current track's waveform (or 20s around a position)
+  wave build|stop  - Build waveform cache for the playlist / stop building
+  
+  add <file>       - Add file to playlist
+  load <directory> - Load all audio files from directory
+  load -r <dir> [-j N]
+                   - Recursively scan directory with N (1-256) threads
+  index [save]     - Show library index / save it now
+  list, ls         - Show tracks around the current one
+  list <n> [count] - Show count tracks starting at track n
+  list all         - Show the whole playlist
+  find <text>      - Search titles, artists and paths
+  play-find <text> - Play the first search match
+  goto <number>    - Jump to track number
+  remove <number>  - Remove track from playlist
+  move <from> <to> - Move track to another position
+  insert <number> <file>
+                   - Insert file before track number
+  clear            - Clear playlist
+  memory           - Show playlist memory usage per track
+  prefetch [n|off] - Show prefetch hit rate / warm the next n tracks / turn it off
+  
+  status, st       - Show current status
+  diag             - Show audio backend diagnostics
+  stats [json|reset]
+                   - Show hot-path counters (latency histograms need a build with
+                     -DENABLE_LATENCY_PROBES=ON)
+  help, h          - Show this help
+  quit, q          - Exit player
+
+)";
+}
+
+// 一行命令的参数：指向输入行的 string_view，不复制、不分配；输入行须在使用期间保持有效
+class CommandArgs {
+public:
+    static constexpr size_t kMaxTokens = 32;
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    std::string_view operator[](size_t i) const { return tokens_[i]; }
+
+    // 第 first 个到第 last - 1 个参数所覆盖的原文（保留其间的空白，用于含空格的路径与查询）
+    std::string_view span(size_t first, size_t last) const {
+        const char* begin = tokens_[first].data();
+        const char* end = tokens_[last - 1].data() + tokens_[last - 1].size();
+        return std::string_view(begin, static_cast<size_t>(end - begin));
+    }
+
+    // 第 first 个参数到行尾
+    std::string_view rest(size_t first) const { return span(first, count_); }
+
+    void push(std::string_view token) { tokens_[count_++] = token; }
+
+private:
+    std::array<std::string_view, kMaxTokens> tokens_{};
+    size_t count_ = 0;
+};
+
+// 把一行输入拆成空白分隔的参数：跳过 UTF-8 BOM，\r 与 \n 视为空白；
+// 超出 kMaxTokens 时最后一个参数延伸到行尾
+inline CommandArgs tokenizeCommand(std::string_view line) {
+    CommandArgs args;
+    if (line.size() >= 3 && static_cast<unsigned char>(line[0]) == 0xEF &&
+        static_cast<unsigned char>(line[1]) == 0xBB && static_cast<unsigned char>(line[2]) == 0xBF) {
+        line.remove_prefix(3);
+    }
+    auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+    size_t i = 0;
+    const size_t n = line.size();
+    while (i < n) {
+        while (i < n && isSpace(line[i])) i++;
+        if (i == n) break;
+        size_t start = i;
+        if (args.size() + 1 == CommandArgs::kMaxTokens) {
+            size_t end = n;
+            while (isSpace(line[end - 1])) end--;
+            args.push(line.substr(start, end - start));
+            break;
+        }
+        while (i < n && !isSpace(line[i])) i++;
+        args.push(line.substr(start, i - start));
+    }
+    return args;
+}
+
+// 命令编号；别名（p、ls、st 等）映射到同一编号
+enum class CommandId : uint8_t {
+    Unknown, Play, Pause, Stop, Next, Prev, Seek, Forward, Rewind, Volume, VolumeUp, VolumeDown,
+    Loop, Shuffle, Gapless, Crossfade, Normalize, Analyze, Wave, Add, Load, Index, List, Find,
+    PlayFind, Goto, Remove, Move, Insert, Clear, Memory, Prefetch, Status, Diag, Stats, Help, Quit
+};
+
+namespace CommandDetail {
+
+// 命令名的完美哈希：FNV-1a 后乘法取高 7 位落入 128 个槽位；
+// 表在编译期生成并校验无冲突，查找只需一次哈希与一次比较
+struct CommandName {
+    std::string_view name;
+    CommandId id;
+};
+
+constexpr CommandName kCommands[] = {
+    { "play", CommandId::Play }, { "p", CommandId::Play },
+    { "pause", CommandId::Pause }, { "pa", CommandId::Pause },
+    { "stop", CommandId::Stop }, { "s", CommandId::Stop },
+    { "next", CommandId::Next }, { "n", CommandId::Next },
+    { "prev", CommandId::Prev }, { "pr", CommandId::Prev },
+    { "seek", CommandId::Seek }, { "ff", CommandId::Forward }, { "rw", CommandId::Rewind },
+    { "vol", CommandId::Volume }, { "vol+", CommandId::VolumeUp }, { "vol-", CommandId::VolumeDown },
+    { "loop", CommandId::Loop }, { "shuffle", CommandId::Shuffle }, { "gapless", CommandId::Gapless },
+    { "xfade", CommandId::Crossfade }, { "normalize", CommandId::Normalize },
+    { "analyze", CommandId::Analyze }, { "wave", CommandId::Wave },
+    { "add", CommandId::Add }, { "load", CommandId::Load }, { "index", CommandId::Index },
+    { "list", CommandId::List }, { "ls", CommandId::List },
+    { "find", CommandId::Find }, { "play-find", CommandId::PlayFind },
+    { "goto", CommandId::Goto }, { "remove", CommandId::Remove }, { "move", CommandId::Move },
+    { "insert", CommandId::Insert }, { "clear", CommandId::Clear }, { "memory", CommandId::Memory },
+    { "prefetch", CommandId::Prefetch },
+    { "status", CommandId::Status }, { "st", CommandId::Status },
+    { "diag", CommandId::Diag }, { "stats", CommandId::Stats },
+    { "help", CommandId::Help }, { "h", CommandId::Help },
+    { "quit", CommandId::Quit }, { "q", CommandId::Quit }, { "exit", CommandId::Quit },
+};
+
+constexpr uint32_t kCommandMultiplier = 0x5AB4D721u;
+constexpr unsigned kCommandSlotBits = 7;
+
+constexpr uint32_t commandHash(std::string_view name) {
+    uint32_t h = 0x811C9DC5u;
+    for (char c : name) h = (h ^ static_cast<unsigned char>(c)) * 0x01000193u;
+    return h;
+}
+
+constexpr uint32_t commandSlot(std::string_view name) {
+    return (commandHash(name) * kCommandMultiplier) >> (32 - kCommandSlotBits);
+}
+
+using CommandTable = std::array<CommandName, size_t(1) << kCommandSlotBits>;
+
+constexpr CommandTable buildCommandTable() {
+    CommandTable table{};
+    for (const auto& command : kCommands) table[commandSlot(command.name)] = command;
+    return table;
+}
+
+constexpr bool commandTableIsPerfect() {
+    CommandTable table = buildCommandTable();
+    for (const auto& command : kCommands) {
+        const CommandName& slot = table[commandSlot(command.name)];
+        if (slot.name != command.name || slot.id != command.id) return false;
+    }
+    return true;
+}
+
+static_assert(commandTableIsPerfect(), "command hash has collisions; pick another multiplier");
+
+constexpr CommandTable kCommandTable = buildCommandTable();
+
+// 数字参数：与 std::stof / std::stoul 一样接受前缀数字，无法解析时抛出 invalid_argument
+template <typename T>
+T parseNumber(std::string_view text) {
+    T value{};
+    const char* begin = text.data();
+    if (!text.empty() && *begin == '+') begin++;
+    auto result = std::from_chars(begin, text.data() + text.size(), value);
+    if (result.ec != std::errc()) {
+        throw std::invalid_argument("invalid number: " + std::string(text));
+    }
+    return value;
+}
+
+} // namespace CommandDetail
+
+// 按命令名查找编号（区分大小写），不是已知命令时返回 Unknown
+inline CommandId findCommand(std::string_view name) {
+    const CommandDetail::CommandName& slot = CommandDetail::kCommandTable[CommandDetail::commandSlot(name)];
+    return slot.name == name ? slot.id : CommandId::Unknown;
+}
+
+// load -r <目录> [-j 线程数]：扫描与合并分开执行，扫描期间调用方可以不持播放器锁
+struct RecursiveLoad {
+    static constexpr size_t kMaxThreads = 256;
+
+    std::string dirPath;
+    size_t threads = 0;  // 0：使用播放器共用的线程池
+};
+
+inline bool isRecursiveLoad(const CommandArgs& args) {
+    return args.size() > 2 && findCommand(args[0]) == CommandId::Load && args[1] == "-r";
+}
+
+// 解析 load -r 的参数；线程数不是 1-kMaxThreads 的整数时输出用法并返回 false
+inline bool parseRecursiveLoad(const CommandArgs& args, RecursiveLoad& load, std::ostream& out) {
+    size_t end = args.size();
+    load.threads = 0;
+    if (end > 4 && args[end - 2] == "-j") {
+        std::string_view text = args[end - 1];
+        const char* last = text.data() + text.size();
+        auto result = std::from_chars(text.data(), last, load.threads);
+        if (result.ec != std::errc() || result.ptr != last || load.threads < 1 ||
+            load.threads > RecursiveLoad::kMaxThreads) {
+            out << "Invalid thread count: " << text << " (usage: load -r <dir> [-j 1-"
+                << RecursiveLoad::kMaxThreads << "])\n";
+            return false;
+        }
+        end -= 2;
+    }
+    load.dirPath = std::string(args.span(2, end));
+    return true;
+}
+
+// 扫描目录，不访问播放器。指定 -j 时使用独立线程池，否则使用 sharedPool
+inline ScanResult scanRecursiveLoad(WorkStealingPool& sharedPool, const RecursiveLoad& load, bool fileStats) {
+    std::unique_ptr<WorkStealingPool> ownPool;
+    if (load.threads > 0) {
+        ownPool = std::make_unique<WorkStealingPool>(load.threads);
+    }
+    LibraryScanner scanner(ownPool ? *ownPool : sharedPool);
+    ScanOptions scanOptions;
+    scanOptions.fileStats = fileStats;
+    return scanner.scan(load.dirPath, scanOptions);
+}
+
+// 把扫描结果加入播放列表与曲库并报告；调用方持有播放器锁
+inline void mergeRecursiveLoad(MusicPlayer& player, const RecursiveLoad& load, const ScanResult& result,
+                               std::ostream& out) {
+    player.getPlaylist().addTracks(result.paths());
+    if (player.hasLibrary()) {
+        player.getLibrary().addScan(load.dirPath, result);
+    }
+    const ScanStats& stats = result.stats;
+    out << "Loaded " << stats.tracks << " tracks from " << load.dirPath
+        << " (" << stats.directories << " directories, "
+        << stats.entries << " files in " << stats.seconds << "s, "
+        << static_cast<uint64_t>(stats.entriesPerSecond()) << " files/s, "
+        << stats.threads << " threads)";
+    if (stats.skippedLoops > 0) {
+        out << ", skipped " << stats.skippedLoops << " repeated directories";
+    }
+    if (stats.rejected > 0) {
+        out << ", skipped " << stats.rejected << " files that are not audio";
+    }
+    if (stats.errors > 0) {
+        out << ", " << stats.errors << " unreadable";
+    }
+    out << '\n';
+}
+
+// 定位后显示目标附近 ±10 秒的单行波形预览（波形缓存尚未构建时不显示）
+inline void printSeekPreview(MusicPlayer& player, float target, std::ostream& out) {
+    auto pyramid = player.getCurrentWaveform();
+    if (!pyramid) return;
+    out << player.renderWaveformStrip(*pyramid, target - 10.0, target + 10.0, target, 60) << '\n';
+}
+
+// 执行一条命令，输出写入 out。不逐行刷新：交互时读取输入前 cin 会刷新 cout，
+// 批处理时输出整块写出
+inline void processCommand(MusicPlayer& player, const CommandArgs& args,
+                           std::ostream& out = std::cout) {
+    using CommandDetail::parseNumber;
+    if (args.empty()) return;
+
+    std::string_view cmd = args[0];
+    CommandId command = findCommand(cmd);
+
+    switch (command) {
+    case CommandId::Play:
+        player.play();
+        out << "Playing...\n";
+        return;
+    case CommandId::Pause:
+        player.pause();
+        out << "Paused\n";
+        return;
+    case CommandId::Stop:
+        player.stop();
+        out << "Stopped\n";
+        return;
+    case CommandId::Next:
+        player.next();
+        out << "Next track\n";
+        return;
+    case CommandId::Prev:
+        player.previous();
+        out << "Previous track\n";
+        return;
+    case CommandId::Seek: {
+        if (args.size() < 2) break;
+        float seconds = parseNumber<float>(args[1]);
+        player.seek(seconds);
+        out << "Seeking to " << seconds << "s\n";
+        printSeekPreview(player, seconds, out);
+        return;
+    }
+    case CommandId::Forward: {
+        float target = player.getCurrentTime() + 10.0f;
+        player.seekForward();
+        out << "Fast forward 10s\n";
+        if (target < player.getDuration()) printSeekPreview(player, target, out);
+        return;
+    }
+    case CommandId::Rewind: {
+        float target = std::max(0.0f, player.getCurrentTime() - 10.0f);
+        player.seekBackward();
+        out << "Rewind 10s\n";
+        printSeekPreview(player, target, out);
+        return;
+    }
+    case CommandId::Volume: {
+        if (args.size() < 2) break;
+        float vol = parseNumber<float>(args[1]);
+        player.setVolume(vol);
+        out << "Volume set to " << vol << "%\n";
+        return;
+    }
+    case CommandId::VolumeUp:
+        player.volumeUp();
+        out << "Volume: " << player.getVolume() << "%\n";
+        return;
+    case CommandId::VolumeDown:
+        player.volumeDown();
+        out << "Volume: " << player.getVolume() << "%\n";
+        return;
+    case CommandId::Loop:
+        player.toggleLoopMode();
+        out << "Loop mode: ";
+        switch (player.getLoopMode()) {
+            case LoopMode::None: out << "Off"; break;
+            case LoopMode::Single: out << "Single"; break;
+            case LoopMode::All: out << "All"; break;
+        }
+        out << '\n';
+        return;
+    case CommandId::Shuffle:
+        player.toggleShuffle();
+        out << "Shuffle: " << (player.getPlaylist().isShuffleEnabled() ? "On" : "Off") << '\n';
+        return;
+    case CommandId::Gapless: {
+        player.toggleGapless();
+        out << "Gapless: " << (player.isGapless() ? "On" : "Off");
+        int64_t gap = player.getLastGapSamples();
+        out << " (last track boundary gap: ";
+        if (gap >= 0) {
+            out << gap << " samples)\n";
+        } else {
+            out << "n/a)\n";
+        }
+        return;
+    }
+    case CommandId::Crossfade: {
+        if (args.size() > 1) {
+            float seconds = parseNumber<float>(args[1]);
+            // inf、nan 与超出范围的时长不改变当前设置
+            if (!(seconds >= 0.0f && seconds <= kMaxCrossfadeSeconds)) {
+                out << "Usage: xfade <seconds> (0-" << kMaxCrossfadeSeconds << ", 0 = off)\n";
+                return;
+            }
+            if (!player.setCrossfade(seconds)) {
+                out << "Crossfade is not supported by this audio backend\n";
+                return;
+            }
+        }
+        float seconds = player.getCrossfade();
+        if (seconds > 0.0f) {
+            out << "Crossfade: " << std::fixed << std::setprecision(1) << seconds << "s";
+            if (player.getLoopMode() == LoopMode::Single) {
+                out << " (inactive while repeating a single track)";
+            }
+            out << '\n';
+        } else {
+            out << "Crossfade: Off\n";
+        }
+        return;
+    }
+    case CommandId::Normalize: {
+        bool enabled = args.size() > 1 ? args[1] == "on" : !player.isNormalize();
+        if (!player.setNormalize(enabled)) {
+            out << "Track gain is not supported by this audio backend\n";
+            return;
+        }
+        out << "Normalize: " << (player.isNormalize() ? "On" : "Off") << " (target "
+            << std::fixed << std::setprecision(1) << MusicPlayer::kTargetLoudness << " LUFS, peak "
+            << MusicPlayer::kPeakCeiling << " dBTP)" << std::defaultfloat << '\n';
+        return;
+    }
+    case CommandId::Analyze: {
+        // analyze：开始或继续分析，分析进行中时显示进度；analyze stop：中止
+        if (args.size() > 1 && args[1] == "stop") {
+            player.stopAnalysis();
+        } else if (!player.getAnalysisProgress().running && player.startAnalysis() == 0) {
+            out << "All tracks have been analyzed\n";
+        }
+        LoudnessScanProgress progress = player.getAnalysisProgress();
+        out << "Loudness analysis: " << (progress.running ? "running" : "stopped") << " | "
+            << progress.analyzed << " analyzed, " << progress.failed << " unmeasurable, "
+            << progress.remaining() << " remaining | " << std::fixed << std::setprecision(1)
+            << progress.seconds << "s, " << progress.tracksPerMinute() << " tracks/min, "
+            << (progress.seconds > 0.0 ? progress.audioSeconds / progress.seconds : 0.0)
+            << "x realtime" << std::defaultfloat << '\n';
+        return;
+    }
+    case CommandId::Wave: {
+        if (args.size() > 1 && (args[1] == "build" || args[1] == "stop")) {
+            // wave build：为整个播放列表构建波形缓存，进行中时显示进度；wave stop：中止
+            if (args[1] == "stop") {
+                player.stopWaveformBuild();
+            } else if (!player.getWaveformProgress().running && player.startWaveformBuild() == 0) {
+                out << "Playlist is empty\n";
+                return;
+            }
+            WaveformScanProgress progress = player.getWaveformProgress();
+            out << "Waveform cache: " << (progress.running ? "building" : "stopped") << " | "
+                << progress.built << " built, " << progress.cached << " up to date, "
+                << progress.failed << " unreadable, " << progress.remaining() << " remaining | "
+                << std::fixed << std::setprecision(1) << progress.seconds << "s" << std::defaultfloat
+                << " | " << player.getWaveformCache().directory() << '\n';
+            return;
+        }
+        // wave：整首曲目；wave <秒>：该位置附近 20 秒（定位预览）
+        auto pyramid = player.getCurrentWaveform();
+        if (!pyramid) {
+            out << (player.getPlaylist().getCurrentTrack()
+                        ? "Waveform is being built, try again in a moment"
+                        : "No track selected") << '\n';
+            return;
+        }
+        double position = player.getCurrentTime();
+        double from = 0.0;
+        double to = pyramid->seconds();
+        if (args.size() > 1) {
+            position = parseNumber<double>(args[1]);
+            from = position - 10.0;
+            to = position + 10.0;
+        }
+        out << player.renderWaveform(*pyramid, from, to, position, 72, 9);
+        return;
+    }
+    case CommandId::Add: {
+        if (args.size() < 2) break;
+        // 文件路径取到行尾（可能包含空格）
+        std::string filepath(args.rest(1));
+        player.getPlaylist().addTrack(filepath);
+        out << "Added: " << filepath << '\n';
+        return;
+    }
+    case CommandId::Load: {
+        if (isRecursiveLoad(args)) {
+            RecursiveLoad load;
+            if (!parseRecursiveLoad(args, load, out)) return;
+            ScanResult result = scanRecursiveLoad(player.getWorkerPool(), load, player.hasLibrary());
+            mergeRecursiveLoad(player, load, result, out);
+            return;
+        }
+        if (args.size() < 2) break;
+        std::string dirPath(args.rest(1));
+        int count = player.getPlaylist().loadFromDirectory(dirPath);
+        out << "Loaded " << count << " tracks from " << dirPath << '\n';
+        return;
+    }
+    case CommandId::Index:
+        if (!player.hasLibrary()) {
+            out << "No library index (start with --library <file>)\n";
+        } else if (args.size() > 1 && args[1] == "save") {
+            out << (player.saveLibrary() ? "Library index saved to " : "Failed to save ")
+                << player.getLibraryPath() << '\n';
+        } else {
+            Library& library = player.getLibrary();
+            out << "Library: " << player.getLibraryPath() << " | "
+                << library.trackCount() << " tracks in "
+                << library.directoryCount() << " directories\n";
+        }
+        return;
+    case CommandId::List: {
+        // list：当前曲目附近一页；list <编号> [行数]：从指定曲目开始；list all：整个列表
+        const size_t kPageRows = 20;
+        if (args.size() > 1 && args[1] == "all") {
+            out << player.getPlaylistPage(0, player.getPlaylist().size());
+        } else if (args.size() > 1) {
+            size_t start = parseNumber<size_t>(args[1]);
+            size_t rows = args.size() > 2 ? parseNumber<size_t>(args[2]) : kPageRows;
+            out << player.getPlaylistPage(start > 0 ? start - 1 : 0, rows);
+        } else {
+            out << player.getPlaylistPageAroundCurrent(kPageRows);
+        }
+        return;
+    }
+    case CommandId::Find:
+    case CommandId::PlayFind: {
+        if (args.size() < 2) break;
+        std::string query(args.rest(1));
+        if (command == CommandId::Find) {
+            out << player.getSearchString(query);
+        } else {
+            size_t index = 0;
+            if (player.playFind(query, index)) {
+                out << "Playing track " << (index + 1) << ": " << player.getPlaylist().getTrack(index)->title()
+                    << '\n';
+            } else {
+                out << "No track matches: " << query << '\n';
+            }
+        }
+        return;
+    }
+    case CommandId::Goto: {
+        if (args.size() < 2) break;
+        size_t index = parseNumber<size_t>(args[1]) - 1;
+        if (player.jumpTo(index)) {
+            out << "Jumping to track " << (index + 1) << '\n';
+        } else {
+            out << "Invalid track number\n";
+        }
+        return;
+    }
+    case CommandId::Remove: {
+        if (args.size() < 2) break;
+        // 编号从 1 开始；0 减一后回绕为无效位置
+        size_t index = parseNumber<size_t>(args[1]) - 1;
+        if (player.getPlaylist().removeTrack(index)) {
+            out << "Removed track " << (index + 1) << '\n';
+        } else {
+            out << "Invalid track number\n";
+        }
+        return;
+    }
+    case CommandId::Move: {
+        if (args.size() < 3) break;
+        size_t from = parseNumber<size_t>(args[1]) - 1;
+        size_t to = parseNumber<size_t>(args[2]) - 1;
+        if (player.getPlaylist().moveTrack(from, to)) {
+            out << "Moved track " << (from + 1) << " to " << (to + 1) << '\n';
+        } else {
+            out << "Invalid track number\n";
+        }
+        return;
+    }
+    case CommandId::Insert: {
+        if (args.size() < 3) break;
+        size_t index = parseNumber<size_t>(args[1]) - 1;
+        std::string filepath(args.rest(2));
+        if (player.getPlaylist().insertTrack(index, filepath)) {
+            out << "Inserted at " << (index + 1) << ": " << filepath << '\n';
+        } else {
+            out << "Invalid track number\n";
+        }
+        return;
+    }
+    case CommandId::Clear:
+        player.getPlaylist().clear();
+        player.stop();
+        out << "Playlist cleared\n";
+        return;
+    case CommandId::Memory: {
+        const Playlist& playlist = player.getPlaylist();
+        TrackStoreMemory mem = playlist.memoryUsage();
+        out << std::fixed << std::setprecision(1)
+            << "Tracks: " << mem.tracks << " | directories: " << playlist.getTrackStore().directoryCount()
+            << " | artists: " << playlist.getTrackStore().artistCount() << "\n"
+            << "Columns: " << mem.columns / 1024.0 << " KiB | strings: " << mem.strings / 1024.0
+            << " KiB | directory table: " << mem.directories / 1024.0
+            << " KiB | artist table: " << mem.artists / 1024.0 << " KiB\n"
+            << "Search index: " << playlist.searchMemoryUsage() / 1024.0 << " KiB\n"
+            << "Total: " << mem.total() / 1024.0 << " KiB (" << mem.bytesPerTrack() << " bytes/track)"
+            << std::defaultfloat << '\n';
+        return;
+    }
+    case CommandId::Prefetch: {
+        std::string_view mode = args.size() > 1 ? args[1] : std::string_view();
+        if (!mode.empty()) {
+            PrefetchConfig config = player.getPrefetchConfig();
+            config.lookahead = mode == "off" ? 0 : parseNumber<size_t>(mode);
+            player.setPrefetch(config);
+        }
+        const Prefetcher* prefetcher = player.getPrefetcher();
+        if (!prefetcher) {
+            out << "Prefetch: Off\n";
+        } else {
+            out << prefetcher->formatStats();
+        }
+        return;
+    }
+    case CommandId::Status:
+        out << "\n" << player.getStatusString() << "\n\n";
+        return;
+    case CommandId::Diag: {
+        std::string diag = player.getDiagnostics();
+        out << (diag.empty() ? "No diagnostics for this backend" : diag) << '\n';
+        return;
+    }
+    case CommandId::Stats: {
+        std::string_view mode = args.size() > 1 ? args[1] : std::string_view();
+        if (mode == "reset") {
+            Stats::Registry::instance().reset();
+            out << "Statistics reset\n";
+        } else if (mode == "json") {
+            out << Stats::snapshotJson(Stats::Registry::instance().snapshot()) << '\n';
+        } else if (mode.empty()) {
+            out << Stats::formatSnapshot(Stats::Registry::instance().snapshot());
+        } else {
+            out << "Usage: stats [json|reset]\n";
+        }
+        return;
+    }
+    case CommandId::Help:
+        printHelp(out);
+        return;
+    case CommandId::Quit:
+        player.quit();
+        out << "Goodbye!\n";
+        return;
+    case CommandId::Unknown:
+        break;
+    }
+    // 未知命令，或已知命令缺少必需的参数
+    out << "Unknown command: " << cmd << ". Type 'help' for commands.\n";
+}
+
+// 拆分并执行一行命令
+inline void processCommandLine(MusicPlayer& player, std::string_view line, std::ostream& out = std::cout) {
+    processCommand(player, tokenizeCommand(line), out);
+}
+
+// 调用方通过 lock 持有播放器锁时执行命令。load -r 的扫描在大型曲库上可能持续数分钟，
+// 扫描期间释放锁，事件循环照常自动切歌；合并结果前重新加锁。返回时 lock 总是持有锁
+inline void processCommand(MusicPlayer& player, const CommandArgs& args,
+                           std::unique_lock<std::mutex>& lock, std::ostream& out = std::cout) {
+    if (!isRecursiveLoad(args)) {
+        processCommand(player, args, out);
+        return;
+    }
+    RecursiveLoad load;
+    if (!parseRecursiveLoad(args, load, out)) return;
+    WorkStealingPool& pool = player.getWorkerPool();
+    bool fileStats = player.hasLibrary();
+    ScanResult result;
+    {
+        struct Relock {
+            std::unique_lock<std::mutex>& lock;
+            ~Relock() { lock.lock(); }
+        };
+        lock.unlock();
+        Relock relock{ lock };
+        result = scanRecursiveLoad(pool, load, fileStats);
+    }
+    mergeRecursiveLoad(player, load, result, out);
+}
+
+} // namespace MusicApp
+
+#endif // COMMAND_PROCESSOR_H
@@ -0,0 +1,665 @@
+#ifndef CONTROL_SERVER_H
+#define CONTROL_SERVER_H
+
+#include "CommandProcessor.h"
+#include "Instrumentation.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace MusicApp {
+
+// 把流输出追加到 std::string：命令输出直接写入客户端的发送缓冲
+class StringAppendBuffer : public std::streambuf {
+public:
+    void setTarget(std::string* target) { target_ = target; }
+
+protected:
+    int overflow(int c) override {
+        if (c != traits_type::eof()) target_->push_back(static_cast<char>(c));
+        return c;
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        target_->append(s, static_cast<size_t>(n));
+        return n;
+    }
+
+private:
+    std::string* target_ = nullptr;
+};
+
+// 推送给订阅者的播放器状态
+// 当前曲目按编号与播放列表版本识别：插入、移动只改变位置，不算切换曲目
+struct PlayerSnapshot {
+    uint32_t trackId = UINT32_MAX;  // 没有当前曲目时为 UINT32_MAX
+    uint64_t revision = 0;
+    int position = -1;              // 当前曲目在播放顺序中的位置，只用于显示
+    PlayState state = PlayState::Stopped;
+    int volume = 0;
+    LoopMode loop = LoopMode::None;
+    bool shuffle = false;
+};
+
+inline PlayerSnapshot takePlayerSnapshot(const MusicPlayer& player) {
+    PlayerSnapshot snap;
+    const Playlist& playlist = player.getPlaylist();
+    TrackView track = playlist.getCurrentTrack();
+    snap.trackId = track ? track.id() : UINT32_MAX;
+    snap.revision = playlist.getRevision();
+    snap.position = playlist.getCurrentIndex();
+    snap.state = player.getState();
+    snap.volume = static_cast<int>(std::lround(player.getVolume()));
+    snap.loop = player.getLoopMode();
+    snap.shuffle = player.getPlaylist().isShuffleEnabled();
+    return snap;
+}
+
+// 与上一份快照不同的字段，每项一行 "! <名称> <值>"；previous 为空时输出全部字段
+inline void appendStateEvents(const MusicPlayer& player, const PlayerSnapshot* previous,
+                              const PlayerSnapshot& current, std::string& out) {
+    if (!previous || previous->trackId != current.trackId || previous->revision != current.revision) {
+        out += "! track ";
+        out += std::to_string(current.position + 1);
+        TrackView track = player.getPlaylist().getCurrentTrack();
+        if (track) {
+            out += ' ';
+            out += track->title();
+        }
+        out += '\n';
+    }
+    if (!previous || previous->state != current.state) {
+        out += "! state ";
+        out += current.state == PlayState::Playing ? "playing" : current.state == PlayState::Paused ? "paused" : "stopped";
+        out += '\n';
+    }
+    if (!previous || previous->volume != current.volume) {
+        out += "! volume ";
+        out += std::to_string(current.volume);
+        out += '\n';
+    }
+    if (!previous || previous->loop != current.loop) {
+        out += "! loop ";
+        out += current.loop == LoopMode::All ? "all" : current.loop == LoopMode::Single ? "single" : "off";
+        out += '\n';
+    }
+    if (!previous || previous->shuffle != current.shuffle) {
+        out += current.shuffle ? "! shuffle on\n" : "! shuffle off\n";
+    }
+}
+
+// 本地控制服务：Unix 域套接字 + epoll 事件循环，单线程服务任意多个客户端。
+// 协议按行：每行一条命令（与控制台相同），每条命令恰好一个响应，响应以单独一行 "." 结束，
+// 以 "." 开头的输出行前再加一个 "."；可以不等响应连续发送多条命令。
+// 服务自身处理的命令：subscribe / unsubscribe 订阅状态变化（"! " 开头的事件行，只出现在响应之间），
+// quit 关闭本连接，shutdown 退出播放器。load -r 的目录扫描在单独的线程中进行，不阻塞事件循环；
+// 扫描期间该客户端后续的命令等待，响应顺序不变，其他客户端照常服务
+class ControlServer {
+public:
+    static constexpr size_t kMaxLine = 64 * 1024;               // 单行上限，超出时断开
+    static constexpr size_t kHighWater = 1024 * 1024;           // 待发送超过此值时暂停读取该客户端
+    static constexpr size_t kCommandsPerTurn = 16;              // 每个客户端每次持锁最多执行的命令数，保证各客户端轮流
+    static constexpr int kEventPollMs = 100;                    // 有订阅者时检查状态变化的间隔
+
+    ControlServer(MusicPlayer& player, std::mutex& playerMutex)
+        : player_(player), playerMutex_(playerMutex) {
+        stream_.rdbuf(&buffer_);
+    }
+
+    ~ControlServer() { stop(); }
+
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+#ifdef __linux__
+    // 在 path 上监听；已有残留的套接字文件且无人监听时先删除
+    bool start(const std::string& path) {
+        stop();
+        error_.clear();
+        sockaddr_un addr{};
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            error_ = "socket path is empty or too long";
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+        listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd_ < 0) return fail("socket");
+        if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            if (errno != EADDRINUSE || !removeStaleSocket(addr)) return fail("bind");
+            if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) return fail("bind");
+        }
+        if (::listen(listenFd_, SOMAXCONN) < 0) return fail("listen");
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        shutdownFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd_ < 0 || wakeFd_ < 0 || shutdownFd_ < 0) return fail("epoll");
+        watch(listenFd_, EPOLLIN, EPOLL_CTL_ADD);
+        watch(wakeFd_, EPOLLIN, EPOLL_CTL_ADD);
+
+        path_ = path;
+        shutdownRequested_ = false;
+        running_ = true;
+        thread_ = std::thread(&ControlServer::run, this);
+        return true;
+    }
+
+    void stop() {
+        if (running_.exchange(false)) {
+            uint64_t one = 1;
+            (void)!::write(wakeFd_, &one, sizeof(one));
+            thread_.join();
+            joinScans();
+            ::unlink(path_.c_str());
+            { std::lock_guard<std::mutex> lock(shutdownMutex_); }
+            shutdownCv_.notify_all();
+        }
+        closeAll();
+    }
+
+    // 等待控制台输入；客户端请求 shutdown 时返回 false。
+    // 先检查 cin 已缓冲的数据，避免缓冲区中还有整行时阻塞在 poll 上
+    bool waitForConsoleInput() const {
+        if (std::cin.rdbuf()->in_avail() > 0) return true;
+        pollfd fds[2] = { { STDIN_FILENO, POLLIN, 0 }, { shutdownFd_, POLLIN, 0 } };
+        while (::poll(fds, 2, -1) < 0) {
+            if (errno != EINTR) return true;
+        }
+        return !(fds[1].revents & POLLIN);
+    }
+#else
+    bool start(const std::string&) {
+        error_ = "the control server is only available on Linux";
+        return false;
+    }
+
+    void stop() {}
+
+    bool waitForConsoleInput() const { return true; }
+#endif
+
+    // 阻塞到有客户端请求 shutdown 或服务停止（控制台输入关闭后继续服务时使用）
+    void waitForShutdown() {
+        std::unique_lock<std::mutex> lock(shutdownMutex_);
+        shutdownCv_.wait(lock, [this]() { return shutdownRequested_ || !running_; });
+    }
+
+    bool isRunning() const { return running_; }
+    const std::string& path() const { return path_; }
+    const std::string& lastError() const { return error_; }
+    size_t clientCount() const { return clientCount_.load(std::memory_order_relaxed); }
+    uint64_t commandCount() const { return commands_.load(std::memory_order_relaxed); }
+
+private:
+#ifdef __linux__
+    struct Client {
+        int fd = -1;
+        uint64_t id = 0;            // 连接编号，不随文件描述符复用
+        std::string input;
+        std::string output;
+        size_t sent = 0;            // output 中已发送的字节数
+        bool subscribed = false;
+        bool readClosed = false;    // 对端已关闭写方向：处理完已收到的命令后断开
+        bool closeAfterFlush = false;
+        bool scanning = false;      // load -r 正在后台扫描：响应完成前不执行后续命令
+        uint32_t events = 0;        // 当前注册的 epoll 事件
+
+        size_t pending() const { return output.size() - sent; }
+    };
+
+    // 一条 load -r 的后台扫描；完成后由事件循环加锁合并并发出响应
+    struct ScanJob {
+        uint64_t client = 0;
+        RecursiveLoad load;
+        ScanResult result;
+        std::string error;
+        std::thread thread;
+    };
+
+    bool fail(const char* what) {
+        error_ = std::string(what) + ": " + std::strerror(errno);
+        closeAll();
+        return false;
+    }
+
+    // 套接字文件存在但连接被拒绝：上一次运行残留，删除后重试
+    static bool removeStaleSocket(const sockaddr_un& addr) {
+        struct stat st;
+        if (::stat(addr.sun_path, &st) != 0 || !S_ISSOCK(st.st_mode)) return false;
+        int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (probe < 0) return false;
+        bool live = ::connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+        ::close(probe);
+        return !live && ::unlink(addr.sun_path) == 0;
+    }
+
+    void watch(int fd, uint32_t events, int op) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        ::epoll_ctl(epollFd_, op, fd, &ev);
+    }
+
+    void closeAll() {
+        for (auto& entry : clients_) ::close(entry.first);
+        clients_.clear();
+        ready_.clear();
+        subscribers_ = 0;
+        clientCount_ = 0;
+        for (int* fd : { &listenFd_, &epollFd_, &wakeFd_, &shutdownFd_ }) {
+            if (*fd >= 0) ::close(*fd);
+            *fd = -1;
+        }
+    }
+
+    void run() {
+        MUSICAPP_STATS_THREAD();
+        std::vector<epoll_event> events(256);
+        while (running_) {
+            // 还有未执行完的命令时不等待；有订阅者时定期检查状态变化
+            int timeout = !ready_.empty() ? 0 : subscribers_ > 0 ? kEventPollMs : -1;
+            int n = ::epoll_wait(epollFd_, events.data(), static_cast<int>(events.size()), timeout);
+            if (n < 0 && errno != EINTR) break;
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+                if (fd == wakeFd_) {
+                    uint64_t count;
+                    (void)!::read(wakeFd_, &count, sizeof(count));
+                    continue;
+                }
+                if (fd == listenFd_) {
+                    acceptClients();
+                    continue;
+                }
+                auto it = clients_.find(fd);
+                if (it == clients_.end()) continue;
+                Client& client = *it->second;
+                if (events[i].events & (EPOLLERR | EPOLLHUP) && !(events[i].events & EPOLLIN)) {
+                    closeClient(client);
+                    continue;
+                }
+                if ((events[i].events & EPOLLOUT) && !flush(client)) continue;
+                if (events[i].events & EPOLLIN) readClient(client);
+            }
+            finishScans();
+            serveReady();
+            // 没有命令时也要发现自动切歌等变化
+            if (subscribers_ > 0 &&
+                std::chrono::steady_clock::now() - lastPublish_ >= std::chrono::milliseconds(kEventPollMs)) {
+                std::lock_guard<std::mutex> lock(playerMutex_);
+                publishChanges();
+            }
+        }
+    }
+
+    void acceptClients() {
+        while (true) {
+            int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                return;     // EAGAIN，或文件描述符耗尽时等下一次
+            }
+            auto client = std::make_unique<Client>();
+            client->fd = fd;
+            client->id = ++lastClientId_;
+            client->events = EPOLLIN;
+            watch(fd, EPOLLIN, EPOLL_CTL_ADD);
+            clients_.emplace(fd, std::move(client));
+            clientCount_ = clients_.size();
+        }
+    }
+
+    // 读取可用数据（每次至多 64 KB，避免单个客户端占满一轮），有完整的行时加入待执行队列
+    void readClient(Client& client) {
+        char buf[16384];
+        for (int round = 0; round < 4; round++) {
+            ssize_t got = ::read(client.fd, buf, sizeof(buf));
+            if (got > 0) {
+                client.input.append(buf, static_cast<size_t>(got));
+                if (static_cast<size_t>(got) < sizeof(buf)) break;
+                continue;
+            }
+            if (got < 0 && errno == EINTR) continue;
+            if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (got < 0) {
+                closeClient(client);
+                return;
+            }
+            // 对端关闭写方向：最后一行可能没有换行
+            client.readClosed = true;
+            if (!client.input.empty() && client.input.back() != '\n') client.input += '\n';
+            break;
+        }
+        if (client.input.find('\n') != std::string::npos) {
+            markReady(client);
+        } else if (client.input.size() > kMaxLine) {
+            closeClient(client);
+            return;
+        }
+        updateEvents(client);
+        if (client.readClosed && client.input.empty()) finish(client);
+    }
+
+    void markReady(Client& client) {
+        if (client.scanning) return;
+        if (std::find(ready_.begin(), ready_.end(), client.fd) == ready_.end()) ready_.push_back(client.fd);
+    }
+
+    // 轮流为有完整命令的客户端执行至多 kCommandsPerTurn 条。每个客户端单独持播放器锁，
+    // 执行完立即发出响应，排在后面的客户端不会让前面的响应等待，控制台也不会被整轮挡住
+    void serveReady() {
+        if (ready_.empty()) return;
+        std::vector<int> turn;
+        turn.swap(ready_);
+        for (int fd : turn) {
+            auto it = clients_.find(fd);
+            if (it == clients_.end()) continue;
+            Client& client = *it->second;
+            size_t start = 0;
+            {
+                std::lock_guard<std::mutex> lock(playerMutex_);
+                size_t executed = 0;
+                size_t end;
+                while (executed < kCommandsPerTurn && client.pending() < kHighWater &&
+                       !client.closeAfterFlush && !client.scanning &&
+                       (end = client.input.find('\n', start)) != std::string::npos) {
+                    execute(client, std::string_view(client.input).substr(start, end - start));
+                    start = end + 1;
+                    executed++;
+                }
+            }
+            client.input.erase(0, start);
+            if (client.closeAfterFlush) {
+                client.input.clear();
+            } else if (client.input.find('\n') != std::string::npos) {
+                // 积压的响应过多时等发送缓冲排空后再继续（由 flush 重新加入队列），扫描中的等扫描完成
+                if (client.pending() < kHighWater && !client.scanning) ready_.push_back(fd);
+            } else if (client.input.size() > kMaxLine) {
+                client.closeAfterFlush = true;
+            }
+            finish(client);
+        }
+        if (subscribers_ > 0) {
+            std::lock_guard<std::mutex> lock(playerMutex_);
+            publishChanges();
+        }
+    }
+
+    // 执行一行并追加完整的响应（load -r 的响应在扫描完成后追加）；调用方持有播放器锁
+    void execute(Client& client, std::string_view line) {
+        MUSICAPP_PROBE(ControlCommand);
+        commands_.fetch_add(1, std::memory_order_relaxed);
+        std::string& out = client.output;
+        size_t begin = out.size();
+        CommandArgs args = tokenizeCommand(line);
+        if (args.empty()) {
+            // 空行也有响应，保持请求与响应一一对应
+        } else if (args[0] == "subscribe" || args[0] == "unsubscribe") {
+            bool subscribe = args[0] == "subscribe";
+            if (subscribe != client.subscribed) {
+                client.subscribed = subscribe;
+                subscribers_ += subscribe ? 1 : -1;
+            }
+            out += subscribe ? "Subscribed to state events\n" : "Unsubscribed\n";
+            if (subscribe) {
+                if (subscribers_ == 1) last_ = takePlayerSnapshot(player_);
+                appendStateEvents(player_, nullptr, last_, out);
+            }
+        } else if (findCommand(args[0]) == CommandId::Quit) {
+            out += "Goodbye!\n";
+            client.closeAfterFlush = true;
+        } else if (args[0] == "shutdown") {
+            player_.quit();
+            out += "Goodbye!\n";
+            requestShutdown();
+        } else if (isRecursiveLoad(args)) {
+            buffer_.setTarget(&out);
+            auto job = std::make_unique<ScanJob>();
+            if (parseRecursiveLoad(args, job->load, stream_)) {
+                startScan(client, std::move(job));
+                return;
+            }
+        } else {
+            buffer_.setTarget(&out);
+            try {
+                processCommand(player_, args, stream_);
+            } catch (const std::exception& e) {
+                out += "Error: ";
+                out += e.what();
+                out += '\n';
+            }
+            stream_.clear();
+            if (!player_.isRunning()) requestShutdown();
+        }
+        endResponse(out, begin);
+    }
+
+    // 以 "." 开头的行前加 "."，单独一行 "." 表示响应结束；begin 为本条响应在 out 中的起点
+    static void endResponse(std::string& out, size_t begin) {
+        for (size_t pos = begin; pos < out.size();) {
+            if (out[pos] == '.') out.insert(pos++, 1, '.');
+            pos = out.find('\n', pos);
+            if (pos == std::string::npos) break;
+            pos++;
+        }
+        if (out.size() > begin && out.back() != '\n') out += '\n';
+        out += ".\n";
+    }
+
+    // 在新线程中扫描；调用方持有播放器锁（取线程池与是否需要文件信息）
+    void startScan(Client& client, std::unique_ptr<ScanJob> job) {
+        client.scanning = true;
+        job->client = client.id;
+        WorkStealingPool& pool = player_.getWorkerPool();
+        bool fileStats = player_.hasLibrary();
+        ScanJob* raw = job.get();
+        scans_.push_back(std::move(job));
+        raw->thread = std::thread([this, raw, &pool, fileStats]() {
+            MUSICAPP_STATS_THREAD();
+            try {
+                raw->result = scanRecursiveLoad(pool, raw->load, fileStats);
+            } catch (const std::exception& e) {
+                raw->error = e.what();
+            }
+            {
+                std::lock_guard<std::mutex> lock(scanMutex_);
+                finishedScans_.push_back(raw);
+            }
+            uint64_t one = 1;
+            (void)!::write(wakeFd_, &one, sizeof(one));
+        });
+    }
+
+    // 合并已完成的扫描并发出响应；发起的客户端已断开时仍然合并（命令已被接受）
+    void finishScans() {
+        std::vector<ScanJob*> finished;
+        {
+            std::lock_guard<std::mutex> lock(scanMutex_);
+            finished.swap(finishedScans_);
+        }
+        for (ScanJob* job : finished) {
+            job->thread.join();
+            Client* client = nullptr;
+            for (auto& entry : clients_) {
+                if (entry.second->id == job->client) client = entry.second.get();
+            }
+            std::string discarded;
+            std::string& out = client ? client->output : discarded;
+            size_t begin = out.size();
+            {
+                std::lock_guard<std::mutex> lock(playerMutex_);
+                if (job->error.empty()) {
+                    buffer_.setTarget(&out);
+                    mergeRecursiveLoad(player_, job->load, job->result, stream_);
+                    stream_.clear();
+                } else {
+                    out += "Error: " + job->error + "\n";
+                }
+            }
+            endResponse(out, begin);
+            scans_.erase(std::find_if(scans_.begin(), scans_.end(),
+                                      [job](const std::unique_ptr<ScanJob>& j) { return j.get() == job; }));
+            if (!client) continue;
+            client->scanning = false;
+            if (client->input.find('\n') != std::string::npos) markReady(*client);
+            finish(*client);
+        }
+    }
+
+    // 停止时等待仍在进行的扫描（结果不再合并）
+    void joinScans() {
+        for (auto& job : scans_) job->thread.join();
+        scans_.clear();
+        finishedScans_.clear();
+    }
+
+    void requestShutdown() {
+        {
+            std::lock_guard<std::mutex> lock(shutdownMutex_);
+            shutdownRequested_ = true;
+        }
+        shutdownCv_.notify_all();
+        uint64_t one = 1;
+        (void)!::write(shutdownFd_, &one, sizeof(one));
+    }
+
+    // 状态有变化时推送给所有订阅者；调用方持有播放器锁
+    void publishChanges() {
+        if (subscribers_ == 0) return;
+        lastPublish_ = std::chrono::steady_clock::now();
+        PlayerSnapshot current = takePlayerSnapshot(player_);
+        std::string events;
+        appendStateEvents(player_, &last_, current, events);
+        last_ = current;
+        if (events.empty()) return;
+        std::vector<int> subscribed;
+        for (auto& entry : clients_) {
+            if (entry.second->subscribed) subscribed.push_back(entry.first);
+        }
+        for (int fd : subscribed) {
+            auto it = clients_.find(fd);
+            if (it == clients_.end()) continue;
+            Client& client = *it->second;
+            client.output += events;
+            // 长期不读取的订阅者断开，避免发送缓冲无限增长
+            if (client.pending() > 8 * kHighWater) {
+                closeClient(client);
+            } else {
+                flush(client);
+            }
+        }
+    }
+
+    // 发送缓冲排空后关闭需要关闭的连接
+    void finish(Client& client) {
+        if (!flush(client)) return;
+        if (client.pending() == 0 && !client.scanning &&
+            (client.closeAfterFlush || (client.readClosed && client.input.empty()))) {
+            closeClient(client);
+        }
+    }
+
+    // 尽量写出待发送数据；写不完时等待 EPOLLOUT。连接出错并已关闭时返回 false
+    bool flush(Client& client) {
+        while (client.pending() > 0) {
+            ssize_t n = ::send(client.fd, client.output.data() + client.sent, client.pending(), MSG_NOSIGNAL);
+            if (n > 0) {
+                client.sent += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            closeClient(client);
+            return false;
+        }
+        if (client.pending() == 0) {
+            client.output.clear();
+            client.sent = 0;
+            // 因积压暂停的客户端：缓冲排空后继续执行剩下的命令
+            if (!client.closeAfterFlush && client.input.find('\n') != std::string::npos) markReady(client);
+        }
+        updateEvents(client);
+        return true;
+    }
+
+    // 有待发送数据时等待可写；输入或输出积压超过上限时暂停读取，形成背压
+    void updateEvents(Client& client) {
+        uint32_t events = client.pending() > 0 ? static_cast<uint32_t>(EPOLLOUT) : 0u;
+        if (!client.readClosed && !client.closeAfterFlush &&
+            client.pending() < kHighWater && client.input.size() < kHighWater) {
+            events |= EPOLLIN;
+        }
+        if (events == client.events) return;
+        client.events = events;
+        watch(client.fd, events, EPOLL_CTL_MOD);
+    }
+
+    void closeClient(Client& client) {
+        int fd = client.fd;
+        if (client.subscribed) subscribers_--;
+        ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        ready_.erase(std::remove(ready_.begin(), ready_.end(), fd), ready_.end());
+        clients_.erase(fd);
+        clientCount_ = clients_.size();
+    }
+
+    int listenFd_ = -1;
+    int epollFd_ = -1;
+    int wakeFd_ = -1;
+    int shutdownFd_ = -1;
+    std::unordered_map<int, std::unique_ptr<Client>> clients_;
+    std::vector<int> ready_;        // 输入中还有完整命令的客户端
+    uint64_t lastClientId_ = 0;
+    std::vector<std::unique_ptr<ScanJob>> scans_;   // 进行中与待合并的扫描，只由事件循环访问
+    std::mutex scanMutex_;
+    std::vector<ScanJob*> finishedScans_;           // 已完成、待事件循环合并的扫描
+    size_t subscribers_ = 0;
+    PlayerSnapshot last_;
+    std::chrono::steady_clock::time_point lastPublish_;
+#endif
+
+    MusicPlayer& player_;
+    std::mutex& playerMutex_;
+    StringAppendBuffer buffer_;
+    std::ostream stream_{nullptr};
+    std::string path_;
+    std::string error_;
+    std::atomic<bool> running_{false};
+    std::atomic<size_t> clientCount_{0};
+    std::atomic<uint64_t> commands_{0};
+    std::thread thread_;
+    std::mutex shutdownMutex_;
+    std::condition_variable shutdownCv_;
+    bool shutdownRequested_ = false;
+};
+
+} // namespace MusicApp
+
+#endif // CONTROL_SERVER_H
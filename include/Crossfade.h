@@ -0,0 +1,189 @@
+#ifndef CROSSFADE_H
+#define CROSSFADE_H
+
+#include "Simd.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace MusicApp {
+
+// 等功率交叉淡变内核
+// 第 f 帧的进度 t = t0 + step * f（截断到 [0, 1]），淡入增益为 sin(πt/2)，淡出增益为 cos(πt/2) = sin(π(1-t)/2)，
+// 两者平方和恒为 1，不相关的两首曲目叠加时响度不下陷。sin 用奇次多项式在向量中逐样本求值（误差约 4e-6），
+// 淡入的样本原地改写为混合结果：incoming[i] = incoming[i] * sin(πt/2) + outgoing[i] * cos(πt/2) * outgoingScale，
+// outgoingScale 补偿两首曲目增益的差异（相同时为 1）
+namespace CrossfadeKernels {
+
+using MixFn = void (*)(float* incoming, const float* outgoing, size_t frames, uint16_t channels,
+                       float t0, float step, float outgoingScale);
+
+// sin(πx/2) 的泰勒多项式，x ∈ [0, 1]
+constexpr float kC1 = 1.5707963268f;
+constexpr float kC3 = -0.6459640975f;
+constexpr float kC5 = 0.0796926262f;
+constexpr float kC7 = -0.0046817541f;
+constexpr float kC9 = 0.0001604411f;
+
+inline float equalPowerGain(float x) {
+    x = std::min(1.0f, std::max(0.0f, x));
+    float x2 = x * x;
+    return x * (kC1 + x2 * (kC3 + x2 * (kC5 + x2 * (kC7 + x2 * kC9))));
+}
+
+inline void mixScalar(float* incoming, const float* outgoing, size_t frames, uint16_t channels,
+                      float t0, float step, float outgoingScale) {
+    for (size_t f = 0; f < frames; f++) {
+        float t = t0 + step * static_cast<float>(f);
+        float gIn = equalPowerGain(t);
+        float gOut = equalPowerGain(1.0f - t) * outgoingScale;
+        for (uint16_t c = 0; c < channels; c++) {
+            size_t i = f * channels + c;
+            incoming[i] = incoming[i] * gIn + outgoing[i] * gOut;
+        }
+    }
+}
+
+#if defined(MUSICAPP_X86)
+inline __m128 equalPowerGainSse2(__m128 x) {
+    x = _mm_min_ps(_mm_set1_ps(1.0f), _mm_max_ps(_mm_setzero_ps(), x));
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_add_ps(_mm_set1_ps(kC7), _mm_mul_ps(x2, _mm_set1_ps(kC9)));
+    p = _mm_add_ps(_mm_set1_ps(kC5), _mm_mul_ps(x2, p));
+    p = _mm_add_ps(_mm_set1_ps(kC3), _mm_mul_ps(x2, p));
+    p = _mm_add_ps(_mm_set1_ps(kC1), _mm_mul_ps(x2, p));
+    return _mm_mul_ps(x, p);
+}
+
+inline void mixSse2(float* incoming, const float* outgoing, size_t frames, uint16_t channels,
+                    float t0, float step, float outgoingScale) {
+    // 向量宽度必须是声道数的整数倍，否则回退到标量
+    if (channels == 0 || 4 % channels != 0) {
+        mixScalar(incoming, outgoing, frames, channels, t0, step, outgoingScale);
+        return;
+    }
+    const size_t framesPerVec = 4 / channels;
+    __m128 offsets = _mm_setr_ps(0.0f, static_cast<float>(1 / channels),
+                                 static_cast<float>(2 / channels),
+                                 static_cast<float>(3 / channels));
+    __m128 vstep = _mm_set1_ps(step);
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 scale = _mm_set1_ps(outgoingScale);
+    size_t f = 0;
+    for (; f + framesPerVec <= frames; f += framesPerVec) {
+        __m128 base = _mm_set1_ps(static_cast<float>(f));
+        __m128 t = _mm_add_ps(_mm_set1_ps(t0), _mm_mul_ps(vstep, _mm_add_ps(base, offsets)));
+        __m128 gIn = equalPowerGainSse2(t);
+        __m128 gOut = _mm_mul_ps(equalPowerGainSse2(_mm_sub_ps(one, t)), scale);
+        float* p = incoming + f * channels;
+        const float* q = outgoing + f * channels;
+        _mm_storeu_ps(p, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(p), gIn), _mm_mul_ps(_mm_loadu_ps(q), gOut)));
+    }
+    mixScalar(incoming + f * channels, outgoing + f * channels, frames - f, channels,
+              t0 + step * static_cast<float>(f), step, outgoingScale);
+}
+
+MUSICAPP_TARGET_AVX2
+inline __m256 equalPowerGainAvx2(__m256 x) {
+    x = _mm256_min_ps(_mm256_set1_ps(1.0f), _mm256_max_ps(_mm256_setzero_ps(), x));
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_fmadd_ps(x2, _mm256_set1_ps(kC9), _mm256_set1_ps(kC7));
+    p = _mm256_fmadd_ps(x2, p, _mm256_set1_ps(kC5));
+    p = _mm256_fmadd_ps(x2, p, _mm256_set1_ps(kC3));
+    p = _mm256_fmadd_ps(x2, p, _mm256_set1_ps(kC1));
+    return _mm256_mul_ps(x, p);
+}
+
+MUSICAPP_TARGET_AVX2
+inline void mixAvx2(float* incoming, const float* outgoing, size_t frames, uint16_t channels,
+                    float t0, float step, float outgoingScale) {
+    if (channels == 0 || 8 % channels != 0) {
+        mixScalar(incoming, outgoing, frames, channels, t0, step, outgoingScale);
+        return;
+    }
+    const size_t framesPerVec = 8 / channels;
+    __m256 offsets = _mm256_setr_ps(0.0f, static_cast<float>(1 / channels),
+                                    static_cast<float>(2 / channels),
+                                    static_cast<float>(3 / channels),
+                                    static_cast<float>(4 / channels),
+                                    static_cast<float>(5 / channels),
+                                    static_cast<float>(6 / channels),
+                                    static_cast<float>(7 / channels));
+    __m256 vstep = _mm256_set1_ps(step);
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 scale = _mm256_set1_ps(outgoingScale);
+    size_t f = 0;
+    for (; f + framesPerVec <= frames; f += framesPerVec) {
+        __m256 base = _mm256_set1_ps(static_cast<float>(f));
+        __m256 t = _mm256_fmadd_ps(vstep, _mm256_add_ps(base, offsets), _mm256_set1_ps(t0));
+        __m256 gIn = equalPowerGainAvx2(t);
+        __m256 gOut = _mm256_mul_ps(equalPowerGainAvx2(_mm256_sub_ps(one, t)), scale);
+        float* p = incoming + f * channels;
+        const float* q = outgoing + f * channels;
+        _mm256_storeu_ps(p, _mm256_fmadd_ps(_mm256_loadu_ps(p), gIn,
+                                            _mm256_mul_ps(_mm256_loadu_ps(q), gOut)));
+    }
+    mixScalar(incoming + f * channels, outgoing + f * channels, frames - f, channels,
+              t0 + step * static_cast<float>(f), step, outgoingScale);
+}
+#endif
+
+#if defined(MUSICAPP_NEON)
+inline float32x4_t equalPowerGainNeon(float32x4_t x) {
+    x = vminq_f32(vdupq_n_f32(1.0f), vmaxq_f32(vdupq_n_f32(0.0f), x));
+    float32x4_t x2 = vmulq_f32(x, x);
+    float32x4_t p = vfmaq_f32(vdupq_n_f32(kC7), x2, vdupq_n_f32(kC9));
+    p = vfmaq_f32(vdupq_n_f32(kC5), x2, p);
+    p = vfmaq_f32(vdupq_n_f32(kC3), x2, p);
+    p = vfmaq_f32(vdupq_n_f32(kC1), x2, p);
+    return vmulq_f32(x, p);
+}
+
+inline void mixNeon(float* incoming, const float* outgoing, size_t frames, uint16_t channels,
+                    float t0, float step, float outgoingScale) {
+    if (channels == 0 || 4 % channels != 0) {
+        mixScalar(incoming, outgoing, frames, channels, t0, step, outgoingScale);
+        return;
+    }
+    const size_t framesPerVec = 4 / channels;
+    const float offsetValues[4] = { 0.0f, static_cast<float>(1 / channels),
+                                    static_cast<float>(2 / channels),
+                                    static_cast<float>(3 / channels) };
+    float32x4_t offsets = vld1q_f32(offsetValues);
+    float32x4_t one = vdupq_n_f32(1.0f);
+    size_t f = 0;
+    for (; f + framesPerVec <= frames; f += framesPerVec) {
+        float32x4_t base = vdupq_n_f32(static_cast<float>(f));
+        float32x4_t t = vfmaq_f32(vdupq_n_f32(t0), vdupq_n_f32(step), vaddq_f32(base, offsets));
+        float32x4_t gIn = equalPowerGainNeon(t);
+        float32x4_t gOut = vmulq_n_f32(equalPowerGainNeon(vsubq_f32(one, t)), outgoingScale);
+        float* p = incoming + f * channels;
+        const float* q = outgoing + f * channels;
+        vst1q_f32(p, vfmaq_f32(vmulq_f32(vld1q_f32(q), gOut), vld1q_f32(p), gIn));
+    }
+    mixScalar(incoming + f * channels, outgoing + f * channels, frames - f, channels,
+              t0 + step * static_cast<float>(f), step, outgoingScale);
+}
+#endif
+
+// 按指令集级别取内核（不支持的级别回退到标量）
+inline MixFn select(SimdLevel level) {
+    if (!simdLevelSupported(level)) level = SimdLevel::Scalar;
+    switch (level) {
+#if defined(MUSICAPP_X86)
+        case SimdLevel::AVX2: return mixAvx2;
+        case SimdLevel::SSE2: return mixSse2;
+#endif
+#if defined(MUSICAPP_NEON)
+        case SimdLevel::NEON: return mixNeon;
+#endif
+        default: break;
+    }
+    return mixScalar;
+}
+
+} // namespace CrossfadeKernels
+
+} // namespace MusicApp
+
+#endif // CROSSFADE_H
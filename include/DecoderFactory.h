@@ -0,0 +1,85 @@
+#ifndef DECODER_FACTORY_H
+#define DECODER_FACTORY_H
+
+#include "AudioDecoder.h"
+#include "AudioFormat.h"
+#include "FlacDecoder.h"
+#include "LibraryScanner.h"
+#include "MappedWavDecoder.h"
+#include "WavDecoder.h"
+#include <memory>
+#include <string>
+
+namespace MusicApp {
+
+// 文件格式：先查扫描时写入的格式缓存（按大小与修改时间校验），未命中时读取文件头嗅探并写入缓存
+inline AudioFormat probeAudioFormat(const std::string& filepath) {
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    AudioFormat format = AudioFormat::Unknown;
+    if (sourceFileStat(filepath, size, mtimeNs) &&
+        AudioFormatCache::shared().lookup(filepath, size, mtimeNs, format)) {
+        return format;
+    }
+    SniffResult sniffed = sniffAudioFile(filepath);
+    if (sniffed.opened) {
+        AudioFormatCache::shared().store(filepath, sniffed);
+    }
+    return sniffed.format;
+}
+
+// 解码器注册表：每种格式对应一个原生解码器的工厂，没有原生解码器的格式为空
+class DecoderRegistry {
+public:
+    using Factory = std::unique_ptr<AudioDecoder> (*)(const std::string& filepath, WorkStealingPool* pool);
+
+    static Factory find(AudioFormat format) {
+        static const Factory kFactories[static_cast<size_t>(AudioFormat::Count)] = {
+            nullptr,        // Unknown
+            &openWav,       // Wav
+            &openFlac,      // Flac
+            nullptr,        // Mp3
+            nullptr,        // Ogg
+            nullptr,        // Mp4
+            nullptr,        // Wma
+        };
+        size_t index = static_cast<size_t>(format);
+        return index < static_cast<size_t>(AudioFormat::Count) ? kFactories[index] : nullptr;
+    }
+
+    static bool canDecode(AudioFormat format) { return find(format) != nullptr; }
+
+private:
+    // 优先使用内存映射的零拷贝读取
+    static std::unique_ptr<AudioDecoder> openWav(const std::string& filepath, WorkStealingPool*) {
+        auto mapped = std::make_unique<MappedWavDecoder>();
+        if (mapped->open(filepath)) {
+            return mapped;
+        }
+        auto wav = std::make_unique<WavDecoder>();
+        if (wav->open(filepath)) {
+            return wav;
+        }
+        return nullptr;
+    }
+
+    static std::unique_ptr<AudioDecoder> openFlac(const std::string& filepath, WorkStealingPool* pool) {
+        auto flac = std::make_unique<FlacDecoder>();
+        flac->setParallel(pool);
+        if (flac->open(filepath)) {
+            return flac;
+        }
+        return nullptr;
+    }
+};
+
+// 根据文件内容选择解码器并打开；播放引擎与响度分析共用。
+// 离线任务传入线程池时，FLAC 按帧并行解码
+inline std::unique_ptr<AudioDecoder> openAudioDecoder(const std::string& filepath, WorkStealingPool* pool = nullptr) {
+    DecoderRegistry::Factory factory = DecoderRegistry::find(probeAudioFormat(filepath));
+    return factory ? factory(filepath, pool) : nullptr;
+}
+
+} // namespace MusicApp
+
+#endif // DECODER_FACTORY_H
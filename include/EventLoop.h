@@ -0,0 +1,71 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include "EventWake.h"
+#include "MusicPlayer.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace MusicApp {
+
+// 播放器事件循环
+// 独立于控制台输入，保证无人输入时也能自动切歌。推送事件的后端在结束、切换与错误事件入队时唤醒循环，
+// 其余时间循环阻塞等待（只为后台任务与预载同步设超时）；不能唤醒的后端按其轮询间隔调用 update
+class PlayerEventLoop {
+public:
+    // mutex 用于与命令处理线程串行访问 MusicPlayer
+    PlayerEventLoop(MusicPlayer& player, std::mutex& mutex)
+        : player_(player), mutex_(mutex), running_(false) {}
+
+    ~PlayerEventLoop() {
+        stop();
+    }
+
+    void start() {
+        if (running_) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wake_ = player_.getEventWake();
+        }
+        running_ = true;
+        thread_ = std::thread(&PlayerEventLoop::run, this);
+    }
+
+    void stop() {
+        running_ = false;
+        if (wake_) wake_->notify();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+private:
+    void run() {
+        MUSICAPP_STATS_THREAD();
+        while (running_) {
+            float interval;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                player_.update();
+                interval = player_.getUpdateInterval();
+            }
+            if (wake_) {
+                wake_->wait(std::chrono::duration<float>(interval));
+            } else {
+                std::this_thread::sleep_for(std::chrono::duration<float>(interval));
+            }
+        }
+    }
+
+    MusicPlayer& player_;
+    std::mutex& mutex_;
+    EventWake* wake_ = nullptr;     // 归后端所有
+    std::atomic<bool> running_;
+    std::thread thread_;
+};
+
+} // namespace MusicApp
+
+#endif // EVENT_LOOP_H
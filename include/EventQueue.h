@@ -0,0 +1,62 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include "RingBuffer.h"
+#include <atomic>
+#include <cstdint>
+
+namespace MusicApp {
+
+// 后端事件类型
+enum class PlayerEventType : uint8_t {
+    EndOfStream,    // 当前曲目播放结束
+    TrackChanged,   // 已无缝切换到预载曲目
+    Error,          // 解码或输出错误
+    Position        // 播放位置更新
+};
+
+// 后端错误码
+enum class PlayerError : int32_t {
+    None = 0,
+    SinkOpenFailed,     // 输出端打开失败
+    DecodeFailed        // 解码中途失败（文件截断或读取错误）
+};
+
+// 后端事件（可平凡复制，可直接放入无锁队列）
+struct PlayerEvent {
+    PlayerEventType type = PlayerEventType::Position;
+    PlayerError error = PlayerError::None;
+    float position = 0.0f;  // 秒
+};
+
+// 有界无等待事件队列（单生产者单消费者）
+// 生产者为音频线程：push 只做一次原子发布，满时丢弃事件并计数
+class PlayerEventQueue {
+public:
+    explicit PlayerEventQueue(size_t capacity = 256) : ring_(capacity) {}
+
+    bool push(const PlayerEvent& event) {
+        if (ring_.write(&event, 1) == 1) return true;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bool pop(PlayerEvent& event) {
+        return ring_.read(&event, 1) == 1;
+    }
+
+    // 剩余可写入的事件数（生产者可据此丢弃低优先级事件）
+    size_t freeSlots() const { return ring_.writeAvailable(); }
+
+    uint64_t getDroppedCount() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    SpscRingBuffer<PlayerEvent> ring_;
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace MusicApp
+
+#endif // EVENT_QUEUE_H
@@ -0,0 +1,103 @@
+#ifndef EVENT_WAKE_H
+#define EVENT_WAKE_H
+
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#endif
+
+namespace MusicApp {
+
+// 事件唤醒：生产者（渲染线程、解码线程）notify 只做一次不阻塞的系统调用，不加锁、不分配内存；
+// 消费者 wait 阻塞到被唤醒或超时。Linux 上为 eventfd，其他 POSIX 平台为非阻塞管道，Windows 上为自动复位事件。
+// 创建失败时 notify 不起作用，wait 退化为按超时睡眠
+class EventWake {
+public:
+    EventWake() {
+#ifdef _WIN32
+        event_ = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+#elif defined(__linux__)
+        readFd_ = writeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#else
+        int fds[2];
+        if (::pipe(fds) == 0) {
+            for (int fd : fds) {
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+            readFd_ = fds[0];
+            writeFd_ = fds[1];
+        }
+#endif
+    }
+
+    ~EventWake() {
+#ifdef _WIN32
+        if (event_) CloseHandle(event_);
+#else
+        if (readFd_ >= 0) ::close(readFd_);
+        if (writeFd_ >= 0 && writeFd_ != readFd_) ::close(writeFd_);
+#endif
+    }
+
+    EventWake(const EventWake&) = delete;
+    EventWake& operator=(const EventWake&) = delete;
+
+    // 可在任意线程调用；尚未被消费的多次唤醒合并为一次
+    void notify() {
+#ifdef _WIN32
+        if (event_) SetEvent(event_);
+#elif defined(__linux__)
+        uint64_t one = 1;
+        if (writeFd_ >= 0) (void)!::write(writeFd_, &one, sizeof(one));
+#else
+        char one = 1;
+        if (writeFd_ >= 0) (void)!::write(writeFd_, &one, 1);   // 管道已满时已有未消费的唤醒
+#endif
+    }
+
+    // 阻塞到被唤醒或超时；被唤醒时返回 true 并清除唤醒状态
+    bool wait(std::chrono::duration<double> timeout) {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count();
+#ifdef _WIN32
+        if (!event_) {
+            std::this_thread::sleep_for(timeout);
+            return false;
+        }
+        return WaitForSingleObject(event_, static_cast<DWORD>(ms)) == WAIT_OBJECT_0;
+#else
+        if (readFd_ < 0) {
+            std::this_thread::sleep_for(timeout);
+            return false;
+        }
+        pollfd fd = { readFd_, POLLIN, 0 };
+        int ready = ::poll(&fd, 1, static_cast<int>(ms));
+        if (ready <= 0) return false;   // 超时，或被信号打断时当作超时
+        char drain[64];
+        while (::read(readFd_, drain, sizeof(drain)) > 0) {}
+        return true;
+#endif
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE event_ = nullptr;
+#else
+    int readFd_ = -1;
+    int writeFd_ = -1;
+#endif
+};
+
+} // namespace MusicApp
+
+#endif // EVENT_WAKE_H
@@ -0,0 +1,961 @@
+#ifndef FLAC_DECODER_H
+#define FLAC_DECODER_H
+
+#include "AudioDecoder.h"
+#include "MappedFile.h"
+#include "Md5.h"
+#include "SeekIndex.h"
+#include "Simd.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace MusicApp {
+
+// STREAMINFO 中的流参数
+struct FlacStreamInfo {
+    uint32_t minBlockSize = 0;
+    uint32_t maxBlockSize = 0;
+    uint32_t sampleRate = 0;
+    uint16_t channels = 0;
+    uint32_t bitsPerSample = 0;
+    uint64_t totalFrames = 0;           // 0 表示未知
+    unsigned char md5[16] = {};         // 未编码样本的 MD5，全 0 表示编码器未计算
+};
+
+// 解析 data 开头（可带 ID3v2 标签）的 "fLaC" 与元数据块，dataStart 为第一帧的偏移
+inline bool parseFlacStreamInfo(const unsigned char* data, uint64_t size, FlacStreamInfo& info, uint64_t& dataStart) {
+    uint64_t pos = Metadata::id3v2Size(data, static_cast<size_t>(std::min<uint64_t>(size, 1 << 16)));
+    if (pos + 8 > size || std::memcmp(data + pos, "fLaC", 4) != 0) return false;
+    pos += 4;
+    bool haveInfo = false;
+    while (true) {
+        if (pos + 4 > size) return false;
+        const unsigned char* h = data + pos;
+        bool last = (h[0] & 0x80) != 0;
+        uint32_t len = (h[1] << 16) | (h[2] << 8) | h[3];
+        if (pos + 4 + len > size) return false;
+        if ((h[0] & 0x7F) == 0 && len >= 34) {
+            // 块长各 16 位，帧长各 24 位，采样率 20 位，声道数 - 1 为 3 位，位深 - 1 为 5 位，总采样数 36 位
+            const unsigned char* b = h + 4;
+            info.minBlockSize = (b[0] << 8) | b[1];
+            info.maxBlockSize = (b[2] << 8) | b[3];
+            info.sampleRate = (b[10] << 12) | (b[11] << 4) | (b[12] >> 4);
+            info.channels = static_cast<uint16_t>(((b[12] >> 1) & 7) + 1);
+            info.bitsPerSample = (((b[12] & 1) << 4) | (b[13] >> 4)) + 1;
+            info.totalFrames = (static_cast<uint64_t>(b[13] & 0x0F) << 32) | Metadata::readBE32(b + 14);
+            std::memcpy(info.md5, b + 18, 16);
+            haveInfo = true;
+        }
+        pos += 4 + len;
+        if (last) break;
+    }
+    dataStart = pos;
+    return haveInfo && info.sampleRate > 0 && info.minBlockSize >= 16 && info.maxBlockSize >= info.minBlockSize &&
+           info.bitsPerSample >= 4 && info.bitsPerSample <= 24;
+}
+
+// 帧数据的位读取器：64 位缓存高位对齐，一次补足 7 字节；越过末尾后按 0 补齐并记录
+class FlacBitReader {
+public:
+    FlacBitReader(const unsigned char* begin, const unsigned char* end) : begin_(begin), p_(begin), end_(end) {
+        refill();
+    }
+
+    uint32_t read(unsigned n) {         // n <= 32
+        if (n == 0) return 0;
+        if (bits_ < 32) refill();
+        uint32_t v = static_cast<uint32_t>(cache_ >> (64 - n));
+        cache_ <<= n;
+        bits_ -= n;
+        return v;
+    }
+
+    int32_t readSigned(unsigned n) {
+        if (n == 0) return 0;
+        uint32_t v = read(n) << (32 - n);
+        return static_cast<int32_t>(v) >> (32 - n);
+    }
+
+    // 一元码：1 之前 0 的个数
+    uint32_t readUnary() {
+        uint32_t count = 0;
+        while (true) {
+            if (bits_ < 32) refill();
+            unsigned zeros = cache_ ? clz64(cache_) : 64;
+            if (zeros < bits_) {
+                cache_ <<= zeros;
+                cache_ <<= 1;
+                bits_ -= zeros + 1;
+                return count + zeros;
+            }
+            count += bits_;
+            cache_ = 0;
+            bits_ = 0;
+            if (pad_ > 64) return count;     // 数据已耗尽
+        }
+    }
+
+    // count 个 Rice 码（参数 k）解码为有符号残差；商与余数都在缓存中时一次 clz 加两次移位。
+    // 缓存状态放在局部变量中：输出为 int32_t，与 unsigned 成员可能别名，否则每个码都要回写成员
+    void readRice(int32_t* out, size_t count, unsigned k) {
+        size_t i = 0;
+        while (i < count) {
+            uint64_t cache = cache_;
+            unsigned bits = bits_;
+            const unsigned char* p = p_;
+            for (; i < count; i++) {
+                if (bits < 56) {
+                    if (end_ - p < 8) break;
+                    uint64_t v = 0;
+                    for (int b = 0; b < 8; b++) v = (v << 8) | p[b];
+                    cache |= v >> bits;
+                    p += (63 - bits) >> 3;
+                    bits |= 56;
+                }
+                unsigned zeros = cache ? clz64(cache) : 64;
+                if (zeros + 1 + k > bits) break;
+                // zeros + 1 + k <= bits <= 63，两次移位都从 cache 出发，依赖链上只有一次移位
+                uint64_t rest = cache << (zeros + 1);
+                uint32_t low = static_cast<uint32_t>((rest >> 1) >> (63 - k));
+                cache <<= zeros + 1 + k;
+                bits -= zeros + 1 + k;
+                uint32_t u = (static_cast<uint32_t>(zeros) << k) | low;
+                out[i] = static_cast<int32_t>(u >> 1) ^ -static_cast<int32_t>(u & 1);
+            }
+            cache_ = cache;
+            bits_ = bits;
+            p_ = p;
+            if (i < count) {
+                // 长的一元码或接近数据末尾：这一个码按慢速路径解码
+                uint32_t high = readUnary();
+                uint32_t u = (high << k) | read(k);
+                out[i++] = static_cast<int32_t>(u >> 1) ^ -static_cast<int32_t>(u & 1);
+            }
+        }
+    }
+
+    void alignToByte() {
+        unsigned drop = static_cast<unsigned>(consumedBits() & 7);
+        if (drop) read(8 - drop);
+    }
+
+    uint64_t consumedBits() const {
+        return static_cast<uint64_t>(p_ - begin_) * 8 + pad_ - bits_;
+    }
+
+    bool overrun() const { return consumedBits() > static_cast<uint64_t>(end_ - begin_) * 8; }
+
+private:
+    static unsigned clz64(uint64_t x) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, x);
+        return 63u - static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_clzll(x));
+#endif
+    }
+
+    // 补足到至少 56 位；调用前 bits_ < 56
+    void refill() {
+        if (end_ - p_ >= 8) {
+            uint64_t v = 0;
+            for (int i = 0; i < 8; i++) v = (v << 8) | p_[i];
+            cache_ |= v >> bits_;
+            p_ += (63 - bits_) >> 3;
+            bits_ |= 56;
+            return;
+        }
+        while (bits_ <= 56) {
+            if (p_ < end_) cache_ |= static_cast<uint64_t>(*p_++) << (56 - bits_);
+            else pad_ += 8;
+            bits_ += 8;
+        }
+    }
+
+    const unsigned char* begin_;
+    const unsigned char* p_;
+    const unsigned char* end_;
+    uint64_t cache_ = 0;
+    unsigned bits_ = 0;
+    uint64_t pad_ = 0;
+};
+
+// 帧尾的 CRC-16（多项式 0x8005，初值 0）。按 8 字节切片查表：table[k][b] 为字节 b 之后再跟 k 个 0 字节的余数，
+// 8 次查表相互独立，不再是逐字节的串行依赖
+inline uint16_t flacCrc16(const unsigned char* p, size_t len) {
+    static const auto table = []() {
+        std::vector<uint16_t> t(8 * 256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t r = i << 8;
+            for (int b = 0; b < 8; b++) r = (r & 0x8000) ? (r << 1) ^ 0x8005 : r << 1;
+            t[i] = static_cast<uint16_t>(r);
+        }
+        for (uint32_t k = 1; k < 8; k++) {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint16_t prev = t[(k - 1) * 256 + i];
+                t[k * 256 + i] = static_cast<uint16_t>((prev << 8) ^ t[prev >> 8]);
+            }
+        }
+        return t;
+    }();
+    const uint16_t* t = table.data();
+    uint16_t crc = 0;
+    for (; len >= 8; p += 8, len -= 8) {
+        uint32_t head = crc ^ ((p[0] << 8) | p[1]);
+        crc = static_cast<uint16_t>(t[7 * 256 + (head >> 8)] ^ t[6 * 256 + (head & 0xFF)] ^ t[5 * 256 + p[2]] ^
+                                    t[4 * 256 + p[3]] ^ t[3 * 256 + p[4]] ^ t[2 * 256 + p[5]] ^ t[256 + p[6]] ^ t[p[7]]);
+    }
+    for (; len > 0; p++, len--) crc = static_cast<uint16_t>((crc << 8) ^ t[(crc >> 8) ^ *p]);
+    return crc;
+}
+
+// LPC 预测恢复内核：out[i] = residual[i] + (Σ coeffs[j] * out[i - 1 - j]) >> shift，i 从 order 起。
+// 调用方保证 32 位累加不会溢出，且 out[order, n) 预先清零。
+// 向量版本每次算 L 个相邻输出：L 路部分和只用到块之前已恢复的样本（块内尚未恢复的位置读到 0），
+// 块内前面样本的贡献（每块 L(L-1)/2 次乘加）随后逐个补上
+namespace FlacKernels {
+
+using LpcFn = void (*)(const int32_t* residual, int32_t* out, size_t n, const int32_t* coeffs, unsigned order,
+                       int shift);
+
+inline void lpcFrom(const int32_t* residual, int32_t* out, size_t begin, size_t n, const int32_t* coeffs,
+                    unsigned order, int shift) {
+    for (size_t i = begin; i < n; i++) {
+        uint32_t sum = 0;
+        for (unsigned j = 0; j < order; j++) {
+            sum += static_cast<uint32_t>(coeffs[j]) * static_cast<uint32_t>(out[i - 1 - j]);
+        }
+        out[i] = residual[i] + (static_cast<int32_t>(sum) >> shift);
+    }
+}
+
+inline void lpcScalar(const int32_t* residual, int32_t* out, size_t n, const int32_t* coeffs, unsigned order,
+                      int shift) {
+    lpcFrom(residual, out, order, n, coeffs, order, shift);
+}
+
+// 向量部分和之后补上块内的依赖并写出 L 个样本。阶数不小于 L 时块内依赖是完整的三角形，
+// 展开后新样本留在寄存器中；最近一个样本的乘加放在最后，串行依赖链只有一次乘加
+template <unsigned L>
+inline void lpcFinishBlock(const int32_t* residual, int32_t* out, size_t i, const int32_t* partial,
+                           const int32_t* coeffs, unsigned order, int shift) {
+    if (order >= L) {
+        int32_t y[L];
+        for (unsigned k = 0; k < L; k++) {
+            uint32_t sum = static_cast<uint32_t>(partial[k]);
+            for (unsigned m = 1; m < k; m++) sum += static_cast<uint32_t>(coeffs[m]) * static_cast<uint32_t>(y[k - 1 - m]);
+            if (k > 0) sum += static_cast<uint32_t>(coeffs[0]) * static_cast<uint32_t>(y[k - 1]);
+            y[k] = residual[i + k] + (static_cast<int32_t>(sum) >> shift);
+        }
+        std::memcpy(out + i, y, sizeof(y));
+        return;
+    }
+    for (unsigned k = 0; k < L; k++) {
+        uint32_t sum = static_cast<uint32_t>(partial[k]);
+        for (unsigned m = 0; m < k && m < order; m++) {
+            sum += static_cast<uint32_t>(coeffs[m]) * static_cast<uint32_t>(out[i + k - 1 - m]);
+        }
+        out[i + k] = residual[i + k] + (static_cast<int32_t>(sum) >> shift);
+    }
+}
+
+#if defined(MUSICAPP_X86)
+// SSE2 没有 32 位乘法取低位，用两次 32x32->64 的无符号乘法拼出（低 32 位与有符号乘法相同）；
+// c 为广播的系数，奇数通道直接取其低 32 位
+inline __m128i mulloBroadcastSse2(__m128i a, __m128i c) {
+    __m128i even = _mm_mul_epu32(a, c);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), c);
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline void lpcSse2(const int32_t* residual, int32_t* out, size_t n, const int32_t* coeffs, unsigned order,
+                    int shift) {
+    size_t i = order;
+    for (; i + 4 <= n; i += 4) {
+        // 两个累加器交替使用，缩短跨系数的依赖链
+        __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+        unsigned j = 0;
+        for (; j + 2 <= order; j += 2) {
+            __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i - 1 - j));
+            __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i - 2 - j));
+            acc0 = _mm_add_epi32(acc0, mulloBroadcastSse2(s0, _mm_set1_epi32(coeffs[j])));
+            acc1 = _mm_add_epi32(acc1, mulloBroadcastSse2(s1, _mm_set1_epi32(coeffs[j + 1])));
+        }
+        if (j < order) {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i - 1 - j));
+            acc0 = _mm_add_epi32(acc0, mulloBroadcastSse2(s, _mm_set1_epi32(coeffs[j])));
+        }
+        alignas(16) int32_t partial[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(partial), _mm_add_epi32(acc0, acc1));
+        lpcFinishBlock<4>(residual, out, i, partial, coeffs, order, shift);
+    }
+    lpcFrom(residual, out, i, n, coeffs, order, shift);
+}
+
+// 块长仍取 4：8 个相邻输出的块内补算是 28 次串行相关的乘加，比向量部分省下的更多（实测慢于 SSE2）。
+// 与 SSE2 版本的区别是直接用 32 位乘法取低位
+MUSICAPP_TARGET_AVX2
+inline void lpcAvx2(const int32_t* residual, int32_t* out, size_t n, const int32_t* coeffs, unsigned order,
+                    int shift) {
+    size_t i = order;
+    for (; i + 4 <= n; i += 4) {
+        __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+        unsigned j = 0;
+        for (; j + 2 <= order; j += 2) {
+            __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i - 1 - j));
+            __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i - 2 - j));
+            acc0 = _mm_add_epi32(acc0, _mm_mullo_epi32(s0, _mm_set1_epi32(coeffs[j])));
+            acc1 = _mm_add_epi32(acc1, _mm_mullo_epi32(s1, _mm_set1_epi32(coeffs[j + 1])));
+        }
+        if (j < order) {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i - 1 - j));
+            acc0 = _mm_add_epi32(acc0, _mm_mullo_epi32(s, _mm_set1_epi32(coeffs[j])));
+        }
+        alignas(16) int32_t partial[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(partial), _mm_add_epi32(acc0, acc1));
+        lpcFinishBlock<4>(residual, out, i, partial, coeffs, order, shift);
+    }
+    lpcFrom(residual, out, i, n, coeffs, order, shift);
+}
+#endif
+
+#if defined(MUSICAPP_NEON)
+inline void lpcNeon(const int32_t* residual, int32_t* out, size_t n, const int32_t* coeffs, unsigned order,
+                    int shift) {
+    size_t i = order;
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t acc = vdupq_n_s32(0);
+        for (unsigned j = 0; j < order; j++) acc = vmlaq_n_s32(acc, vld1q_s32(out + i - 1 - j), coeffs[j]);
+        int32_t partial[4];
+        vst1q_s32(partial, acc);
+        lpcFinishBlock<4>(residual, out, i, partial, coeffs, order, shift);
+    }
+    lpcFrom(residual, out, i, n, coeffs, order, shift);
+}
+#endif
+
+// 高位深或高精度系数时 32 位累加会溢出，改用 64 位
+inline void lpcWideFrom(const int32_t* residual, int32_t* out, size_t begin, size_t n, const int32_t* coeffs,
+                        unsigned order, int shift) {
+    for (size_t i = begin; i < n; i++) {
+        int64_t sum = 0;
+        for (unsigned j = 0; j < order; j++) sum += static_cast<int64_t>(coeffs[j]) * out[i - 1 - j];
+        out[i] = residual[i] + static_cast<int32_t>(sum >> shift);
+    }
+}
+
+inline void lpcWide(const int32_t* residual, int32_t* out, size_t n, const int32_t* coeffs, unsigned order,
+                    int shift) {
+    lpcWideFrom(residual, out, order, n, coeffs, order, shift);
+}
+
+#if defined(MUSICAPP_X86)
+// 64 位累加的向量版本（24 位流）：4 个相邻输出一块，样本符号扩展到 64 位后用有符号 32x32->64 乘法；
+// 与 32 位内核相同，要求 out[order, n) 预先清零
+MUSICAPP_TARGET_AVX2
+inline void lpcWideAvx2(const int32_t* residual, int32_t* out, size_t n, const int32_t* coeffs, unsigned order,
+                        int shift) {
+    size_t i = order;
+    for (; i + 4 <= n; i += 4) {
+        __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+        unsigned j = 0;
+        for (; j + 2 <= order; j += 2) {
+            __m256i s0 = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i - 1 - j)));
+            __m256i s1 = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i - 2 - j)));
+            acc0 = _mm256_add_epi64(acc0, _mm256_mul_epi32(s0, _mm256_set1_epi64x(coeffs[j])));
+            acc1 = _mm256_add_epi64(acc1, _mm256_mul_epi32(s1, _mm256_set1_epi64x(coeffs[j + 1])));
+        }
+        if (j < order) {
+            __m256i s = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i - 1 - j)));
+            acc0 = _mm256_add_epi64(acc0, _mm256_mul_epi32(s, _mm256_set1_epi64x(coeffs[j])));
+        }
+        alignas(32) int64_t partial[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(partial), _mm256_add_epi64(acc0, acc1));
+        for (unsigned k = 0; k < 4; k++) {
+            int64_t sum = partial[k];
+            for (unsigned m = 0; m < k && m < order; m++) sum += static_cast<int64_t>(coeffs[m]) * out[i + k - 1 - m];
+            out[i + k] = residual[i + k] + static_cast<int32_t>(sum >> shift);
+        }
+    }
+    lpcWideFrom(residual, out, i, n, coeffs, order, shift);
+}
+#endif
+
+// 按指令集级别取内核（不支持的级别回退到标量）
+inline LpcFn select(SimdLevel level) {
+    if (!simdLevelSupported(level)) level = SimdLevel::Scalar;
+    switch (level) {
+#if defined(MUSICAPP_X86)
+        case SimdLevel::AVX2: return lpcAvx2;
+        case SimdLevel::SSE2: return lpcSse2;
+#endif
+#if defined(MUSICAPP_NEON)
+        case SimdLevel::NEON: return lpcNeon;
+#endif
+        default: break;
+    }
+    return lpcScalar;
+}
+
+// 64 位累加的内核：只有 AVX2 有向量版本（SSE2 / NEON 缺少合适的 64 位乘法，用标量）
+inline LpcFn selectWide(SimdLevel level) {
+#if defined(MUSICAPP_X86)
+    if (level == SimdLevel::AVX2 && simdLevelSupported(level)) return lpcWideAvx2;
+#endif
+    (void)level;
+    return lpcWide;
+}
+
+} // namespace FlacKernels
+
+// 解码后的一帧，样本按声道分开存放：samples[channel * blockSize + i]
+struct FlacBlock {
+    uint64_t sample = 0;
+    uint32_t blockSize = 0;
+    size_t bytes = 0;                   // 帧在文件中的长度
+    std::vector<int32_t> samples;
+};
+
+// 单帧解码器：解析帧头、各声道子帧与声道去相关，并核对帧尾 CRC-16。
+// 每个实例自带残差缓冲区，不同线程各用一个实例即可并行解码不同的帧
+class FlacFrameDecoder {
+public:
+    explicit FlacFrameDecoder(const FlacStreamInfo& info, SimdLevel level = hostSimdLevel())
+        : info_(info), lpc_(FlacKernels::select(level)), lpcWide_(FlacKernels::selectWide(level)) {}
+
+    // 解码 data 处的一帧（len 为到数据末尾的字节数）；帧头、子帧或 CRC-16 无效时返回 false
+    bool decode(const unsigned char* data, size_t len, FlacBlock& block) {
+        SeekScan::FlacFrameHeader h;
+        if (!SeekScan::parseFlacFrameHeader(data, std::min<size_t>(len, 16), info_.minBlockSize, h)) return false;
+        static const uint32_t kSampleSizes[8] = { 0, 8, 12, 0, 16, 20, 24, 0 };
+        uint32_t bps = h.sampleSizeCode ? kSampleSizes[h.sampleSizeCode] : info_.bitsPerSample;
+        unsigned channels = h.channelAssignment < 8 ? h.channelAssignment + 1u : 2u;
+        if (bps == 0 || bps != info_.bitsPerSample || channels != info_.channels ||
+            (h.sampleRate != 0 && h.sampleRate != info_.sampleRate)) {
+            return false;
+        }
+
+        uint32_t n = h.blockSize;
+        block.sample = h.sample;
+        block.blockSize = n;
+        block.samples.resize(static_cast<size_t>(channels) * n);
+        residual_.resize(n);
+        FlacBitReader bits(data + h.headerBytes, data + len);
+        for (unsigned ch = 0; ch < channels; ch++) {
+            // 侧声道（差值）比原始样本多 1 位
+            bool side = (h.channelAssignment == 8 && ch == 1) || (h.channelAssignment == 9 && ch == 0) ||
+                        (h.channelAssignment == 10 && ch == 1);
+            if (!decodeSubframe(bits, n, bps + (side ? 1 : 0), block.samples.data() + static_cast<size_t>(ch) * n)) {
+                return false;
+            }
+        }
+        bits.alignToByte();
+        if (bits.overrun()) return false;
+        size_t end = h.headerBytes + static_cast<size_t>(bits.consumedBits() / 8);
+        if (end + 2 > len || flacCrc16(data, end) != ((data[end] << 8) | data[end + 1])) return false;
+        block.bytes = end + 2;
+        decorrelate(h.channelAssignment, block.samples.data(), n);
+        return true;
+    }
+
+private:
+    bool decodeSubframe(FlacBitReader& bits, uint32_t n, uint32_t bps, int32_t* out) {
+        if (bits.read(1) != 0) return false;
+        uint32_t type = bits.read(6);
+        uint32_t wasted = 0;
+        if (bits.read(1)) {
+            wasted = bits.readUnary() + 1;
+            if (wasted >= bps) return false;
+            bps -= wasted;
+        }
+
+        if (type == 0) {
+            std::fill(out, out + n, bits.readSigned(bps));
+        } else if (type == 1) {
+            for (uint32_t i = 0; i < n; i++) out[i] = bits.readSigned(bps);
+        } else if (type >= 8 && type <= 12) {
+            unsigned order = type - 8;
+            if (order > n) return false;
+            for (unsigned i = 0; i < order; i++) out[i] = bits.readSigned(bps);
+            if (!decodeResidual(bits, n, order)) return false;
+            restoreFixed(out, n, order);
+        } else if (type >= 32) {
+            unsigned order = type - 31;
+            if (order > n) return false;
+            for (unsigned i = 0; i < order; i++) out[i] = bits.readSigned(bps);
+            unsigned precision = bits.read(4) + 1;
+            int shift = bits.readSigned(5);
+            if (precision == 16 || shift < 0) return false;
+            int32_t coeffs[32];
+            for (unsigned j = 0; j < order; j++) coeffs[j] = bits.readSigned(precision);
+            if (!decodeResidual(bits, n, order)) return false;
+            // |Σ| < order * 2^(bps + precision - 2)，bps + precision + floor(log2(order)) <= 32 时 32 位累加不会溢出
+            unsigned orderBits = 0;
+            while ((2u << orderBits) <= order) orderBits++;
+            std::fill(out + order, out + n, 0);
+            if (bps + precision + orderBits <= 32) {
+                lpc_(residual_.data(), out, n, coeffs, order, shift);
+            } else {
+                lpcWide_(residual_.data(), out, n, coeffs, order, shift);
+            }
+        } else {
+            return false;
+        }
+
+        if (wasted) {
+            for (uint32_t i = 0; i < n; i++) out[i] = static_cast<int32_t>(static_cast<uint32_t>(out[i]) << wasted);
+        }
+        return true;
+    }
+
+    // 残差写入 residual_[order, n)，下标与输出样本对齐
+    bool decodeResidual(FlacBitReader& bits, uint32_t n, unsigned order) {
+        uint32_t method = bits.read(2);
+        if (method > 1) return false;
+        unsigned paramBits = method == 0 ? 4 : 5;
+        uint32_t escape = method == 0 ? 15 : 31;
+        unsigned partitionOrder = bits.read(4);
+        uint32_t perPartition = n >> partitionOrder;
+        if ((perPartition << partitionOrder) != n || perPartition < order) return false;
+
+        int32_t* residual = residual_.data();
+        size_t i = order;
+        for (uint32_t p = 0; p < (1u << partitionOrder); p++) {
+            size_t count = perPartition - (p == 0 ? order : 0);
+            uint32_t k = bits.read(paramBits);
+            if (k == escape) {
+                unsigned raw = bits.read(5);
+                for (size_t c = 0; c < count; c++) residual[i + c] = bits.readSigned(raw);
+            } else {
+                bits.readRice(residual + i, count, k);
+            }
+            i += count;
+        }
+        return !bits.overrun();
+    }
+
+    // 固定多项式预测（0-4 阶），系数为二项式系数
+    void restoreFixed(int32_t* out, uint32_t n, unsigned order) const {
+        const int32_t* r = residual_.data();
+        switch (order) {
+            case 0:
+                std::copy(r, r + n, out);
+                break;
+            case 1:
+                for (uint32_t i = 1; i < n; i++) out[i] = r[i] + out[i - 1];
+                break;
+            case 2:
+                for (uint32_t i = 2; i < n; i++) out[i] = r[i] + 2 * out[i - 1] - out[i - 2];
+                break;
+            case 3:
+                for (uint32_t i = 3; i < n; i++) out[i] = r[i] + 3 * (out[i - 1] - out[i - 2]) + out[i - 3];
+                break;
+            default:
+                for (uint32_t i = 4; i < n; i++) {
+                    out[i] = r[i] + 4 * (out[i - 1] + out[i - 3]) - 6 * out[i - 2] - out[i - 4];
+                }
+                break;
+        }
+    }
+
+    // 左/侧、侧/右、中/侧 还原为左右声道
+    static void decorrelate(uint8_t assignment, int32_t* samples, uint32_t n) {
+        int32_t* a = samples;
+        int32_t* b = samples + n;
+        switch (assignment) {
+            case 8:
+                for (uint32_t i = 0; i < n; i++) b[i] = a[i] - b[i];
+                break;
+            case 9:
+                for (uint32_t i = 0; i < n; i++) a[i] += b[i];
+                break;
+            case 10:
+                for (uint32_t i = 0; i < n; i++) {
+                    int32_t side = b[i];
+                    int32_t mid = static_cast<int32_t>((static_cast<uint32_t>(a[i]) << 1) | (side & 1));
+                    a[i] = (mid + side) >> 1;
+                    b[i] = (mid - side) >> 1;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    FlacStreamInfo info_;
+    FlacKernels::LpcFn lpc_;
+    FlacKernels::LpcFn lpcWide_;
+    std::vector<int32_t> residual_;
+};
+
+// STREAMINFO 的 MD5 核对结果
+enum class FlacMd5Status {
+    Unchecked,      // 尚未解码到流末尾、中途定位过、未开启核对或文件中没有签名
+    Match,
+    Mismatch
+};
+
+// 原生 FLAC 解码器。
+// 播放使用单流模式：每次只解码下一帧，延迟为一帧。
+// 离线任务（分析、转码、建缓存）可用 setParallel() 改为帧并行：帧头自带样本号与 CRC-8，
+// 由消费线程按字节扫描出一批帧的边界，各帧交给线程池独立解码；消费线程自己也领取帧，
+// 只等待已被其他线程领走的帧，嵌套在线程池任务中使用也不会死锁。同时有两批在途，
+// 消费当前批时下一批已在解码
+class FlacDecoder : public AudioDecoder {
+public:
+    static constexpr size_t kFramesPerWorker = 4;
+    static constexpr size_t kMinBatchFrames = 8;
+
+    FlacDecoder() = default;
+    FlacDecoder(const FlacDecoder&) = delete;
+    FlacDecoder& operator=(const FlacDecoder&) = delete;
+
+    ~FlacDecoder() override {
+        dropBatches();
+    }
+
+    bool open(const std::string& filepath) override {
+        dropBatches();
+        seekFile_.reset();
+        file_.close();
+        if (!file_.open(filepath)) return false;
+        FlacStreamInfo info;
+        uint64_t dataStart = 0;
+        if (!parseFlacStreamInfo(file_.data(), file_.size(), info, dataStart)) {
+            file_.close();
+            return false;
+        }
+        info_ = info;
+        path_ = filepath;
+        dataStart_ = dataStart;
+        dataEnd_ = file_.size();
+        if (dataEnd_ >= dataStart_ + 128 && std::memcmp(file_.data() + dataEnd_ - 128, "TAG", 3) == 0) {
+            dataEnd_ -= 128;
+        }
+        variable_ = dataStart_ + 2 <= dataEnd_ && (file_.data()[dataStart_ + 1] & 1) != 0;
+        frames_ = std::make_unique<FlacFrameDecoder>(info_, level_);
+        pos_ = dataStart_;
+        framePos_ = 0;
+        block_.blockSize = 0;
+        blockPos_ = 0;
+        corruptFrames_ = 0;
+        md5_.reset();
+        hashedFrames_ = 0;
+        hashing_ = verifyMd5_;
+        md5Status_ = FlacMd5Status::Unchecked;
+        return true;
+    }
+
+    uint32_t getSampleRate() const override { return info_.sampleRate; }
+    uint16_t getChannels() const override { return info_.channels; }
+    uint64_t getTotalFrames() const override { return info_.totalFrames; }
+    uint64_t tell() const override { return framePos_; }
+
+    uint32_t getBitsPerSample() const { return info_.bitsPerSample; }
+    const FlacStreamInfo& getStreamInfo() const { return info_; }
+    uint64_t getCorruptFrames() const { return corruptFrames_; }
+
+    // 指定 LPC 内核的指令集级别（默认取 CPU 支持的最高级别）；open() 之前调用
+    void setSimdLevel(SimdLevel level) { level_ = level; }
+
+    // 帧并行解码；pool 为 nullptr 时恢复单流模式
+    void setParallel(WorkStealingPool* pool) {
+        dropBatches();
+        pool_ = pool;
+    }
+
+    // 从头顺序解码到末尾时按 STREAMINFO 核对 MD5；open() 之前调用
+    void setVerifyMd5(bool enabled) { verifyMd5_ = enabled; }
+    FlacMd5Status getMd5Status() const { return md5Status_; }
+
+    size_t read(float* out, size_t frames) override {
+        if (!file_.isOpen()) return 0;
+        const size_t channels = info_.channels;
+        const float scale = 1.0f / static_cast<float>(1u << (info_.bitsPerSample - 1));
+        size_t done = 0;
+        while (done < frames) {
+            if (blockPos_ >= block_.blockSize && !nextBlock()) break;
+            size_t n = std::min<size_t>(frames - done, block_.blockSize - blockPos_);
+            for (size_t c = 0; c < channels; c++) {
+                const int32_t* src = block_.samples.data() + c * block_.blockSize + blockPos_;
+                float* dst = out + done * channels + c;
+                for (size_t i = 0; i < n; i++) dst[i * channels] = static_cast<float>(src[i]) * scale;
+            }
+            blockPos_ += static_cast<uint32_t>(n);
+            done += n;
+        }
+        framePos_ += done;
+        return done;
+    }
+
+    // 经 SeekIndex 定位到目标帧所在的帧，解码后丢弃目标之前的样本
+    bool seek(uint64_t frame) override {
+        if (!file_.isOpen()) return false;
+        if (info_.totalFrames > 0) frame = std::min(frame, info_.totalFrames);
+        dropBatches();
+        hashing_ = false;
+        pos_ = dataStart_;
+        uint64_t skip = frame;
+        if (auto index = SeekIndex::get(path_)) {
+            if (!seekFile_) {
+                seekFile_ = std::make_unique<Metadata::SourceFile>();
+                if (!seekFile_->open(path_)) seekFile_.reset();
+            }
+            if (seekFile_) {
+                SeekTarget target = index->locate(*seekFile_, frame);
+                pos_ = target.offset;
+                skip = target.skip;
+            }
+        }
+        block_.blockSize = 0;
+        blockPos_ = 0;
+        framePos_ = frame;
+        while (nextBlock()) {
+            if (skip < block_.blockSize) {
+                blockPos_ = static_cast<uint32_t>(skip);
+                break;
+            }
+            skip -= block_.blockSize;
+        }
+        return true;
+    }
+
+private:
+    // 一批帧：边界由消费线程预先扫描，各帧由领取到它的线程解码
+    struct Batch {
+        const unsigned char* data = nullptr;
+        FlacStreamInfo info;
+        SimdLevel level = SimdLevel::Scalar;
+        std::vector<uint64_t> offsets;      // count + 1 个边界
+        std::vector<FlacBlock> blocks;
+        std::vector<char> ok;
+        size_t count = 0;
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> done{ 0 };
+        std::mutex mutex;
+        std::condition_variable finished;
+
+        // 领取并解码帧，直到本批全部被领走
+        void work() {
+            std::unique_ptr<FlacFrameDecoder> decoder;
+            for (size_t k; (k = next.fetch_add(1)) < count;) {
+                if (!decoder) decoder = std::make_unique<FlacFrameDecoder>(info, level);
+                size_t len = static_cast<size_t>(offsets[k + 1] - offsets[k]);
+                ok[k] = decoder->decode(data + offsets[k], len, blocks[k]) && blocks[k].bytes == len;
+                done.fetch_add(1);
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.notify_all();
+            }
+        }
+
+        // 帮忙解码剩余的帧，再等其他线程手中的帧完成
+        void finish() {
+            work();
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [this]() { return done.load() >= count; });
+        }
+
+        // 不再领取新帧，等待已领走的帧完成（之后不再访问文件映射）
+        void cancel() {
+            size_t claimed = std::min(next.exchange(count), count);
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [this, claimed]() { return done.load() >= claimed; });
+        }
+    };
+
+    bool nextBlock() {
+        bool ok = pool_ ? nextParallelBlock() : decodeSerial();
+        if (!ok) {
+            if (hashing_) finishMd5();
+            return false;
+        }
+        blockPos_ = 0;
+        if (hashing_) hashBlock();
+        return true;
+    }
+
+    bool decodeSerial() {
+        while (pos_ < dataEnd_) {
+            if (frames_->decode(file_.data() + pos_, static_cast<size_t>(dataEnd_ - pos_), block_)) {
+                pos_ += block_.bytes;
+                return true;
+            }
+            // 损坏的帧：跳到下一个有效帧头
+            corruptFrames_++;
+            uint64_t next = 0;
+            pos_ = findFrame(pos_ + 1, kAnySample, next) ? next : dataEnd_;
+        }
+        return false;
+    }
+
+    bool nextParallelBlock() {
+        while (true) {
+            if (current_ && batchIndex_ < current_->count) {
+                size_t k = batchIndex_++;
+                if (!current_->ok[k]) {
+                    // 边界扫描或解码失败：从该帧起按单流方式解码一帧（含失步恢复），下一批从其后开始
+                    pos_ = current_->offsets[k];
+                    dropBatches();
+                    return decodeSerial();
+                }
+                std::swap(block_, current_->blocks[k]);
+                pos_ = current_->offsets[k + 1];
+                return true;
+            }
+            if (current_) spare_ = std::move(current_);
+            if (!ahead_) {
+                if (pos_ >= dataEnd_) return false;
+                ahead_ = launch(pos_);
+            }
+            ahead_->finish();
+            current_ = std::move(ahead_);
+            batchIndex_ = 0;
+            if (current_->count == 0) {
+                current_.reset();
+                return decodeSerial();
+            }
+            uint64_t nextStart = current_->offsets.back();
+            if (nextStart < dataEnd_) ahead_ = launch(nextStart);
+        }
+    }
+
+    std::shared_ptr<Batch> launch(uint64_t offset) {
+        std::shared_ptr<Batch> batch;
+        if (spare_ && spare_.use_count() == 1) batch = std::move(spare_);
+        else batch = std::make_shared<Batch>();
+        spare_.reset();
+        batch->data = file_.data();
+        batch->info = info_;
+        batch->level = level_;
+        batch->offsets.assign(1, offset);
+
+        size_t want = std::max(kMinBatchFrames, kFramesPerWorker * pool_->size());
+        uint64_t pos = offset;
+        while (batch->offsets.size() <= want && pos < dataEnd_) {
+            SeekScan::FlacFrameHeader h;
+            if (!headerAt(pos, h)) break;
+            uint64_t next = 0;
+            if (!findFrame(pos + h.headerBytes, h.sample + h.blockSize, next)) next = dataEnd_;
+            batch->offsets.push_back(next);
+            pos = next;
+        }
+        batch->count = batch->offsets.size() - 1;
+        batch->blocks.resize(batch->count);
+        batch->ok.assign(batch->count, 0);
+        batch->next.store(0);
+        batch->done.store(0);
+        size_t tasks = std::min(batch->count, pool_->size());
+        for (size_t t = 0; t < tasks; t++) pool_->submit([batch]() { batch->work(); });
+        return batch;
+    }
+
+    void dropBatches() {
+        if (current_) current_->cancel();
+        if (ahead_) ahead_->cancel();
+        current_.reset();
+        ahead_.reset();
+        batchIndex_ = 0;
+    }
+
+    static constexpr uint64_t kAnySample = ~0ULL;
+
+    // offset 处是否为与本流一致的帧头（CRC-8、分块方式、块长、采样率与声道数）
+    bool headerAt(uint64_t offset, SeekScan::FlacFrameHeader& h) const {
+        const unsigned char* p = file_.data() + offset;
+        size_t len = static_cast<size_t>(std::min<uint64_t>(16, dataEnd_ - offset));
+        if (!SeekScan::parseFlacFrameHeader(p, len, info_.minBlockSize, h)) return false;
+        unsigned channels = h.channelAssignment < 8 ? h.channelAssignment + 1u : 2u;
+        return ((p[1] & 1) != 0) == variable_ && h.blockSize <= info_.maxBlockSize && channels == info_.channels &&
+               (h.sampleRate == 0 || h.sampleRate == info_.sampleRate);
+    }
+
+    // [from, dataEnd_) 中第一个有效帧头；sample 不为 kAnySample 时还要求其样本号相符
+    bool findFrame(uint64_t from, uint64_t sample, uint64_t& found) const {
+        const unsigned char* data = file_.data();
+        uint64_t pos = from;
+        while (pos + 1 < dataEnd_) {
+            const void* hit = std::memchr(data + pos, 0xFF, static_cast<size_t>(dataEnd_ - pos));
+            if (!hit) return false;
+            pos = static_cast<uint64_t>(static_cast<const unsigned char*>(hit) - data);
+            if (pos + 1 >= dataEnd_) return false;
+            SeekScan::FlacFrameHeader h;
+            if ((data[pos + 1] & 0xFE) == 0xF8 && headerAt(pos, h) && (sample == kAnySample || h.sample == sample)) {
+                found = pos;
+                return true;
+            }
+            pos++;
+        }
+        return false;
+    }
+
+    // 按 STREAMINFO 的约定：交错的小端样本，每个样本 (位深 + 7) / 8 字节
+    void hashBlock() {
+        const size_t channels = info_.channels;
+        const size_t width = (info_.bitsPerSample + 7) / 8;
+        const size_t n = block_.blockSize;
+        md5Bytes_.resize(n * channels * width);
+        unsigned char* dst = md5Bytes_.data();
+        for (size_t i = 0; i < n; i++) {
+            for (size_t c = 0; c < channels; c++) {
+                uint32_t v = static_cast<uint32_t>(block_.samples[c * n + i]);
+                for (size_t b = 0; b < width; b++) *dst++ = static_cast<unsigned char>(v >> (8 * b));
+            }
+        }
+        md5_.update(md5Bytes_.data(), md5Bytes_.size());
+        hashedFrames_ += n;
+    }
+
+    void finishMd5() {
+        hashing_ = false;
+        static const unsigned char kZero[16] = {};
+        if (std::memcmp(info_.md5, kZero, 16) == 0) return;
+        unsigned char digest[16];
+        md5_.finish(digest);
+        bool match = std::memcmp(digest, info_.md5, 16) == 0 &&
+                     (info_.totalFrames == 0 || hashedFrames_ == info_.totalFrames);
+        md5Status_ = match ? FlacMd5Status::Match : FlacMd5Status::Mismatch;
+    }
+
+    MappedFile file_;
+    std::string path_;
+    FlacStreamInfo info_;
+    SimdLevel level_ = hostSimdLevel();
+    std::unique_ptr<FlacFrameDecoder> frames_;
+    std::unique_ptr<Metadata::SourceFile> seekFile_;    // 定位时按需打开
+    uint64_t dataStart_ = 0;
+    uint64_t dataEnd_ = 0;
+    bool variable_ = false;
+
+    uint64_t pos_ = 0;                  // 下一帧的偏移
+    uint64_t framePos_ = 0;
+    FlacBlock block_;
+    uint32_t blockPos_ = 0;
+    uint64_t corruptFrames_ = 0;
+
+    WorkStealingPool* pool_ = nullptr;
+    std::shared_ptr<Batch> current_;
+    std::shared_ptr<Batch> ahead_;
+    std::shared_ptr<Batch> spare_;
+    size_t batchIndex_ = 0;
+
+    bool verifyMd5_ = false;
+    bool hashing_ = false;
+    Md5 md5_;
+    std::vector<unsigned char> md5Bytes_;
+    uint64_t hashedFrames_ = 0;
+    FlacMd5Status md5Status_ = FlacMd5Status::Unchecked;
+};
+
+} // namespace MusicApp
+
+#endif // FLAC_DECODER_H
@@ -0,0 +1,239 @@
+#ifndef GAIN_STAGE_H
+#define GAIN_STAGE_H
+
+#include "Simd.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace MusicApp {
+
+// 增益内核：恒定增益与逐样本线性插值的斜坡增益
+// 斜坡内核中第 f 帧的增益为 g0 + step * f，同一帧的所有声道使用相同增益
+namespace GainKernels {
+
+using ConstantFn = void (*)(float* samples, size_t count, float gain);
+using RampFn = void (*)(float* samples, size_t frames, uint16_t channels, float g0, float step);
+
+inline void constantScalar(float* samples, size_t count, float gain) {
+    for (size_t i = 0; i < count; i++) {
+        samples[i] *= gain;
+    }
+}
+
+inline void rampScalar(float* samples, size_t frames, uint16_t channels, float g0, float step) {
+    for (size_t f = 0; f < frames; f++) {
+        float g = g0 + step * static_cast<float>(f);
+        for (uint16_t c = 0; c < channels; c++) {
+            samples[f * channels + c] *= g;
+        }
+    }
+}
+
+#if defined(MUSICAPP_X86)
+inline void constantSse2(float* samples, size_t count, float gain) {
+    __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), g));
+        _mm_storeu_ps(samples + i + 4, _mm_mul_ps(_mm_loadu_ps(samples + i + 4), g));
+    }
+    constantScalar(samples + i, count - i, gain);
+}
+
+inline void rampSse2(float* samples, size_t frames, uint16_t channels, float g0, float step) {
+    // 向量宽度必须是声道数的整数倍，否则回退到标量
+    if (channels == 0 || 4 % channels != 0) {
+        rampScalar(samples, frames, channels, g0, step);
+        return;
+    }
+    const size_t framesPerVec = 4 / channels;
+    __m128 offsets = _mm_setr_ps(0.0f, static_cast<float>(1 / channels),
+                                 static_cast<float>(2 / channels),
+                                 static_cast<float>(3 / channels));
+    __m128 vstep = _mm_set1_ps(step);
+    size_t f = 0;
+    for (; f + framesPerVec <= frames; f += framesPerVec) {
+        __m128 base = _mm_set1_ps(static_cast<float>(f));
+        __m128 g = _mm_add_ps(_mm_set1_ps(g0), _mm_mul_ps(vstep, _mm_add_ps(base, offsets)));
+        float* p = samples + f * channels;
+        _mm_storeu_ps(p, _mm_mul_ps(_mm_loadu_ps(p), g));
+    }
+    rampScalar(samples + f * channels, frames - f, channels,
+               g0 + step * static_cast<float>(f), step);
+}
+
+MUSICAPP_TARGET_AVX2
+inline void constantAvx2(float* samples, size_t count, float gain) {
+    __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), g));
+        _mm256_storeu_ps(samples + i + 8, _mm256_mul_ps(_mm256_loadu_ps(samples + i + 8), g));
+    }
+    for (; i < count; i++) {
+        samples[i] *= gain;
+    }
+}
+
+MUSICAPP_TARGET_AVX2
+inline void rampAvx2(float* samples, size_t frames, uint16_t channels, float g0, float step) {
+    if (channels == 0 || 8 % channels != 0) {
+        rampScalar(samples, frames, channels, g0, step);
+        return;
+    }
+    const size_t framesPerVec = 8 / channels;
+    alignas(32) float off[8];
+    for (int k = 0; k < 8; k++) {
+        off[k] = static_cast<float>(k / channels);
+    }
+    __m256 offsets = _mm256_load_ps(off);
+    __m256 vstep = _mm256_set1_ps(step);
+    __m256 vg0 = _mm256_set1_ps(g0);
+    size_t f = 0;
+    for (; f + framesPerVec <= frames; f += framesPerVec) {
+        __m256 base = _mm256_set1_ps(static_cast<float>(f));
+        __m256 g = _mm256_fmadd_ps(vstep, _mm256_add_ps(base, offsets), vg0);
+        float* p = samples + f * channels;
+        _mm256_storeu_ps(p, _mm256_mul_ps(_mm256_loadu_ps(p), g));
+    }
+    for (; f < frames; f++) {
+        float g = g0 + step * static_cast<float>(f);
+        for (uint16_t c = 0; c < channels; c++) {
+            samples[f * channels + c] *= g;
+        }
+    }
+}
+#endif
+
+#if defined(MUSICAPP_NEON)
+inline void constantNeon(float* samples, size_t count, float gain) {
+    float32x4_t g = vdupq_n_f32(gain);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(samples + i, vmulq_f32(vld1q_f32(samples + i), g));
+    }
+    constantScalar(samples + i, count - i, gain);
+}
+
+inline void rampNeon(float* samples, size_t frames, uint16_t channels, float g0, float step) {
+    if (channels == 0 || 4 % channels != 0) {
+        rampScalar(samples, frames, channels, g0, step);
+        return;
+    }
+    const size_t framesPerVec = 4 / channels;
+    const float off[4] = { 0.0f, static_cast<float>(1 / channels),
+                           static_cast<float>(2 / channels), static_cast<float>(3 / channels) };
+    float32x4_t offsets = vld1q_f32(off);
+    size_t f = 0;
+    for (; f + framesPerVec <= frames; f += framesPerVec) {
+        float32x4_t idx = vaddq_f32(vdupq_n_f32(static_cast<float>(f)), offsets);
+        float32x4_t g = vmlaq_n_f32(vdupq_n_f32(g0), idx, step);
+        float* p = samples + f * channels;
+        vst1q_f32(p, vmulq_f32(vld1q_f32(p), g));
+    }
+    rampScalar(samples + f * channels, frames - f, channels,
+               g0 + step * static_cast<float>(f), step);
+}
+#endif
+
+// 一组内核
+struct KernelSet {
+    ConstantFn constant;
+    RampFn ramp;
+};
+
+// 按指令集级别取内核（不支持的级别回退到标量）
+inline KernelSet select(SimdLevel level) {
+    if (!simdLevelSupported(level)) level = SimdLevel::Scalar;
+    switch (level) {
+#if defined(MUSICAPP_X86)
+        case SimdLevel::AVX2: return { constantAvx2, rampAvx2 };
+        case SimdLevel::SSE2: return { constantSse2, rampSse2 };
+#endif
+#if defined(MUSICAPP_NEON)
+        case SimdLevel::NEON: return { constantNeon, rampNeon };
+#endif
+        default: break;
+    }
+    return { constantScalar, rampScalar };
+}
+
+} // namespace GainKernels
+
+// 单路音频流的增益级
+// 控制线程设置目标增益，渲染线程在 rampFrames 帧内逐样本插值到目标，避免音量跳变产生爆音
+// 每个播放器拥有独立实例，互不影响
+class GainStage {
+public:
+    explicit GainStage(float gain = 1.0f, uint32_t rampFrames = 0,
+                       SimdLevel level = hostSimdLevel())
+        : kernels_(GainKernels::select(level)),
+          target_(gain),
+          rampFrames_(rampFrames),
+          current_(gain),
+          rampTarget_(gain) {}
+
+    // 控制线程：设置目标增益
+    void setTarget(float gain) {
+        target_.store(gain, std::memory_order_relaxed);
+    }
+
+    float getTarget() const {
+        return target_.load(std::memory_order_relaxed);
+    }
+
+    // 控制线程：设置斜坡长度（帧）
+    void setRampFrames(uint32_t frames) {
+        rampFrames_.store(frames, std::memory_order_relaxed);
+    }
+
+    uint32_t getRampFrames() const {
+        return rampFrames_.load(std::memory_order_relaxed);
+    }
+
+    // 渲染线程：对交错样本原地应用增益
+    void process(float* samples, size_t frames, uint16_t channels) {
+        float target = target_.load(std::memory_order_relaxed);
+        if (target != rampTarget_) {
+            // 目标变化：从当前增益重新开始斜坡（斜坡途中改变目标也不会跳变）
+            rampTarget_ = target;
+            rampRemaining_ = rampFrames_.load(std::memory_order_relaxed);
+            if (rampRemaining_ == 0) {
+                current_ = target;
+            } else {
+                step_ = (target - current_) / static_cast<float>(rampRemaining_);
+            }
+        }
+
+        size_t done = 0;
+        if (rampRemaining_ > 0) {
+            done = std::min<size_t>(frames, rampRemaining_);
+            kernels_.ramp(samples, done, channels, current_, step_);
+            rampRemaining_ -= static_cast<uint32_t>(done);
+            current_ = rampRemaining_ == 0 ? rampTarget_
+                                           : current_ + step_ * static_cast<float>(done);
+        }
+        if (done < frames && current_ != 1.0f) {
+            kernels_.constant(samples + done * channels, (frames - done) * channels, current_);
+        }
+    }
+
+    float getCurrentGain() const { return current_; }
+
+private:
+    GainKernels::KernelSet kernels_;
+    std::atomic<float> target_;
+    std::atomic<uint32_t> rampFrames_;
+
+    // 渲染线程状态
+    float current_;
+    float rampTarget_;
+    float step_ = 0.0f;
+    uint32_t rampRemaining_ = 0;
+};
+
+} // namespace MusicApp
+
+#endif // GAIN_STAGE_H
@@ -0,0 +1,453 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MUSICAPP_HAVE_TSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define MUSICAPP_HAVE_TSC 1
+#endif
+
+// 热路径统计：计数器始终记录；定义 MUSICAPP_LATENCY_PROBES 时另外记录耗时直方图，
+// 未定义时计时探针展开为空，不产生任何代码
+#define MUSICAPP_COUNT(counter, n) ::MusicApp::Stats::count(::MusicApp::Stats::Counter::counter, (n))
+// 登记当前线程：程序创建的每个线程在开始时调用一次（登记会加锁分配），之后的记录写入本线程独占的统计块
+#define MUSICAPP_STATS_THREAD() ::MusicApp::Stats::registerThread()
+#ifdef MUSICAPP_LATENCY_PROBES
+#define MUSICAPP_STATS_CONCAT_(a, b) a##b
+#define MUSICAPP_STATS_CONCAT(a, b) MUSICAPP_STATS_CONCAT_(a, b)
+// 记录所在作用域的耗时
+#define MUSICAPP_PROBE(probe) \
+    ::MusicApp::Stats::ScopedTimer MUSICAPP_STATS_CONCAT(musicappProbe, __LINE__)(::MusicApp::Stats::Probe::probe)
+#else
+#define MUSICAPP_PROBE(probe) ((void)0)
+#endif
+
+namespace MusicApp {
+namespace Stats {
+
+#ifdef MUSICAPP_LATENCY_PROBES
+constexpr bool kProbesEnabled = true;
+#else
+constexpr bool kProbesEnabled = false;
+#endif
+
+// 计时探针
+enum class Probe : uint8_t {
+    Load,           // 后端加载曲目
+    Seek,           // 后端定位
+    PlayTrack,      // 播放当前曲目（增益、加载、启动、预载下一首）
+    LoadDirectory,  // 单层目录加载
+    TrackEnd,       // 曲目结束后的切换
+    Transition,     // 无缝 / 淡变切换后的列表推进
+    DecodeChunk,    // 原生引擎解码一块（含声道映射与重采样）
+    RenderPeriod,   // 原生引擎渲染一个周期（不含等待）
+    ControlCommand, // 控制服务执行一条命令
+    Count
+};
+
+// 事件计数
+enum class Counter : uint8_t {
+    Underruns,      // 欠载周期
+    UnderrunFrames, // 欠载时补入的静音帧
+    LoadFailures,   // 加载失败的曲目
+    PrefetchHits,   // 加载时已预热的曲目
+    PrefetchMisses, // 加载时尚未预热的曲目
+    PrefetchBytes,  // 预读的字节数
+    Count
+};
+
+constexpr size_t kProbes = static_cast<size_t>(Probe::Count);
+constexpr size_t kCounters = static_cast<size_t>(Counter::Count);
+
+inline const char* probeName(Probe probe) {
+    static const char* const kNames[] = { "load", "seek", "play_track", "load_directory", "track_end",
+                                          "transition", "decode_chunk", "render_period", "control_command" };
+    return kNames[static_cast<size_t>(probe)];
+}
+
+inline const char* counterName(Counter counter) {
+    static const char* const kNames[] = { "underruns", "underrun_frames", "load_failures",
+                                          "prefetch_hits", "prefetch_misses", "prefetch_bytes" };
+    return kNames[static_cast<size_t>(counter)];
+}
+
+// 对数线性直方图（HDR 风格）：每个 2 的幂区间再分 16 格，相对误差不超过 6.25%；
+// 16 以下的值各占一格，上限 2^48 个时钟周期
+constexpr unsigned kSubBucketBits = 4;
+constexpr uint64_t kSubBuckets = uint64_t(1) << kSubBucketBits;
+constexpr unsigned kValueBits = 48;
+constexpr size_t kBuckets = (kValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+inline unsigned highestBit(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return static_cast<unsigned>(index);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(v));
+#endif
+}
+
+inline size_t bucketIndex(uint64_t v) {
+    if (v < kSubBuckets) return static_cast<size_t>(v);
+    v = std::min<uint64_t>(v, (uint64_t(1) << kValueBits) - 1);
+    unsigned shift = highestBit(v) - kSubBucketBits;
+    return static_cast<size_t>((shift + 1) * kSubBuckets + ((v >> shift) & (kSubBuckets - 1)));
+}
+
+// 格子的代表值（区间中点）
+inline double bucketValue(size_t index) {
+    if (index < kSubBuckets) return static_cast<double>(index);
+    unsigned shift = static_cast<unsigned>(index / kSubBuckets - 1);
+    uint64_t mantissa = kSubBuckets + index % kSubBuckets;
+    return (static_cast<double>(mantissa) + 0.5) * static_cast<double>(uint64_t(1) << shift);
+}
+
+// 时间戳：x86 上为 TSC（一条指令），换算成纳秒的比例在读取快照时校准；其他平台直接用纳秒
+inline uint64_t ticks() {
+#ifdef MUSICAPP_HAVE_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// 每个线程独占的一块统计：只有所属线程写入（普通的 relaxed 读改写，不带锁前缀），
+// 读取方汇总所有线程块。线程退出后块留给下一个新线程复用，累计值不丢失
+struct ThreadBlock {
+    // 次数由各格子之和得出，最大值取最高的非空格子，热路径上只写总和与一个格子
+    struct Histogram {
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> buckets[kBuckets] = {};
+    };
+
+    std::atomic<uint64_t> counters[kCounters] = {};
+    Histogram histograms[kProbes];
+    std::atomic<bool> inUse{true};
+    ThreadBlock* next = nullptr;
+
+    static void bump(std::atomic<uint64_t>& a, uint64_t n) {
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void record(Probe probe, uint64_t elapsed) {
+        Histogram& h = histograms[static_cast<size_t>(probe)];
+        bump(h.sum, elapsed);
+        bump(h.buckets[bucketIndex(elapsed)], 1);
+    }
+};
+
+// 尚未登记的线程共用的统计块，常量初始化，始终在登记表中
+inline ThreadBlock sharedBlock;
+
+// 汇总后的快照
+struct ProbeSummary {
+    uint64_t count = 0;
+    double meanUs = 0.0;
+    double p50Us = 0.0;
+    double p90Us = 0.0;
+    double p99Us = 0.0;
+    double p999Us = 0.0;
+    double maxUs = 0.0;
+};
+
+struct Snapshot {
+    ProbeSummary probes[kProbes];
+    uint64_t counters[kCounters] = {};
+    double seconds = 0.0;       // 自上次重置以来的时间
+    size_t threads = 0;
+};
+
+class Registry {
+public:
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    ThreadBlock* acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (ThreadBlock* b = head_.load(std::memory_order_acquire); b; b = b->next) {
+            bool expected = false;
+            if (b->inUse.compare_exchange_strong(expected, true)) return b;
+        }
+        ThreadBlock* block = new ThreadBlock();
+        block->next = head_.load(std::memory_order_relaxed);
+        head_.store(block, std::memory_order_release);
+        return block;
+    }
+
+    void release(ThreadBlock* block) { block->inUse.store(false, std::memory_order_release); }
+
+    // 汇总所有线程块，减去上次重置时的基线
+    Snapshot snapshot() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Totals totals = collect();
+        double ticksPerNs = kProbesEnabled ? calibrate() : 1.0;
+        Snapshot snap;
+        for (size_t p = 0; p < kProbes; p++) {
+            ProbeTotals& t = totals.probes[p];
+            const ProbeTotals& base = baseline_.probes[p];
+            ProbeSummary& s = snap.probes[p];
+            s.count = t.count - base.count;
+            if (s.count == 0) continue;
+            for (size_t i = 0; i < kBuckets; i++) t.buckets[i] -= base.buckets[i];
+            double toUs = 1.0 / (ticksPerNs * 1000.0);
+            s.meanUs = static_cast<double>(t.sum - base.sum) / s.count * toUs;
+            // 最大值与分位数都取格子中点（相对误差不超过 6.25%）
+            double maxTicks = highestBucket(t);
+            s.maxUs = maxTicks * toUs;
+            s.p50Us = std::min(percentile(t, s.count, 0.50), maxTicks) * toUs;
+            s.p90Us = std::min(percentile(t, s.count, 0.90), maxTicks) * toUs;
+            s.p99Us = std::min(percentile(t, s.count, 0.99), maxTicks) * toUs;
+            s.p999Us = std::min(percentile(t, s.count, 0.999), maxTicks) * toUs;
+        }
+        for (size_t c = 0; c < kCounters; c++) snap.counters[c] = totals.counters[c] - baseline_.counters[c];
+        snap.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - resetTime_).count();
+        snap.threads = totals.threads;
+        return snap;
+    }
+
+    // 之后的快照从此刻开始计算；写入方不受影响
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        baseline_ = collect();
+        resetTime_ = std::chrono::steady_clock::now();
+    }
+
+private:
+    struct ProbeTotals {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        std::vector<uint64_t> buckets = std::vector<uint64_t>(kBuckets, 0);
+    };
+
+    struct Totals {
+        ProbeTotals probes[kProbes];
+        uint64_t counters[kCounters] = {};
+        size_t threads = 0;
+    };
+
+    Registry()
+        : head_(&sharedBlock),
+          startTicks_(ticks()),
+          startTime_(std::chrono::steady_clock::now()),
+          resetTime_(startTime_) {}
+
+    Totals collect() const {
+        Totals totals;
+        for (const ThreadBlock* b = head_.load(std::memory_order_acquire); b; b = b->next) {
+            if (b != &sharedBlock) totals.threads++;
+            for (size_t c = 0; c < kCounters; c++) totals.counters[c] += b->counters[c].load(std::memory_order_relaxed);
+            for (size_t p = 0; p < kProbes; p++) {
+                const ThreadBlock::Histogram& h = b->histograms[p];
+                ProbeTotals& t = totals.probes[p];
+                t.sum += h.sum.load(std::memory_order_relaxed);
+                for (size_t i = 0; i < kBuckets; i++) {
+                    uint64_t n = h.buckets[i].load(std::memory_order_relaxed);
+                    t.buckets[i] += n;
+                    t.count += n;
+                }
+            }
+        }
+        return totals;
+    }
+
+    // TSC 频率：以进程启动以来的时钟周期与 steady_clock 之比估计，间隔过短时先等待
+    double calibrate() const {
+#ifdef MUSICAPP_HAVE_TSC
+        auto minimum = std::chrono::milliseconds(20);
+        auto elapsed = std::chrono::steady_clock::now() - startTime_;
+        if (elapsed < minimum) std::this_thread::sleep_for(minimum - elapsed);
+        uint64_t t = ticks();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime_).count();
+        return static_cast<double>(t - startTicks_) / ns;
+#else
+        return 1.0;
+#endif
+    }
+
+    static double percentile(const ProbeTotals& t, uint64_t count, double q) {
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; i++) {
+            seen += t.buckets[i];
+            if (seen > rank) return bucketValue(i);
+        }
+        return bucketValue(kBuckets - 1);
+    }
+
+    static double highestBucket(const ProbeTotals& t) {
+        for (size_t i = kBuckets; i-- > 0;) {
+            if (t.buckets[i]) return bucketValue(i);
+        }
+        return 0.0;
+    }
+
+    std::mutex mutex_;
+    std::atomic<ThreadBlock*> head_{nullptr};
+    Totals baseline_;
+    uint64_t startTicks_;
+    std::chrono::steady_clock::time_point startTime_;
+    std::chrono::steady_clock::time_point resetTime_;
+};
+
+// 快速路径只读一个静态初始化的线程局部指针，不经过动态初始化的守卫检查，也不判空：
+// 未登记的线程指向共享块（字段都是原子量，并发写入时会丢失少量计数，但不会出错）
+inline thread_local ThreadBlock* tlsBlock = &sharedBlock;
+
+// 登记当前线程，重复调用无效；线程退出时 Holder 归还统计块
+inline void registerThread() {
+    struct Holder {
+        ThreadBlock* block = Registry::instance().acquire();
+        ~Holder() {
+            tlsBlock = &sharedBlock;
+            Registry::instance().release(block);
+        }
+    };
+    thread_local Holder holder;
+    tlsBlock = holder.block;
+}
+
+inline void count(Counter counter, uint64_t n) {
+    ThreadBlock::bump(tlsBlock->counters[static_cast<size_t>(counter)], n);
+}
+
+// 构造时先取出线程块与直方图，析构时只剩读取时间戳与两次写入
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Probe probe)
+        : histogram_(tlsBlock->histograms[static_cast<size_t>(probe)]), start_(ticks()) {}
+    ~ScopedTimer() {
+        uint64_t elapsed = ticks() - start_;
+        ThreadBlock::bump(histogram_.sum, elapsed);
+        ThreadBlock::bump(histogram_.buckets[bucketIndex(elapsed)], 1);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    ThreadBlock::Histogram& histogram_;
+    uint64_t start_;
+};
+
+// stats 命令的表格
+inline std::string formatSnapshot(const Snapshot& snap) {
+    std::ostringstream ss;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-16s %10s %10s %10s %10s %10s %10s  (us, %.1fs, %zu threads)\n",
+                  "probe", "count", "mean", "p50", "p99", "p99.9", "max", snap.seconds, snap.threads);
+    if (!kProbesEnabled) {
+        std::snprintf(line, sizeof(line), "Latency probes are not compiled in (ENABLE_LATENCY_PROBES=OFF); "
+                      "counters only (%.1fs, %zu threads)\n", snap.seconds, snap.threads);
+    }
+    ss << line;
+    for (size_t p = 0; kProbesEnabled && p < kProbes; p++) {
+        const ProbeSummary& s = snap.probes[p];
+        std::snprintf(line, sizeof(line), "%-16s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                      probeName(static_cast<Probe>(p)), static_cast<unsigned long long>(s.count),
+                      s.meanUs, s.p50Us, s.p99Us, s.p999Us, s.maxUs);
+        ss << line;
+    }
+    for (size_t c = 0; c < kCounters; c++) {
+        ss << counterName(static_cast<Counter>(c)) << ": " << snap.counters[c] << (c + 1 < kCounters ? " | " : "\n");
+    }
+    return ss.str();
+}
+
+// 单行 JSON（周期转储的一行）；未编译计时探针时 probes 为空对象
+inline std::string snapshotJson(const Snapshot& snap) {
+    std::ostringstream ss;
+    ss << "{\"time\": " << std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::system_clock::now().time_since_epoch()).count()
+       << ", \"seconds\": " << snap.seconds << ", \"threads\": " << snap.threads << ", \"probes\": {";
+    for (size_t p = 0; kProbesEnabled && p < kProbes; p++) {
+        const ProbeSummary& s = snap.probes[p];
+        ss << (p ? ", " : "") << "\"" << probeName(static_cast<Probe>(p)) << "\": {\"count\": " << s.count
+           << ", \"mean_us\": " << s.meanUs << ", \"p50_us\": " << s.p50Us << ", \"p90_us\": " << s.p90Us
+           << ", \"p99_us\": " << s.p99Us << ", \"p999_us\": " << s.p999Us << ", \"max_us\": " << s.maxUs << "}";
+    }
+    ss << "}, \"counters\": {";
+    for (size_t c = 0; c < kCounters; c++) {
+        ss << (c ? ", " : "") << "\"" << counterName(static_cast<Counter>(c)) << "\": " << snap.counters[c];
+    }
+    ss << "}}";
+    return ss.str();
+}
+
+// 周期转储：后台线程每隔 interval 秒向文件追加一行 JSON
+class Dumper {
+public:
+    Dumper() = default;
+    ~Dumper() { stop(); }
+
+    Dumper(const Dumper&) = delete;
+    Dumper& operator=(const Dumper&) = delete;
+
+    bool start(const std::string& path, double intervalSeconds) {
+        stop();
+        out_.open(path, std::ios::app);
+        if (!out_) return false;
+        interval_ = std::chrono::duration<double>(std::max(0.1, intervalSeconds));
+        running_ = true;
+        thread_ = std::thread(&Dumper::run, this);
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) return;
+            running_ = false;
+        }
+        cv_.notify_all();
+        thread_.join();
+        writeLine();    // 退出时再写一行，保留最后一段的数据
+        out_.close();
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            if (cv_.wait_for(lock, interval_, [this]() { return !running_; })) break;
+            lock.unlock();
+            writeLine();
+            lock.lock();
+        }
+    }
+
+    void writeLine() {
+        out_ << snapshotJson(Registry::instance().snapshot()) << "\n";
+        out_.flush();
+    }
+
+    std::ofstream out_;
+    std::chrono::duration<double> interval_{10.0};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_ = false;
+    std::thread thread_;
+};
+
+} // namespace Stats
+} // namespace MusicApp
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,731 @@
+#ifndef LIBRARY_INDEX_H
+#define LIBRARY_INDEX_H
+
+#include "LibraryScanner.h"
+#include "MappedFile.h"
+#include "Playlist.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace MusicApp {
+
+// 曲库索引文件格式（小端，映射后直接按结构体访问，无需解析）
+//   [IndexHeader][IndexDirRecord × dirCount][IndexTrackRecord × trackCount][字符串表]
+// 字符串以 (偏移, 长度) 引用字符串表，不以 0 结尾；相同的艺术家只存一份，
+// 与文件名主干相同的标题直接引用文件名的字节。每个目录的曲目在记录表中连续存放
+// 版本 2 的曲目记录增加了响度分析结果；版本 1 的文件打开时转换为版本 2 的记录，保存时写为版本 2
+const char kLibraryIndexMagic[4] = { 'M', 'P', 'L', 'I' };
+const uint32_t kLibraryIndexVersion = 2;
+const uint32_t kLibraryIndexByteOrder = 0x01020304;
+
+struct IndexStringRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct IndexHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;         // 写入端字节序标记，读取端不一致时拒绝
+    uint32_t dirCount;
+    uint32_t trackCount;
+    uint32_t reserved;
+    uint64_t dirOffset;
+    uint64_t trackOffset;
+    uint64_t stringOffset;
+    uint64_t stringSize;
+};
+
+struct IndexDirRecord {
+    IndexStringRef path;
+    int64_t mtimeNs;
+    uint64_t device;            // 目录标识，增量扫描时跳过经符号链接重复到达的已索引目录
+    uint64_t inode;
+    uint32_t firstTrack;
+    uint32_t trackCount;
+};
+
+struct IndexTrackRecord {
+    IndexStringRef name;        // 目录内的文件名
+    IndexStringRef title;
+    IndexStringRef artist;
+    uint64_t size;
+    int64_t mtimeNs;
+    float duration;             // 秒
+    uint32_t flags;             // kTrackMetadataRead 等
+    int16_t loudness;           // 0.01 LUFS（packDecibels），kTrackLoudnessAnalyzed 时有效
+    int16_t truePeak;           // 0.01 dBTP
+    uint32_t reserved;
+};
+
+// 版本 1 的曲目记录
+struct IndexTrackRecordV1 {
+    IndexStringRef name;
+    IndexStringRef title;
+    IndexStringRef artist;
+    uint64_t size;
+    int64_t mtimeNs;
+    float duration;
+    uint32_t flags;
+};
+
+// 已尝试读取文件标签；未设置的曲目会在加入播放列表后由元数据流水线补全
+const uint32_t kTrackMetadataRead = 1u << 0;
+// 已做过响度分析；中断后重新开始的分析跳过这些曲目
+const uint32_t kTrackLoudnessAnalyzed = 1u << 1;
+
+static_assert(sizeof(IndexHeader) == 56, "IndexHeader layout");
+static_assert(sizeof(IndexDirRecord) == 40, "IndexDirRecord layout");
+static_assert(sizeof(IndexTrackRecord) == 56, "IndexTrackRecord layout");
+static_assert(sizeof(IndexTrackRecordV1) == 48, "IndexTrackRecordV1 layout");
+
+inline TrackLoudness recordLoudness(const IndexTrackRecord& t) {
+    TrackLoudness loudness;
+    if (t.flags & kTrackLoudnessAnalyzed) {
+        loudness.analyzed = true;
+        loudness.loudness = unpackDecibels(t.loudness);
+        loudness.truePeak = unpackDecibels(t.truePeak);
+    }
+    return loudness;
+}
+
+// 索引文件的只读视图
+class LibraryIndexView {
+public:
+    // 映射并校验边界；任何越界引用都视为损坏
+    bool open(const std::string& filepath) {
+        close();
+        if (!file_.open(filepath)) return false;
+        if (!validate()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        file_.close();
+        upgraded_.clear();
+        upgraded_.shrink_to_fit();
+        header_ = nullptr;
+        dirs_ = nullptr;
+        tracks_ = nullptr;
+        strings_ = nullptr;
+    }
+
+    bool isOpen() const { return header_ != nullptr; }
+
+    uint32_t directoryCount() const { return header_ ? header_->dirCount : 0; }
+    uint32_t trackCount() const { return header_ ? header_->trackCount : 0; }
+
+    const IndexDirRecord& directory(uint32_t i) const { return dirs_[i]; }
+    const IndexTrackRecord& track(uint32_t i) const { return tracks_[i]; }
+
+    std::string_view str(IndexStringRef ref) const {
+        return std::string_view(strings_ + ref.offset, ref.length);
+    }
+
+private:
+    bool validate() {
+        const unsigned char* base = file_.data();
+        uint64_t size = file_.size();
+        if (size < sizeof(IndexHeader)) return false;
+        const IndexHeader* h = reinterpret_cast<const IndexHeader*>(base);
+        if (std::memcmp(h->magic, kLibraryIndexMagic, 4) != 0 ||
+            (h->version != kLibraryIndexVersion && h->version != 1) ||
+            h->byteOrder != kLibraryIndexByteOrder) {
+            return false;
+        }
+        const size_t recordSize = h->version == 1 ? sizeof(IndexTrackRecordV1) : sizeof(IndexTrackRecord);
+        auto fits = [size](uint64_t offset, uint64_t bytes) {
+            return offset <= size && bytes <= size - offset;
+        };
+        if (h->dirOffset % 8 != 0 || h->trackOffset % 8 != 0 ||
+            !fits(h->dirOffset, uint64_t(h->dirCount) * sizeof(IndexDirRecord)) ||
+            !fits(h->trackOffset, uint64_t(h->trackCount) * recordSize) ||
+            !fits(h->stringOffset, h->stringSize)) {
+            return false;
+        }
+
+        const IndexDirRecord* dirs = reinterpret_cast<const IndexDirRecord*>(base + h->dirOffset);
+        const IndexTrackRecord* tracks =
+            reinterpret_cast<const IndexTrackRecord*>(base + h->trackOffset);
+        if (h->version == 1) {
+            // 旧版本：逐条转换到自有的新版记录（一次性，之后保存为新版本）
+            const IndexTrackRecordV1* old =
+                reinterpret_cast<const IndexTrackRecordV1*>(base + h->trackOffset);
+            upgraded_.resize(h->trackCount);
+            for (uint32_t i = 0; i < h->trackCount; i++) {
+                IndexTrackRecord& t = upgraded_[i];
+                t.name = old[i].name;
+                t.title = old[i].title;
+                t.artist = old[i].artist;
+                t.size = old[i].size;
+                t.mtimeNs = old[i].mtimeNs;
+                t.duration = old[i].duration;
+                t.flags = old[i].flags & kTrackMetadataRead;
+                t.loudness = 0;
+                t.truePeak = 0;
+                t.reserved = 0;
+            }
+            tracks = upgraded_.data();
+        }
+        auto refOk = [h](IndexStringRef ref) {
+            return uint64_t(ref.offset) + ref.length <= h->stringSize;
+        };
+        for (uint32_t i = 0; i < h->dirCount; i++) {
+            const IndexDirRecord& d = dirs[i];
+            if (!refOk(d.path) || uint64_t(d.firstTrack) + d.trackCount > h->trackCount) {
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < h->trackCount; i++) {
+            const IndexTrackRecord& t = tracks[i];
+            if (!refOk(t.name) || !refOk(t.title) || !refOk(t.artist)) return false;
+        }
+
+        header_ = h;
+        dirs_ = dirs;
+        tracks_ = tracks;
+        strings_ = reinterpret_cast<const char*>(base + h->stringOffset);
+        return true;
+    }
+
+    MappedFile file_;
+    const IndexHeader* header_ = nullptr;
+    const IndexDirRecord* dirs_ = nullptr;
+    const IndexTrackRecord* tracks_ = nullptr;
+    const char* strings_ = nullptr;
+    std::vector<IndexTrackRecord> upgraded_;    // 由版本 1 转换的记录
+};
+
+// 会话中新扫描或重新验证过的曲目
+struct LibraryTrack {
+    std::string name;
+    std::string title;
+    std::string artist;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    float duration = 0.0f;
+    bool metadataRead = false;
+    TrackLoudness loudness;
+};
+
+struct LibraryDirectory {
+    std::string path;
+    int64_t mtimeNs = 0;
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    std::vector<LibraryTrack> tracks;
+};
+
+// 加载统计
+struct LibraryLoadStats {
+    size_t directories = 0;
+    size_t tracks = 0;
+    size_t changedDirectories = 0;  // 修改时间变化、已重新列出的目录
+    size_t newDirectories = 0;      // 变化目录下新出现的子目录
+    size_t removedDirectories = 0;  // 已不存在的目录
+    double seconds = 0.0;
+};
+
+// 持久化曲库
+// 启动时映射索引文件，只对修改时间变化的目录重新列出；未变化的目录直接引用映射内存
+class Library {
+public:
+    Library() = default;
+    Library(const Library&) = delete;
+    Library& operator=(const Library&) = delete;
+
+    // 映射索引文件并重新验证目录；文件不存在或损坏返回 false
+    bool load(const std::string& filepath, WorkStealingPool& pool,
+              LibraryLoadStats* stats = nullptr) {
+        auto start = std::chrono::steady_clock::now();
+        slots_.clear();
+        if (!view_.open(filepath)) return false;
+
+        LibraryLoadStats local;
+        slots_.resize(view_.directoryCount());
+        for (uint32_t i = 0; i < view_.directoryCount(); i++) {
+            const IndexDirRecord& d = view_.directory(i);
+            slots_[i].path = view_.str(d.path);
+            slots_[i].mtimeNs = d.mtimeNs;
+            slots_[i].device = d.device;
+            slots_[i].inode = d.inode;
+            slots_[i].mapped = i;
+        }
+
+        // 并行获取每个目录当前的修改时间
+        const int64_t kMissing = std::numeric_limits<int64_t>::min();
+        std::vector<int64_t> current(slots_.size(), kMissing);
+        {
+            const size_t kChunk = 256;
+            TaskGroup group(pool);
+            for (size_t begin = 0; begin < slots_.size(); begin += kChunk) {
+                size_t end = std::min(slots_.size(), begin + kChunk);
+                group.run([this, &current, begin, end]() {
+                    std::string path;
+                    for (size_t i = begin; i < end; i++) {
+                        path.assign(slots_[i].path);
+                        directoryMtime(path, current[i]);
+                    }
+                });
+            }
+        }
+
+        // 已删除的目录直接丢弃，修改过的目录重新列出（非递归）
+        std::vector<DirSlot> kept;
+        std::vector<DirSlot> changed;
+        kept.reserve(slots_.size());
+        for (size_t i = 0; i < slots_.size(); i++) {
+            if (current[i] == kMissing) {
+                local.removedDirectories++;
+            } else if (current[i] != slots_[i].mtimeNs) {
+                changed.push_back(std::move(slots_[i]));
+            } else {
+                kept.push_back(std::move(slots_[i]));
+            }
+        }
+        slots_.swap(kept);
+        local.changedDirectories = changed.size();
+
+        if (!changed.empty()) {
+            LibraryScanner scanner(pool);
+            std::vector<std::string> paths;
+            for (const auto& slot : changed) {
+                paths.emplace_back(slot.path);
+            }
+            ScanOptions listOnly;
+            listOnly.recursive = false;
+            listOnly.fileStats = true;
+            ScanResult relisted = scanner.scan(paths, listOnly);
+
+            std::vector<std::string> newRoots;
+            for (const auto& dir : relisted.directories) {
+                for (const auto& sub : dir.subdirectories) {
+                    std::string child = joinPath(dir.path, sub);
+                    if (!findSlot(slots_, child) && !findSlot(changed, child)) {
+                        newRoots.push_back(std::move(child));
+                    }
+                }
+            }
+            insertScanned(relisted, changed);
+
+            // 变化目录下新建的子目录整体递归扫描，已索引的目录（如指回曲库内部的符号链接）跳过
+            if (!newRoots.empty()) {
+                std::vector<std::pair<uint64_t, uint64_t>> known;
+                known.reserve(slots_.size());
+                for (const auto& slot : slots_) {
+                    if (slot.device != 0 || slot.inode != 0) {
+                        known.emplace_back(slot.device, slot.inode);
+                    }
+                }
+                ScanOptions full;
+                full.fileStats = true;
+                full.knownDirectories = &known;
+                ScanResult added = scanner.scan(newRoots, full);
+                local.newDirectories = added.directories.size();
+                insertScanned(added, {});
+            }
+            sortSlots();
+        }
+
+        local.directories = slots_.size();
+        local.tracks = trackCount();
+        local.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        if (stats) *stats = local;
+        return true;
+    }
+
+    // 合并一次递归扫描的结果：root 下原有的目录全部被替换，
+    // 大小与修改时间未变的曲目保留已有的标题、艺术家与时长
+    void addScan(const std::string& root, const ScanResult& result) {
+        std::string base = root;
+        while (base.size() > 1 && (base.back() == '/' || base.back() == '\\')) {
+            base.pop_back();
+        }
+        std::vector<DirSlot> kept;
+        std::vector<DirSlot> replaced;
+        for (auto& slot : slots_) {
+            if (isUnder(slot.path, base)) {
+                replaced.push_back(std::move(slot));
+            } else {
+                kept.push_back(std::move(slot));
+            }
+        }
+        slots_.swap(kept);
+        insertScanned(result, replaced);
+        sortSlots();
+    }
+
+    // 按目录顺序将全部曲目加入播放列表；先统计曲目数与字符数，一次预留到位
+    void appendTo(Playlist& playlist) const {
+        size_t tracks = 0;
+        size_t chars = 0;
+        for (const auto& slot : slots_) {
+            if (slot.owned) {
+                tracks += slot.owned->tracks.size();
+                for (const auto& t : slot.owned->tracks) chars += t.name.size() + t.title.size();
+            } else {
+                const IndexDirRecord& d = view_.directory(slot.mapped);
+                tracks += d.trackCount;
+                for (uint32_t i = d.firstTrack; i < d.firstTrack + d.trackCount; i++) {
+                    chars += view_.track(i).name.length + view_.track(i).title.length;
+                }
+            }
+        }
+        playlist.reserve(playlist.size() + tracks, chars);
+        forEachTrack([&playlist](std::string_view prefix, std::string_view name,
+                                 std::string_view title, std::string_view artist,
+                                 float duration, bool metadataRead, const TrackLoudness& loudness) {
+            uint32_t id = playlist.addTrack(prefix, name, title, artist, duration, metadataRead);
+            if (loudness.analyzed) playlist.setTrackLoudness(id, loudness);
+        });
+    }
+
+    // 写入后台读取到的元数据与响度；映射中的目录先转为自有数据。曲目不在曲库中时返回 false
+    bool updateTrack(const TrackView& track) {
+        // 目录前缀去掉末尾分隔符（根目录除外）即曲库中的目录路径
+        std::string_view dir = track.directory();
+        if (dir.empty()) return false;
+        if (dir.size() > 1) dir.remove_suffix(1);
+        std::string_view name = track.fileName();
+        auto it = std::lower_bound(slots_.begin(), slots_.end(), dir,
+                                   [](const DirSlot& s, std::string_view p) { return pathLess(s.path, p); });
+        if (it == slots_.end() || it->path != dir) return false;
+        if (!it->owned) detachSlot(*it);
+        for (auto& t : it->owned->tracks) {
+            if (t.name == name) {
+                t.title.assign(track.title());
+                t.artist.assign(track.artist());
+                t.duration = track.duration();
+                t.metadataRead = track.metadataRead();
+                t.loudness = track.loudness();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 写入索引文件（先写临时文件再替换，写入失败不会破坏旧索引）
+    bool save(const std::string& filepath) {
+        IndexWriter writer;
+        for (const auto& slot : slots_) {
+            writer.beginDirectory(slot.path, slot.mtimeNs, slot.device, slot.inode);
+            if (slot.owned) {
+                for (const auto& t : slot.owned->tracks) {
+                    writer.addTrack(t.name, t.title, t.artist, t.size, t.mtimeNs, t.duration,
+                                    t.metadataRead ? kTrackMetadataRead : 0, t.loudness);
+                }
+            } else {
+                const IndexDirRecord& d = view_.directory(slot.mapped);
+                for (uint32_t i = d.firstTrack; i < d.firstTrack + d.trackCount; i++) {
+                    const IndexTrackRecord& t = view_.track(i);
+                    writer.addTrack(view_.str(t.name), view_.str(t.title), view_.str(t.artist),
+                                    t.size, t.mtimeNs, t.duration, t.flags, recordLoudness(t));
+                }
+            }
+        }
+
+        std::string tmpPath = filepath + ".tmp";
+        if (!writer.write(tmpPath)) {
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+#ifdef _WIN32
+        // Windows 不能替换仍被映射的文件：先把映射中的目录转为自有数据
+        detachFromView();
+        return MoveFileExA(tmpPath.c_str(), filepath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return std::rename(tmpPath.c_str(), filepath.c_str()) == 0;
+#endif
+    }
+
+    size_t directoryCount() const { return slots_.size(); }
+
+    size_t trackCount() const {
+        size_t total = 0;
+        for (const auto& slot : slots_) {
+            total += slot.owned ? slot.owned->tracks.size()
+                                : view_.directory(slot.mapped).trackCount;
+        }
+        return total;
+    }
+
+private:
+    struct DirSlot {
+        std::string_view path;                      // 指向映射内存或 owned->path
+        int64_t mtimeNs = 0;
+        uint64_t device = 0;
+        uint64_t inode = 0;
+        uint32_t mapped = 0;                        // owned 为空时：映射视图中的目录下标
+        std::shared_ptr<LibraryDirectory> owned;
+    };
+
+    // 构建字符串表与记录表
+    class IndexWriter {
+    public:
+        void beginDirectory(std::string_view path, int64_t mtimeNs,
+                            uint64_t device, uint64_t inode) {
+            IndexDirRecord d;
+            d.path = addString(path);
+            d.mtimeNs = mtimeNs;
+            d.device = device;
+            d.inode = inode;
+            d.firstTrack = static_cast<uint32_t>(tracks_.size());
+            d.trackCount = 0;
+            dirs_.push_back(d);
+        }
+
+        void addTrack(std::string_view name, std::string_view title, std::string_view artist,
+                      uint64_t size, int64_t mtimeNs, float duration, uint32_t flags,
+                      const TrackLoudness& loudness) {
+            IndexTrackRecord t;
+            t.name = addString(name);
+            // 标题与文件名主干一致时直接引用文件名
+            std::string_view stem = name.substr(0, std::min(name.size(), name.find_last_of('.')));
+            t.title = title == stem
+                ? IndexStringRef{ t.name.offset, static_cast<uint32_t>(stem.size()) }
+                : addString(title);
+            t.artist = internString(artist);
+            t.size = size;
+            t.mtimeNs = mtimeNs;
+            t.duration = duration;
+            t.flags = flags & ~kTrackLoudnessAnalyzed;
+            t.loudness = 0;
+            t.truePeak = 0;
+            t.reserved = 0;
+            if (loudness.analyzed) {
+                t.flags |= kTrackLoudnessAnalyzed;
+                t.loudness = packDecibels(loudness.loudness);
+                t.truePeak = packDecibels(loudness.truePeak);
+            }
+            tracks_.push_back(t);
+            dirs_.back().trackCount++;
+        }
+
+        bool write(const std::string& filepath) const {
+            IndexHeader h;
+            std::memcpy(h.magic, kLibraryIndexMagic, 4);
+            h.version = kLibraryIndexVersion;
+            h.byteOrder = kLibraryIndexByteOrder;
+            h.dirCount = static_cast<uint32_t>(dirs_.size());
+            h.trackCount = static_cast<uint32_t>(tracks_.size());
+            h.reserved = 0;
+            h.dirOffset = sizeof(IndexHeader);
+            h.trackOffset = h.dirOffset + dirs_.size() * sizeof(IndexDirRecord);
+            h.stringOffset = h.trackOffset + tracks_.size() * sizeof(IndexTrackRecord);
+            h.stringSize = strings_.size();
+
+            std::ofstream out(filepath, std::ios::binary | std::ios::trunc);
+            if (!out) return false;
+            out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+            out.write(reinterpret_cast<const char*>(dirs_.data()),
+                      static_cast<std::streamsize>(dirs_.size() * sizeof(IndexDirRecord)));
+            out.write(reinterpret_cast<const char*>(tracks_.data()),
+                      static_cast<std::streamsize>(tracks_.size() * sizeof(IndexTrackRecord)));
+            out.write(strings_.data(), static_cast<std::streamsize>(strings_.size()));
+            return static_cast<bool>(out.flush());
+        }
+
+    private:
+        IndexStringRef addString(std::string_view s) {
+            IndexStringRef ref{ static_cast<uint32_t>(strings_.size()),
+                                static_cast<uint32_t>(s.size()) };
+            strings_.append(s);
+            return ref;
+        }
+
+        IndexStringRef internString(std::string_view s) {
+            if (s.empty()) return IndexStringRef{ 0, 0 };
+            auto it = interned_.find(std::string(s));
+            if (it != interned_.end()) return it->second;
+            IndexStringRef ref = addString(s);
+            interned_.emplace(std::string(s), ref);
+            return ref;
+        }
+
+        std::vector<IndexDirRecord> dirs_;
+        std::vector<IndexTrackRecord> tracks_;
+        std::string strings_;
+        std::unordered_map<std::string, IndexStringRef> interned_;
+    };
+
+    // fn 收到的是目录前缀（含末尾分隔符），每个目录只拼接一次
+    template <typename Fn>
+    void forEachTrack(Fn&& fn) const {
+        std::string prefix;
+        for (const auto& slot : slots_) {
+            prefix = joinPath(slot.path, std::string_view());
+            if (slot.owned) {
+                for (const auto& t : slot.owned->tracks) {
+                    fn(prefix, t.name, t.title, t.artist, t.duration, t.metadataRead, t.loudness);
+                }
+            } else {
+                const IndexDirRecord& d = view_.directory(slot.mapped);
+                for (uint32_t i = d.firstTrack; i < d.firstTrack + d.trackCount; i++) {
+                    const IndexTrackRecord& t = view_.track(i);
+                    fn(prefix, view_.str(t.name), view_.str(t.title), view_.str(t.artist), t.duration,
+                       (t.flags & kTrackMetadataRead) != 0, recordLoudness(t));
+                }
+            }
+        }
+    }
+
+    static bool directoryMtime(const std::string& path, int64_t& mtimeNs) {
+#ifdef _WIN32
+        WIN32_FILE_ATTRIBUTE_DATA attr;
+        if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attr) ||
+            !(attr.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            return false;
+        }
+        mtimeNs = fileTimeToNs(attr.ftLastWriteTime);
+#else
+        struct stat st;
+        if (::stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) return false;
+        mtimeNs = statMtimeNs(st);
+#endif
+        return true;
+    }
+
+    static bool isUnder(std::string_view path, std::string_view root) {
+        if (path.size() < root.size() || path.compare(0, root.size(), root) != 0) return false;
+        if (path.size() == root.size()) return true;
+        char c = root.empty() ? '\0' : root.back();
+        return c == '/' || c == '\\' || path[root.size()] == '/' || path[root.size()] == '\\';
+    }
+
+    // 在按路径排序的目录表 [0, count) 中查找
+    static const DirSlot* findSlot(const std::vector<DirSlot>& slots, std::string_view path,
+                                   size_t count = std::numeric_limits<size_t>::max()) {
+        auto end = slots.begin() + std::min(count, slots.size());
+        auto it = std::lower_bound(slots.begin(), end, path,
+                                   [](const DirSlot& s, std::string_view p) { return pathLess(s.path, p); });
+        return (it != end && it->path == path) ? &*it : nullptr;
+    }
+
+    void sortSlots() {
+        std::sort(slots_.begin(), slots_.end(),
+                  [](const DirSlot& a, const DirSlot& b) { return pathLess(a.path, b.path); });
+    }
+
+    // 加入扫描到的目录；previous 为同一批目录的旧记录（按路径排序），用于保留元数据
+    // 调用前 slots_ 必须有序，新目录追加在末尾，由调用方重新排序
+    void insertScanned(const ScanResult& result, const std::vector<DirSlot>& previous) {
+        const size_t existing = slots_.size();
+        for (const auto& scanned : result.directories) {
+            if (findSlot(slots_, scanned.path, existing)) continue;
+
+            auto dir = std::make_shared<LibraryDirectory>();
+            dir->path = scanned.path;
+            dir->mtimeNs = scanned.mtimeNs;
+            dir->device = scanned.device;
+            dir->inode = scanned.inode;
+            dir->tracks.reserve(scanned.files.size());
+            const DirSlot* old = findSlot(previous, scanned.path);
+            for (const auto& file : scanned.files) {
+                LibraryTrack track;
+                track.name = file.name;
+                track.size = file.size;
+                track.mtimeNs = file.mtimeNs;
+                if (!(old && carryOver(*old, track))) {
+                    track.title = extractFileName(file.name);
+                }
+                dir->tracks.push_back(std::move(track));
+            }
+
+            DirSlot slot;
+            slot.path = dir->path;
+            slot.mtimeNs = dir->mtimeNs;
+            slot.device = dir->device;
+            slot.inode = dir->inode;
+            slot.owned = std::move(dir);
+            slots_.push_back(std::move(slot));
+        }
+    }
+
+    // 旧记录中同名且大小、修改时间未变的曲目：沿用其元数据
+    bool carryOver(const DirSlot& old, LibraryTrack& track) const {
+        if (old.owned) {
+            for (const auto& t : old.owned->tracks) {
+                if (t.name == track.name && t.size == track.size && t.mtimeNs == track.mtimeNs) {
+                    track.title = t.title;
+                    track.artist = t.artist;
+                    track.duration = t.duration;
+                    track.metadataRead = t.metadataRead;
+                    track.loudness = t.loudness;
+                    return true;
+                }
+            }
+            return false;
+        }
+        const IndexDirRecord& d = view_.directory(old.mapped);
+        for (uint32_t i = d.firstTrack; i < d.firstTrack + d.trackCount; i++) {
+            const IndexTrackRecord& t = view_.track(i);
+            if (view_.str(t.name) == track.name && t.size == track.size &&
+                t.mtimeNs == track.mtimeNs) {
+                track.title.assign(view_.str(t.title));
+                track.artist.assign(view_.str(t.artist));
+                track.duration = t.duration;
+                track.metadataRead = (t.flags & kTrackMetadataRead) != 0;
+                track.loudness = recordLoudness(t);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 把映射中的目录复制为自有数据
+    void detachSlot(DirSlot& slot) const {
+        auto dir = std::make_shared<LibraryDirectory>();
+        dir->path.assign(slot.path);
+        dir->mtimeNs = slot.mtimeNs;
+        dir->device = slot.device;
+        dir->inode = slot.inode;
+        const IndexDirRecord& d = view_.directory(slot.mapped);
+        dir->tracks.reserve(d.trackCount);
+        for (uint32_t i = d.firstTrack; i < d.firstTrack + d.trackCount; i++) {
+            const IndexTrackRecord& t = view_.track(i);
+            LibraryTrack track;
+            track.name.assign(view_.str(t.name));
+            track.title.assign(view_.str(t.title));
+            track.artist.assign(view_.str(t.artist));
+            track.size = t.size;
+            track.mtimeNs = t.mtimeNs;
+            track.duration = t.duration;
+            track.metadataRead = (t.flags & kTrackMetadataRead) != 0;
+            track.loudness = recordLoudness(t);
+            dir->tracks.push_back(std::move(track));
+        }
+        slot.path = dir->path;
+        slot.owned = std::move(dir);
+    }
+
+#ifdef _WIN32
+    void detachFromView() {
+        for (auto& slot : slots_) {
+            if (!slot.owned) detachSlot(slot);
+        }
+        view_.close();
+    }
+#endif
+
+    LibraryIndexView view_;
+    std::vector<DirSlot> slots_;    // 按路径排序
+};
+
+} // namespace MusicApp
+
+#endif // LIBRARY_INDEX_H
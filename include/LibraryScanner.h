@@ -0,0 +1,451 @@
+#ifndef LIBRARY_SCANNER_H
+#define LIBRARY_SCANNER_H
+
+#include "Playlist.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MusicApp {
+
+#ifdef _WIN32
+const char kPathSeparator = '\\';
+
+// FILETIME（100ns 刻度）转换为纳秒
+inline int64_t fileTimeToNs(const FILETIME& ft) {
+    uint64_t ticks = (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    return static_cast<int64_t>(ticks * 100);
+}
+#else
+const char kPathSeparator = '/';
+
+// stat 中的修改时间（纳秒）
+inline int64_t statMtimeNs(const struct stat& st) {
+#ifdef __APPLE__
+    return static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+#endif
+
+// 源文件的大小与修改时间
+inline bool sourceFileStat(const std::string& path, uint64_t& size, int64_t& mtimeNs) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA attr;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attr) ||
+        (attr.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        return false;
+    }
+    size = (static_cast<uint64_t>(attr.nFileSizeHigh) << 32) | attr.nFileSizeLow;
+    mtimeNs = fileTimeToNs(attr.ftLastWriteTime);
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    size = static_cast<uint64_t>(st.st_size);
+    mtimeNs = statMtimeNs(st);
+#endif
+    return true;
+}
+
+// 拼接目录与文件名
+inline std::string joinPath(std::string_view dir, std::string_view name) {
+    std::string path;
+    path.reserve(dir.size() + name.size() + 1);
+    path.append(dir);
+    if (!dir.empty() && dir.back() != '/' && dir.back() != '\\') {
+        path += kPathSeparator;
+    }
+    path.append(name);
+    return path;
+}
+
+// 比较路径时把分隔符视为最小字符，使 "a/b" 紧跟在 "a" 之后而不是排在 "a-c" 之后
+inline bool pathLess(std::string_view a, std::string_view b) {
+    auto key = [](char c) {
+        return (c == '/' || c == '\\') ? 0 : static_cast<unsigned char>(c) + 1;
+    };
+    size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; i++) {
+        int ka = key(a[i]), kb = key(b[i]);
+        if (ka != kb) return ka < kb;
+    }
+    return a.size() < b.size();
+}
+
+// 扫描选项
+struct ScanOptions {
+    bool recursive = true;      // false 时只列出根目录本身，子目录名记录在 subdirectories 中
+    bool fileStats = false;     // 为匹配的音频文件获取大小与修改时间（多一次 fstatat）
+    bool sniffContent = true;   // 扩展名匹配后读取文件头确认内容，跳过内容不是音频的文件；结果写入格式缓存
+    // 视为已访问的目录 (dev, ino)，用于增量扫描时跳过已索引的目录
+    const std::vector<std::pair<uint64_t, uint64_t>>* knownDirectories = nullptr;
+};
+
+// 扫描统计
+struct ScanStats {
+    size_t tracks = 0;          // 匹配的音频文件
+    size_t rejected = 0;        // 扩展名是音频格式但内容不是（或无法读取）的文件
+    size_t entries = 0;         // 检查过的目录项
+    size_t directories = 0;     // 扫描过的目录
+    size_t skippedLoops = 0;    // 因重复访问（符号链接环等）跳过的目录
+    size_t errors = 0;          // 无法打开的目录
+    size_t threads = 0;
+    double seconds = 0.0;
+
+    double entriesPerSecond() const {
+        return seconds > 0 ? entries / seconds : 0.0;
+    }
+};
+
+struct ScannedFile {
+    std::string name;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+};
+
+struct ScannedDirectory {
+    std::string path;
+    int64_t mtimeNs = 0;
+    uint64_t device = 0;        // 目录标识（POSIX 的 st_dev/st_ino，Windows 上为 0）
+    uint64_t inode = 0;
+    std::vector<ScannedFile> files;             // 按文件名排序
+    std::vector<std::string> subdirectories;    // 仅非递归扫描时填写
+};
+
+struct ScanResult {
+    std::vector<ScannedDirectory> directories;  // 确定性顺序：按目录路径逐级排序（含无音频文件的目录）
+    ScanStats stats;
+
+    // 按目录顺序展开的完整路径
+    std::vector<std::string> paths() const {
+        std::vector<std::string> out;
+        out.reserve(stats.tracks);
+        for (const auto& dir : directories) {
+            for (const auto& file : dir.files) {
+                out.push_back(joinPath(dir.path, file.name));
+            }
+        }
+        return out;
+    }
+};
+
+// 并行递归曲库扫描器
+// 每个目录是线程池中的一个任务，子目录作为新任务提交，由空闲线程窃取
+// POSIX 上通过 openat/fstatat 相对父目录 fd 访问，优先使用 d_type 避免逐项 stat
+// 指向目录的符号链接推迟到下一轮按路径排序后依次认领，结合 (dev, ino) 去重，
+// 既能终止符号链接环，又保证结果与线程调度无关
+class LibraryScanner {
+public:
+    explicit LibraryScanner(WorkStealingPool& pool) : pool_(pool) {}
+
+    ScanResult scan(const std::string& root, const ScanOptions& options = ScanOptions()) {
+        return scan(std::vector<std::string>{ root }, options);
+    }
+
+    // 同时扫描多个根目录，结果合并排序
+    ScanResult scan(const std::vector<std::string>& rootPaths,
+                    const ScanOptions& options = ScanOptions()) {
+        auto start = std::chrono::steady_clock::now();
+        ScanState state;
+        state.options = options;
+        if (options.knownDirectories) {
+            state.visited.insert(options.knownDirectories->begin(), options.knownDirectories->end());
+        }
+
+        std::vector<std::string> roots;
+        for (std::string base : rootPaths) {
+            while (base.size() > 1 && (base.back() == '/' || base.back() == '\\')) {
+                base.pop_back();
+            }
+            roots.push_back(std::move(base));
+        }
+        std::sort(roots.begin(), roots.end(), pathLess);
+
+        bool first = true;
+        while (!roots.empty()) {
+            TaskGroup group(pool_);
+            for (const auto& dir : roots) {
+                scheduleRoot(state, group, dir, first);
+            }
+            group.wait();
+            first = false;
+
+            // 下一轮：本轮发现的目录符号链接
+            roots.swap(state.linkedDirs);
+            state.linkedDirs.clear();
+            std::sort(roots.begin(), roots.end(), pathLess);
+        }
+
+        ScanResult result;
+        result.directories = std::move(state.listings);
+        std::sort(result.directories.begin(), result.directories.end(),
+                  [](const ScannedDirectory& a, const ScannedDirectory& b) {
+                      return pathLess(a.path, b.path);
+                  });
+        for (const auto& dir : result.directories) {
+            result.stats.tracks += dir.files.size();
+        }
+
+        result.stats.entries = state.entries.load();
+        result.stats.directories = result.directories.size();
+        result.stats.rejected = state.rejected.load();
+        result.stats.skippedLoops = state.skippedLoops.load();
+        result.stats.errors = state.errors.load();
+        result.stats.threads = pool_.size();
+        result.stats.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+private:
+    struct ScanState {
+        ScanOptions options;
+        std::mutex mutex;
+        std::set<std::pair<uint64_t, uint64_t>> visited;    // (dev, ino)
+        std::vector<ScannedDirectory> listings;
+        std::vector<std::string> linkedDirs;
+
+        std::atomic<size_t> entries{0};
+        std::atomic<size_t> rejected{0};
+        std::atomic<size_t> skippedLoops{0};
+        std::atomic<size_t> errors{0};
+
+        // 认领目录，已访问过返回 false
+        bool claim(uint64_t dev, uint64_t ino) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return visited.emplace(dev, ino).second;
+        }
+    };
+
+    static void addListing(ScanState& state, ScannedDirectory&& listing) {
+        std::sort(listing.files.begin(), listing.files.end(),
+                  [](const ScannedFile& a, const ScannedFile& b) { return a.name < b.name; });
+        std::sort(listing.subdirectories.begin(), listing.subdirectories.end());
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.listings.push_back(std::move(listing));
+    }
+
+#ifdef _WIN32
+    // Windows：按路径枚举，跳过重解析点（目录联接/符号链接）以避免环
+    void scheduleRoot(ScanState& state, TaskGroup& group, const std::string& dir, bool first) {
+        (void)first;
+        WIN32_FILE_ATTRIBUTE_DATA attr;
+        if (!GetFileAttributesExA(dir.c_str(), GetFileExInfoStandard, &attr)) {
+            state.errors++;
+            return;
+        }
+        int64_t mtime = fileTimeToNs(attr.ftLastWriteTime);
+        group.run([this, &state, &group, dir, mtime]() {
+            scanDirectory(state, group, dir, mtime);
+        });
+    }
+
+    void scanDirectory(ScanState& state, TaskGroup& group, const std::string& path, int64_t mtime) {
+        WIN32_FIND_DATAA findData;
+        std::string searchPath = joinPath(path, "*");
+        HANDLE hFind = FindFirstFileA(searchPath.c_str(), &findData);
+        if (hFind == INVALID_HANDLE_VALUE) {
+            state.errors++;
+            return;
+        }
+        ScannedDirectory listing;
+        listing.path = path;
+        listing.mtimeNs = mtime;
+        do {
+            std::string name = findData.cFileName;
+            if (name == "." || name == "..") continue;
+            state.entries++;
+            if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                if (findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) {
+                    state.skippedLoops++;
+                    continue;
+                }
+                if (!state.options.recursive) {
+                    listing.subdirectories.push_back(std::move(name));
+                    continue;
+                }
+                std::string child = joinPath(path, name);
+                int64_t childMtime = fileTimeToNs(findData.ftLastWriteTime);
+                group.run([this, &state, &group, child, childMtime]() {
+                    scanDirectory(state, group, child, childMtime);
+                });
+            } else if (hasAudioExtension(name)) {
+                if (state.options.sniffContent) {
+                    std::string filepath = joinPath(path, name);
+                    SniffResult sniffed = sniffAudioFile(filepath);
+                    if (sniffed.format == AudioFormat::Unknown) {
+                        state.rejected++;
+                        continue;
+                    }
+                    AudioFormatCache::shared().store(filepath, sniffed);
+                }
+                // FindFirstFile 已附带大小与时间，无需额外系统调用
+                ScannedFile file;
+                file.name = std::move(name);
+                file.size = (static_cast<uint64_t>(findData.nFileSizeHigh) << 32) |
+                            findData.nFileSizeLow;
+                file.mtimeNs = fileTimeToNs(findData.ftLastWriteTime);
+                listing.files.push_back(std::move(file));
+            }
+        } while (FindNextFileA(hFind, &findData));
+        FindClose(hFind);
+        addListing(state, std::move(listing));
+    }
+#else
+    // 子任务持有父目录 fd，执行时才 openat 打开自己，排队中的子目录不占用 fd
+    struct DirHandle {
+        DIR* dir;
+        int fd;
+        explicit DirHandle(DIR* d) : dir(d), fd(::dirfd(d)) {}
+        ~DirHandle() { ::closedir(dir); }
+        DirHandle(const DirHandle&) = delete;
+        DirHandle& operator=(const DirHandle&) = delete;
+    };
+
+    void scheduleRoot(ScanState& state, TaskGroup& group, const std::string& dir, bool first) {
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            state.errors++;
+            return;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || !state.claim(st.st_dev, st.st_ino)) {
+            ::close(fd);
+            if (!first) state.skippedLoops++;
+            return;
+        }
+        group.run([this, &state, &group, fd, dir, st]() {
+            scanDirectory(state, group, fd, dir, st);
+        });
+    }
+
+    void scheduleChild(ScanState& state, TaskGroup& group,
+                       const std::shared_ptr<DirHandle>& parent,
+                       const char* name, std::string path) {
+        group.run([this, &state, &group, parent, name = std::string(name),
+                   path = std::move(path)]() {
+            int fd = ::openat(parent->fd, name.c_str(),
+                              O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (fd < 0) {
+                state.errors++;
+                return;
+            }
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || !state.claim(st.st_dev, st.st_ino)) {
+                ::close(fd);
+                state.skippedLoops++;
+                return;
+            }
+            scanDirectory(state, group, fd, path, st);
+        });
+    }
+
+    void scanDirectory(ScanState& state, TaskGroup& group, int fd,
+                       const std::string& path, const struct stat& dirStat) {
+        DIR* dir = ::fdopendir(fd);
+        if (!dir) {
+            ::close(fd);
+            state.errors++;
+            return;
+        }
+        auto handle = std::make_shared<DirHandle>(dir);
+
+        ScannedDirectory listing;
+        listing.path = path;
+        listing.mtimeNs = statMtimeNs(dirStat);
+        listing.device = static_cast<uint64_t>(dirStat.st_dev);
+        listing.inode = static_cast<uint64_t>(dirStat.st_ino);
+        struct dirent* entry;
+        while ((entry = ::readdir(dir)) != nullptr) {
+            const char* name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+            state.entries++;
+
+            unsigned char type = entry->d_type;
+            struct stat st;
+            bool haveStat = false;
+            if (type == DT_UNKNOWN) {
+                // 部分文件系统不提供 d_type
+                if (::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+                type = S_ISDIR(st.st_mode) ? DT_DIR
+                     : S_ISREG(st.st_mode) ? DT_REG
+                     : S_ISLNK(st.st_mode) ? DT_LNK : DT_UNKNOWN;
+                haveStat = type != DT_LNK;
+            }
+            if (type == DT_LNK) {
+                if (::fstatat(fd, name, &st, 0) != 0) continue;     // 悬空链接
+                if (S_ISDIR(st.st_mode)) {
+                    if (!state.options.recursive) {
+                        listing.subdirectories.emplace_back(name);
+                        continue;
+                    }
+                    std::lock_guard<std::mutex> lock(state.mutex);
+                    state.linkedDirs.push_back(joinPath(path, name));
+                    continue;
+                }
+                type = S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+                haveStat = true;
+            }
+
+            if (type == DT_REG) {
+                if (hasAudioExtension(name)) {
+                    ScannedFile file;
+                    file.name = name;
+                    if (state.options.sniffContent) {
+                        // 嗅探时打开文件的 fstat 同时给出大小与修改时间
+                        SniffResult sniffed = sniffAudioFileAt(fd, name);
+                        if (sniffed.format == AudioFormat::Unknown) {
+                            state.rejected++;
+                            continue;
+                        }
+                        AudioFormatCache::shared().store(joinPath(path, name), sniffed);
+                        if (state.options.fileStats) {
+                            file.size = sniffed.size;
+                            file.mtimeNs = sniffed.mtimeNs;
+                        }
+                    } else if (state.options.fileStats &&
+                               (haveStat || ::fstatat(fd, name, &st, 0) == 0)) {
+                        file.size = static_cast<uint64_t>(st.st_size);
+                        file.mtimeNs = statMtimeNs(st);
+                    }
+                    listing.files.push_back(std::move(file));
+                }
+            } else if (type == DT_DIR) {
+                if (state.options.recursive) {
+                    scheduleChild(state, group, handle, name, joinPath(path, name));
+                } else {
+                    listing.subdirectories.emplace_back(name);
+                }
+            }
+        }
+        addListing(state, std::move(listing));
+    }
+#endif
+
+    WorkStealingPool& pool_;
+};
+
+} // namespace MusicApp
+
+#endif // LIBRARY_SCANNER_H
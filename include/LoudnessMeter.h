@@ -0,0 +1,486 @@
+#ifndef LOUDNESS_METER_H
+#define LOUDNESS_METER_H
+
+#include "DecoderFactory.h"
+#include "Resampler.h"
+#include "Simd.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MusicApp {
+
+// 二阶 IIR 节（转置直接 II 型），a0 归一化为 1
+struct Biquad {
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+};
+
+// ITU-R BS.1770 的 K 计权：高频搁架预滤波 + RLB 高通
+// 标准只给出 48 kHz 的系数，这里按模拟原型的参数对任意采样率做双线性变换
+inline void kWeightingFilters(uint32_t sampleRate, Biquad& shelf, Biquad& highPass) {
+    const double pi = 3.14159265358979323846;
+    double f0 = 1681.974450955533;
+    double gainDb = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = std::tan(pi * f0 / sampleRate);
+    double vh = std::pow(10.0, gainDb / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    shelf.b0 = static_cast<float>((vh + vb * k / q + k * k) / a0);
+    shelf.b1 = static_cast<float>(2.0 * (k * k - vh) / a0);
+    shelf.b2 = static_cast<float>((vh - vb * k / q + k * k) / a0);
+    shelf.a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+    shelf.a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(pi * f0 / sampleRate);
+    a0 = 1.0 + k / q + k * k;
+    highPass.b0 = 1.0f;
+    highPass.b1 = -2.0f;
+    highPass.b2 = 1.0f;
+    highPass.a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+    highPass.a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+}
+
+// 响度计的内核
+namespace LoudnessKernels {
+
+const uint16_t kMaxChannels = 8;
+
+// K 计权并累加平方：交错输入的每个声道占向量的一条通道（SIMD 路径至多 4 个声道）。
+// state 为 4 × kMaxChannels 个浮点：两级滤波器的 (z1, z2) 按声道排列；sums[c] 累加第 c 声道输出的平方
+using KWeightFn = void (*)(const float* in, size_t frames, uint16_t channels,
+                           const Biquad& shelf, const Biquad& highPass, float* state, float* sums);
+
+// 过采样真峰值：buf 为单声道连续样本，窗口 s 覆盖 buf[s, s + taps)，
+// 对 windows 个窗口分别与 phases 组系数（相位优先排列）求点积，返回插值样本绝对值的最大值
+using TruePeakFn = float (*)(const float* buf, size_t windows, const float* coefficients,
+                             uint32_t phases, uint32_t taps);
+
+struct KernelSet {
+    KWeightFn kWeight;
+    TruePeakFn truePeak;
+};
+
+inline void kWeightScalar(const float* in, size_t frames, uint16_t channels,
+                          const Biquad& s, const Biquad& h, float* state, float* sums) {
+    for (uint16_t c = 0; c < channels; c++) {
+        float z1 = state[c];
+        float z2 = state[kMaxChannels + c];
+        float w1 = state[2 * kMaxChannels + c];
+        float w2 = state[3 * kMaxChannels + c];
+        float acc = 0.0f;
+        for (size_t f = 0; f < frames; f++) {
+            float x = in[f * channels + c];
+            float y = s.b0 * x + z1;
+            z1 = s.b1 * x - s.a1 * y + z2;
+            z2 = s.b2 * x - s.a2 * y;
+            float v = h.b0 * y + w1;
+            w1 = h.b1 * y - h.a1 * v + w2;
+            w2 = h.b2 * y - h.a2 * v;
+            acc += v * v;
+        }
+        state[c] = z1;
+        state[kMaxChannels + c] = z2;
+        state[2 * kMaxChannels + c] = w1;
+        state[3 * kMaxChannels + c] = w2;
+        sums[c] += acc;
+    }
+}
+
+inline float truePeakScalar(const float* buf, size_t windows, const float* coefficients,
+                            uint32_t phases, uint32_t taps) {
+    float peak = 0.0f;
+    for (size_t s = 0; s < windows; s++) {
+        for (uint32_t p = 0; p < phases; p++) {
+            const float* c = coefficients + static_cast<size_t>(p) * taps;
+            float acc = 0.0f;
+            for (uint32_t k = 0; k < taps; k++) acc += c[k] * buf[s + k];
+            peak = std::max(peak, std::fabs(acc));
+        }
+    }
+    return peak;
+}
+
+#if defined(MUSICAPP_X86)
+inline void kWeightSse2(const float* in, size_t frames, uint16_t channels,
+                        const Biquad& s, const Biquad& h, float* state, float* sums) {
+    if (channels == 0 || channels > 4) {
+        kWeightScalar(in, frames, channels, s, h, state, sums);
+        return;
+    }
+    __m128 z1 = _mm_loadu_ps(state);
+    __m128 z2 = _mm_loadu_ps(state + kMaxChannels);
+    __m128 w1 = _mm_loadu_ps(state + 2 * kMaxChannels);
+    __m128 w2 = _mm_loadu_ps(state + 3 * kMaxChannels);
+    const __m128 sb0 = _mm_set1_ps(s.b0), sb1 = _mm_set1_ps(s.b1), sb2 = _mm_set1_ps(s.b2);
+    const __m128 sa1 = _mm_set1_ps(s.a1), sa2 = _mm_set1_ps(s.a2);
+    const __m128 hb0 = _mm_set1_ps(h.b0), hb1 = _mm_set1_ps(h.b1), hb2 = _mm_set1_ps(h.b2);
+    const __m128 ha1 = _mm_set1_ps(h.a1), ha2 = _mm_set1_ps(h.a2);
+    __m128 acc = _mm_setzero_ps();
+    float frame[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (size_t f = 0; f < frames; f++) {
+        const float* p = in + f * channels;
+        __m128 x;
+        if (channels == 2) {
+            x = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p));
+        } else if (channels == 4) {
+            x = _mm_loadu_ps(p);
+        } else if (channels == 1) {
+            x = _mm_load_ss(p);
+        } else {
+            std::memcpy(frame, p, channels * sizeof(float));
+            x = _mm_loadu_ps(frame);
+        }
+        __m128 y = _mm_add_ps(_mm_mul_ps(sb0, x), z1);
+        z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(sb1, x), _mm_mul_ps(sa1, y)), z2);
+        z2 = _mm_sub_ps(_mm_mul_ps(sb2, x), _mm_mul_ps(sa2, y));
+        __m128 v = _mm_add_ps(_mm_mul_ps(hb0, y), w1);
+        w1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(hb1, y), _mm_mul_ps(ha1, v)), w2);
+        w2 = _mm_sub_ps(_mm_mul_ps(hb2, y), _mm_mul_ps(ha2, v));
+        acc = _mm_add_ps(acc, _mm_mul_ps(v, v));
+    }
+    _mm_storeu_ps(state, z1);
+    _mm_storeu_ps(state + kMaxChannels, z2);
+    _mm_storeu_ps(state + 2 * kMaxChannels, w1);
+    _mm_storeu_ps(state + 3 * kMaxChannels, w2);
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    for (uint16_t c = 0; c < channels; c++) sums[c] += lanes[c];
+}
+
+// 相邻的 4 个窗口占向量的 4 条通道，逐相位累加
+inline float truePeakSse2(const float* buf, size_t windows, const float* coefficients,
+                          uint32_t phases, uint32_t taps) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 peak = _mm_setzero_ps();
+    size_t s = 0;
+    for (; s + 4 <= windows; s += 4) {
+        for (uint32_t p = 0; p < phases; p++) {
+            const float* c = coefficients + static_cast<size_t>(p) * taps;
+            __m128 acc0 = _mm_setzero_ps();
+            __m128 acc1 = _mm_setzero_ps();
+            uint32_t k = 0;
+            for (; k + 2 <= taps; k += 2) {
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_set1_ps(c[k]), _mm_loadu_ps(buf + s + k)));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_set1_ps(c[k + 1]), _mm_loadu_ps(buf + s + k + 1)));
+            }
+            for (; k < taps; k++) {
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_set1_ps(c[k]), _mm_loadu_ps(buf + s + k)));
+            }
+            peak = _mm_max_ps(peak, _mm_and_ps(_mm_add_ps(acc0, acc1), absMask));
+        }
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, peak);
+    float result = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    return std::max(result, truePeakScalar(buf + s, windows - s, coefficients, phases, taps));
+}
+
+MUSICAPP_TARGET_AVX2
+inline float truePeakAvx2(const float* buf, size_t windows, const float* coefficients,
+                          uint32_t phases, uint32_t taps) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 peak = _mm256_setzero_ps();
+    size_t s = 0;
+    for (; s + 8 <= windows; s += 8) {
+        for (uint32_t p = 0; p < phases; p++) {
+            const float* c = coefficients + static_cast<size_t>(p) * taps;
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            uint32_t k = 0;
+            for (; k + 2 <= taps; k += 2) {
+                acc0 = _mm256_fmadd_ps(_mm256_set1_ps(c[k]), _mm256_loadu_ps(buf + s + k), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_set1_ps(c[k + 1]), _mm256_loadu_ps(buf + s + k + 1), acc1);
+            }
+            for (; k < taps; k++) {
+                acc0 = _mm256_fmadd_ps(_mm256_set1_ps(c[k]), _mm256_loadu_ps(buf + s + k), acc0);
+            }
+            peak = _mm256_max_ps(peak, _mm256_and_ps(_mm256_add_ps(acc0, acc1), absMask));
+        }
+    }
+    __m128 h = _mm_max_ps(_mm256_castps256_ps128(peak), _mm256_extractf128_ps(peak, 1));
+    h = _mm_max_ps(h, _mm_movehl_ps(h, h));
+    h = _mm_max_ss(h, _mm_shuffle_ps(h, h, 1));
+    float result = _mm_cvtss_f32(h);
+    return std::max(result, truePeakScalar(buf + s, windows - s, coefficients, phases, taps));
+}
+#endif
+
+#if defined(MUSICAPP_NEON)
+inline void kWeightNeon(const float* in, size_t frames, uint16_t channels,
+                        const Biquad& s, const Biquad& h, float* state, float* sums) {
+    if (channels == 0 || channels > 4) {
+        kWeightScalar(in, frames, channels, s, h, state, sums);
+        return;
+    }
+    float32x4_t z1 = vld1q_f32(state);
+    float32x4_t z2 = vld1q_f32(state + kMaxChannels);
+    float32x4_t w1 = vld1q_f32(state + 2 * kMaxChannels);
+    float32x4_t w2 = vld1q_f32(state + 3 * kMaxChannels);
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    float frame[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (size_t f = 0; f < frames; f++) {
+        const float* p = in + f * channels;
+        float32x4_t x;
+        if (channels == 2) {
+            x = vcombine_f32(vld1_f32(p), vdup_n_f32(0.0f));
+        } else if (channels == 4) {
+            x = vld1q_f32(p);
+        } else {
+            std::memcpy(frame, p, channels * sizeof(float));
+            x = vld1q_f32(frame);
+        }
+        float32x4_t y = vfmaq_n_f32(z1, x, s.b0);
+        z1 = vfmaq_n_f32(vfmsq_f32(z2, y, vdupq_n_f32(s.a1)), x, s.b1);
+        z2 = vfmsq_f32(vmulq_n_f32(x, s.b2), y, vdupq_n_f32(s.a2));
+        float32x4_t v = vfmaq_n_f32(w1, y, h.b0);
+        w1 = vfmaq_n_f32(vfmsq_f32(w2, v, vdupq_n_f32(h.a1)), y, h.b1);
+        w2 = vfmsq_f32(vmulq_n_f32(y, h.b2), v, vdupq_n_f32(h.a2));
+        acc = vfmaq_f32(acc, v, v);
+    }
+    vst1q_f32(state, z1);
+    vst1q_f32(state + kMaxChannels, z2);
+    vst1q_f32(state + 2 * kMaxChannels, w1);
+    vst1q_f32(state + 3 * kMaxChannels, w2);
+    float lanes[4];
+    vst1q_f32(lanes, acc);
+    for (uint16_t c = 0; c < channels; c++) sums[c] += lanes[c];
+}
+
+inline float truePeakNeon(const float* buf, size_t windows, const float* coefficients,
+                          uint32_t phases, uint32_t taps) {
+    float32x4_t peak = vdupq_n_f32(0.0f);
+    size_t s = 0;
+    for (; s + 4 <= windows; s += 4) {
+        for (uint32_t p = 0; p < phases; p++) {
+            const float* c = coefficients + static_cast<size_t>(p) * taps;
+            float32x4_t acc = vdupq_n_f32(0.0f);
+            for (uint32_t k = 0; k < taps; k++) {
+                acc = vfmaq_n_f32(acc, vld1q_f32(buf + s + k), c[k]);
+            }
+            peak = vmaxq_f32(peak, vabsq_f32(acc));
+        }
+    }
+    return std::max(vmaxvq_f32(peak), truePeakScalar(buf + s, windows - s, coefficients, phases, taps));
+}
+#endif
+
+// 按指令集级别取内核（不支持的级别回退到标量）
+// K 计权是逐帧递推，向量通道对应声道，AVX2 与 SSE2 共用同一内核
+inline KernelSet select(SimdLevel level) {
+    if (!simdLevelSupported(level)) level = SimdLevel::Scalar;
+    switch (level) {
+#if defined(MUSICAPP_X86)
+        case SimdLevel::AVX2: return { kWeightSse2, truePeakAvx2 };
+        case SimdLevel::SSE2: return { kWeightSse2, truePeakSse2 };
+#endif
+#if defined(MUSICAPP_NEON)
+        case SimdLevel::NEON: return { kWeightNeon, truePeakNeon };
+#endif
+        default: break;
+    }
+    return { kWeightScalar, truePeakScalar };
+}
+
+} // namespace LoudnessKernels
+
+// 一首曲目的测量结果
+struct LoudnessResult {
+    double integrated = -std::numeric_limits<double>::infinity();  // 积分响度（LUFS）
+    double truePeak = 0.0;      // 真峰值（线性，满幅为 1）
+    double seconds = 0.0;       // 已测量的音频长度
+
+    double truePeakDb() const {
+        return truePeak > 0.0 ? 20.0 * std::log10(truePeak) : -std::numeric_limits<double>::infinity();
+    }
+};
+
+// EBU R128 / ITU-R BS.1770-4 响度计
+// K 计权后的平方按 100 ms 分段累加，400 ms 的测量块由相邻 4 段组成（75% 重叠），
+// 积分响度经 -70 LUFS 的绝对门限与低于平均值 10 LU 的相对门限筛选。
+// 真峰值用 4 倍过采样（与重采样器共用 16 抽头的多相滤波器组）并与样本峰值取大者
+class LoudnessMeter {
+public:
+    explicit LoudnessMeter(SimdLevel level = hostSimdLevel())
+        : kernels_(LoudnessKernels::select(level)) {}
+
+    // 声道数超过 kMaxChannels 时返回 false
+    bool reset(uint32_t sampleRate, uint16_t channels) {
+        if (sampleRate == 0 || channels == 0 || channels > LoudnessKernels::kMaxChannels) return false;
+        sampleRate_ = sampleRate;
+        channels_ = channels;
+        kWeightingFilters(sampleRate, shelf_, highPass_);
+        std::fill(std::begin(state_), std::end(state_), 0.0f);
+        std::fill(std::begin(sums_), std::end(sums_), 0.0f);
+        // 5.1 声道的环绕声道权重为 1.41，LFE 不计入；其余布局各声道权重为 1
+        for (uint16_t c = 0; c < channels; c++) {
+            weights_[c] = 1.0;
+            if (channels == 6) weights_[c] = c == 3 ? 0.0 : (c >= 4 ? 1.41 : 1.0);
+        }
+        segments_.clear();
+        segmentIndex_ = 0;
+        segmentPos_ = 0;
+        segmentLength_ = segmentEnd(0);
+        frames_ = 0;
+
+        oversampler_ = PolyphaseFilterBank::get(sampleRate, sampleRate * 4, ResamplerQuality::Fast);
+        planar_.assign(channels, std::vector<float>(oversampler_->taps - 1, 0.0f));
+        truePeak_ = 0.0f;
+        return true;
+    }
+
+    // 处理 frames 帧交错样本
+    void process(const float* in, size_t frames) {
+        frames_ += frames;
+        measurePeak(in, frames);
+        while (frames > 0) {
+            size_t n = std::min(frames, segmentLength_ - segmentPos_);
+            kernels_.kWeight(in, n, channels_, shelf_, highPass_, state_, sums_);
+            in += n * channels_;
+            frames -= n;
+            segmentPos_ += n;
+            if (segmentPos_ == segmentLength_) finishSegment();
+        }
+    }
+
+    LoudnessResult result() const {
+        LoudnessResult r;
+        r.truePeak = truePeak_;
+        r.seconds = static_cast<double>(frames_) / sampleRate_;
+
+        // 400 ms 块的加权均方值
+        std::vector<double> blocks;
+        if (segments_.size() >= 4) {
+            blocks.reserve(segments_.size() - 3);
+            for (size_t j = 0; j + 4 <= segments_.size(); j++) {
+                double energy = 0.0;
+                double frames = 0.0;
+                for (size_t i = j; i < j + 4; i++) {
+                    energy += segments_[i].energy;
+                    frames += segments_[i].frames;
+                }
+                blocks.push_back(energy / frames);
+            }
+        }
+        const double absoluteGate = loudnessToPower(-70.0);
+        double sum = 0.0;
+        size_t count = 0;
+        for (double b : blocks) {
+            if (b > absoluteGate) {
+                sum += b;
+                count++;
+            }
+        }
+        if (count == 0) return r;
+        double relativeGate = std::max(absoluteGate, sum / count * 0.1);     // -10 LU
+        sum = 0.0;
+        count = 0;
+        for (double b : blocks) {
+            if (b > relativeGate) {
+                sum += b;
+                count++;
+            }
+        }
+        if (count > 0) r.integrated = powerToLoudness(sum / count);
+        return r;
+    }
+
+    static double powerToLoudness(double power) { return -0.691 + 10.0 * std::log10(power); }
+    static double loudnessToPower(double lufs) { return std::pow(10.0, (lufs + 0.691) / 10.0); }
+
+private:
+    struct Segment {
+        double energy;      // 各声道加权的平方和
+        uint32_t frames;
+    };
+
+    // 第 k 段的长度：段边界取 round(k * rate / 10)，采样率不是 10 的倍数时各段相差一帧
+    size_t segmentEnd(uint64_t k) const {
+        return static_cast<size_t>(((k + 1) * sampleRate_ + 5) / 10 - (k * sampleRate_ + 5) / 10);
+    }
+
+    void finishSegment() {
+        double energy = 0.0;
+        for (uint16_t c = 0; c < channels_; c++) {
+            energy += weights_[c] * sums_[c];
+            sums_[c] = 0.0f;
+        }
+        segments_.push_back({ energy, static_cast<uint32_t>(segmentLength_) });
+        segmentIndex_++;
+        segmentPos_ = 0;
+        segmentLength_ = segmentEnd(segmentIndex_);
+    }
+
+    // 逐声道拆成连续样本，接在上一块留下的 taps - 1 个样本之后做过采样
+    void measurePeak(const float* in, size_t frames) {
+        const uint32_t taps = oversampler_->taps;
+        float samplePeak = truePeak_;
+        for (uint16_t c = 0; c < channels_; c++) {
+            std::vector<float>& buf = planar_[c];
+            size_t base = buf.size();
+            buf.resize(base + frames);
+            for (size_t f = 0; f < frames; f++) {
+                float x = in[f * channels_ + c];
+                buf[base + f] = x;
+                samplePeak = std::max(samplePeak, std::fabs(x));
+            }
+            size_t windows = buf.size() - (taps - 1);
+            truePeak_ = std::max(truePeak_, kernels_.truePeak(buf.data(), windows,
+                                                              oversampler_->coefficients.data(),
+                                                              oversampler_->phases, taps));
+            buf.erase(buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(windows));
+        }
+        truePeak_ = std::max(truePeak_, samplePeak);
+    }
+
+    LoudnessKernels::KernelSet kernels_;
+    uint32_t sampleRate_ = 0;
+    uint16_t channels_ = 0;
+    Biquad shelf_;
+    Biquad highPass_;
+    float state_[4 * LoudnessKernels::kMaxChannels] = {};
+    float sums_[LoudnessKernels::kMaxChannels] = {};        // 当前段内各声道的平方和
+    double weights_[LoudnessKernels::kMaxChannels] = {};
+    std::vector<Segment> segments_;
+    uint64_t segmentIndex_ = 0;
+    size_t segmentPos_ = 0;
+    size_t segmentLength_ = 0;
+    uint64_t frames_ = 0;
+    std::shared_ptr<const PolyphaseFilterBank> oversampler_;
+    std::vector<std::vector<float>> planar_;
+    float truePeak_ = 0.0f;
+};
+
+// 解码整首曲目并测量；无法解码或 cancel 被置位时返回 false
+// 在线程池的工作线程上运行：开启非规格化数清零，避免滤波器在静音段衰减到非规格化数时变慢；
+// 传入 pool 时 FLAC 曲目在同一线程池上按帧并行解码
+inline bool analyzeTrackLoudness(const std::string& filepath, LoudnessResult& result,
+                                 const std::atomic<bool>* cancel = nullptr, WorkStealingPool* pool = nullptr) {
+    std::unique_ptr<AudioDecoder> decoder = openAudioDecoder(filepath, pool);
+    if (!decoder) return false;
+    LoudnessMeter meter;
+    if (!meter.reset(decoder->getSampleRate(), decoder->getChannels())) return false;
+    enableFlushDenormals();
+    const size_t kChunkFrames = 8192;
+    std::vector<float> buffer(kChunkFrames * decoder->getChannels());
+    size_t got;
+    while ((got = decoder->read(buffer.data(), kChunkFrames)) > 0) {
+        meter.process(buffer.data(), got);
+        if (cancel && cancel->load(std::memory_order_relaxed)) return false;
+    }
+    result = meter.result();
+    return true;
+}
+
+} // namespace MusicApp
+
+#endif // LOUDNESS_METER_H
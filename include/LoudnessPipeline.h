@@ -0,0 +1,109 @@
+#ifndef LOUDNESS_PIPELINE_H
+#define LOUDNESS_PIPELINE_H
+
+#include "LoudnessMeter.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace MusicApp {
+
+// 响度分析结果，id 为提交时的曲目编号
+struct LoudnessAnalysis {
+    size_t id = 0;
+    std::string filepath;
+    LoudnessResult result;
+    bool ok = false;            // false：无法解码（格式不支持或文件损坏）
+    bool cancelled = false;     // 分析被中止，曲目保持未分析状态
+};
+
+// 批量分析的进度
+struct LoudnessScanProgress {
+    bool running = false;
+    size_t total = 0;           // 本次分析开始时尚未分析的曲目数
+    size_t analyzed = 0;
+    size_t failed = 0;          // 无法解码，记为无法测量
+    double seconds = 0.0;       // 已用时间
+    double audioSeconds = 0.0;  // 已测量的音频长度
+
+    size_t remaining() const {
+        size_t done = analyzed + failed;
+        return total > done ? total - done : 0;
+    }
+    double tracksPerMinute() const {
+        return seconds > 0.0 ? (analyzed + failed) * 60.0 / seconds : 0.0;
+    }
+};
+
+// 有界的后台响度分析流水线
+// 与 MetadataPipeline 相同：每首曲目一个任务，在共享线程池上并行解码与测量，
+// 已提交但未取回的任务数不超过 capacity，结果由调用方在自己的线程中取回。
+// cancel() 让正在测量的任务在下一个解码块后退出，尚未开始的任务直接返回
+class LoudnessPipeline {
+public:
+    explicit LoudnessPipeline(WorkStealingPool& pool, size_t capacity = 64)
+        : pool_(pool), group_(pool), capacity_(capacity) {}
+
+    LoudnessPipeline(const LoudnessPipeline&) = delete;
+    LoudnessPipeline& operator=(const LoudnessPipeline&) = delete;
+
+    ~LoudnessPipeline() {
+        cancel();
+        group_.wait();
+    }
+
+    size_t available() const {
+        size_t used = outstanding_.load();
+        return used < capacity_ ? capacity_ - used : 0;
+    }
+
+    size_t outstanding() const { return outstanding_.load(); }
+
+    void cancel() { cancelled_.store(true); }
+
+    void submit(size_t id, std::string filepath) {
+        outstanding_++;
+        group_.run([this, id, path = std::move(filepath)]() mutable {
+            LoudnessAnalysis analysis;
+            analysis.id = id;
+            if (cancelled_.load(std::memory_order_relaxed)) {
+                analysis.cancelled = true;
+            } else {
+                analysis.ok = analyzeTrackLoudness(path, analysis.result, &cancelled_, &pool_);
+                analysis.cancelled = !analysis.ok && cancelled_.load(std::memory_order_relaxed);
+            }
+            analysis.filepath = std::move(path);
+            std::lock_guard<std::mutex> lock(mutex_);
+            completed_.push_back(std::move(analysis));
+        });
+    }
+
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        std::vector<LoudnessAnalysis> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batch.swap(completed_);
+        }
+        for (auto& analysis : batch) {
+            fn(analysis);
+        }
+        outstanding_ -= batch.size();
+        return batch.size();
+    }
+
+private:
+    WorkStealingPool& pool_;
+    TaskGroup group_;
+    const size_t capacity_;
+    std::atomic<bool> cancelled_{ false };
+    std::atomic<size_t> outstanding_{ 0 };
+    std::mutex mutex_;
+    std::vector<LoudnessAnalysis> completed_;
+};
+
+} // namespace MusicApp
+
+#endif // LOUDNESS_PIPELINE_H
@@ -0,0 +1,104 @@
+#ifndef MAPPED_WAV_DECODER_H
+#define MAPPED_WAV_DECODER_H
+
+#include "AudioDecoder.h"
+#include "MappedFile.h"
+#include "WavDecoder.h"
+#include <algorithm>
+
+namespace MusicApp {
+
+// 基于内存映射的零拷贝 WAV 解码器
+// 原地解析 RIFF 块，readSpan 直接返回映射内存中的样本；seek 只是指针计算
+class MappedWavDecoder : public AudioDecoder {
+public:
+    MappedWavDecoder() = default;
+    MappedWavDecoder(const MappedWavDecoder&) = delete;
+    MappedWavDecoder& operator=(const MappedWavDecoder&) = delete;
+
+    bool open(const std::string& filepath) override {
+        if (!file_.open(filepath)) return false;
+        if (!parseWavHeader(file_.data(), file_.size(), format_)) {
+            file_.close();
+            return false;
+        }
+        samples_ = file_.data() + format_.dataOffset;
+        totalFrames_ = format_.dataSize / format_.blockAlign;
+        framePos_ = 0;
+        advise(true);
+        return true;
+    }
+
+    uint32_t getSampleRate() const override { return format_.sampleRate; }
+    uint16_t getChannels() const override { return format_.channels; }
+    uint64_t getTotalFrames() const override { return totalFrames_; }
+    uint64_t tell() const override { return framePos_; }
+
+    bool readSpan(size_t frames, PcmSpan& span) override {
+        uint64_t remaining = totalFrames_ - framePos_;
+        if (frames > remaining) frames = static_cast<size_t>(remaining);
+        if (randomAccess_) {
+            // 定位后恢复顺序预读
+            advise(true);
+        }
+        span.data = samples_ + framePos_ * format_.blockAlign;
+        span.frames = frames;
+        span.encoding = format_.encoding;
+        framePos_ += frames;
+        return true;
+    }
+
+    bool supportsSpans() const override { return true; }
+
+    size_t read(float* out, size_t frames) override {
+        PcmSpan span;
+        readSpan(frames, span);
+        convertPcmSamples(span.data, span.encoding, span.frames * format_.channels, out);
+        return span.frames;
+    }
+
+    bool seek(uint64_t frame) override {
+        // 定位为 O(1) 指针计算；定位期间改为随机访问提示，避免内核无效预读
+        framePos_ = std::min(frame, totalFrames_);
+        advise(false);
+        return true;
+    }
+
+    const WavFormat& getFormat() const { return format_; }
+
+private:
+    // 映射的打开与关闭由 MappedFile 负责，这里只设置访问提示
+#ifdef _WIN32
+    void advise(bool sequential) {
+        randomAccess_ = !sequential;
+    }
+#else
+    void advise(bool sequential) {
+        void* addr = const_cast<unsigned char*>(file_.data());
+        uint64_t size = file_.size();
+        if (sequential) {
+            madvise(addr, static_cast<size_t>(size), MADV_SEQUENTIAL);
+        } else {
+            madvise(addr, static_cast<size_t>(size), MADV_RANDOM);
+            // 预取定位点附近的页，使定位后的第一次读取不发生缺页等待
+            uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+            uint64_t offset = (format_.dataOffset + framePos_ * format_.blockAlign) / page * page;
+            uint64_t length = std::min<uint64_t>(256 * 1024, size - offset);
+            madvise(static_cast<char*>(addr) + offset,
+                    static_cast<size_t>(length), MADV_WILLNEED);
+        }
+        randomAccess_ = !sequential;
+    }
+#endif
+
+    MappedFile file_;
+    const unsigned char* samples_ = nullptr;
+    WavFormat format_;
+    uint64_t totalFrames_ = 0;
+    uint64_t framePos_ = 0;
+    bool randomAccess_ = false;
+};
+
+} // namespace MusicApp
+
+#endif // MAPPED_WAV_DECODER_H
@@ -0,0 +1,101 @@
+#ifndef MD5_H
+#define MD5_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace MusicApp {
+
+// MD5（RFC 1321），用于核对 FLAC STREAMINFO 中未编码样本的签名
+class Md5 {
+public:
+    Md5() { reset(); }
+
+    void reset() {
+        state_[0] = 0x67452301u;
+        state_[1] = 0xEFCDAB89u;
+        state_[2] = 0x98BADCFEu;
+        state_[3] = 0x10325476u;
+        length_ = 0;
+        buffered_ = 0;
+    }
+
+    void update(const void* data, size_t len) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        length_ += len;
+        if (buffered_ > 0) {
+            size_t n = std::min(len, sizeof(buffer_) - buffered_);
+            std::memcpy(buffer_ + buffered_, p, n);
+            buffered_ += n;
+            p += n;
+            len -= n;
+            if (buffered_ < sizeof(buffer_)) return;
+            transform(buffer_);
+            buffered_ = 0;
+        }
+        for (; len >= 64; p += 64, len -= 64) transform(p);
+        std::memcpy(buffer_, p, len);
+        buffered_ = len;
+    }
+
+    void finish(unsigned char digest[16]) {
+        uint64_t bits = length_ * 8;
+        unsigned char pad[72] = { 0x80 };
+        size_t padLen = (buffered_ < 56 ? 56 : 120) - buffered_;
+        for (int i = 0; i < 8; i++) pad[padLen + i] = static_cast<unsigned char>(bits >> (8 * i));
+        update(pad, padLen + 8);
+        for (int i = 0; i < 4; i++) {
+            for (int b = 0; b < 4; b++) digest[4 * i + b] = static_cast<unsigned char>(state_[i] >> (8 * b));
+        }
+    }
+
+private:
+    static uint32_t rotl(uint32_t x, int c) { return (x << c) | (x >> (32 - c)); }
+
+    void transform(const unsigned char* block) {
+        static const uint32_t kSine[64] = {
+            0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+            0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+            0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+            0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+            0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+            0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+            0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+            0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391 };
+        static const int kShift[16] = { 7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21 };
+        uint32_t m[16];
+        for (int i = 0; i < 16; i++) {
+            m[i] = static_cast<uint32_t>(block[4 * i]) | (static_cast<uint32_t>(block[4 * i + 1]) << 8) |
+                   (static_cast<uint32_t>(block[4 * i + 2]) << 16) | (static_cast<uint32_t>(block[4 * i + 3]) << 24);
+        }
+        uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+        for (int i = 0; i < 64; i++) {
+            uint32_t f;
+            int g;
+            if (i < 16) { f = (b & c) | (~b & d); g = i; }
+            else if (i < 32) { f = (d & b) | (~d & c); g = (5 * i + 1) & 15; }
+            else if (i < 48) { f = b ^ c ^ d; g = (3 * i + 5) & 15; }
+            else { f = c ^ (b | ~d); g = (7 * i) & 15; }
+            uint32_t next = d;
+            d = c;
+            c = b;
+            b = b + rotl(a + f + kSine[i] + m[g], kShift[(i / 16) * 4 + (i & 3)]);
+            a = next;
+        }
+        state_[0] += a;
+        state_[1] += b;
+        state_[2] += c;
+        state_[3] += d;
+    }
+
+    uint32_t state_[4];
+    uint64_t length_;
+    unsigned char buffer_[64];
+    size_t buffered_;
+};
+
+} // namespace MusicApp
+
+#endif // MD5_H
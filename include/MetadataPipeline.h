@@ -0,0 +1,82 @@
+#ifndef METADATA_PIPELINE_H
+#define METADATA_PIPELINE_H
+
+#include "MetadataReader.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace MusicApp {
+
+// 元数据读取结果，id 为提交时的曲目编号
+struct MetadataResult {
+    size_t id = 0;
+    std::string filepath;
+    TrackMetadata metadata;
+    bool ok = false;
+};
+
+// 有界的后台元数据流水线
+// 读取任务在共享线程池上执行；已提交但未取回的任务数不超过 capacity，
+// 结果由调用方在自己的线程中取回并写入曲目，工作线程从不触碰播放列表
+class MetadataPipeline {
+public:
+    explicit MetadataPipeline(WorkStealingPool& pool, size_t capacity = 256)
+        : group_(pool), capacity_(capacity) {}
+
+    MetadataPipeline(const MetadataPipeline&) = delete;
+    MetadataPipeline& operator=(const MetadataPipeline&) = delete;
+
+    ~MetadataPipeline() {
+        group_.wait();
+    }
+
+    // 还可提交的任务数
+    size_t available() const {
+        size_t used = outstanding_.load();
+        return used < capacity_ ? capacity_ - used : 0;
+    }
+
+    // 尚未取回的任务数（含正在读取的）
+    size_t outstanding() const { return outstanding_.load(); }
+
+    void submit(size_t id, std::string filepath) {
+        outstanding_++;
+        group_.run([this, id, path = std::move(filepath)]() mutable {
+            MetadataResult result;
+            result.id = id;
+            result.ok = readTrackMetadata(path, result.metadata);
+            result.filepath = std::move(path);
+            std::lock_guard<std::mutex> lock(mutex_);
+            completed_.push_back(std::move(result));
+        });
+    }
+
+    // 取回已完成的结果并逐个交给 fn，返回数量
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        std::vector<MetadataResult> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batch.swap(completed_);
+        }
+        for (auto& result : batch) {
+            fn(result);
+        }
+        outstanding_ -= batch.size();
+        return batch.size();
+    }
+
+private:
+    TaskGroup group_;
+    const size_t capacity_;
+    std::atomic<size_t> outstanding_{ 0 };
+    std::mutex mutex_;
+    std::vector<MetadataResult> completed_;
+};
+
+} // namespace MusicApp
+
+#endif // METADATA_PIPELINE_H
@@ -0,0 +1,589 @@
+#ifndef METADATA_READER_H
+#define METADATA_READER_H
+
+#include "AudioDecoder.h"
+#include "AudioFormat.h"
+#include "Playlist.h"
+#include "WavDecoder.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MusicApp {
+
+// 从文件头部读取的曲目元数据
+struct TrackMetadata {
+    std::string title;
+    std::string artist;
+    float duration = 0.0f;      // 秒，0 表示未知
+};
+
+namespace Metadata {
+
+inline uint32_t readBE32(const unsigned char* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline uint64_t readBE64(const unsigned char* p) {
+    return (static_cast<uint64_t>(readBE32(p)) << 32) | readBE32(p + 4);
+}
+
+// 文件头给出的时长只在合理范围内采用，否则与未知时长一样记为 0：
+// 采样率须不低于 kMinSampleRate（MP4 的时间刻度另行放宽到 1），时长不超过 kMaxDuration 秒
+constexpr double kMinSampleRate = 1000.0;
+constexpr double kMaxDuration = 1e6;
+
+inline float plausibleDuration(double seconds) {
+    return seconds > 0.0 && seconds <= kMaxDuration ? static_cast<float>(seconds) : 0.0f;
+}
+
+inline float plausibleDuration(double units, double rate, double minRate = kMinSampleRate) {
+    return rate >= minRate ? plausibleDuration(units / rate) : 0.0f;
+}
+
+// 按偏移读取的文件，只做少量小块读取（不经过流缓冲，每次读取一次系统调用）
+class SourceFile {
+public:
+    SourceFile() = default;
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+
+    ~SourceFile() {
+#ifdef _WIN32
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+#else
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+
+    bool open(const std::string& path) {
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size)) return false;
+        size_ = static_cast<uint64_t>(size.QuadPart);
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) return false;
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) return false;
+        size_ = static_cast<uint64_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    uint64_t size() const { return size_; }
+
+    // 读取 [offset, offset + len)，超出文件末尾的部分被截断
+    size_t readAt(uint64_t offset, void* buf, size_t len) {
+        if (offset >= size_) return 0;
+        len = static_cast<size_t>(std::min<uint64_t>(len, size_ - offset));
+#ifdef _WIN32
+        OVERLAPPED ov = {};
+        ov.Offset = static_cast<DWORD>(offset);
+        ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD got = 0;
+        if (!ReadFile(file_, buf, static_cast<DWORD>(len), &got, &ov)) return 0;
+        return got;
+#else
+        size_t total = 0;
+        while (total < len) {
+            ssize_t n = ::pread(fd_, static_cast<char*>(buf) + total, len - total,
+                                static_cast<off_t>(offset + total));
+            if (n <= 0) break;
+            total += static_cast<size_t>(n);
+        }
+        return total;
+#endif
+    }
+
+    std::vector<unsigned char> readBlock(uint64_t offset, size_t len) {
+        std::vector<unsigned char> buf(len);
+        buf.resize(readAt(offset, buf.data(), len));
+        return buf;
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+#else
+    int fd_ = -1;
+#endif
+    uint64_t size_ = 0;
+};
+
+inline void appendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+inline std::string latin1ToUtf8(const unsigned char* p, size_t len) {
+    std::string out;
+    for (size_t i = 0; i < len && p[i] != 0; i++) {
+        appendUtf8(out, p[i]);
+    }
+    return out;
+}
+
+inline std::string utf16ToUtf8(const unsigned char* p, size_t len, bool bigEndian) {
+    std::string out;
+    for (size_t i = 0; i + 1 < len; i += 2) {
+        uint32_t unit = bigEndian ? (p[i] << 8) | p[i + 1] : p[i] | (p[i + 1] << 8);
+        if (unit == 0) break;
+        if (unit >= 0xD800 && unit < 0xDC00 && i + 3 < len) {
+            uint32_t low = bigEndian ? (p[i + 2] << 8) | p[i + 3] : p[i + 2] | (p[i + 3] << 8);
+            if (low >= 0xDC00 && low < 0xE000) {
+                unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                i += 2;
+            }
+        }
+        appendUtf8(out, unit);
+    }
+    return out;
+}
+
+// 去掉尾部的 0 与空白（ID3v1 用空格或 0 填充）
+inline std::string trimmed(std::string s) {
+    while (!s.empty() && (s.back() == '\0' || s.back() == ' ')) s.pop_back();
+    return s;
+}
+
+// ID3v2 文本帧：首字节为编码
+inline std::string decodeId3Text(const unsigned char* p, size_t len) {
+    if (len == 0) return "";
+    unsigned char encoding = p[0];
+    p++;
+    len--;
+    switch (encoding) {
+        case 0: return trimmed(latin1ToUtf8(p, len));
+        case 1:
+            if (len >= 2 && p[0] == 0xFE && p[1] == 0xFF) return trimmed(utf16ToUtf8(p + 2, len - 2, true));
+            if (len >= 2 && p[0] == 0xFF && p[1] == 0xFE) return trimmed(utf16ToUtf8(p + 2, len - 2, false));
+            return trimmed(utf16ToUtf8(p, len, false));
+        case 2: return trimmed(utf16ToUtf8(p, len, true));
+        case 3: return trimmed(std::string(reinterpret_cast<const char*>(p),
+                                           strnlen(reinterpret_cast<const char*>(p), len)));
+        default: return "";
+    }
+}
+
+// 解析 ID3v2.2/2.3/2.4 中的标题、艺术家与 TLEN（毫秒）
+inline void parseId3v2(const std::vector<unsigned char>& tag, TrackMetadata& meta) {
+    if (tag.size() < 10) return;
+    unsigned char version = tag[3];
+    unsigned char flags = tag[5];
+    size_t end = std::min<size_t>(tag.size(), 10 + readSyncsafe32(tag.data() + 6));
+    size_t pos = 10;
+    if ((flags & 0x40) && version >= 3 && pos + 4 <= end) {
+        // 扩展头
+        uint32_t extSize = version == 4 ? readSyncsafe32(tag.data() + pos) : readBE32(tag.data() + pos) + 4;
+        pos += extSize;
+    }
+
+    const size_t idLen = version == 2 ? 3 : 4;
+    const size_t headerLen = version == 2 ? 6 : 10;
+    while (pos + headerLen <= end) {
+        const unsigned char* h = tag.data() + pos;
+        if (h[0] == 0) break;   // 填充
+        uint32_t size;
+        if (version == 2) {
+            size = (h[3] << 16) | (h[4] << 8) | h[5];
+        } else if (version == 4) {
+            size = readSyncsafe32(h + 4);
+        } else {
+            size = readBE32(h + 4);
+        }
+        size_t body = pos + headerLen;
+        if (size > end - body) break;
+        std::string id(reinterpret_cast<const char*>(h), idLen);
+        const unsigned char* data = tag.data() + body;
+        if (id == "TIT2" || id == "TT2") {
+            meta.title = decodeId3Text(data, size);
+        } else if (id == "TPE1" || id == "TP1") {
+            meta.artist = decodeId3Text(data, size);
+        } else if ((id == "TLEN" || id == "TLE") && meta.duration == 0.0f) {
+            std::string ms = decodeId3Text(data, size);
+            char* endp = nullptr;
+            double v = std::strtod(ms.c_str(), &endp);
+            if (endp != ms.c_str()) meta.duration = plausibleDuration(v / 1000.0);
+        }
+        pos = body + size;
+    }
+}
+
+// ---- MP3 ----
+
+// 由首帧（Xing/Info/VBRI 头或恒定码率）估算时长
+inline float mp3Duration(SourceFile& file, const std::vector<unsigned char>& head,
+                         uint64_t audioStart, uint64_t audioEnd) {
+    // 标签较短时首帧已在文件头缓冲中，无需再读
+    std::vector<unsigned char> buf = audioStart + 4096 <= head.size()
+        ? std::vector<unsigned char>(head.begin() + static_cast<size_t>(audioStart), head.end())
+        : file.readBlock(audioStart, 16 * 1024);
+    for (size_t i = 0; i + 4 <= buf.size(); i++) {
+        MpegFrameHeader h;
+        if (!parseMpegHeader(buf.data() + i, h)) continue;
+        // 下一帧也必须是有效帧头，避免误判
+        size_t next = i + h.frameBytes;
+        MpegFrameHeader h2;
+        if (next + 4 <= buf.size() && !parseMpegHeader(buf.data() + next, h2)) continue;
+
+        size_t xing = i + 4 + h.sideInfoBytes;
+        if (xing + 12 <= buf.size() &&
+            (std::memcmp(buf.data() + xing, "Xing", 4) == 0 ||
+             std::memcmp(buf.data() + xing, "Info", 4) == 0)) {
+            uint32_t flags = readBE32(buf.data() + xing + 4);
+            if (flags & 1) {
+                uint32_t frames = readBE32(buf.data() + xing + 8);
+                return plausibleDuration(double(frames) * h.samplesPerFrame, h.sampleRate);
+            }
+        }
+        size_t vbri = i + 4 + 32;
+        if (vbri + 18 <= buf.size() && std::memcmp(buf.data() + vbri, "VBRI", 4) == 0) {
+            uint32_t frames = readBE32(buf.data() + vbri + 14);
+            return plausibleDuration(double(frames) * h.samplesPerFrame, h.sampleRate);
+        }
+        uint64_t bytes = audioEnd > audioStart + i ? audioEnd - audioStart - i : 0;
+        return plausibleDuration(double(bytes) * 8.0, h.bitrate, 1.0);
+    }
+    return 0.0f;
+}
+
+inline bool readMp3(SourceFile& file, const std::vector<unsigned char>& head, TrackMetadata& meta) {
+    uint64_t tagSize = id3v2Size(head.data(), head.size());
+    if (tagSize > 0) {
+        std::vector<unsigned char> tag = tagSize <= head.size()
+            ? std::vector<unsigned char>(head.begin(), head.begin() + static_cast<size_t>(tagSize))
+            : file.readBlock(0, static_cast<size_t>(std::min<uint64_t>(tagSize, 1 << 20)));
+        parseId3v2(tag, meta);
+    }
+
+    uint64_t audioEnd = file.size();
+    unsigned char v1[128];
+    if (file.size() >= 128 + tagSize && file.readAt(file.size() - 128, v1, 128) == 128 &&
+        std::memcmp(v1, "TAG", 3) == 0) {
+        audioEnd -= 128;
+        if (meta.title.empty()) meta.title = trimmed(latin1ToUtf8(v1 + 3, 30));
+        if (meta.artist.empty()) meta.artist = trimmed(latin1ToUtf8(v1 + 33, 30));
+    }
+    if (meta.duration == 0.0f) {
+        meta.duration = mp3Duration(file, head, tagSize, audioEnd);
+    }
+    return tagSize > 0 || meta.duration > 0.0f;
+}
+
+// ---- Vorbis 注释（FLAC / Ogg 共用） ----
+
+inline void parseVorbisComments(const unsigned char* p, size_t len, TrackMetadata& meta) {
+    if (len < 8) return;
+    uint32_t vendorLen = readLE32(p);
+    size_t pos = 4 + static_cast<size_t>(vendorLen);
+    if (pos + 4 > len) return;
+    uint32_t count = readLE32(p + pos);
+    pos += 4;
+    for (uint32_t i = 0; i < count && pos + 4 <= len; i++) {
+        uint32_t n = readLE32(p + pos);
+        pos += 4;
+        if (n > len - pos) break;
+        std::string entry(reinterpret_cast<const char*>(p + pos), n);
+        pos += n;
+        size_t eq = entry.find('=');
+        if (eq == std::string::npos) continue;
+        std::string key = entry.substr(0, eq);
+        std::transform(key.begin(), key.end(), key.begin(), ::toupper);
+        if (key == "TITLE" && meta.title.empty()) {
+            meta.title = entry.substr(eq + 1);
+        } else if (key == "ARTIST" && meta.artist.empty()) {
+            meta.artist = entry.substr(eq + 1);
+        }
+    }
+}
+
+// ---- FLAC ----
+
+inline bool readFlac(SourceFile& file, uint64_t start, TrackMetadata& meta) {
+    uint64_t pos = start + 4;
+    bool haveInfo = false;
+    while (true) {
+        unsigned char h[4];
+        if (file.readAt(pos, h, 4) != 4) break;
+        bool last = (h[0] & 0x80) != 0;
+        int type = h[0] & 0x7F;
+        uint32_t len = (h[1] << 16) | (h[2] << 8) | h[3];
+        if (type == 0 && len >= 34) {
+            // STREAMINFO：采样率 20 位，总采样数 36 位
+            std::vector<unsigned char> b = file.readBlock(pos + 4, 34);
+            if (b.size() == 34) {
+                uint32_t rate = (b[10] << 12) | (b[11] << 4) | (b[12] >> 4);
+                uint64_t samples = (static_cast<uint64_t>(b[13] & 0x0F) << 32) | readBE32(b.data() + 14);
+                meta.duration = plausibleDuration(double(samples), rate);
+                haveInfo = true;
+            }
+        } else if (type == 4) {
+            std::vector<unsigned char> b = file.readBlock(pos + 4, std::min<uint32_t>(len, 1 << 20));
+            parseVorbisComments(b.data(), b.size(), meta);
+        }
+        pos += 4 + len;
+        if (last) break;
+    }
+    return haveInfo;
+}
+
+// ---- Ogg (Vorbis / Opus) ----
+
+// 从文件开头的若干页中重组前 count 个逻辑包（只跟踪第一个逻辑流）
+inline std::vector<std::vector<unsigned char>> oggPackets(const std::vector<unsigned char>& buf,
+                                                          size_t count) {
+    std::vector<std::vector<unsigned char>> packets(1);
+    size_t pos = 0;
+    uint32_t serial = 0;
+    bool first = true;
+    while (pos + 27 <= buf.size() && packets.size() <= count) {
+        if (std::memcmp(buf.data() + pos, "OggS", 4) != 0) break;
+        uint32_t pageSerial = readLE32(buf.data() + pos + 14);
+        size_t segments = buf[pos + 26];
+        size_t dataPos = pos + 27 + segments;
+        if (dataPos > buf.size()) break;
+        size_t bodyLen = 0;
+        for (size_t s = 0; s < segments; s++) bodyLen += buf[pos + 27 + s];
+        if (first) {
+            serial = pageSerial;
+            first = false;
+        }
+        if (pageSerial == serial) {
+            size_t p = dataPos;
+            for (size_t s = 0; s < segments && packets.size() <= count; s++) {
+                size_t lace = buf[pos + 27 + s];
+                if (p + lace > buf.size()) return packets;
+                packets.back().insert(packets.back().end(), buf.begin() + p, buf.begin() + p + lace);
+                p += lace;
+                if (lace < 255) packets.emplace_back();
+            }
+        }
+        pos = dataPos + bodyLen;
+    }
+    return packets;
+}
+
+// 最后一页的颗粒位置（总采样数）：先读文件末尾 8KB，找不到页头再扩大到最大页长
+inline uint64_t oggLastGranule(SourceFile& file) {
+    for (size_t tailSize : { size_t(8 * 1024), size_t(64 * 1024) }) {
+        uint64_t start = file.size() > tailSize ? file.size() - tailSize : 0;
+        std::vector<unsigned char> tail = file.readBlock(start, tailSize);
+        for (size_t i = tail.size() >= 27 ? tail.size() - 27 : 0; i-- > 0;) {
+            if (std::memcmp(tail.data() + i, "OggS", 4) == 0) {
+                uint64_t granule = readLE32(tail.data() + i + 6) |
+                                   (static_cast<uint64_t>(readLE32(tail.data() + i + 10)) << 32);
+                if (granule != ~0ULL) return granule;
+            }
+        }
+        if (start == 0) break;
+    }
+    return 0;
+}
+
+inline bool readOgg(SourceFile& file, const std::vector<unsigned char>& head, TrackMetadata& meta) {
+    std::vector<unsigned char> buf = head.size() >= 64 * 1024 ? head : file.readBlock(0, 64 * 1024);
+    auto packets = oggPackets(buf, 2);
+    if (packets.size() < 2) return false;
+    const auto& id = packets[0];
+    const auto& comments = packets[1];
+    if (id.size() >= 16 && id[0] == 1 && std::memcmp(id.data() + 1, "vorbis", 6) == 0) {
+        uint32_t rate = readLE32(id.data() + 12);
+        if (comments.size() > 7 && comments[0] == 3 && std::memcmp(comments.data() + 1, "vorbis", 6) == 0) {
+            parseVorbisComments(comments.data() + 7, comments.size() - 7, meta);
+        }
+        uint64_t granule = oggLastGranule(file);
+        meta.duration = plausibleDuration(double(granule), rate);
+        return true;
+    }
+    if (id.size() >= 19 && std::memcmp(id.data(), "OpusHead", 8) == 0) {
+        // Opus 颗粒位置固定为 48kHz，需扣除预跳过样本
+        uint16_t preSkip = readLE16(id.data() + 10);
+        if (comments.size() > 8 && std::memcmp(comments.data(), "OpusTags", 8) == 0) {
+            parseVorbisComments(comments.data() + 8, comments.size() - 8, meta);
+        }
+        uint64_t granule = oggLastGranule(file);
+        if (granule > preSkip) meta.duration = plausibleDuration(double(granule - preSkip), 48000.0);
+        return true;
+    }
+    return false;
+}
+
+// ---- MP4 / M4A ----
+
+// 在 [begin, end) 内查找子 atom，返回其数据区
+inline bool findAtom(const std::vector<unsigned char>& b, size_t begin, size_t end,
+                     const char* type, size_t& body, size_t& bodyEnd) {
+    size_t pos = begin;
+    while (pos + 8 <= end) {
+        uint64_t size = readBE32(b.data() + pos);
+        size_t header = 8;
+        if (size == 1 && pos + 16 <= end) {
+            size = readBE64(b.data() + pos + 8);
+            header = 16;
+        } else if (size == 0) {
+            size = end - pos;
+        }
+        if (size < header || size > end - pos) return false;
+        if (std::memcmp(b.data() + pos + 4, type, 4) == 0) {
+            body = pos + header;
+            bodyEnd = pos + static_cast<size_t>(size);
+            return true;
+        }
+        pos += static_cast<size_t>(size);
+    }
+    return false;
+}
+
+inline std::string mp4Text(const std::vector<unsigned char>& b, size_t begin, size_t end) {
+    size_t body, bodyEnd;
+    // 'data' atom：4 字节类型 + 4 字节区域设置，之后为 UTF-8 文本
+    if (!findAtom(b, begin, end, "data", body, bodyEnd) || bodyEnd - body < 8) return "";
+    return std::string(reinterpret_cast<const char*>(b.data() + body + 8), bodyEnd - body - 8);
+}
+
+inline bool readMp4(SourceFile& file, TrackMetadata& meta) {
+    // 顶层 atom 逐个跳过，只读取 moov（可能位于文件末尾）
+    uint64_t pos = 0;
+    while (pos < file.size() && file.size() - pos >= 8) {
+        unsigned char h[16];
+        size_t got = file.readAt(pos, h, 16);
+        if (got < 8) return false;
+        uint64_t size = readBE32(h);
+        uint64_t header = 8;
+        if (size == 1) {
+            if (got < 16) return false;
+            size = readBE64(h + 8);
+            header = 16;
+        } else if (size == 0) {
+            size = file.size() - pos;
+        }
+        // 与 findAtom 相同：超出文件的 size 会让 pos 回绕，必须在前进前拒绝
+        if (size < header || size > file.size() - pos) return false;
+        if (std::memcmp(h + 4, "moov", 4) == 0) {
+            if (size > (16u << 20)) return false;
+            std::vector<unsigned char> moov = file.readBlock(pos + header, static_cast<size_t>(size - header));
+            size_t body, end;
+            if (findAtom(moov, 0, moov.size(), "mvhd", body, end) && end - body >= 32) {
+                bool v1 = moov[body] == 1;
+                uint32_t timescale = readBE32(moov.data() + body + (v1 ? 20 : 12));
+                uint64_t duration = v1 && end - body >= 36 ? readBE64(moov.data() + body + 24)
+                                                           : readBE32(moov.data() + body + 16);
+                meta.duration = plausibleDuration(double(duration), timescale, 1.0);
+            }
+            size_t udta, udtaEnd, metaBody, metaEnd, ilst, ilstEnd;
+            if (findAtom(moov, 0, moov.size(), "udta", udta, udtaEnd) &&
+                findAtom(moov, udta, udtaEnd, "meta", metaBody, metaEnd) &&
+                findAtom(moov, metaBody + 4, metaEnd, "ilst", ilst, ilstEnd)) {     // meta 是 full box
+                size_t item, itemEnd;
+                if (findAtom(moov, ilst, ilstEnd, "\xA9nam", item, itemEnd)) {
+                    meta.title = mp4Text(moov, item, itemEnd);
+                }
+                if (findAtom(moov, ilst, ilstEnd, "\xA9" "ART", item, itemEnd)) {
+                    meta.artist = mp4Text(moov, item, itemEnd);
+                }
+            }
+            return true;
+        }
+        pos += size;
+    }
+    return false;
+}
+
+// ---- WAV ----
+
+inline bool readWav(SourceFile& file, TrackMetadata& meta) {
+    WavFormat fmt;
+    uint64_t pos = 12;
+    bool haveFmt = false;
+    while (pos + 8 <= file.size()) {
+        unsigned char h[8];
+        if (file.readAt(pos, h, 8) != 8) break;
+        uint32_t size = readLE32(h + 4);
+        if (std::memcmp(h, "fmt ", 4) == 0) {
+            std::vector<unsigned char> b = file.readBlock(pos + 8, std::min<uint32_t>(size, 64));
+            haveFmt = parseWavFmtChunk(b.data(), static_cast<uint32_t>(b.size()), fmt);
+        } else if (std::memcmp(h, "data", 4) == 0) {
+            uint64_t bytes = std::min<uint64_t>(size, file.size() - pos - 8);
+            if (haveFmt) {
+                meta.duration = plausibleDuration(double(bytes / fmt.blockAlign), fmt.sampleRate);
+            }
+        } else if (std::memcmp(h, "LIST", 4) == 0 && size >= 4) {
+            std::vector<unsigned char> b = file.readBlock(pos + 8, std::min<uint32_t>(size, 64 * 1024));
+            if (b.size() >= 4 && std::memcmp(b.data(), "INFO", 4) == 0) {
+                size_t p = 4;
+                while (p + 8 <= b.size()) {
+                    uint32_t n = readLE32(b.data() + p + 4);
+                    if (n > b.size() - p - 8) break;
+                    std::string value = trimmed(std::string(reinterpret_cast<const char*>(b.data() + p + 8),
+                                                            strnlen(reinterpret_cast<const char*>(b.data() + p + 8), n)));
+                    if (std::memcmp(b.data() + p, "INAM", 4) == 0) meta.title = value;
+                    if (std::memcmp(b.data() + p, "IART", 4) == 0) meta.artist = value;
+                    p += 8 + n + (n & 1);
+                }
+            }
+        }
+        pos += 8 + uint64_t(size) + (size & 1);
+    }
+    return haveFmt;
+}
+
+} // namespace Metadata
+
+// 读取文件头部的标签与时长：按内容识别格式，扩展名只作为 MP3 的后备判断
+inline bool readTrackMetadata(const std::string& path, TrackMetadata& meta) {
+    Metadata::SourceFile file;
+    if (!file.open(path)) return false;
+    std::vector<unsigned char> head = file.readBlock(0, 16 * 1024);
+    if (head.size() < 12) return false;
+
+    // FLAC 文件前可能带有 ID3v2 标签
+    uint64_t tagSize = Metadata::id3v2Size(head.data(), head.size());
+    unsigned char afterTag[4] = { 0, 0, 0, 0 };
+    if (tagSize > 0) file.readAt(tagSize, afterTag, 4);
+
+    switch (sniffAudioFormat(head.data(), head.size(), afterTag)) {
+        case AudioFormat::Flac: return Metadata::readFlac(file, tagSize, meta);
+        case AudioFormat::Ogg: return Metadata::readOgg(file, head, meta);
+        case AudioFormat::Wav: return Metadata::readWav(file, meta);
+        case AudioFormat::Mp4: return Metadata::readMp4(file, meta);
+        case AudioFormat::Mp3: return Metadata::readMp3(file, head, meta);
+        default: break;
+    }
+    // 文件头内没有找到帧头的 MP3（例如前面有较长的填充）
+    if (formatFromExtension(path) == AudioFormat::Mp3) {
+        return Metadata::readMp3(file, head, meta);
+    }
+    return false;
+}
+
+} // namespace MusicApp
+
+#endif // METADATA_READER_H
@@ -2,7 +2,17 @@
 #define MUSIC_PLAYER_H
 
 #include "AudioPlayer.h"
+#include "Instrumentation.h"
+#include "LibraryIndex.h"
+#include "LoudnessPipeline.h"
+#include "MetadataPipeline.h"
 #include "Playlist.h"
+#include "PlaylistRenderer.h"
+#include "Prefetcher.h"
+#include "ThreadPool.h"
+#include "WaveformRenderer.h"
+#include <chrono>
+#include <cmath>
 #include <memory>
 #include <iostream>
 #include <iomanip>
@@ -13,20 +23,61 @@ namespace MusicApp {
 // 音乐播放器控制器
 class MusicPlayer {
 public:
-    MusicPlayer(std::unique_ptr<AudioPlayer> player)
+    // sharedPool 非空时后台任务提交到调用方的线程池（多会话宿主中的各播放器共用），
+    // 线程池须比播放器存活更久
+    MusicPlayer(std::unique_ptr<AudioPlayer> player, WorkStealingPool* sharedPool = nullptr)
         : audioPlayer_(std::move(player)),
+          sharedPool_(sharedPool),
           loopMode_(LoopMode::None),
-          isRunning_(true) {
+          isRunning_(true),
+          gapless_(false) {
         // 设置播放结束回调
         audioPlayer_->setOnEndCallback([this]() {
             onTrackEnd();
         });
+        // 设置无缝切换回调
+        audioPlayer_->setOnTransitionCallback([this]() {
+            onTrackTransition();
+        });
+        // 设置后端事件回调
+        audioPlayer_->setOnEventCallback([this](const PlayerEvent& event) {
+            onPlayerEvent(event);
+        });
     }
     
     // 播放列表操作
     Playlist& getPlaylist() { return playlist_; }
     const Playlist& getPlaylist() const { return playlist_; }
     
+    // 曲库索引：映射索引文件并把曲目加入播放列表
+    bool openLibrary(const std::string& path, LibraryLoadStats* stats = nullptr) {
+        libraryPath_ = path;
+        if (!library_.load(path, getWorkerPool(), stats)) {
+            return false;
+        }
+        library_.appendTo(playlist_);
+        return true;
+    }
+    
+    // 写回曲库索引；未指定索引文件时返回 false
+    bool saveLibrary() {
+        if (libraryPath_.empty()) return false;
+        return library_.save(libraryPath_);
+    }
+    
+    bool hasLibrary() const { return !libraryPath_.empty(); }
+    const std::string& getLibraryPath() const { return libraryPath_; }
+    Library& getLibrary() { return library_; }
+    
+    // 扫描、曲库验证等后台任务共用的线程池（未指定共享线程池时在首次使用时创建）
+    WorkStealingPool& getWorkerPool() {
+        if (sharedPool_) return *sharedPool_;
+        if (!workerPool_) {
+            workerPool_ = std::make_unique<WorkStealingPool>();
+        }
+        return *workerPool_;
+    }
+    
     // 添加曲目并开始播放
     bool addAndPlay(const std::string& filepath) {
         playlist_.addTrack(filepath);
@@ -35,12 +86,27 @@ public:
     
     // 播放当前曲目
     bool playCurrentTrack() {
-        const TrackInfo* track = playlist_.getCurrentTrack();
+        MUSICAPP_PROBE(PlayTrack);
+        TrackView track = playlist_.getCurrentTrack();
         if (track) {
-            if (audioPlayer_->load(track->filepath)) {
+            audioPlayer_->setTrackGain(trackGain(track));
+            std::string path = track->filepath();
+            PrefetchState prefetched = prefetcher_ ? prefetcher_->claim(path) : PrefetchState::Cold;
+            auto loadStart = std::chrono::steady_clock::now();
+            bool loaded = false;
+            {
+                MUSICAPP_PROBE(Load);
+                loaded = audioPlayer_->load(path);
+            }
+            if (prefetcher_) prefetcher_->recordLoad(prefetched, secondsSince(loadStart));
+            if (loaded) {
                 audioPlayer_->play();
+                syncQueuedNext();
+                syncPrefetch();
+                requestWaveform(track);
                 return true;
             }
+            MUSICAPP_COUNT(LoadFailures, 1);
         }
         return false;
     }
@@ -104,10 +170,12 @@ public:
     
     // 进度控制
     void seek(float seconds) {
+        MUSICAPP_PROBE(Seek);
         audioPlayer_->seek(seconds);
     }
     
     void seekForward(float seconds = 10.0f) {
+        MUSICAPP_PROBE(Seek);
         float newPos = audioPlayer_->getCurrentTime() + seconds;
         float duration = audioPlayer_->getDuration();
         if (newPos < duration) {
@@ -116,6 +184,7 @@ public:
     }
     
     void seekBackward(float seconds = 10.0f) {
+        MUSICAPP_PROBE(Seek);
         float newPos = audioPlayer_->getCurrentTime() - seconds;
         if (newPos < 0) newPos = 0;
         audioPlayer_->seek(newPos);
@@ -141,6 +210,7 @@ public:
     // 循环模式
     void setLoopMode(LoopMode mode) {
         loopMode_ = mode;
+        applyCrossfade();
     }
     
     LoopMode getLoopMode() const {
@@ -159,6 +229,7 @@ public:
                 loopMode_ = LoopMode::None;
                 break;
         }
+        applyCrossfade();
     }
     
     // 随机播放
@@ -166,6 +237,182 @@ public:
         playlist_.setShuffle(!playlist_.isShuffleEnabled());
     }
     
+    // 无缝播放
+    void setGapless(bool enabled) {
+        gapless_ = enabled;
+        if (enabled) {
+            syncQueuedNext();
+        } else {
+            audioPlayer_->clearQueuedNext();
+        }
+    }
+    
+    bool isGapless() const { return gapless_; }
+    
+    // 预取（lookahead 为 0 时关闭）：按播放顺序把接下来的几首曲目的开头预读进页缓存
+    void setPrefetch(const PrefetchConfig& config) {
+        prefetchConfig_ = Prefetcher::clamped(config);
+        if (prefetchConfig_.lookahead == 0) {
+            prefetcher_.reset();
+        } else if (prefetcher_) {
+            prefetcher_->setConfig(prefetchConfig_);
+        } else {
+            prefetcher_ = std::make_unique<Prefetcher>(prefetchConfig_);
+        }
+        prefetchIds_.clear();
+        prefetchRevision_ = UINT64_MAX;
+        syncPrefetch();
+    }
+    
+    const PrefetchConfig& getPrefetchConfig() const { return prefetchConfig_; }
+    
+    // 未开启预取时返回 nullptr
+    const Prefetcher* getPrefetcher() const { return prefetcher_.get(); }
+    
+    // 交叉淡变（秒，0 关闭）：下一首按播放顺序（含随机顺序）预载，单曲循环时不淡变
+    // 后端不支持时返回 false
+    bool setCrossfade(float seconds) {
+        crossfade_ = std::isfinite(seconds) ? std::clamp(seconds, 0.0f, kMaxCrossfadeSeconds) : 0.0f;
+        if (!applyCrossfade()) {
+            crossfade_ = 0.0f;
+            return false;
+        }
+        syncQueuedNext();
+        return true;
+    }
+    
+    float getCrossfade() const { return crossfade_; }
+    
+    // 响度归一化：已分析的曲目按积分响度调整到 kTargetLoudness，并限制真峰值不超过 kPeakCeiling
+    // 未分析或无法测量的曲目保持原始电平；后端不支持曲目增益时返回 false
+    bool setNormalize(bool enabled) {
+        normalize_ = enabled;
+        if (!audioPlayer_->setTrackGain(trackGain(playlist_.getCurrentTrack()))) {
+            normalize_ = false;
+            return false;
+        }
+        // 已预载的下一首按新设置重新预载
+        if (!audioPlayer_->getQueuedNext().empty()) {
+            audioPlayer_->clearQueuedNext();
+            syncQueuedNext();
+        }
+        return true;
+    }
+    
+    bool isNormalize() const { return normalize_; }
+    
+    // 批量响度分析：在共享线程池上并行测量所有尚未分析的曲目，结果写入曲目与曲库索引
+    // 已分析的曲目跳过，中断（stopAnalysis 或退出）后再次开始即从剩余曲目继续
+    // 返回待分析的曲目数；没有待分析的曲目时不开始，保留上一次的进度
+    size_t startAnalysis() {
+        if (analysis_.running) return analysis_.remaining();
+        size_t total = 0;
+        for (size_t id = 0; id < playlist_.getTrackIdLimit(); id++) {
+            TrackView track = playlist_.getTrackById(id);
+            if (track && !track->loudness().analyzed) total++;
+        }
+        if (total == 0) return 0;
+        analysis_ = LoudnessScanProgress();
+        analysis_.running = true;
+        analysis_.total = total;
+        analysisCursor_ = 0;
+        analysisRevision_ = playlist_.getRevision();
+        analysisStart_ = std::chrono::steady_clock::now();
+        lastCheckpoint_ = analysisStart_;
+        loudness_ = std::make_unique<LoudnessPipeline>(getWorkerPool(), 4 * getWorkerPool().size());
+        return total;
+    }
+    
+    // 中止分析：已完成的结果保留，正在测量的曲目下次重新分析
+    void stopAnalysis() {
+        if (!analysis_.running) return;
+        finishAnalysis();
+        loudness_->cancel();
+    }
+    
+    LoudnessScanProgress getAnalysisProgress() const {
+        LoudnessScanProgress progress = analysis_;
+        if (progress.running) progress.seconds = secondsSince(analysisStart_);
+        return progress;
+    }
+    
+    // 波形缓存目录（首次使用缓存之前设置）
+    void setWaveformCacheDirectory(const std::string& directory) { waveformDirectory_ = directory; }
+    
+    // 是否为开始播放的曲目预先构建波形；默认关闭，只在 wave、定位预览与 wave build 时构建
+    void setWaveformAutoBuild(bool enabled) { waveformAutoBuild_ = enabled; }
+    
+    WaveformCache& getWaveformCache() {
+        if (!waveforms_) {
+            if (waveformDirectory_.empty()) waveformDirectory_ = defaultWaveformCacheDirectory();
+            waveforms_ = std::make_unique<WaveformCache>(getWorkerPool(), waveformDirectory_,
+                                                         2 * getWorkerPool().size());
+        }
+        return *waveforms_;
+    }
+    
+    // 当前曲目的波形；尚未构建时提交后台构建并返回 nullptr
+    std::shared_ptr<const WaveformPyramid> getCurrentWaveform() {
+        TrackView track = playlist_.getCurrentTrack();
+        if (!track) return nullptr;
+        std::string path = track->filepath();
+        auto pyramid = getWaveformCache().find(path);
+        if (!pyramid) getWaveformCache().submit(path, true);
+        return pyramid;
+    }
+    
+    // 返回的引用在下一次渲染前有效
+    const std::string& renderWaveform(const WaveformPyramid& pyramid, double from, double to, double position,
+                                      size_t width, size_t rows) const {
+        return waveRenderer_.render(pyramid, from, to, position, width, rows);
+    }
+    
+    const std::string& renderWaveformStrip(const WaveformPyramid& pyramid, double from, double to, double position,
+                                           size_t width) const {
+        return waveRenderer_.renderStrip(pyramid, from, to, position, width);
+    }
+    
+    // 为播放列表中的所有曲目构建波形缓存；已有有效缓存的曲目只做校验，中止后再次开始即从剩余曲目继续
+    size_t startWaveformBuild() {
+        if (waveBuild_.running) return waveBuild_.remaining();
+        if (playlist_.isEmpty()) return 0;
+        waveBuild_ = WaveformScanProgress();
+        waveBuild_.running = true;
+        waveBuild_.total = playlist_.size();
+        waveCursor_ = 0;
+        waveDeferred_.clear();
+        waveRevision_ = playlist_.getRevision();
+        waveStart_ = std::chrono::steady_clock::now();
+        waveBatch_ = getWaveformCache().startBatch();
+        return waveBuild_.total;
+    }
+    
+    void stopWaveformBuild() {
+        if (!waveBuild_.running) return;
+        waveBuild_.running = false;
+        waveBuild_.seconds = secondsSince(waveStart_);
+        waveDeferred_.clear();
+        waveforms_->cancelBatch();
+    }
+    
+    WaveformScanProgress getWaveformProgress() const {
+        WaveformScanProgress progress = waveBuild_;
+        if (progress.running) progress.seconds = secondsSince(waveStart_);
+        return progress;
+    }
+    
+    static constexpr float kTargetLoudness = -18.0f;    // LUFS（ReplayGain 2.0 参考电平）
+    static constexpr float kPeakCeiling = -1.0f;        // dBTP
+    
+    void toggleGapless() {
+        setGapless(!gapless_);
+    }
+    
+    // 最近一次曲目切换的间隙（样本数），-1 表示尚未切换过或后端不支持
+    int64_t getLastGapSamples() const {
+        return audioPlayer_->getLastGapFrames();
+    }
+    
     // 状态查询
     bool isPlaying() const {
         return audioPlayer_->isPlaying();
@@ -183,9 +430,38 @@ public:
         return audioPlayer_->getDuration();
     }
     
-    // 更新状态
+    // 更新状态：分发后端事件，取回后台读取的元数据（由事件循环线程周期调用）
     void update() {
         audioPlayer_->update();
+        pumpMetadata();
+        pumpLoudness();
+        pumpWaveforms();
+        syncQueuedNext();
+        syncPrefetch();
+    }
+    
+    // 尚未取回的元数据读取任务数
+    size_t getPendingMetadata() const {
+        return metadata_ ? metadata_->outstanding() : 0;
+    }
+    
+    // 后端的事件唤醒，不支持时为 nullptr（见 AudioPlayer::getEventWake）
+    EventWake* getEventWake() { return audioPlayer_->getEventWake(); }
+    
+    // 事件循环在两次唤醒之间最长等待的时间（秒）：轮询的后端与有后台任务（元数据、响度、波形）时
+    // 按后端的缓冲周期取回结果；否则只需偶尔同步预载与预取，结束与切换由后端唤醒
+    float getUpdateInterval() const {
+        float period = audioPlayer_->getUpdateInterval();
+        if (!audioPlayer_->getEventWake() || hasBackgroundWork()) return period;
+        return audioPlayer_->getState() == PlayState::Playing ? kPlayingUpdateSeconds : kIdleUpdateSeconds;
+    }
+    
+    // 最近一次后端错误
+    const std::string& getLastError() const { return lastError_; }
+    
+    // 后端诊断信息
+    std::string getDiagnostics() const {
+        return audioPlayer_->getDiagnostics();
     }
     
     // 运行状态
@@ -196,9 +472,23 @@ public:
     std::string getStatusString() const {
         std::stringstream ss;
         
-        const TrackInfo* track = playlist_.getCurrentTrack();
+        TrackView track = playlist_.getCurrentTrack();
         if (track) {
-            ss << "Now Playing: " << track->title << "\n";
+            ss << "Now Playing: " << track->title();
+            if (!track->artist().empty()) {
+                ss << " - " << track->artist();
+            }
+            ss << "\n";
+            TrackLoudness loudness = track->loudness();
+            if (loudness.measured()) {
+                ss << "Loudness: " << std::fixed << std::setprecision(1) << loudness.loudness
+                   << " LUFS, peak " << loudness.truePeak << " dBTP";
+                if (normalize_) {
+                    ss << " (gain " << std::showpos << 20.0f * std::log10(trackGain(track))
+                       << std::noshowpos << " dB)";
+                }
+                ss << std::defaultfloat << "\n";
+            }
         }
         
         // 播放状态
@@ -229,37 +519,60 @@ public:
             ss << " | Shuffle: On";
         }
         
-        // 播放列表位置
-        ss << " | Track " << (playlist_.getCurrentIndex() + 1) 
-           << "/" << playlist_.size();
+        // 无缝播放
+        if (gapless_) {
+            ss << " | Gapless: On";
+        }
         
-        return ss.str();
-    }
-    
-    // 获取播放列表字符串
-    std::string getPlaylistString() const {
-        std::stringstream ss;
-        ss << "\n=== Playlist ===\n";
+        // 交叉淡变
+        if (crossfade_ > 0.0f) {
+            ss << " | Crossfade: " << std::fixed << std::setprecision(1) << crossfade_ << "s";
+        }
         
-        const auto& tracks = playlist_.getTracks();
-        for (size_t i = 0; i < tracks.size(); i++) {
-            if (static_cast<int>(i) == playlist_.getCurrentIndex()) {
-                ss << " > ";
-            } else {
-                ss << "   ";
-            }
-            ss << "[" << (i + 1) << "] " << tracks[i].title << "\n";
+        // 响度归一化
+        if (normalize_) {
+            ss << " | Normalize: On";
         }
         
-        if (tracks.empty()) {
-            ss << "   (empty)\n";
+        // 播放列表位置
+        ss << " | Track " << (playlist_.getCurrentIndex() + 1) 
+           << "/" << playlist_.size();
+        
+        // 后端错误
+        if (!lastError_.empty()) {
+            ss << "\nLast error: " << lastError_;
         }
         
         return ss.str();
     }
     
+    // 播放列表的一页：从列表位置 offset 开始的 count 行；返回的引用在下一次渲染前有效
+    const std::string& getPlaylistPage(size_t offset, size_t count) const {
+        return renderer_.render(playlist_, offset, count);
+    }
+    
+    // 当前曲目附近的一页
+    const std::string& getPlaylistPageAroundCurrent(size_t count) const {
+        return renderer_.renderAroundCurrent(playlist_, count);
+    }
+    
+    // 搜索播放列表并列出前 limit 个匹配
+    const std::string& getSearchString(const std::string& query, size_t limit = 20) {
+        SearchMatches matches = playlist_.find(query, limit);
+        return renderer_.renderMatches(playlist_, query, matches);
+    }
+    
+    // 播放第一个匹配（列表顺序），返回其列表位置
+    bool playFind(const std::string& query, size_t& index) {
+        SearchMatches matches = playlist_.find(query, 1);
+        if (matches.positions.empty()) return false;
+        index = matches.positions.front();
+        return jumpTo(playlist_.getPlayPosition(index));
+    }
+    
 private:
     void onTrackEnd() {
+        MUSICAPP_PROBE(TrackEnd);
         switch (loopMode_) {
             case LoopMode::Single:
                 // 单曲循环
@@ -281,6 +594,291 @@ private:
         }
     }
     
+    // 处理后端推送的错误与位置事件
+    void onPlayerEvent(const PlayerEvent& event) {
+        if (event.type != PlayerEventType::Error) return;
+        switch (event.error) {
+            case PlayerError::SinkOpenFailed:
+                lastError_ = "audio output could not be opened";
+                break;
+            case PlayerError::DecodeFailed:
+                lastError_ = "decoding stopped early (truncated or unreadable file)";
+                break;
+            case PlayerError::None:
+                break;
+        }
+    }
+    
+    // 后端已无缝切换到预载曲目：只推进播放列表，不重新加载
+    void onTrackTransition() {
+        MUSICAPP_PROBE(Transition);
+        if (loopMode_ != LoopMode::Single) {
+            playlist_.next();
+        }
+        // 预载后才分析完成的曲目：切换后按最新结果校正增益
+        audioPlayer_->setTrackGain(trackGain(playlist_.getCurrentTrack()));
+        syncQueuedNext();
+        requestWaveform(playlist_.getCurrentTrack());
+    }
+    
+    // 后台流水线仍有待提交或待取回的结果
+    bool hasBackgroundWork() const {
+        return (metadata_ && metadata_->outstanding() > 0) || metadataCursor_ < playlist_.getTrackIdLimit() ||
+               loudness_ || (waveforms_ && (waveBuild_.running || waveforms_->outstanding() > 0));
+    }
+    
+    // 按循环模式与随机顺序计算下一首的播放位置，-1 表示没有下一首
+    int nextPlayPosition() const {
+        // current 为 -1 而仍在播放：正在播放的曲目已从列表开头移除，下一首是位置 0
+        int current = playlist_.getCurrentIndex();
+        if (playlist_.isEmpty()) return -1;
+        switch (loopMode_) {
+            case LoopMode::Single:
+                return current;
+            case LoopMode::All:
+                return static_cast<int>((current + 1) % playlist_.size());
+            case LoopMode::None:
+                return playlist_.isAtEnd() ? -1 : current + 1;
+        }
+        return -1;
+    }
+    
+    // 单曲循环时后端不做淡变，重新从头播放同一首
+    bool applyCrossfade() {
+        return audioPlayer_->setCrossfade(loopMode_ == LoopMode::Single ? 0.0f : crossfade_);
+    }
+    
+    // 使后端预载的曲目与实际将要播放的下一首保持一致（无缝播放或交叉淡变开启时）
+    void syncQueuedNext() {
+        bool crossfading = crossfade_ > 0.0f && loopMode_ != LoopMode::Single;
+        if (audioPlayer_->getState() == PlayState::Stopped) return;
+        if (!gapless_ && !crossfading) {
+            // 例如淡变时切换到单曲循环：撤销已预载的下一首
+            if (!audioPlayer_->getQueuedNext().empty()) audioPlayer_->clearQueuedNext();
+            return;
+        }
+        int position = nextPlayPosition();
+        TrackView next = position >= 0 ? playlist_.getTrackInPlayOrder(position) : TrackView();
+        std::string queued = audioPlayer_->getQueuedNext();
+        if (!next) {
+            if (!queued.empty()) audioPlayer_->clearQueuedNext();
+        } else {
+            std::string path = next->filepath();
+            if (path != queued) {
+                audioPlayer_->queueNext(path, trackGain(next));
+            }
+        }
+    }
+    
+    // 把按循环模式与随机顺序接下来将要播放的几首交给预取器；顺序不变时只比较曲目编号，不分配内存
+    void syncPrefetch() {
+        if (!prefetcher_) return;
+        prefetchScratch_.clear();
+        int current = playlist_.getCurrentIndex();
+        size_t count = playlist_.size();
+        bool playing = current >= 0 || audioPlayer_->getState() != PlayState::Stopped;
+        if (playing && loopMode_ != LoopMode::Single) {
+            for (size_t k = 1; k <= prefetchConfig_.lookahead && k < count; k++) {
+                size_t position = static_cast<size_t>(current + static_cast<int>(k));
+                if (position >= count) {
+                    if (loopMode_ != LoopMode::All) break;
+                    position -= count;
+                }
+                prefetchScratch_.push_back(playlist_.getTrackInPlayOrder(position).id());
+            }
+        }
+        if (prefetchScratch_ == prefetchIds_ && prefetchRevision_ == playlist_.getRevision()) return;
+        prefetchIds_.swap(prefetchScratch_);
+        prefetchRevision_ = playlist_.getRevision();
+        std::vector<std::string> paths;
+        paths.reserve(prefetchIds_.size());
+        for (uint32_t id : prefetchIds_) paths.push_back(playlist_.getTrackById(id)->filepath());
+        prefetcher_->setUpcoming(std::move(paths));
+    }
+    
+    // 取回已完成的元数据，并为尚未读取的曲目提交任务；只在事件循环中调用，不等待读取
+    void pumpMetadata() {
+        if (playlist_.getRevision() != metadataRevision_) {
+            // 曲目编号已失效：从头检查，已读取过的曲目直接跳过
+            metadataRevision_ = playlist_.getRevision();
+            metadataCursor_ = 0;
+        }
+        if (metadata_) {
+            metadata_->drain([this](MetadataResult& result) {
+                applyMetadata(result);
+            });
+        }
+        // 每次最多检查的曲目数，避免长时间占用播放器锁
+        const size_t kScanLimit = 65536;
+        // 按编号而不是列表位置推进，插入、移除与移动都不会让游标跳过曲目
+        for (size_t scanned = 0; metadataCursor_ < playlist_.getTrackIdLimit() && scanned < kScanLimit; scanned++) {
+            TrackView track = playlist_.getTrackById(metadataCursor_);
+            if (track && !track->metadataRead()) {
+                if (!metadata_) {
+                    metadata_ = std::make_unique<MetadataPipeline>(getWorkerPool());
+                }
+                if (metadata_->available() == 0) break;
+                metadata_->submit(metadataCursor_, track->filepath());
+            }
+            metadataCursor_++;
+        }
+    }
+    
+    void applyMetadata(MetadataResult& result) {
+        TrackView track = playlist_.getTrackById(result.id);
+        // 提交后曲目已移除或编号已失效：该编号已不是原曲目，等待重新提交
+        if (!track || track->filepath() != result.filepath) return;
+        if (result.ok) {
+            playlist_.setTrackMetadata(result.id, result.metadata.title, result.metadata.artist,
+                                       result.metadata.duration);
+        } else {
+            playlist_.setTrackMetadata(result.id, std::string_view(), std::string_view(), 0.0f);
+        }
+        if (hasLibrary()) {
+            library_.updateTrack(track);
+        }
+    }
+    
+    // 曲目增益（线性）
+    float trackGain(const TrackView& track) const {
+        if (!normalize_ || !track) return 1.0f;
+        TrackLoudness loudness = track->loudness();
+        if (!loudness.measured()) return 1.0f;
+        float gainDb = kTargetLoudness - loudness.loudness;
+        if (std::isfinite(loudness.truePeak)) {
+            gainDb = std::min(gainDb, kPeakCeiling - loudness.truePeak);
+        }
+        return std::pow(10.0f, gainDb / 20.0f);
+    }
+    
+    // 取回响度分析结果并补充提交任务，与 pumpMetadata 相同只在事件循环中调用
+    void pumpLoudness() {
+        if (!loudness_) return;
+        loudness_->drain([this](LoudnessAnalysis& analysis) {
+            applyLoudness(analysis);
+        });
+        if (!analysis_.running) {
+            // 已中止：等待正在测量的任务退出后释放流水线
+            if (loudness_->outstanding() == 0) loudness_.reset();
+            return;
+        }
+        if (playlist_.getRevision() != analysisRevision_) {
+            analysisRevision_ = playlist_.getRevision();
+            analysisCursor_ = 0;
+        }
+        const size_t kScanLimit = 65536;
+        for (size_t scanned = 0; analysisCursor_ < playlist_.getTrackIdLimit() && scanned < kScanLimit; scanned++) {
+            TrackView track = playlist_.getTrackById(analysisCursor_);
+            if (track && !track->loudness().analyzed) {
+                if (loudness_->available() == 0) break;
+                loudness_->submit(analysisCursor_, track->filepath());
+            }
+            analysisCursor_++;
+        }
+        if (analysisCursor_ >= playlist_.getTrackIdLimit() && loudness_->outstanding() == 0) {
+            finishAnalysis();
+            loudness_.reset();
+        } else if (secondsSince(lastCheckpoint_) >= kCheckpointSeconds) {
+            // 定期写回曲库索引，中断后已分析的曲目不必重做
+            saveLibrary();
+            lastCheckpoint_ = std::chrono::steady_clock::now();
+        }
+    }
+    
+    void applyLoudness(LoudnessAnalysis& analysis) {
+        if (analysis.cancelled) return;
+        TrackView track = playlist_.getTrackById(analysis.id);
+        if (!track || track->filepath() != analysis.filepath) return;
+        TrackLoudness loudness;
+        loudness.analyzed = true;
+        if (analysis.ok) {
+            loudness.loudness = static_cast<float>(analysis.result.integrated);
+            loudness.truePeak = static_cast<float>(analysis.result.truePeakDb());
+            analysis_.analyzed++;
+            analysis_.audioSeconds += analysis.result.seconds;
+        } else {
+            loudness.loudness = -std::numeric_limits<float>::infinity();
+            loudness.truePeak = -std::numeric_limits<float>::infinity();
+            analysis_.failed++;
+        }
+        playlist_.setTrackLoudness(analysis.id, loudness);
+        if (hasLibrary()) {
+            library_.updateTrack(track);
+        }
+        // 正在播放的曲目立即按测量结果调整
+        TrackView current = playlist_.getCurrentTrack();
+        if (normalize_ && current && current.id() == analysis.id) {
+            audioPlayer_->setTrackGain(trackGain(track));
+        }
+    }
+    
+    void finishAnalysis() {
+        analysis_.running = false;
+        analysis_.seconds = secondsSince(analysisStart_);
+        saveLibrary();
+    }
+    
+    // 开启预先构建时为正在播放的曲目提交构建，与批量构建共用在途上限
+    void requestWaveform(const TrackView& track) {
+        if (!waveformAutoBuild_ || !track) return;
+        WaveformCache& cache = getWaveformCache();
+        std::string path = track->filepath();
+        if (cache.available() == 0 || cache.pending(path)) return;
+        if (!cache.find(path)) cache.submit(path, true);
+    }
+    
+    // 取回构建结果，批量构建时按列表顺序补充提交；只统计本批次提交的任务
+    void pumpWaveforms() {
+        if (!waveforms_) return;
+        waveforms_->drain([this](WaveformBuild& result) {
+            if (!waveBuild_.running || result.cancelled || result.batch != waveBatch_) return;
+            if (!result.ok) {
+                waveBuild_.failed++;
+            } else if (result.built) {
+                waveBuild_.built++;
+            } else {
+                waveBuild_.cached++;
+            }
+        });
+        if (!waveBuild_.running) return;
+        if (playlist_.getRevision() != waveRevision_) {
+            // 列表位置已失效：换一个批次从头提交并重新计数，已有缓存的曲目只做校验
+            waveRevision_ = playlist_.getRevision();
+            waveCursor_ = 0;
+            waveDeferred_.clear();
+            waveBuild_.total = playlist_.size();
+            waveBuild_.built = waveBuild_.cached = waveBuild_.failed = 0;
+            waveBatch_ = waveforms_->startBatch();
+        }
+        // 单独提交的构建（正在播放的曲目）完成后再由本批次提交，校验缓存文件后计数
+        for (size_t i = 0; i < waveDeferred_.size() && waveforms_->available() > 0;) {
+            if (waveforms_->submit(waveDeferred_[i], false, waveBatch_)) {
+                waveDeferred_[i] = std::move(waveDeferred_.back());
+                waveDeferred_.pop_back();
+            } else {
+                i++;
+            }
+        }
+        TrackList tracks = playlist_.getTracks();
+        while (waveCursor_ < playlist_.size() && waveforms_->available() > 0) {
+            std::string path = tracks[waveCursor_]->filepath();
+            if (waveforms_->pending(path)) {
+                waveDeferred_.push_back(std::move(path));
+            } else {
+                waveforms_->submit(path, false, waveBatch_);
+            }
+            waveCursor_++;
+        }
+        if (waveCursor_ >= playlist_.size() && waveDeferred_.empty() && waveforms_->outstanding() == 0) {
+            waveBuild_.running = false;
+            waveBuild_.seconds = secondsSince(waveStart_);
+        }
+    }
+    
+    static double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    
     static std::string formatTime(float seconds) {
         int mins = static_cast<int>(seconds) / 60;
         int secs = static_cast<int>(seconds) % 60;
@@ -292,8 +890,45 @@ private:
     
     std::unique_ptr<AudioPlayer> audioPlayer_;
     Playlist playlist_;
+    Library library_;
+    std::string libraryPath_;
+    WorkStealingPool* sharedPool_;
+    std::unique_ptr<WorkStealingPool> workerPool_;
+    std::unique_ptr<MetadataPipeline> metadata_;    // 须在线程池之前析构
+    size_t metadataCursor_ = 0;                     // 之前的曲目均已提交或读取过
+    uint64_t metadataRevision_ = 0;
+    std::unique_ptr<LoudnessPipeline> loudness_;    // 须在线程池之前析构
+    LoudnessScanProgress analysis_;
+    size_t analysisCursor_ = 0;
+    uint64_t analysisRevision_ = 0;
+    std::chrono::steady_clock::time_point analysisStart_;
+    std::chrono::steady_clock::time_point lastCheckpoint_;
+    static constexpr double kCheckpointSeconds = 60.0;
+    std::string waveformDirectory_;
+    bool waveformAutoBuild_ = false;
+    std::unique_ptr<WaveformCache> waveforms_;      // 须在线程池之前析构
+    std::unique_ptr<Prefetcher> prefetcher_;
+    PrefetchConfig prefetchConfig_{0};
+    // 可唤醒的后端空闲时事件循环的等待上限：播放中按此同步预载与预取，停止或暂停时只偶尔醒来
+    static constexpr float kPlayingUpdateSeconds = 0.25f;
+    static constexpr float kIdleUpdateSeconds = 1.0f;
+    std::vector<uint32_t> prefetchIds_;             // 已交给预取器的曲目编号
+    std::vector<uint32_t> prefetchScratch_;
+    uint64_t prefetchRevision_ = UINT64_MAX;
+    WaveformScanProgress waveBuild_;
+    size_t waveCursor_ = 0;
+    std::vector<std::string> waveDeferred_;         // 提交时正由单独的构建占用的曲目
+    uint64_t waveBatch_ = 0;
+    uint64_t waveRevision_ = 0;
+    std::chrono::steady_clock::time_point waveStart_;
+    mutable WaveformRenderer waveRenderer_;
+    bool normalize_ = false;
     LoopMode loopMode_;
     bool isRunning_;
+    bool gapless_;
+    float crossfade_ = 0.0f;
+    std::string lastError_;
+    mutable PlaylistRenderer renderer_;             // 列表与搜索输出共用的缓冲区
 };
 
 } // namespace MusicApp
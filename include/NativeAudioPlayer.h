@@ -0,0 +1,904 @@
+#ifndef NATIVE_AUDIO_PLAYER_H
+#define NATIVE_AUDIO_PLAYER_H
+
+#include "AudioPlayer.h"
+#include "AudioDecoder.h"
+#include "AudioSink.h"
+#include "Crossfade.h"
+#include "DecoderFactory.h"
+#include "EventQueue.h"
+#include "EventWake.h"
+#include "GainStage.h"
+#include "Instrumentation.h"
+#include "Resampler.h"
+#include "RingBuffer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace MusicApp {
+
+// 原生引擎配置
+struct NativeEngineConfig {
+    uint32_t sampleRate = 44100;    // 输出采样率
+    uint16_t channels = 2;          // 输出声道数
+    uint32_t periodFrames = 512;    // 每个渲染周期的帧数
+    uint32_t bufferFrames = 16384;  // 环形缓冲区容量（帧）
+    float gainRampMs = 20.0f;       // 音量变化的插值时长（毫秒）
+    ResamplerQuality resampler = ResamplerQuality::Balanced;    // 采样率与输出不同的曲目所用的重采样预设
+    bool hosted = false;            // 不创建解码/渲染线程，由宿主调用 renderPeriods 驱动（见 SessionManager）
+};
+
+// 原生 PCM 播放引擎
+// 解码线程 -> SPSC 环形缓冲区 -> 实时渲染线程 -> 输出端
+// 渲染线程只读写原子变量与预分配缓冲区，不加锁、不分配内存
+// 托管模式下没有这两个线程：宿主在自己的线程（通常是共享线程池）中交替执行解码与渲染
+class NativeAudioPlayer : public AudioPlayer {
+public:
+    explicit NativeAudioPlayer(std::unique_ptr<AudioSink> sink = nullptr,
+                               const NativeEngineConfig& config = NativeEngineConfig())
+        : sink_(sink ? std::move(sink) : std::make_unique<NullAudioSink>()),
+          config_(config),
+          volume_(50.0f),
+          state_(PlayState::Stopped),
+          duration_(0.0f),
+          gain_(0.5f, static_cast<uint32_t>(config.gainRampMs * config.sampleRate / 1000.0f)) {
+        decode_.converter = Resampler(config_.resampler);
+        decode_.nextConverter = Resampler(config_.resampler);
+        ring_.reset(static_cast<size_t>(config_.bufferFrames) * config_.channels);
+        mix_.assign(static_cast<size_t>(config_.periodFrames) * config_.channels, 0.0f);
+        // 托管模式由宿主调用 update，不需要唤醒（也不为每个会话占用一个描述符）
+        if (!config_.hosted) wake_ = std::make_unique<EventWake>();
+        sinkOpen_ = sink_->open(config_.sampleRate, config_.channels, config_.periodFrames);
+        if (!sinkOpen_) {
+            PlayerEvent event;
+            event.type = PlayerEventType::Error;
+            event.error = PlayerError::SinkOpenFailed;
+            pushEvent(decodeEvents_, event);
+        }
+        running_ = true;
+        if (!config_.hosted) {
+            decodeThread_ = std::thread(&NativeAudioPlayer::decodeLoop, this);
+            renderThread_ = std::thread(&NativeAudioPlayer::renderLoop, this);
+        }
+    }
+
+    ~NativeAudioPlayer() override {
+        running_ = false;
+        decodeCv_.notify_all();
+        if (decodeThread_.joinable()) decodeThread_.join();
+        if (renderThread_.joinable()) renderThread_.join();
+        sink_->close();
+    }
+
+    bool load(const std::string& filepath) override {
+        stop();
+
+        std::unique_ptr<AudioDecoder> decoder = openAudioDecoder(filepath);
+        if (!decoder) {
+            currentFile_.clear();
+            return false;
+        }
+
+        float duration = static_cast<float>(decoder->getTotalFrames()) / decoder->getSampleRate();
+        // 被替换的解码器在锁外析构
+        std::unique_ptr<AudioDecoder> replaced, unqueued;
+        {
+            std::lock_guard<std::mutex> lock(decodeMutex_);
+            replaced = std::move(request_.decoder);
+            request_.decoder = std::move(decoder);
+            unqueued = setQueued(nullptr, std::string(), 0.0f, 1.0f);
+            switchedFile_.clear();
+            requestSeek(0.0f);
+        }
+        decodeCv_.notify_one();
+
+        duration_ = duration;
+        loaded_ = true;
+        currentFile_ = filepath;
+        bytesCopied_ = 0;
+        startTime_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void play() override {
+        if (!currentFile_.empty()) {
+            state_ = PlayState::Playing;
+        }
+    }
+
+    void pause() override {
+        PlayState expected = PlayState::Playing;
+        state_.compare_exchange_strong(expected, PlayState::Paused);
+    }
+
+    void stop() override {
+        state_ = PlayState::Stopped;
+        if (!currentFile_.empty()) {
+            seek(0.0f);
+        }
+    }
+
+    void seek(float seconds) override {
+        if (!loaded_) return;
+        {
+            std::lock_guard<std::mutex> lock(decodeMutex_);
+            requestSeek(std::max(0.0f, std::min(seconds, duration_)));
+        }
+        decodeCv_.notify_one();
+    }
+
+    float getCurrentTime() const override {
+        return static_cast<float>(framesPlayed_.load(std::memory_order_relaxed)) /
+               config_.sampleRate;
+    }
+
+    float getDuration() const override {
+        return duration_;
+    }
+
+    void setVolume(float volume) override {
+        // 渲染线程每个周期按音量与曲目增益更新增益级的目标
+        volume_ = std::max(0.0f, std::min(100.0f, volume));
+    }
+
+    float getVolume() const override {
+        return volume_;
+    }
+
+    PlayState getState() const override {
+        return state_;
+    }
+
+    bool isPlaying() const override {
+        return state_ == PlayState::Playing;
+    }
+
+    std::string getCurrentFile() const override {
+        return currentFile_;
+    }
+
+    void setOnEndCallback(EndCallback callback) override {
+        onEndCallback_ = callback;
+    }
+
+    // 分发渲染线程与解码线程推送的事件
+    void update() override {
+        PlayerEvent event;
+        while (renderEvents_.pop(event) || decodeEvents_.pop(event)) {
+            switch (event.type) {
+                case PlayerEventType::TrackChanged:
+                    // 渲染线程已无缝切换到预载曲目
+                    {
+                        std::lock_guard<std::mutex> lock(decodeMutex_);
+                        currentFile_ = switchedFile_;
+                        duration_ = switchedDuration_;
+                        switchedFile_.clear();
+                    }
+                    if (onTransitionCallback_) onTransitionCallback_();
+                    break;
+                case PlayerEventType::EndOfStream:
+                    // 结束事件产生后若已重新加载或定位，则该事件已过期
+                    if (state_ == PlayState::Stopped && onEndCallback_) onEndCallback_();
+                    break;
+                case PlayerEventType::Error:
+                case PlayerEventType::Position:
+                    if (onEventCallback_) onEventCallback_(event);
+                    break;
+            }
+        }
+    }
+
+    float getUpdateInterval() const override {
+        return static_cast<float>(config_.periodFrames) / config_.sampleRate;
+    }
+
+    EventWake* getEventWake() override { return wake_.get(); }
+
+    void setOnEventCallback(EventCallback callback) override {
+        onEventCallback_ = callback;
+    }
+
+    // 曲目增益与音量相乘后由同一个增益级应用，不增加逐样本的开销
+    bool setTrackGain(float gain) override {
+        trackGain_.store(std::max(0.0f, gain), std::memory_order_relaxed);
+        return true;
+    }
+
+    bool queueNext(const std::string& filepath, float trackGain) override {
+        std::unique_ptr<AudioDecoder> decoder = openAudioDecoder(filepath);
+        if (!decoder) return false;
+        float duration = static_cast<float>(decoder->getTotalFrames()) / decoder->getSampleRate();
+        std::unique_ptr<AudioDecoder> replaced;
+        {
+            std::lock_guard<std::mutex> lock(decodeMutex_);
+            replaced = setQueued(std::move(decoder), filepath, duration, std::max(0.0f, trackGain));
+        }
+        decodeCv_.notify_one();
+        return true;
+    }
+
+    void clearQueuedNext() override {
+        std::unique_ptr<AudioDecoder> replaced;
+        std::lock_guard<std::mutex> lock(decodeMutex_);
+        replaced = setQueued(nullptr, std::string(), 0.0f, 1.0f);
+    }
+
+    std::string getQueuedNext() const override {
+        // 已衔接但渲染线程尚未播放到边界的曲目同样视为已预载
+        std::lock_guard<std::mutex> lock(decodeMutex_);
+        return !queuedFile_.empty() ? queuedFile_ : switchedFile_;
+    }
+
+    bool setCrossfade(float seconds) override {
+        float clamped = std::isfinite(seconds) ? std::clamp(seconds, 0.0f, kMaxCrossfadeSeconds) : 0.0f;
+        crossfadeFrames_.store(static_cast<uint32_t>(clamped * config_.sampleRate), std::memory_order_relaxed);
+        return true;
+    }
+
+    void setOnTransitionCallback(TransitionCallback callback) override {
+        onTransitionCallback_ = callback;
+    }
+
+    int64_t getLastGapFrames() const override {
+        return lastGapFrames_.load(std::memory_order_relaxed);
+    }
+
+    std::string getDiagnostics() const override {
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - startTime_).count();
+        std::stringstream ss;
+        ss << "Engine: " << config_.sampleRate << " Hz, " << config_.channels
+           << " ch, period " << config_.periodFrames << " frames"
+           << (config_.hosted ? ", hosted" : "") << "\n";
+        ss << "Resampler: " << resamplerQualityName(config_.resampler) << " ("
+           << resamplerPreset(config_.resampler).taps << " taps, "
+           << simdLevelName(hostSimdLevel()) << ")\n";
+        ss << "Crossfade: " << static_cast<float>(crossfadeFrames_.load()) / config_.sampleRate
+           << " s\n";
+        ss << "Decode path: " << (zeroCopy_ ? "zero-copy (mmap)" : "buffered") << "\n";
+        ss << "Bytes copied: " << static_cast<uint64_t>(bytesCopied_ / std::max(seconds, 1e-3))
+           << " B/s (" << bytesCopied_.load() << " total)\n";
+        ss << "Underruns: " << underruns_.load()
+           << " | Sink dropped frames: " << sink_->getDroppedFrames()
+           << " | Dropped events: "
+           << renderEvents_.getDroppedCount() + decodeEvents_.getDroppedCount();
+        return ss.str();
+    }
+
+    // 渲染线程缓冲区欠载次数
+    uint64_t getUnderrunCount() const {
+        return underruns_.load(std::memory_order_relaxed);
+    }
+
+    const NativeEngineConfig& getConfig() const { return config_; }
+
+    // 托管模式：在调用线程上渲染 periods 个周期，每个周期之前先把环形缓冲区解码填满。
+    // 不按实时节奏等待，节奏由宿主决定；同一实例不得被并发调用
+    void renderPeriods(uint32_t periods) {
+        enableFlushDenormals();
+        for (uint32_t i = 0; i < periods; i++) {
+            while (decodeStep()) {}
+            renderPeriod();
+        }
+    }
+
+private:
+    // 需要及时处理的事件：入队后唤醒事件循环（一次不阻塞的系统调用，渲染线程可用）。
+    // 位置事件不唤醒，留到事件循环下一次醒来时一并取出
+    void pushEvent(PlayerEventQueue& queue, const PlayerEvent& event) {
+        queue.push(event);
+        if (wake_) wake_->notify();
+    }
+
+    // 提交定位请求（调用方持有 decodeMutex_）
+    void requestSeek(float seconds) {
+        request_.seconds = seconds;
+        requestGen_.fetch_add(1, std::memory_order_release);
+    }
+
+    // 替换预载请求（调用方持有 decodeMutex_），decoder 为空表示取消；返回被替换的解码器，由调用方在锁外析构
+    std::unique_ptr<AudioDecoder> setQueued(std::unique_ptr<AudioDecoder> decoder, const std::string& filepath,
+                                            float duration, float gain) {
+        std::unique_ptr<AudioDecoder> replaced = std::move(queued_.decoder);
+        queued_.decoder = std::move(decoder);
+        queued_.file = filepath;
+        queued_.duration = duration;
+        queued_.gain = gain;
+        queuedFile_ = filepath;
+        queueGen_.fetch_add(1, std::memory_order_release);
+        return replaced;
+    }
+
+    // 是否有尚未取走的请求（调用方持有 decodeMutex_）
+    bool hasRequests() const {
+        return requestGen_.load(std::memory_order_relaxed) != decode_.servedGen ||
+               queueGen_.load(std::memory_order_relaxed) != decode_.queueGen;
+    }
+
+    // 解码一块数据：读取、声道映射、采样率转换，结果写入 out
+    size_t decodeChunk(AudioDecoder& decoder, Resampler& converter,
+                       std::vector<float>& out) {
+        MUSICAPP_PROBE(DecodeChunk);
+        const size_t chunkFrames = 1024;
+        const uint16_t outChannels = config_.channels;
+        uint16_t srcChannels = decoder.getChannels();
+        decoded_.resize(chunkFrames * srcChannels);
+        uint64_t decoderCopied = decoder.getBytesCopied();
+        size_t got = decoder.read(decoded_.data(), chunkFrames);
+        out.clear();
+        if (got == 0) return 0;
+
+        // 声道映射：单声道复制到所有输出声道，多余声道丢弃
+        mapped_.resize(got * outChannels);
+        for (size_t f = 0; f < got; f++) {
+            for (uint16_t c = 0; c < outChannels; c++) {
+                uint16_t sc = std::min<uint16_t>(c, srcChannels - 1);
+                mapped_[f * outChannels + c] = decoded_[f * srcChannels + sc];
+            }
+        }
+        converter.process(mapped_.data(), got, out);
+
+        // 统计经由中间缓冲区的字节数：解码器内部缓冲 + 解码/映射/转换结果
+        uint64_t copied = decoder.getBytesCopied() - decoderCopied +
+                          (got * srcChannels + mapped_.size() + out.size()) * sizeof(float);
+        bytesCopied_.fetch_add(copied, std::memory_order_relaxed);
+        return got;
+    }
+
+    // 零拷贝路径：源格式与输出一致时，样本片段直接转换写入环形缓冲区
+    bool canWriteDirect(const AudioDecoder& decoder) const {
+        return decoder.supportsSpans() && decoder.getChannels() == config_.channels &&
+               decoder.getSampleRate() == config_.sampleRate;
+    }
+
+    size_t writeDirect(AudioDecoder& decoder, size_t maxFrames) {
+        PcmSpan span;
+        if (!decoder.readSpan(std::min<size_t>(maxFrames, 4096), span) || span.frames == 0) {
+            return 0;
+        }
+        float* first;
+        size_t firstLen;
+        float* second;
+        size_t secondLen;
+        size_t samples = ring_.prepareWrite(span.frames * config_.channels,
+                                            first, firstLen, second, secondLen);
+        convertPcmSamples(span.data, span.encoding, firstLen, first);
+        if (secondLen > 0) {
+            convertPcmSamples(span.data + firstLen * pcmBytesPerSample(span.encoding),
+                              span.encoding, secondLen, second);
+        }
+        ring_.commitWrite(samples);
+        return span.frames;
+    }
+
+    // 解码线程：填充环形缓冲区，没有可做的工作时等待
+    void decodeLoop() {
+        MUSICAPP_STATS_THREAD();
+        while (running_) {
+            if (decodeStep()) continue;
+            std::unique_lock<std::mutex> lock(decodeMutex_);
+            if (!hasRequests()) waitForWork(lock);
+        }
+    }
+
+    // 解码一步：处理请求、写入一块数据或切换曲目。只在取走请求与发布曲目名时短暂持有 decodeMutex_，
+    // 文件读取、定位与解码器的析构都在锁外，控制线程的 load / seek / queueNext 不必等待磁盘。
+    // 返回 false 表示暂时无事可做（缓冲区已满或曲目已读完）
+    bool decodeStep() {
+        const uint16_t outChannels = config_.channels;
+        std::vector<float>& pending = decode_.pending;
+        size_t& pendingPos = decode_.pendingPos;
+        bool& eof = decode_.eof;
+        Resampler& converter = decode_.converter;
+        bool& drained = decode_.drained;
+        std::vector<float>& nextPending = decode_.nextPending;
+        Resampler& nextConverter = decode_.nextConverter;
+        uint64_t& primedGen = decode_.primedGen;
+
+        // 边界已被渲染线程消费且淡变结束，释放上一曲的解码器
+        if (prevDecoder_ && !fade_.active &&
+            boundaryIndex_.load(std::memory_order_acquire) == UINT64_MAX) {
+            prevDecoder_.reset();
+        }
+
+        // 处理加载/定位请求：清空旧数据并通知渲染线程跳过
+        uint64_t gen = requestGen_.load(std::memory_order_acquire);
+        if (gen != decode_.servedGen) {
+            std::unique_ptr<AudioDecoder> loaded;
+            float seconds;
+            {
+                std::lock_guard<std::mutex> lock(decodeMutex_);
+                gen = requestGen_.load(std::memory_order_relaxed);
+                seconds = request_.seconds;
+                loaded = std::move(request_.decoder);
+                // 加载之后才完成的衔接已经作废
+                if (loaded) switchedFile_.clear();
+            }
+            decode_.servedGen = gen;
+            fade_.active = false;
+            uint64_t boundary = boundaryIndex_.load();
+            if (loaded) {
+                // 新加载的曲目：上一曲与衔接中的曲目在这里（锁外）析构
+                prevDecoder_.reset();
+                decoder_ = std::move(loaded);
+            } else if (prevDecoder_ && boundary != UINT64_MAX &&
+                       boundaryIndex_.compare_exchange_strong(boundary, UINT64_MAX)) {
+                // 已衔接但尚未播放到边界时定位：撤销衔接，定位作用于当前曲目
+                decoder_->seek(0);
+                nextDecoder_ = std::move(decoder_);
+                nextGain_ = switchedGain_.load(std::memory_order_relaxed);
+                {
+                    std::lock_guard<std::mutex> lock(decodeMutex_);
+                    nextFile_ = std::move(switchedFile_);
+                    nextDuration_ = switchedDuration_;
+                    switchedFile_.clear();
+                    // 之后又有新的预载请求时由它取代
+                    if (queueGen_.load(std::memory_order_relaxed) == decode_.queueGen) queuedFile_ = nextFile_;
+                }
+                decoder_ = std::move(prevDecoder_);
+                primedGen = 0;
+            }
+            pending.clear();
+            pendingPos = 0;
+            eof = !decoder_;
+            drained = false;
+            if (decoder_) {
+                uint32_t srcRate = decoder_->getSampleRate();
+                decoder_->seek(static_cast<uint64_t>(seconds * srcRate));
+                converter.reset(srcRate, config_.sampleRate, outChannels);
+            }
+            eofIndex_.store(UINT64_MAX, std::memory_order_relaxed);
+            boundaryIndex_.store(UINT64_MAX, std::memory_order_relaxed);
+            flushIndex_.store(ring_.writeIndex(), std::memory_order_relaxed);
+            flushFrame_.store(static_cast<uint64_t>(seconds * config_.sampleRate),
+                              std::memory_order_relaxed);
+            flushSeq_.store(gen, std::memory_order_release);
+        }
+
+        // 取走预载请求（加载时也会清空预载），被替换的解码器在锁外析构
+        if (queueGen_.load(std::memory_order_acquire) != decode_.queueGen) {
+            std::unique_ptr<AudioDecoder> replaced = std::move(nextDecoder_);
+            {
+                std::lock_guard<std::mutex> lock(decodeMutex_);
+                decode_.queueGen = queueGen_.load(std::memory_order_relaxed);
+                nextDecoder_ = std::move(queued_.decoder);
+                nextFile_ = queued_.file;
+                nextDuration_ = queued_.duration;
+                nextGain_ = queued_.gain;
+            }
+            nextGen_++;
+        }
+
+        // 预解码下一曲的开头
+        auto prime = [&]() {
+            nextConverter.reset(nextDecoder_->getSampleRate(), config_.sampleRate, outChannels);
+            decodeChunk(*nextDecoder_, nextConverter, nextPending);
+            primedGen = nextGen_;
+        };
+
+        // 缓冲区已满：利用空闲时间预解码下一曲的开头，否则无事可做
+        auto idle = [&]() {
+            if (nextDecoder_ && primedGen != nextGen_) {
+                prime();
+                return true;
+            }
+            return false;
+        };
+
+        // 切换到预载曲目：上一曲的解码器保留到渲染线程跨过边界（淡变时到淡变结束）
+        auto switchToNext = [&]() {
+            if (primedGen != nextGen_) prime();
+            prevDecoder_ = std::move(decoder_);
+            decoder_ = std::move(nextDecoder_);
+            {
+                std::lock_guard<std::mutex> lock(decodeMutex_);
+                switchedFile_ = std::move(nextFile_);
+                switchedDuration_ = nextDuration_;
+                // 切换之后控制线程又提交的预载仍然显示
+                if (queueGen_.load(std::memory_order_relaxed) == decode_.queueGen) queuedFile_.clear();
+            }
+            switchedGain_.store(nextGain_, std::memory_order_relaxed);
+            nextFile_.clear();
+            converter = nextConverter;
+            pending.swap(nextPending);
+            nextPending.clear();
+            pendingPos = 0;
+            eof = false;
+            drained = false;
+            eofIndex_.store(UINT64_MAX, std::memory_order_relaxed);
+            boundaryIndex_.store(ring_.writeIndex(), std::memory_order_release);
+        };
+
+        // 先写完上一块转换结果
+        if (pendingPos < pending.size()) {
+            size_t space = ring_.writeAvailable();
+            space -= space % outChannels;
+            size_t n = ring_.write(pending.data() + pendingPos,
+                                   std::min(space, pending.size() - pendingPos));
+            pendingPos += n;
+            return n > 0 || idle();
+        }
+
+        size_t got = 0;
+        if (!eof) {
+            // 剩余长度进入淡变窗口：开始交叉淡变，上一曲的剩余部分与下一曲的开头同时解码并混合
+            uint64_t fadeFrames = crossfadeFrames_.load(std::memory_order_relaxed);
+            uint64_t remaining = remainingFrames(*decoder_);
+            bool fadeArmed = fadeFrames > 0 && !fade_.active && nextDecoder_ && !prevDecoder_ &&
+                             boundaryIndex_.load(std::memory_order_acquire) == UINT64_MAX;
+            if (fadeArmed && remaining <= fadeFrames) {
+                fade_.total = std::min(remaining, remainingFrames(*nextDecoder_));
+                fade_.position = 0;
+                fade_.drained = drained;
+                fade_.outgoingGain = trackGain_.load(std::memory_order_relaxed);
+                fade_.buffer.clear();
+                fade_.bufferPos = 0;
+                std::swap(fade_.converter, converter);
+                fade_.active = fade_.total > 0;
+                switchToNext();
+                if (fade_.active) mixCrossfade(pending);
+                return true;
+            }
+
+            bool direct = !fade_.active && canWriteDirect(*decoder_);
+            zeroCopy_.store(direct, std::memory_order_relaxed);
+            if (direct) {
+                size_t space = ring_.writeAvailable() / outChannels;
+                if (space == 0) return idle();
+                // 不越过淡变的起点
+                if (fadeArmed) space = std::min<uint64_t>(space, remaining - fadeFrames);
+                got = writeDirect(*decoder_, space);
+            } else {
+                got = decodeChunk(*decoder_, converter, pending);
+                pendingPos = 0;
+                if (got > 0 && fade_.active) mixCrossfade(pending);
+            }
+        }
+        if (got > 0) return true;
+
+        // 解码器读完：输出重采样器中按前瞻保留的最后几帧
+        if (!eof && !drained) {
+            drained = true;
+            converter.flush(pending);
+            pendingPos = 0;
+            if (fade_.active && !pending.empty()) mixCrossfade(pending);
+            if (!pending.empty()) return true;
+        }
+        // 淡入的曲目比淡变更早结束（文件被截断）：放弃剩余的淡变
+        fade_.active = false;
+
+        if (!eof && decoder_->tell() < decoder_->getTotalFrames()) {
+            // 未到声明的长度就读不出数据：按截断处理并报告错误
+            PlayerEvent event;
+            event.type = PlayerEventType::Error;
+            event.error = PlayerError::DecodeFailed;
+            pushEvent(decodeEvents_, event);
+        }
+
+        // 当前曲目解码完毕：若已预载下一曲且上一个边界已被渲染线程消费，则无缝衔接
+        if (decoder_ && nextDecoder_ && !prevDecoder_ &&
+            boundaryIndex_.load(std::memory_order_acquire) == UINT64_MAX) {
+            switchToNext();
+            return true;
+        }
+
+        if (!eof) {
+            eof = true;
+            eofIndex_.store(ring_.writeIndex(), std::memory_order_release);
+        }
+        return false;
+    }
+
+    // 解码器剩余的长度（输出帧）
+    uint64_t remainingFrames(const AudioDecoder& decoder) const {
+        uint64_t total = decoder.getTotalFrames();
+        uint64_t position = decoder.tell();
+        if (position >= total || decoder.getSampleRate() == 0) return 0;
+        return (total - position) * config_.sampleRate / decoder.getSampleRate();
+    }
+
+    // 交叉淡变：把淡出曲目（prevDecoder_）的对应样本按等功率曲线混入淡入曲目刚解码的一块
+    // 只在解码线程中运行，缓冲区在第一次淡变后复用；淡出曲目提前读完时以静音补齐
+    void mixCrossfade(std::vector<float>& samples) {
+        const uint16_t channels = config_.channels;
+        size_t frames = static_cast<size_t>(
+            std::min<uint64_t>(samples.size() / channels, fade_.total - fade_.position));
+        size_t needed = frames * channels;
+        while (fade_.buffer.size() - fade_.bufferPos < needed) {
+            fade_.buffer.erase(fade_.buffer.begin(), fade_.buffer.begin() + fade_.bufferPos);
+            fade_.bufferPos = 0;
+            if (!fade_.drained && prevDecoder_) {
+                if (decodeChunk(*prevDecoder_, fade_.converter, fade_.chunk) == 0) {
+                    fade_.converter.flush(fade_.chunk);
+                    fade_.drained = true;
+                }
+                fade_.buffer.insert(fade_.buffer.end(), fade_.chunk.begin(), fade_.chunk.end());
+            } else {
+                fade_.buffer.resize(needed, 0.0f);
+            }
+        }
+        float step = 1.0f / static_cast<float>(fade_.total);
+        // 渲染线程在淡变开始时已改用淡入曲目的增益，淡出曲目按两者之比补偿
+        float incomingGain = switchedGain_.load(std::memory_order_relaxed);
+        float outgoingScale = incomingGain > 0.0f ? fade_.outgoingGain / incomingGain : 0.0f;
+        mixKernel_(samples.data(), fade_.buffer.data() + fade_.bufferPos, frames, channels,
+                   static_cast<float>(fade_.position) * step, step, outgoingScale);
+        fade_.bufferPos += needed;
+        fade_.position += frames;
+        if (fade_.position >= fade_.total) {
+            fade_.active = false;
+        }
+    }
+
+    void waitForWork(std::unique_lock<std::mutex>& lock) {
+        // 渲染线程不会通知条件变量，因此按半个周期超时轮询剩余空间
+        auto timeout = std::chrono::microseconds(
+            500000ULL * config_.periodFrames / config_.sampleRate);
+        decodeCv_.wait_for(lock, timeout);
+    }
+
+    // 渲染线程：按周期从环形缓冲区取数据写入输出端
+    void renderLoop() {
+        const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(
+                static_cast<double>(config_.periodFrames) / config_.sampleRate));
+        enableFlushDenormals();
+        MUSICAPP_STATS_THREAD();
+        auto next = std::chrono::steady_clock::now();
+
+        while (running_) {
+            // 流刚结束：立即进入下一个（已停止的）周期
+            if (!renderPeriod()) continue;
+
+            // 非时钟驱动的输出端由引擎按实时节奏调度
+            if (!sink_->isClocked()) {
+                auto now = std::chrono::steady_clock::now();
+                next += period;
+                if (next + 20 * period < now) next = now;
+                std::this_thread::sleep_until(next);
+            }
+        }
+    }
+
+    // 渲染一个周期；流在本周期结束时返回 false（设备时钟只前进实际输出的帧数）
+    bool renderPeriod() {
+        const size_t channels = config_.channels;
+        const size_t periodSamples = mix_.size();
+        uint64_t& localSeq = render_.localSeq;
+        uint64_t& clock = render_.clock;
+        uint64_t& endClock = render_.endClock;
+        bool& gapArmed = render_.gapArmed;
+        uint64_t& silenceRun = render_.silenceRun;
+        uint32_t& positionClock = render_.positionClock;
+
+        uint64_t seq = flushSeq_.load(std::memory_order_acquire);
+        if (seq != localSeq) {
+            ring_.skipTo(flushIndex_.load(std::memory_order_relaxed));
+            framesPlayed_.store(flushFrame_.load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+            localSeq = seq;
+        }
+
+        if (state_.load(std::memory_order_acquire) == PlayState::Playing) {
+            MUSICAPP_PROBE(RenderPeriod);
+            // 周期内若包含曲目边界，分两段读取以精确定位切换点
+            uint64_t boundary = boundaryIndex_.load(std::memory_order_acquire);
+            uint64_t readPos = ring_.readIndex();
+            size_t got = 0;
+            size_t beforeBoundary = periodSamples;
+            if (boundary != UINT64_MAX && boundary >= readPos &&
+                boundary - readPos < periodSamples) {
+                beforeBoundary = static_cast<size_t>(boundary - readPos);
+                got = ring_.read(mix_.data(), beforeBoundary);
+                if (got == beforeBoundary) {
+                    got += ring_.read(mix_.data() + got, periodSamples - got);
+                }
+            } else {
+                got = ring_.read(mix_.data(), periodSamples);
+            }
+            size_t frames = got / channels;
+
+            gain_.setTarget(volume_.load(std::memory_order_relaxed) / 100.0f *
+                            trackGain_.load(std::memory_order_relaxed));
+            gain_.process(mix_.data(), frames, config_.channels);
+
+            // 跨过边界且已读到下一曲的数据：记录切换与间隙
+            // 与解码线程撤销衔接竞争同一个边界，CAS 成功者生效
+            uint64_t expectedBoundary = boundary;
+            if (got > beforeBoundary &&
+                requestGen_.load() == localSeq &&
+                boundaryIndex_.compare_exchange_strong(expectedBoundary, UINT64_MAX)) {
+                lastGapFrames_.store(beforeBoundary > 0 ? 0 : static_cast<int64_t>(silenceRun),
+                                     std::memory_order_relaxed);
+                trackGain_.store(switchedGain_.load(std::memory_order_relaxed),
+                                 std::memory_order_relaxed);
+                framesPlayed_.store(0, std::memory_order_relaxed);
+                frames = (got - beforeBoundary) / channels;
+                PlayerEvent event;
+                event.type = PlayerEventType::TrackChanged;
+                pushEvent(renderEvents_, event);
+            }
+            if (got > 0) {
+                if (gapArmed) {
+                    lastGapFrames_.store(static_cast<int64_t>(clock - endClock), std::memory_order_relaxed);
+                    gapArmed = false;
+                }
+                silenceRun = 0;
+            }
+
+            if (got < periodSamples) {
+                uint64_t eofIndex = eofIndex_.load(std::memory_order_acquire);
+                // 仍有未处理的加载/定位请求时不判定结束
+                bool ended = flushSeq_.load(std::memory_order_acquire) == localSeq &&
+                             requestGen_.load(std::memory_order_acquire) == localSeq &&
+                             ring_.readIndex() >= eofIndex;
+                if (ended) {
+                    // 流结束：输出剩余数据后停止
+                    if (got > 0 && sinkOpen_) sink_->write(mix_.data(), got / channels);
+                    framesPlayed_.fetch_add(frames, std::memory_order_relaxed);
+                    clock += got / channels;
+                    endClock = clock;
+                    gapArmed = true;
+                    PlayState expected = PlayState::Playing;
+                    if (state_.compare_exchange_strong(expected, PlayState::Stopped)) {
+                        PlayerEvent event;
+                        event.type = PlayerEventType::EndOfStream;
+                        event.position = framesPlayed_.load(std::memory_order_relaxed) /
+                                         static_cast<float>(config_.sampleRate);
+                        pushEvent(renderEvents_, event);
+                    }
+                    return false;
+                }
+                // 欠载：补静音，保持输出连续
+                underruns_.fetch_add(1, std::memory_order_relaxed);
+                MUSICAPP_COUNT(Underruns, 1);
+                MUSICAPP_COUNT(UnderrunFrames, (periodSamples - got) / channels);
+                std::fill(mix_.begin() + got, mix_.end(), 0.0f);
+                silenceRun += (periodSamples - got) / channels;
+            }
+
+            if (sinkOpen_) sink_->write(mix_.data(), config_.periodFrames);
+            uint64_t played = framesPlayed_.fetch_add(frames, std::memory_order_relaxed) + frames;
+
+            // 位置事件为低优先级：约每 250ms 一次，队列过半时丢弃
+            positionClock += config_.periodFrames;
+            if (positionClock >= config_.sampleRate / 4 &&
+                renderEvents_.freeSlots() > 128) {
+                positionClock = 0;
+                PlayerEvent event;
+                event.type = PlayerEventType::Position;
+                event.position = played / static_cast<float>(config_.sampleRate);
+                renderEvents_.push(event);
+            }
+        }
+        clock += config_.periodFrames;
+        return true;
+    }
+
+    std::unique_ptr<AudioSink> sink_;
+    NativeEngineConfig config_;
+    bool sinkOpen_ = false;
+
+    // 控制线程状态
+    std::string currentFile_;
+    std::atomic<float> volume_;
+    std::atomic<float> trackGain_{1.0f};
+    std::atomic<PlayState> state_;
+    float duration_;
+    bool loaded_ = false;           // 曾成功加载过曲目（之后才接受定位）
+    EndCallback onEndCallback_;
+    TransitionCallback onTransitionCallback_;
+    EventCallback onEventCallback_;
+
+    // 控制线程提交给解码线程的请求与对外显示的曲目名（由 decodeMutex_ 保护，只交换指针与字符串）
+    mutable std::mutex decodeMutex_;
+    std::condition_variable decodeCv_;
+    struct LoadRequest {
+        std::unique_ptr<AudioDecoder> decoder;  // 非空表示加载，否则只是定位
+        float seconds = 0.0f;
+    };
+    LoadRequest request_;                       // 随 requestGen_ 递增
+    struct QueueRequest {
+        std::unique_ptr<AudioDecoder> decoder;  // 为空表示取消预载
+        std::string file;
+        float duration = 0.0f;
+        float gain = 1.0f;
+    };
+    QueueRequest queued_;                       // 随 queueGen_ 递增
+    std::atomic<uint64_t> queueGen_{0};
+    std::string queuedFile_;        // 已预载（请求中或已取走）的曲目
+    std::string switchedFile_;      // 已衔接、等待渲染线程跨过边界的曲目
+    float switchedDuration_ = 0.0f;
+    std::atomic<float> switchedGain_{1.0f};     // 渲染线程跨过边界时成为当前曲目增益
+
+    // 解码线程独占的状态（托管模式下为调用 renderPeriods 的线程）
+    std::unique_ptr<AudioDecoder> decoder_;
+    std::unique_ptr<AudioDecoder> nextDecoder_;
+    std::unique_ptr<AudioDecoder> prevDecoder_;    // 衔接后、边界消费前保留的上一曲
+    std::string nextFile_;
+    float nextDuration_ = 0.0f;
+    uint64_t nextGen_ = 0;
+    float nextGain_ = 1.0f;
+    std::vector<float> decoded_;
+    std::vector<float> mapped_;
+
+    // 解码进度：在 decodeStep 的调用之间保留
+    struct DecodeCursor {
+        std::vector<float> pending;     // 已转换、尚未写入环形缓冲区的样本
+        size_t pendingPos = 0;
+        uint64_t servedGen = 0;         // 已处理的加载/定位请求
+        uint64_t queueGen = 0;          // 已取走的预载请求
+        bool eof = true;
+        Resampler converter;
+        bool drained = false;           // 重采样器的尾部已输出
+        std::vector<float> nextPending; // 下一曲的预解码数据
+        Resampler nextConverter;
+        uint64_t primedGen = 0;
+    };
+    DecodeCursor decode_;
+
+    // 交叉淡变状态（只由解码线程访问）
+    struct CrossfadeState {
+        bool active = false;
+        uint64_t total = 0;             // 淡变长度（输出帧）
+        uint64_t position = 0;
+        bool drained = false;           // 淡出曲目已读完
+        float outgoingGain = 1.0f;      // 淡出曲目的曲目增益
+        Resampler converter;            // 淡出曲目的重采样器
+        std::vector<float> buffer;      // 淡出曲目已转换、尚未混合的样本
+        size_t bufferPos = 0;
+        std::vector<float> chunk;
+    };
+    CrossfadeState fade_;
+    CrossfadeKernels::MixFn mixKernel_ = CrossfadeKernels::select(hostSimdLevel());
+    std::atomic<uint32_t> crossfadeFrames_{0};
+
+    // 解码线程与渲染线程之间的无锁通信
+    SpscRingBuffer<float> ring_;
+    std::atomic<uint64_t> requestGen_{0};
+    std::atomic<uint64_t> flushSeq_{0};
+    std::atomic<uint64_t> flushIndex_{0};
+    std::atomic<uint64_t> flushFrame_{0};
+    std::atomic<uint64_t> eofIndex_{UINT64_MAX};
+    std::atomic<uint64_t> boundaryIndex_{UINT64_MAX};
+    std::atomic<int64_t> lastGapFrames_{-1};     // 尚未发生曲目切换时为 -1
+    std::atomic<uint64_t> framesPlayed_{0};
+    std::atomic<uint64_t> underruns_{0};
+    std::atomic<uint64_t> bytesCopied_{0};
+    std::atomic<bool> zeroCopy_{false};
+    std::chrono::steady_clock::time_point startTime_ = std::chrono::steady_clock::now();
+    PlayerEventQueue renderEvents_;     // 生产者：渲染线程
+    PlayerEventQueue decodeEvents_;     // 生产者：解码线程
+    std::unique_ptr<EventWake> wake_;   // 结束、切换与错误事件入队后唤醒事件循环；托管模式下为空
+    std::atomic<bool> running_{false};
+
+    // 渲染线程预分配缓冲区与增益级
+    std::vector<float> mix_;
+    GainStage gain_;
+
+    // 渲染进度：在 renderPeriod 的调用之间保留（只由渲染方访问）
+    struct RenderClock {
+        uint64_t localSeq = 0;
+        uint64_t clock = 0;             // 设备时钟（帧）
+        uint64_t endClock = 0;          // 上一次流结束时的设备时钟
+        bool gapArmed = false;          // 流结束后等待下一首的第一帧
+        uint64_t silenceRun = 0;        // 自最后一帧有效数据以来补入的静音帧数
+        uint32_t positionClock = 0;     // 距上次位置事件的帧数
+    };
+    RenderClock render_;
+
+    std::thread decodeThread_;
+    std::thread renderThread_;
+};
+
+} // namespace MusicApp
+
+#endif // NATIVE_AUDIO_PLAYER_H
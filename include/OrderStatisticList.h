@@ -0,0 +1,259 @@
+#ifndef ORDER_STATISTIC_LIST_H
+#define ORDER_STATISTIC_LIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MusicApp {
+
+// 32 位编号组成的序列（隐式 treap）
+// 按位置插入、删除、取第 k 个元素与求元素位置均为期望 O(log n)。编号同时是节点下标，
+// 父指针使得按编号删除与求位置无需查找；优先级由编号哈希得到，不额外存储。
+// 两次修改之间按位置读取较多时，序列展开为位置 → 编号数组，之后的读取为 O(1)
+class OrderStatisticList {
+public:
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+    size_t size() const { return root_ == kNone ? 0 : nodes_[root_].size; }
+    bool empty() const { return root_ == kNone; }
+    bool contains(uint32_t id) const { return id < nodes_.size() && nodes_[id].size != 0; }
+
+    void reserve(size_t ids) { nodes_.reserve(ids); }
+
+    void clear() {
+        nodes_.clear();
+        root_ = kNone;
+        invalidateFlat();
+    }
+
+    // 插入到 position 之前（position == size() 时追加）；id 不能已在序列中
+    void insert(size_t position, uint32_t id) {
+        prepare(id);
+        uint32_t left, right;
+        split(root_, position, left, right);
+        setRoot(merge(merge(left, id), right));
+        invalidateFlat();
+    }
+
+    // 追加到末尾：只沿右链合并
+    void pushBack(uint32_t id) {
+        prepare(id);
+        setRoot(merge(root_, id));
+        if (flatValid_) flat_.push_back(id);
+    }
+
+    void erase(uint32_t id) {
+        Node removed = nodes_[id];
+        uint32_t child = merge(removed.left, removed.right);
+        if (child != kNone) nodes_[child].parent = removed.parent;
+        if (removed.parent == kNone) {
+            root_ = child;
+        } else {
+            Node& p = nodes_[removed.parent];
+            (p.left == id ? p.left : p.right) = child;
+            for (uint32_t x = removed.parent; x != kNone; x = nodes_[x].parent) {
+                nodes_[x].size--;
+            }
+        }
+        nodes_[id] = Node();
+        invalidateFlat();
+    }
+
+    // 第 position 个元素。自上次修改以来的读取次数超过 size() / kFlattenRatio 时展开一次（O(n)），
+    // 展开的代价由之前的树上查找分摊。const 读取会更新展开数组，调用方须与修改互斥
+    uint32_t at(size_t position) const {
+        if (!flatValid_ && ++lookups_ > size() / kFlattenRatio) {
+            flat_ = toVector();
+            flatValid_ = true;
+        }
+        if (flatValid_) return flat_[position];
+        uint32_t t = root_;
+        while (true) {
+            size_t leftSize = sizeOf(nodes_[t].left);
+            if (position < leftSize) {
+                t = nodes_[t].left;
+            } else if (position == leftSize) {
+                return t;
+            } else {
+                position -= leftSize + 1;
+                t = nodes_[t].right;
+            }
+        }
+    }
+
+    // 元素所在位置
+    size_t positionOf(uint32_t id) const {
+        size_t position = sizeOf(nodes_[id].left);
+        for (uint32_t x = id; nodes_[x].parent != kNone; x = nodes_[x].parent) {
+            const Node& p = nodes_[nodes_[x].parent];
+            if (p.right == x) position += sizeOf(p.left) + 1;
+        }
+        return position;
+    }
+
+    uint32_t first() const {
+        uint32_t t = root_;
+        if (t == kNone) return kNone;
+        while (nodes_[t].left != kNone) t = nodes_[t].left;
+        return t;
+    }
+
+    // 中序后继，没有时返回 kNone
+    uint32_t next(uint32_t id) const {
+        if (nodes_[id].right != kNone) {
+            uint32_t t = nodes_[id].right;
+            while (nodes_[t].left != kNone) t = nodes_[t].left;
+            return t;
+        }
+        uint32_t x = id;
+        while (nodes_[x].parent != kNone && nodes_[nodes_[x].parent].right == x) {
+            x = nodes_[x].parent;
+        }
+        return nodes_[x].parent;
+    }
+
+    // 按序列顺序输出全部编号
+    std::vector<uint32_t> toVector() const {
+        std::vector<uint32_t> ids;
+        ids.reserve(size());
+        for (uint32_t id = first(); id != kNone; id = next(id)) {
+            ids.push_back(id);
+        }
+        return ids;
+    }
+
+    // 以给定序列重建，O(n)：按优先级用单调栈构造笛卡尔树
+    void assign(const std::vector<uint32_t>& ids) {
+        clear();
+        if (ids.empty()) return;
+        uint32_t maxId = 0;
+        for (uint32_t id : ids) {
+            if (id > maxId) maxId = id;
+        }
+        nodes_.resize(static_cast<size_t>(maxId) + 1);
+        std::vector<uint32_t> stack;
+        for (uint32_t id : ids) {
+            nodes_[id] = Node{ kNone, kNone, kNone, 1 };
+            uint32_t last = kNone;
+            while (!stack.empty() && priority(stack.back()) < priority(id)) {
+                last = stack.back();
+                stack.pop_back();
+            }
+            nodes_[id].left = last;
+            if (last != kNone) nodes_[last].parent = id;
+            if (!stack.empty()) {
+                nodes_[stack.back()].right = id;
+                nodes_[id].parent = stack.back();
+            }
+            stack.push_back(id);
+        }
+        root_ = stack.front();
+
+        // 先序的逆序保证子节点先于父节点计算大小
+        std::vector<uint32_t> order;
+        order.reserve(ids.size());
+        stack.assign(1, root_);
+        while (!stack.empty()) {
+            uint32_t t = stack.back();
+            stack.pop_back();
+            order.push_back(t);
+            if (nodes_[t].left != kNone) stack.push_back(nodes_[t].left);
+            if (nodes_[t].right != kNone) stack.push_back(nodes_[t].right);
+        }
+        for (size_t i = order.size(); i-- > 0;) {
+            Node& n = nodes_[order[i]];
+            n.size = 1 + sizeOf(n.left) + sizeOf(n.right);
+        }
+    }
+
+    size_t memoryUsage() const { return nodes_.capacity() * sizeof(Node) + flat_.capacity() * sizeof(uint32_t); }
+
+private:
+    struct Node {
+        uint32_t left = kNone;
+        uint32_t right = kNone;
+        uint32_t parent = kNone;
+        uint32_t size = 0;      // 0 表示不在序列中
+    };
+
+    // 32 位整数哈希（双射，优先级不会重复）
+    static uint32_t priority(uint32_t id) {
+        id ^= id >> 16;
+        id *= 0x85EBCA6Bu;
+        id ^= id >> 13;
+        id *= 0xC2B2AE35u;
+        id ^= id >> 16;
+        return id;
+    }
+
+    static constexpr size_t kFlattenRatio = 32;
+
+    uint32_t sizeOf(uint32_t t) const { return t == kNone ? 0 : nodes_[t].size; }
+
+    void invalidateFlat() {
+        flatValid_ = false;
+        lookups_ = 0;
+    }
+
+    void prepare(uint32_t id) {
+        if (id >= nodes_.size()) nodes_.resize(static_cast<size_t>(id) + 1);
+        nodes_[id] = Node{ kNone, kNone, kNone, 1 };
+    }
+
+    void setRoot(uint32_t t) {
+        root_ = t;
+        if (t != kNone) nodes_[t].parent = kNone;
+    }
+
+    void update(uint32_t t) {
+        Node& n = nodes_[t];
+        n.size = 1 + sizeOf(n.left) + sizeOf(n.right);
+        if (n.left != kNone) nodes_[n.left].parent = t;
+        if (n.right != kNone) nodes_[n.right].parent = t;
+    }
+
+    // 把 t 拆成前 count 个元素与其余部分
+    void split(uint32_t t, size_t count, uint32_t& left, uint32_t& right) {
+        if (t == kNone) {
+            left = right = kNone;
+            return;
+        }
+        size_t leftSize = sizeOf(nodes_[t].left);
+        if (leftSize < count) {
+            uint32_t rest;
+            split(nodes_[t].right, count - leftSize - 1, rest, right);
+            nodes_[t].right = rest;
+            left = t;
+        } else {
+            uint32_t rest;
+            split(nodes_[t].left, count, left, rest);
+            nodes_[t].left = rest;
+            right = t;
+        }
+        update(t);
+    }
+
+    uint32_t merge(uint32_t a, uint32_t b) {
+        if (a == kNone) return b;
+        if (b == kNone) return a;
+        if (priority(a) > priority(b)) {
+            nodes_[a].right = merge(nodes_[a].right, b);
+            update(a);
+            return a;
+        }
+        nodes_[b].left = merge(a, nodes_[b].left);
+        update(b);
+        return b;
+    }
+
+    std::vector<Node> nodes_;
+    uint32_t root_ = kNone;
+    mutable std::vector<uint32_t> flat_;    // 展开的位置 → 编号，flatValid_ 为 true 时有效
+    mutable bool flatValid_ = false;
+    mutable size_t lookups_ = 0;            // 自上次修改以来的树上查找次数
+};
+
+} // namespace MusicApp
+
+#endif // ORDER_STATISTIC_LIST_H
@@ -1,10 +1,17 @@
 #ifndef PLAYLIST_H
 #define PLAYLIST_H
 
+#include "AudioFormat.h"
+#include "Instrumentation.h"
+#include "OrderStatisticList.h"
+#include "SearchIndex.h"
+#include "TrackStore.h"
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <random>
 #include <algorithm>
+#include <chrono>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -25,24 +32,16 @@ inline std::string extractFileName(const std::string& path) {
            filename.substr(0, lastDot) : filename;
 }
 
-// 获取文件扩展名（小写）
-inline std::string getExtension(const std::string& path) {
-    size_t lastDot = path.find_last_of('.');
-    if (lastDot == std::string::npos) return "";
-    std::string ext = path.substr(lastDot);
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    return ext;
-}
-
-// 歌曲信息结构
+// 歌曲信息结构（添加曲目时使用；列表内部以列式 TrackStore 存放，通过 TrackView 访问）
 struct TrackInfo {
     std::string filepath;
     std::string title;
     std::string artist;
     float duration;  // 秒
+    bool metadataRead;  // 已尝试读取文件标签（无论是否读到）
     
     TrackInfo(const std::string& path = "") 
-        : filepath(path), duration(0.0f) {
+        : filepath(path), duration(0.0f), metadataRead(false) {
         // 从文件路径提取标题
         if (!path.empty()) {
             title = extractFileName(path);
@@ -50,7 +49,69 @@ struct TrackInfo {
     }
 };
 
+// 搜索结果
+struct SearchMatches {
+    size_t total = 0;
+    bool approximate = false;       // 没有精确匹配时按近似匹配给出
+    double seconds = 0.0;
+    std::vector<size_t> positions;  // 列表位置，按列表顺序，至多 limit 个
+};
+
+// 按列表顺序访问曲目的视图
+class TrackList {
+public:
+    class Iterator {
+    public:
+        Iterator(const TrackList* list, size_t position, uint32_t node)
+            : list_(list), position_(position), node_(node) {}
+        
+        TrackView operator*() const {
+            size_t ordered = list_->order_.size();
+            return list_->store_[position_ < ordered ? node_ : list_->tail_[position_ - ordered]];
+        }
+        
+        Iterator& operator++() {
+            position_++;
+            if (node_ != OrderStatisticList::kNone) node_ = list_->order_.next(node_);
+            return *this;
+        }
+        
+        bool operator==(const Iterator& other) const { return position_ == other.position_; }
+        bool operator!=(const Iterator& other) const { return position_ != other.position_; }
+        
+    private:
+        const TrackList* list_;
+        size_t position_;
+        uint32_t node_;
+    };
+    
+    TrackList(const TrackStore& store, const OrderStatisticList& order, const std::vector<uint32_t>& tail)
+        : store_(store), order_(order), tail_(tail) {}
+    
+    size_t size() const { return order_.size() + tail_.size(); }
+    bool empty() const { return size() == 0; }
+    
+    TrackView operator[](size_t index) const {
+        return store_[index < order_.size() ? order_.at(index) : tail_[index - order_.size()]];
+    }
+    
+    Iterator begin() const { return Iterator(this, 0, order_.first()); }
+    // 从 position 开始遍历，定位 O(log n)
+    Iterator iteratorAt(size_t position) const {
+        return Iterator(this, position, position < order_.size() ? order_.at(position) : OrderStatisticList::kNone);
+    }
+    Iterator end() const { return Iterator(this, size(), OrderStatisticList::kNone); }
+    
+private:
+    const TrackStore& store_;
+    const OrderStatisticList& order_;
+    const std::vector<uint32_t>& tail_;
+};
+
 // 播放列表管理类
+// 列表顺序与随机顺序各是一条顺序统计序列，插入、移除与移动都是 O(log n)，随机顺序不会因此重排；
+// 当前位置始终指向同一首曲目。追加的曲目先放在列表尾部缓冲区，下一次在中间修改时再并入序列；
+// 加载后尚未修改的前缀（以及整理之后的整个列表）中编号就是位置，按位置取曲目直接访问列存储
 class Playlist {
 public:
     Playlist() : currentIndex_(-1), shuffleMode_(false) {
@@ -60,58 +121,83 @@ public:
     
     // 添加曲目
     void addTrack(const std::string& filepath) {
-        tracks_.emplace_back(filepath);
-        shuffledIndices_.push_back(tracks_.size() - 1);
-        if (currentIndex_ < 0) {
-            currentIndex_ = 0;
+        append(tracks_.add(filepath, std::string_view(), std::string_view(), 0.0f, false));
+    }
+    
+    // 添加已带元数据的曲目
+    void addTrack(const TrackInfo& track) {
+        append(tracks_.add(track.filepath, track.title, track.artist, track.duration, track.metadataRead));
+    }
+    
+    // 按目录前缀（含末尾分隔符）与文件名添加，批量加载时避免拼接完整路径；返回曲目编号
+    uint32_t addTrack(std::string_view directory, std::string_view name, std::string_view title,
+                      std::string_view artist, float duration, bool metadataRead) {
+        uint32_t id = tracks_.add(directory, name, title, artist, duration, metadataRead);
+        append(id);
+        return id;
+    }
+    
+    // 插入到列表中的 index 之前（index == size() 时追加）
+    bool insertTrack(size_t index, const std::string& filepath) {
+        if (index > size()) return false;
+        if (index == size()) {
+            addTrack(filepath);
+            return true;
+        }
+        settleTail();
+        uint32_t id = tracks_.add(filepath, std::string_view(), std::string_view(), 0.0f, false);
+        order_.insert(index, id);
+        identity_ = std::min(identity_, index);
+        if (shuffleMode_) {
+            insertShuffled(id);
+        } else if (static_cast<int>(index) <= currentIndex_) {
+            currentIndex_++;
         }
+        return true;
+    }
+    
+    // 预留容量，批量添加前调用；extraChars 为新增曲目文件名与标题的字节数（已知时）
+    void reserve(size_t count, size_t extraChars = 0) {
+        tracks_.reserve(count, extraChars);
+        tail_.reserve(count - std::min(count, order_.size()));
     }
     
     // 添加多个曲目
     void addTracks(const std::vector<std::string>& files) {
+        reserve(size() + files.size());
         for (const auto& f : files) {
             addTrack(f);
         }
     }
     
-    // 从目录加载音频文件
+    // 从目录加载音频文件：扩展名匹配的文件再嗅探内容，内容不是音频的文件在此跳过
     int loadFromDirectory(const std::string& dirPath) {
+        MUSICAPP_PROBE(LoadDirectory);
         int count = 0;
 #ifdef _WIN32
         WIN32_FIND_DATAA findData;
         std::string searchPath = dirPath + "\\*";
+        std::string prefix = dirPath + "\\";
         HANDLE hFind = FindFirstFileA(searchPath.c_str(), &findData);
         
         if (hFind != INVALID_HANDLE_VALUE) {
             do {
-                if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-                    std::string filename = findData.cFileName;
-                    std::string ext = getExtension(filename);
-                    // 支持常见音频格式
-                    if (ext == ".mp3" || ext == ".wav" || ext == ".ogg" || 
-                        ext == ".flac" || ext == ".m4a" || ext == ".wma") {
-                        std::string fullPath = dirPath + "\\" + filename;
-                        addTrack(fullPath);
-                        count++;
-                    }
+                const char* name = findData.cFileName;
+                if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && hasAudioExtension(name)) {
+                    count += addScannedFile(prefix, name, sniffAudioFile(prefix + name));
                 }
             } while (FindNextFileA(hFind, &findData));
             FindClose(hFind);
         }
 #else
+        std::string prefix = dirPath + "/";
         DIR* dir = opendir(dirPath.c_str());
         if (dir) {
             struct dirent* entry;
             while ((entry = readdir(dir)) != nullptr) {
-                if (entry->d_type == DT_REG) {
-                    std::string filename = entry->d_name;
-                    std::string ext = getExtension(filename);
-                    if (ext == ".mp3" || ext == ".wav" || ext == ".ogg" || 
-                        ext == ".flac" || ext == ".m4a" || ext == ".wma") {
-                        std::string fullPath = dirPath + "/" + filename;
-                        addTrack(fullPath);
-                        count++;
-                    }
+                const char* name = entry->d_name;
+                if (entry->d_type == DT_REG && hasAudioExtension(name)) {
+                    count += addScannedFile(prefix, name, sniffAudioFileAt(dirfd(dir), name));
                 }
             }
             closedir(dir);
@@ -120,93 +206,229 @@ public:
         return count;
     }
     
-    // 移除曲目
-    void removeTrack(size_t index) {
-        if (index < tracks_.size()) {
-            tracks_.erase(tracks_.begin() + index);
-            rebuildShuffleIndices();
-            if (currentIndex_ >= static_cast<int>(tracks_.size())) {
-                currentIndex_ = tracks_.empty() ? -1 : tracks_.size() - 1;
+    // 移除曲目；位置无效时返回 false
+    bool removeTrack(size_t index) {
+        if (index >= size()) return false;
+        settleTail();
+        uint32_t id = order_.at(index);
+        size_t position = index;
+        if (shuffleMode_) {
+            position = shuffle_.positionOf(id);
+            shuffle_.erase(id);
+        }
+        order_.erase(id);
+        tracks_.erase(id);
+        identity_ = std::min(identity_, index);
+        // 移除的是当前曲目时（其音频仍在播放），当前位置退到前一首，
+        // 下一次 next() 正好落到被移除曲目的后继上；可能变为 -1
+        if (static_cast<int>(position) <= currentIndex_) {
+            currentIndex_--;
+        }
+        if (currentIndex_ >= static_cast<int>(size())) {
+            currentIndex_ = static_cast<int>(size()) - 1;
+        }
+        compactIfSparse();
+        return true;
+    }
+    
+    // 把列表中 from 处的曲目移到 to 处；随机顺序不变
+    bool moveTrack(size_t from, size_t to) {
+        if (from >= size() || to >= size()) return false;
+        if (from == to) return true;
+        settleTail();
+        uint32_t id = order_.at(from);
+        order_.erase(id);
+        order_.insert(to, id);
+        identity_ = std::min(identity_, std::min(from, to));
+        if (!shuffleMode_) {
+            int current = currentIndex_;
+            if (current == static_cast<int>(from)) {
+                currentIndex_ = static_cast<int>(to);
+            } else if (from < to && current > static_cast<int>(from) && current <= static_cast<int>(to)) {
+                currentIndex_--;
+            } else if (to < from && current >= static_cast<int>(to) && current < static_cast<int>(from)) {
+                currentIndex_++;
             }
         }
+        return true;
     }
     
     // 清空列表
     void clear() {
         tracks_.clear();
-        shuffledIndices_.clear();
+        order_.clear();
+        shuffle_.clear();
+        tail_.clear();
+        search_.clear();
+        identity_ = 0;
         currentIndex_ = -1;
+        revision_++;
     }
     
     // 获取当前曲目
-    const TrackInfo* getCurrentTrack() const {
-        if (currentIndex_ >= 0 && currentIndex_ < static_cast<int>(tracks_.size())) {
-            int idx = shuffleMode_ ? shuffledIndices_[currentIndex_] : currentIndex_;
-            return &tracks_[idx];
-        }
-        return nullptr;
+    TrackView getCurrentTrack() const {
+        if (currentIndex_ < 0) return TrackView();
+        return getTrackInPlayOrder(currentIndex_);
+    }
+    
+    // 按播放顺序获取曲目（随机模式下经过洗牌映射）
+    TrackView getTrackInPlayOrder(size_t position) const {
+        if (position >= size()) return TrackView();
+        return tracks_[shuffleMode_ ? shuffle_.at(position) : idAt(position)];
     }
     
     // 获取指定曲目
-    const TrackInfo* getTrack(size_t index) const {
-        if (index < tracks_.size()) {
-            return &tracks_[index];
+    TrackView getTrack(size_t index) const {
+        if (index < size()) {
+            return tracks_[idAt(index)];
         }
-        return nullptr;
+        return TrackView();
     }
     
+    // 按曲目编号获取（编号在 clear() 或整理之前不变，见 getRevision()），已移除时返回空视图
+    TrackView getTrackById(size_t id) const {
+        if (id < tracks_.size() && !tracks_.isRemoved(id)) {
+            return tracks_[id];
+        }
+        return TrackView();
+    }
+    
+    // 编号上限（含已移除的曲目）
+    size_t getTrackIdLimit() const { return tracks_.size(); }
+    
+    // 写入后台读取到的元数据：空字符串与 0 时长表示保留原值，曲目随即标记为已读取
+    void setTrackMetadata(size_t id, std::string_view title, std::string_view artist, float duration) {
+        if (!getTrackById(id)) return;
+        if (!title.empty()) tracks_.setTitle(id, title);
+        if (!artist.empty()) tracks_.setArtist(id, artist);
+        if (duration > 0.0f) tracks_.setDuration(id, duration);
+        tracks_.setMetadataRead(id);
+        if (!title.empty()) search_.retitle(tracks_, static_cast<uint32_t>(id));
+    }
+    
+    // 写入响度分析结果
+    void setTrackLoudness(size_t id, const TrackLoudness& loudness) {
+        if (!getTrackById(id)) return;
+        tracks_.setLoudness(id, loudness);
+    }
+    
+    // 曲目编号失效（清空或整理）时递增
+    uint64_t getRevision() const { return revision_; }
+    
     // 下一曲
     bool next() {
-        if (tracks_.empty()) return false;
-        currentIndex_ = (currentIndex_ + 1) % tracks_.size();
+        if (isEmpty()) return false;
+        currentIndex_ = (currentIndex_ + 1) % size();
         return true;
     }
     
     // 上一曲
     bool previous() {
-        if (tracks_.empty()) return false;
-        currentIndex_ = (currentIndex_ - 1 + tracks_.size()) % tracks_.size();
+        if (isEmpty()) return false;
+        currentIndex_ = (currentIndex_ - 1 + size()) % size();
         return true;
     }
     
     // 跳转到指定曲目
     bool jumpTo(size_t index) {
-        if (index < tracks_.size()) {
+        if (index < size()) {
             currentIndex_ = index;
             return true;
         }
         return false;
     }
     
-    // 随机播放模式
+    // 随机播放模式：切换时当前曲目不变
     void setShuffle(bool enabled) {
+        TrackView current = getCurrentTrack();
         shuffleMode_ = enabled;
         if (enabled) {
-            shuffle();
+            reshuffle(current);
+        } else {
+            shuffle_.clear();
+            settleTail();
+            if (current) currentIndex_ = static_cast<int>(order_.positionOf(current.id()));
         }
     }
     
     bool isShuffleEnabled() const { return shuffleMode_; }
     
-    // 重新洗牌
+    // 重新洗牌，当前曲目不变
     void shuffle() {
-        rebuildShuffleIndices();
-        std::shuffle(shuffledIndices_.begin(), shuffledIndices_.end(), rng_);
+        if (shuffleMode_) reshuffle(getCurrentTrack());
+    }
+    
+    // 在标题、艺术家与路径中搜索（ASCII 不区分大小写）；没有精确匹配时改用近似匹配
+    SearchMatches find(std::string_view query, size_t limit) {
+        auto start = std::chrono::steady_clock::now();
+        SearchMatches matches;
+        std::vector<uint32_t> ids = search_.find(tracks_, query);
+        if (ids.empty()) {
+            ids = search_.findApproximate(tracks_, query);
+            matches.approximate = !ids.empty();
+        }
+        matches.total = ids.size();
+        // 匹配较少时逐个求位置再排序，较多时按列表顺序遍历一次
+        const size_t kSortLimit = 1024;
+        if (ids.size() <= kSortLimit) {
+            for (uint32_t id : ids) {
+                matches.positions.push_back(positionOf(id));
+            }
+            std::sort(matches.positions.begin(), matches.positions.end());
+            if (matches.positions.size() > limit) matches.positions.resize(limit);
+        } else {
+            std::vector<bool> hit(tracks_.size(), false);
+            for (uint32_t id : ids) hit[id] = true;
+            size_t position = 0;
+            for (TrackView track : getTracks()) {
+                if (matches.positions.size() >= limit) break;
+                if (hit[track.id()]) matches.positions.push_back(position);
+                position++;
+            }
+        }
+        matches.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return matches;
+    }
+    
+    // 列表位置对应的播放顺序位置（供 jumpTo 使用）
+    size_t getPlayPosition(size_t index) const {
+        if (!shuffleMode_ || index >= size()) return index;
+        return shuffle_.positionOf(idAt(index));
     }
     
     // 获取列表大小
-    size_t size() const { return tracks_.size(); }
-    bool isEmpty() const { return tracks_.empty(); }
+    size_t size() const { return order_.size() + tail_.size(); }
+    bool isEmpty() const { return size() == 0; }
     
     // 获取当前索引
     int getCurrentIndex() const { return currentIndex_; }
     
-    // 获取所有曲目
-    const std::vector<TrackInfo>& getTracks() const { return tracks_; }
+    // 当前曲目的列表位置（随机模式下与播放顺序位置不同），没有当前曲目时返回 -1
+    int getCurrentListIndex() const {
+        TrackView current = getCurrentTrack();
+        return current ? static_cast<int>(positionOf(current.id())) : -1;
+    }
+    
+    // 获取所有曲目（列表顺序）
+    TrackList getTracks() const { return TrackList(tracks_, order_, tail_); }
+    
+    // 底层曲目存储（目录表、艺术家表等统计）
+    const TrackStore& getTrackStore() const { return tracks_; }
+    
+    // 搜索索引的内存占用（首次搜索时建立）
+    size_t searchMemoryUsage() const { return search_.memoryUsage(); }
+    
+    // 曲目存储与顺序结构的内存占用
+    TrackStoreMemory memoryUsage() const {
+        TrackStoreMemory m = tracks_.memoryUsage();
+        m.tracks = size();
+        m.columns += order_.memoryUsage() + shuffle_.memoryUsage() + tail_.capacity() * sizeof(uint32_t);
+        return m;
+    }
     
     // 检查是否到达列表末尾
     bool isAtEnd() const {
-        return currentIndex_ >= static_cast<int>(tracks_.size()) - 1;
+        return currentIndex_ >= static_cast<int>(size()) - 1;
     }
     
     // 检查是否在列表开头
@@ -215,18 +437,108 @@ public:
     }
     
 private:
-    void rebuildShuffleIndices() {
-        shuffledIndices_.clear();
-        for (size_t i = 0; i < tracks_.size(); i++) {
-            shuffledIndices_.push_back(i);
+    uint32_t idAt(size_t index) const {
+        if (index < identity_) return static_cast<uint32_t>(index);
+        return index < order_.size() ? order_.at(index) : tail_[index - order_.size()];
+    }
+    
+    // 曲目的列表位置；尾部缓冲区中的编号递增，二分查找
+    size_t positionOf(uint32_t id) const {
+        if (id < identity_) return id;
+        if (order_.contains(id)) return order_.positionOf(id);
+        return order_.size() + (std::lower_bound(tail_.begin(), tail_.end(), id) - tail_.begin());
+    }
+    
+    // 所有曲目重新随机排列（O(n)），current 移到其在新顺序中的位置
+    void reshuffle(TrackView current) {
+        settleTail();
+        std::vector<uint32_t> ids = order_.toVector();
+        std::shuffle(ids.begin(), ids.end(), rng_);
+        shuffle_.assign(ids);
+        if (current) currentIndex_ = static_cast<int>(shuffle_.positionOf(current.id()));
+    }
+    
+    // 目录加载时的候选文件：内容是音频时加入列表，嗅探结果写入格式缓存供打开解码器时使用
+    bool addScannedFile(const std::string& prefix, const char* name, const SniffResult& sniffed) {
+        if (sniffed.format == AudioFormat::Unknown) return false;
+        AudioFormatCache::shared().store(prefix + name, sniffed);
+        addTrack(prefix, name, std::string_view(), std::string_view(), 0.0f, false);
+        return true;
+    }
+
+    void append(uint32_t id) {
+        if (identity_ == size() && id == identity_) identity_++;
+        tail_.push_back(id);
+        if (shuffleMode_) {
+            insertShuffled(id);
+        }
+        if (currentIndex_ < 0) {
+            currentIndex_ = 0;
+        }
+    }
+    
+    // 插入随机顺序中均匀随机的位置，当前曲目保持不变
+    void insertShuffled(uint32_t id) {
+        std::uniform_int_distribution<size_t> pick(0, shuffle_.size());
+        size_t position = pick(rng_);
+        shuffle_.insert(position, id);
+        if (currentIndex_ >= 0 && static_cast<int>(position) <= currentIndex_) {
+            currentIndex_++;
+        }
+    }
+    
+    // 把尾部缓冲区并入列表顺序：数量较多时整体重建（O(n)），否则逐个追加
+    void settleTail() {
+        if (tail_.empty()) return;
+        if (tail_.size() > order_.size() / 16) {
+            std::vector<uint32_t> ids = order_.toVector();
+            ids.insert(ids.end(), tail_.begin(), tail_.end());
+            order_.assign(ids);
+            std::vector<uint32_t>().swap(tail_);
+        } else {
+            for (uint32_t id : tail_) {
+                order_.pushBack(id);
+            }
+            tail_.clear();
+        }
+    }
+    
+    // 已移除的曲目多于现存曲目时按列表顺序重建存储，回收空间；曲目编号随之改变
+    void compactIfSparse() {
+        const size_t kMinRemoved = 4096;
+        if (tracks_.removedCount() < kMinRemoved || tracks_.removedCount() < size()) return;
+        settleTail();
+        std::vector<uint32_t> remap(tracks_.size(), OrderStatisticList::kNone);
+        TrackStore store;
+        store.reserve(size());
+        for (uint32_t id = order_.first(); id != OrderStatisticList::kNone; id = order_.next(id)) {
+            TrackView t = tracks_[id];
+            remap[id] = store.add(t.directory(), t.fileName(), t.title(), t.artist(), t.duration(),
+                                  t.metadataRead());
+            store.setLoudness(remap[id], t.loudness());
         }
+        std::vector<uint32_t> ids(store.size());
+        for (size_t i = 0; i < ids.size(); i++) ids[i] = static_cast<uint32_t>(i);
+        std::vector<uint32_t> shuffled = shuffle_.toVector();
+        for (auto& id : shuffled) id = remap[id];
+        tracks_ = std::move(store);
+        order_.assign(ids);
+        shuffle_.assign(shuffled);
+        search_.clear();
+        identity_ = ids.size();
+        revision_++;
     }
     
-    std::vector<TrackInfo> tracks_;
-    std::vector<size_t> shuffledIndices_;
-    int currentIndex_;
+    TrackStore tracks_;
+    OrderStatisticList order_;      // 列表顺序（不含尾部缓冲区）
+    std::vector<uint32_t> tail_;    // 追加到列表末尾、尚未并入 order_ 的曲目
+    size_t identity_ = 0;           // 前 identity_ 个位置上的编号等于位置，按位置取曲目时不经过顺序结构
+    OrderStatisticList shuffle_;    // 随机顺序，只在随机模式下维护
+    int currentIndex_;              // 当前曲目在播放顺序中的位置
     bool shuffleMode_;
+    uint64_t revision_ = 0;
     std::mt19937 rng_;
+    SearchIndex search_;            // 首次搜索时建立，之后随添加增量更新
 };
 
 } // namespace MusicApp
@@ -0,0 +1,131 @@
+#ifndef PLAYLIST_RENDERER_H
+#define PLAYLIST_RENDERER_H
+
+#include "Playlist.h"
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace MusicApp {
+
+// 播放列表的分页渲染
+// 只格式化可见的行，写入复用的缓冲区：编号与时长用 to_chars 写入栈上的小数组，标题与艺术家直接从 TrackStore
+// 追加，缓冲区容量够用之后不再有堆分配。起始行由顺序统计序列 O(log n) 定位，之后逐行取后继，
+// 一页的开销只取决于行数，与列表长度无关
+class PlaylistRenderer {
+public:
+    // 从列表位置 offset 开始的至多 count 行；返回的引用在下一次渲染前有效
+    const std::string& render(const Playlist& playlist, size_t offset, size_t count) {
+        buffer_.clear();
+        size_t total = playlist.size();
+        if (total == 0) {
+            buffer_ += "\n=== Playlist ===\n   (empty)\n";
+            return buffer_;
+        }
+        offset = std::min(offset, total - 1);
+        size_t end = offset + std::min(count, total - offset);
+        buffer_ += "\n=== Playlist (";
+        appendNumber(offset + 1);
+        buffer_ += '-';
+        appendNumber(end);
+        buffer_ += " of ";
+        appendNumber(total);
+        buffer_ += ") ===\n";
+
+        TrackList tracks = playlist.getTracks();
+        TrackView current = playlist.getCurrentTrack();
+        size_t index = offset;
+        for (auto it = tracks.iteratorAt(offset); index < end; ++it, ++index) {
+            appendRow(index, *it, current);
+        }
+        return buffer_;
+    }
+
+    // 以当前曲目为中心的一页（随机模式下按当前曲目的列表位置）
+    const std::string& renderAroundCurrent(const Playlist& playlist, size_t count) {
+        int current = playlist.getCurrentListIndex();
+        size_t offset = 0;
+        if (current >= 0 && playlist.size() > count) {
+            size_t center = static_cast<size_t>(current);
+            offset = std::min(center - std::min(center, count / 2), playlist.size() - count);
+        }
+        return render(playlist, offset, count);
+    }
+
+    // 搜索结果
+    const std::string& renderMatches(const Playlist& playlist, std::string_view query, const SearchMatches& matches) {
+        buffer_.clear();
+        buffer_ += "\n=== Search: ";
+        buffer_ += query;
+        buffer_ += " (";
+        appendNumber(matches.total);
+        if (matches.approximate) buffer_ += " approximate";
+        buffer_ += matches.total == 1 ? " match, " : " matches, ";
+        char digits[32];
+        auto result = std::to_chars(digits, digits + sizeof(digits), matches.seconds * 1000.0,
+                                    std::chars_format::fixed, 2);
+        buffer_.append(digits, result.ptr);
+        buffer_ += " ms) ===\n";
+        TrackView current = playlist.getCurrentTrack();
+        for (size_t position : matches.positions) {
+            appendRow(position, playlist.getTrack(position), current);
+        }
+        if (matches.total > matches.positions.size()) {
+            buffer_ += "   ... ";
+            appendNumber(matches.total - matches.positions.size());
+            buffer_ += " more\n";
+        }
+        return buffer_;
+    }
+
+    size_t capacity() const { return buffer_.capacity(); }
+
+private:
+    void appendRow(size_t index, TrackView track, TrackView current) {
+        buffer_ += current && current.id() == track.id() ? " > [" : "   [";
+        appendNumber(index + 1);
+        buffer_ += "] ";
+        buffer_ += track.title();
+        if (!track.artist().empty()) {
+            buffer_ += " - ";
+            buffer_ += track.artist();
+        }
+        if (track.duration() > 0.0f) {
+            buffer_ += " (";
+            appendTime(track.duration());
+            buffer_ += ')';
+        }
+        buffer_ += '\n';
+    }
+
+    void appendNumber(uint64_t value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer_.append(digits, result.ptr);
+    }
+
+    // mm:ss，与状态行的格式相同；文件头给出的时长可能任意大，超过上限或不是有限值时显示 --:--
+    void appendTime(float seconds) {
+        if (!(seconds >= 0.0f && seconds <= kMaxDisplaySeconds)) {
+            buffer_ += "--:--";
+            return;
+        }
+        uint64_t total = static_cast<uint64_t>(seconds);
+        uint64_t mins = total / 60;
+        uint64_t secs = total % 60;
+        if (mins < 10) buffer_ += '0';
+        appendNumber(mins);
+        buffer_ += ':';
+        buffer_ += static_cast<char>('0' + secs / 10);
+        buffer_ += static_cast<char>('0' + secs % 10);
+    }
+
+    static constexpr float kMaxDisplaySeconds = 1e6f;
+
+    std::string buffer_;
+};
+
+} // namespace MusicApp
+
+#endif // PLAYLIST_RENDERER_H
@@ -0,0 +1,350 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include "Instrumentation.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MusicApp {
+
+// 预取配置
+struct PrefetchConfig {
+    size_t lookahead = 3;                   // 按播放顺序预热接下来的几首（0 为关闭，不超过 capacity）
+    uint64_t headBytes = 8ull << 20;        // 每首预读文件开头的字节数
+    double maxBytesPerSecond = 32e6;        // 预读带宽上限，0 为不限
+    size_t capacity = 64;                   // 记住的已预热曲目数
+};
+
+// 加载时曲目的预取状态
+enum class PrefetchState {
+    Cold,       // 不在预取范围内
+    Pending,    // 仍在排队或预读中
+    Warm        // 已预读完成
+};
+
+// 预取统计
+struct PrefetchStats {
+    uint64_t warmed = 0;        // 完成预读的曲目
+    uint64_t cancelled = 0;     // 预读中途不再需要（播放顺序改变）
+    uint64_t failed = 0;        // 无法打开或读取
+    uint64_t bytes = 0;         // 预读的字节数
+    uint64_t hits = 0;          // 加载时已预热
+    uint64_t late = 0;          // 加载时仍在预读
+    uint64_t misses = 0;        // 加载时未预取
+    double hitSeconds = 0.0;    // 命中的加载耗时之和
+    double missSeconds = 0.0;   // 未命中（含 late）的加载耗时之和
+
+    uint64_t loads() const { return hits + late + misses; }
+
+    double hitRate() const {
+        return loads() ? static_cast<double>(hits) / static_cast<double>(loads()) : 0.0;
+    }
+
+    // 估计节省的加载时间：命中次数 ×（未命中平均耗时 − 命中平均耗时）；缺少任一方的样本时为 0
+    double savedSeconds() const {
+        uint64_t cold = late + misses;
+        if (hits == 0 || cold == 0) return 0.0;
+        double saved = missSeconds / static_cast<double>(cold) - hitSeconds / static_cast<double>(hits);
+        return std::max(0.0, saved) * static_cast<double>(hits);
+    }
+};
+
+// 预取器：把接下来将要播放的几首曲目的开头读入系统页缓存，load() 与解码线程随后读取时不再等待存储。
+// 预读在自己的线程中逐块进行并按带宽上限节流，不占用共享线程池，也不与正在播放的曲目争抢带宽；
+// 数据留在页缓存里，进程内只记住已完整预热、且仍在接下来几首之中的路径，用于统计命中
+class Prefetcher {
+public:
+    explicit Prefetcher(const PrefetchConfig& config = PrefetchConfig())
+        : config_(clamped(config)), buffer_(kChunkBytes) {
+        thread_ = std::thread(&Prefetcher::run, this);
+    }
+
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+
+    ~Prefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    PrefetchConfig getConfig() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return config_;
+    }
+
+    void setConfig(const PrefetchConfig& config) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            config_ = clamped(config);
+            if (upcoming_.size() > config_.lookahead) upcoming_.resize(config_.lookahead);
+            forgetUnwanted();
+        }
+        cv_.notify_all();
+    }
+
+    // 接下来将要播放的曲目（按播放顺序）；不再出现的曲目停止预读
+    void setUpcoming(std::vector<std::string> paths) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (paths.size() > config_.lookahead) paths.resize(config_.lookahead);
+            if (paths == upcoming_) return;
+            upcoming_ = std::move(paths);
+            failed_.clear();
+            forgetUnwanted();
+        }
+        cv_.notify_all();
+    }
+
+    // lookahead 不超过 capacity：否则预热的记录被挤出后又成为预读目标，预读线程反复读同几首
+    static PrefetchConfig clamped(PrefetchConfig config) {
+        config.lookahead = std::min(config.lookahead, config.capacity);
+        return config;
+    }
+
+    // 加载前调用：该曲目的预取状态；已预热的记录随之取走
+    PrefetchState claim(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find(warm_.begin(), warm_.end(), path);
+        if (it != warm_.end()) {
+            warm_.erase(it);
+            return PrefetchState::Warm;
+        }
+        return wanted(path) ? PrefetchState::Pending : PrefetchState::Cold;
+    }
+
+    // 记录一次加载的耗时
+    void recordLoad(PrefetchState state, double seconds) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        switch (state) {
+            case PrefetchState::Warm:
+                stats_.hits++;
+                stats_.hitSeconds += seconds;
+                MUSICAPP_COUNT(PrefetchHits, 1);
+                return;
+            case PrefetchState::Pending:
+                stats_.late++;
+                break;
+            case PrefetchState::Cold:
+                stats_.misses++;
+                break;
+        }
+        stats_.missSeconds += seconds;
+        MUSICAPP_COUNT(PrefetchMisses, 1);
+    }
+
+    PrefetchStats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    std::string formatStats() const {
+        PrefetchConfig config = getConfig();
+        PrefetchStats stats = getStats();
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1)
+           << "Prefetch: next " << config.lookahead << " tracks, head "
+           << config.headBytes / 1048576.0 << " MiB, limit ";
+        if (config.maxBytesPerSecond > 0) {
+            ss << config.maxBytesPerSecond / 1e6 << " MB/s\n";
+        } else {
+            ss << "none\n";
+        }
+        ss << "Warmed: " << stats.warmed << " tracks (" << stats.bytes / 1048576.0 << " MiB), cancelled "
+           << stats.cancelled << ", unreadable " << stats.failed << "\n"
+           << "Loads: " << stats.hits << " warm, " << stats.late << " late, " << stats.misses
+           << " cold (hit rate " << std::setprecision(0) << stats.hitRate() * 100.0 << "%)\n"
+           << std::setprecision(2) << "Load time: warm "
+           << (stats.hits ? stats.hitSeconds * 1000.0 / stats.hits : 0.0) << " ms, cold "
+           << (stats.late + stats.misses ? stats.missSeconds * 1000.0 / (stats.late + stats.misses) : 0.0)
+           << " ms on average; saved about " << stats.savedSeconds() * 1000.0 << " ms\n";
+        return ss.str();
+    }
+
+private:
+    static constexpr size_t kChunkBytes = 256 * 1024;
+
+    // 只读打开文件，按偏移读取
+    class HeadReader {
+    public:
+        ~HeadReader() {
+#ifdef _WIN32
+            if (file_) std::fclose(file_);
+#else
+            if (fd_ >= 0) ::close(fd_);
+#endif
+        }
+
+        bool open(const std::string& path) {
+#ifdef _WIN32
+            file_ = std::fopen(path.c_str(), "rb");
+            if (!file_ || std::fseek(file_, 0, SEEK_END) != 0) return false;
+            long size = std::ftell(file_);
+            if (size < 0) return false;
+            size_ = static_cast<uint64_t>(size);
+            return std::fseek(file_, 0, SEEK_SET) == 0;
+#else
+            fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd_ < 0) return false;
+            struct stat st;
+            if (::fstat(fd_, &st) != 0) return false;
+            size_ = static_cast<uint64_t>(st.st_size);
+            return true;
+#endif
+        }
+
+        uint64_t size() const { return size_; }
+
+        // 顺序读取：offset 为之前各次读取的总量
+        size_t read(unsigned char* buffer, size_t bytes, uint64_t offset) {
+#ifdef _WIN32
+            (void)offset;
+            return std::fread(buffer, 1, bytes, file_);
+#else
+            ssize_t n = ::pread(fd_, buffer, bytes, static_cast<off_t>(offset));
+            return n > 0 ? static_cast<size_t>(n) : 0;
+#endif
+        }
+
+    private:
+#ifdef _WIN32
+        std::FILE* file_ = nullptr;
+#else
+        int fd_ = -1;
+#endif
+        uint64_t size_ = 0;
+    };
+
+    // 调用方持有 mutex_
+    bool wanted(const std::string& path) const {
+        return std::find(upcoming_.begin(), upcoming_.end(), path) != upcoming_.end();
+    }
+
+    // 超出 capacity 时从最旧的记录逐出，仍在 upcoming_ 中的保留；调用方持有 mutex_
+    void trimWarm() {
+        auto it = warm_.end();
+        while (warm_.size() > config_.capacity && it != warm_.begin()) {
+            --it;
+            if (!wanted(*it)) it = warm_.erase(it);
+        }
+    }
+
+    // 不再是预读目标的曲目不再记为已预热：之后其数据可能已被挤出页缓存，加载时不能报告为命中；
+    // 调用方持有 mutex_
+    void forgetUnwanted() {
+        warm_.remove_if([this](const std::string& path) { return !wanted(path); });
+        trimWarm();
+    }
+
+    // 播放顺序中第一个尚未预热、也未失败的曲目；没有时返回空
+    const std::string* nextTarget() const {
+        for (const auto& path : upcoming_) {
+            if (std::find(warm_.begin(), warm_.end(), path) == warm_.end() &&
+                std::find(failed_.begin(), failed_.end(), path) == failed_.end()) {
+                return &path;
+            }
+        }
+        return nullptr;
+    }
+
+    void run() {
+        MUSICAPP_STATS_THREAD();
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            const std::string* target = nextTarget();
+            if (!target) {
+                cv_.wait(lock);
+                continue;
+            }
+            warm(std::string(*target), lock);
+        }
+    }
+
+    // 逐块预读 path 的开头；持有 lock 进入，I/O 期间释放。
+    // 每块在上一块用完带宽配额后才开始；曲目不再需要或停止时中途放弃。
+    // 只有读完整个开头才记为已预热，读取出错或文件变短时记为失败
+    void warm(const std::string& path, std::unique_lock<std::mutex>& lock) {
+        HeadReader reader;
+        lock.unlock();
+        bool opened = reader.open(path);
+        lock.lock();
+        if (!opened) {
+            stats_.failed++;
+            failed_.push_back(path);
+            return;
+        }
+        uint64_t limit = std::min(reader.size(), config_.headBytes);
+        uint64_t done = 0;
+        while (done < limit) {
+            double rate = config_.maxBytesPerSecond;
+            if (rate > 0) {
+                auto now = std::chrono::steady_clock::now();
+                if (nextSlot_ < now) nextSlot_ = now;
+                cv_.wait_until(lock, nextSlot_, [&]() { return stop_ || !wanted(path); });
+            }
+            if (stop_ || !wanted(path)) {
+                stats_.cancelled++;
+                return;
+            }
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(kChunkBytes, limit - done));
+            if (rate > 0) {
+                nextSlot_ += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(chunk / rate));
+            }
+            lock.unlock();
+            size_t n = reader.read(buffer_.data(), chunk, done);
+            lock.lock();
+            if (n == 0) {
+                stats_.failed++;
+                failed_.push_back(path);
+                return;
+            }
+            done += n;
+            stats_.bytes += n;
+            MUSICAPP_COUNT(PrefetchBytes, n);
+        }
+        if (stop_ || !wanted(path)) {
+            stats_.cancelled++;
+            return;
+        }
+        stats_.warmed++;
+        warm_.push_front(path);
+        trimWarm();
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    PrefetchConfig config_;
+    std::vector<std::string> upcoming_;
+    std::list<std::string> warm_;           // 已预热、尚未加载的曲目（最近的在前）
+    std::vector<std::string> failed_;       // 本轮无法打开或读取的曲目，播放顺序改变后重试
+    PrefetchStats stats_;
+    std::chrono::steady_clock::time_point nextSlot_;   // 下一块最早的开始时刻
+    bool stop_ = false;
+
+    std::vector<unsigned char> buffer_;     // 只由预读线程使用
+    std::thread thread_;
+};
+
+} // namespace MusicApp
+
+#endif // PREFETCHER_H
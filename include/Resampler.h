@@ -0,0 +1,340 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace MusicApp {
+
+// 重采样质量预设：抽头越多，过渡带越窄、阻带衰减越深，延迟（半个滤波器长度）也越大
+enum class ResamplerQuality {
+    Fast,       // 16 抽头，约 60 dB，过渡带跨过奈奎斯特频率，延迟约 0.2 ms
+    Balanced,   // 64 抽头，约 80 dB，阻带从奈奎斯特频率开始，延迟约 0.7 ms
+    Best        // 160 抽头，约 120 dB，延迟约 1.8 ms
+};
+
+inline const char* resamplerQualityName(ResamplerQuality quality) {
+    switch (quality) {
+        case ResamplerQuality::Fast: return "fast";
+        case ResamplerQuality::Balanced: return "balanced";
+        case ResamplerQuality::Best: return "best";
+    }
+    return "unknown";
+}
+
+inline bool parseResamplerQuality(const std::string& name, ResamplerQuality& quality) {
+    for (ResamplerQuality q : { ResamplerQuality::Fast, ResamplerQuality::Balanced, ResamplerQuality::Best }) {
+        if (name == resamplerQualityName(q)) {
+            quality = q;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 预设参数；频率以两个采样率中较低者为单位（0.5 为其奈奎斯特频率）
+struct ResamplerPreset {
+    uint32_t taps;              // 以较低采样率计的滤波器长度
+    double attenuationDb;       // 凯撒窗的设计阻带衰减
+    bool centeredTransition;    // 过渡带以奈奎斯特频率为中心（允许少量混叠换取更宽的通带）
+
+    // 凯撒窗设计公式给出的过渡带宽度
+    double transitionWidth() const {
+        return (attenuationDb - 8.0) / (2.285 * 2.0 * 3.14159265358979323846 * taps);
+    }
+    double stopbandEdge() const { return centeredTransition ? 0.5 + transitionWidth() / 2 : 0.5; }
+    double passbandEdge() const { return stopbandEdge() - transitionWidth(); }
+};
+
+inline ResamplerPreset resamplerPreset(ResamplerQuality quality) {
+    switch (quality) {
+        case ResamplerQuality::Fast: return { 16, 60.0, true };
+        case ResamplerQuality::Balanced: return { 64, 80.0, false };
+        case ResamplerQuality::Best: return { 160, 120.0, false };
+    }
+    return { 64, 80.0, false };
+}
+
+// 点积内核：n 为 8 的倍数
+namespace ResamplerKernels {
+
+using DotFn = float (*)(const float* a, const float* b, size_t n);
+
+inline float dotScalar(const float* a, const float* b, size_t n) {
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    for (size_t i = 0; i < n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+#if defined(MUSICAPP_X86)
+inline float dotSse2(const float* a, const float* b, size_t n) {
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+    for (size_t i = 0; i < n; i += 8) {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    __m128 s = _mm_add_ps(s0, s1);
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+MUSICAPP_TARGET_AVX2
+inline float dotAvx2(const float* a, const float* b, size_t n) {
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), s1);
+    }
+    if (i < n) {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+    }
+    __m256 s = _mm256_add_ps(s0, s1);
+    __m128 h = _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1));
+    h = _mm_add_ps(h, _mm_movehl_ps(h, h));
+    h = _mm_add_ss(h, _mm_shuffle_ps(h, h, 1));
+    return _mm_cvtss_f32(h);
+}
+#endif
+
+#if defined(MUSICAPP_NEON)
+inline float dotNeon(const float* a, const float* b, size_t n) {
+    float32x4_t s0 = vdupq_n_f32(0.0f);
+    float32x4_t s1 = vdupq_n_f32(0.0f);
+    for (size_t i = 0; i < n; i += 8) {
+        s0 = vfmaq_f32(s0, vld1q_f32(a + i), vld1q_f32(b + i));
+        s1 = vfmaq_f32(s1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    return vaddvq_f32(vaddq_f32(s0, s1));
+}
+#endif
+
+inline DotFn select(SimdLevel level) {
+    if (!simdLevelSupported(level)) level = SimdLevel::Scalar;
+    switch (level) {
+#if defined(MUSICAPP_X86)
+        case SimdLevel::AVX2: return dotAvx2;
+        case SimdLevel::SSE2: return dotSse2;
+#endif
+#if defined(MUSICAPP_NEON)
+        case SimdLevel::NEON: return dotNeon;
+#endif
+        default: break;
+    }
+    return dotScalar;
+}
+
+} // namespace ResamplerKernels
+
+// 多相滤波器组
+// 采样率之比化为最简分数 L/M（输出每帧在输入上前进 M/L 帧），L 个相位各一组 taps 个系数，
+// 相位 p 对应输入上的小数位置 p/L。原型为凯撒窗 sinc，降采样时按比例加长以保持以输出采样率计的抽头数
+struct PolyphaseFilterBank {
+    uint32_t phases = 1;        // L
+    uint32_t step = 1;          // M
+    uint32_t taps = 0;          // 每相位抽头数（8 的倍数）
+    double passband = 0.0;      // 通带边缘（Hz）
+    double stopband = 0.0;      // 阻带边缘（Hz）
+    std::vector<float> coefficients;    // phases * taps，相位 p 从 p * taps 开始，按输入时间正序排列
+
+    const float* phase(uint32_t p) const { return coefficients.data() + static_cast<size_t>(p) * taps; }
+
+    // 相位数过多（互质的采样率）时用最接近的有限相位近似，速率误差不超过 1/(2 * kMaxPhases * M)
+    static constexpr uint32_t kMaxPhases = 4096;
+
+    // 进程内缓存：同一比率与预设只设计一次
+    static std::shared_ptr<const PolyphaseFilterBank> get(uint32_t srcRate, uint32_t dstRate,
+                                                          ResamplerQuality quality) {
+        static std::mutex mutex;
+        static std::map<std::tuple<uint32_t, uint32_t, int>, std::shared_ptr<const PolyphaseFilterBank>> cache;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto key = std::make_tuple(srcRate, dstRate, static_cast<int>(quality));
+        auto it = cache.find(key);
+        if (it != cache.end()) return it->second;
+        auto bank = std::make_shared<const PolyphaseFilterBank>(design(srcRate, dstRate, quality));
+        cache.emplace(key, bank);
+        return bank;
+    }
+
+    static PolyphaseFilterBank design(uint32_t srcRate, uint32_t dstRate, ResamplerQuality quality) {
+        PolyphaseFilterBank bank;
+        uint32_t g = std::gcd(srcRate, dstRate);
+        uint64_t phases = dstRate / g;
+        uint64_t step = srcRate / g;
+        if (phases > kMaxPhases) {
+            step = std::max<uint64_t>(1, (step * kMaxPhases + phases / 2) / phases);
+            phases = kMaxPhases;
+        }
+        bank.phases = static_cast<uint32_t>(phases);
+        bank.step = static_cast<uint32_t>(step);
+
+        ResamplerPreset preset = resamplerPreset(quality);
+        double ratio = std::min(1.0, static_cast<double>(phases) / step);     // 较低采样率 / 输入采样率
+        uint32_t taps = static_cast<uint32_t>(std::ceil(preset.taps / ratio));
+        bank.taps = (taps + 7) / 8 * 8;
+        double lowRate = std::min(srcRate, dstRate);
+        bank.passband = preset.passbandEdge() * lowRate;
+        bank.stopband = preset.stopbandEdge() * lowRate;
+
+        // 截止频率取过渡带中点，以输入采样为单位
+        double cutoff = (preset.passbandEdge() + preset.stopbandEdge()) / 2 * ratio;
+        double beta = preset.attenuationDb > 50.0 ? 0.1102 * (preset.attenuationDb - 8.7)
+                                                  : 0.5842 * std::pow(preset.attenuationDb - 21.0, 0.4) +
+                                                    0.07886 * (preset.attenuationDb - 21.0);
+        double half = bank.taps / 2.0;
+        double norm = besselI0(beta);
+        bank.coefficients.resize(static_cast<size_t>(bank.phases) * bank.taps);
+        for (uint32_t p = 0; p < bank.phases; p++) {
+            // 相位 p 的第 k 个系数作用于输入 x[i - taps/2 + 1 + k]，与输出位置 i + p/L 相距 tau
+            double frac = static_cast<double>(p) / bank.phases;
+            double sum = 0.0;
+            std::vector<double> h(bank.taps);
+            for (uint32_t k = 0; k < bank.taps; k++) {
+                double tau = frac - (static_cast<double>(k) - half + 1.0);
+                double u = tau / half;
+                double window = std::fabs(u) >= 1.0 ? 0.0 : besselI0(beta * std::sqrt(1.0 - u * u)) / norm;
+                double x = 2.0 * cutoff * tau;
+                double sinc = x == 0.0 ? 1.0 : std::sin(3.14159265358979323846 * x) / (3.14159265358979323846 * x);
+                h[k] = 2.0 * cutoff * sinc * window;
+                sum += h[k];
+            }
+            // 每个相位单独归一化直流增益，避免相位间的增益起伏
+            for (uint32_t k = 0; k < bank.taps; k++) {
+                bank.coefficients[static_cast<size_t>(p) * bank.taps + k] = static_cast<float>(h[k] / sum);
+            }
+        }
+        return bank;
+    }
+
+    static double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 64; k++) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < sum * 1e-17) break;
+        }
+        return sum;
+    }
+};
+
+// 流式多相重采样器（在解码线程中运行）
+// 输入按声道拆成平面缓冲区，每个输出样本是一段连续输入与一个相位系数的点积，由 SIMD 内核计算。
+// 输出与输入在时间上对齐（不引入群延迟），代价是需要向前看 taps/2 帧；流结束时调用 flush() 输出剩余部分
+class Resampler {
+public:
+    explicit Resampler(ResamplerQuality quality = ResamplerQuality::Balanced, SimdLevel level = hostSimdLevel())
+        : quality_(quality), dot_(ResamplerKernels::select(level)) {}
+
+    void setQuality(ResamplerQuality quality) { quality_ = quality; }
+    ResamplerQuality getQuality() const { return quality_; }
+
+    void reset(uint32_t srcRate, uint32_t dstRate, uint16_t channels) {
+        channels_ = channels;
+        bank_.reset();
+        if (srcRate != dstRate && srcRate > 0 && dstRate > 0) {
+            bank_ = PolyphaseFilterBank::get(srcRate, dstRate, quality_);
+        }
+        planar_.assign(channels, std::vector<float>());
+        // 左侧补 taps/2 - 1 帧静音，使第一个输出与第一个输入对齐
+        size_t pad = bank_ ? bank_->taps / 2 - 1 : 0;
+        for (auto& plane : planar_) plane.assign(pad, 0.0f);
+        index_ = pad;
+        phase_ = 0;
+    }
+
+    bool isPassthrough() const { return !bank_; }
+
+    // 向前看的帧数（以输入采样率计）
+    uint32_t latencyFrames() const { return bank_ ? bank_->taps / 2 : 0; }
+
+    const PolyphaseFilterBank* filterBank() const { return bank_.get(); }
+
+    // 处理 frames 帧交错输入，结果追加到 out
+    void process(const float* in, size_t frames, std::vector<float>& out) {
+        if (frames == 0) return;
+        if (!bank_) {
+            out.insert(out.end(), in, in + frames * channels_);
+            return;
+        }
+        for (uint16_t c = 0; c < channels_; c++) {
+            std::vector<float>& plane = planar_[c];
+            size_t base = plane.size();
+            plane.resize(base + frames);
+            for (size_t f = 0; f < frames; f++) {
+                plane[base + f] = in[f * channels_ + c];
+            }
+        }
+        run(out);
+    }
+
+    // 流结束：补 taps/2 帧静音，输出到最后一个输入帧为止
+    void flush(std::vector<float>& out) {
+        if (!bank_) return;
+        for (auto& plane : planar_) plane.resize(plane.size() + bank_->taps / 2, 0.0f);
+        run(out);
+    }
+
+private:
+    void run(std::vector<float>& out) {
+        const PolyphaseFilterBank& bank = *bank_;
+        const size_t taps = bank.taps;
+        const size_t half = taps / 2;
+        const size_t available = planar_[0].size();
+        if (index_ + half >= available) return;
+
+        // 预先扩容，循环内只写入
+        size_t estimate = ((available - half - index_) * bank.phases) / bank.step + 2;
+        size_t written = out.size();
+        out.resize(written + estimate * channels_);
+        float* dst = out.data() + written;
+        size_t produced = 0;
+        while (index_ + half < available && produced < estimate) {
+            const float* coefficients = bank.phase(phase_);
+            size_t start = index_ + 1 - half;
+            for (uint16_t c = 0; c < channels_; c++) {
+                *dst++ = dot_(planar_[c].data() + start, coefficients, taps);
+            }
+            produced++;
+            phase_ += bank.step;
+            index_ += phase_ / bank.phases;
+            phase_ %= bank.phases;
+        }
+        out.resize(written + produced * channels_);
+
+        // 丢弃不再需要的输入
+        size_t keep = std::min(index_ + 1 - half, available);
+        for (auto& plane : planar_) plane.erase(plane.begin(), plane.begin() + keep);
+        index_ -= keep;
+    }
+
+    ResamplerQuality quality_;
+    ResamplerKernels::DotFn dot_;
+    std::shared_ptr<const PolyphaseFilterBank> bank_;
+    uint16_t channels_ = 0;
+    std::vector<std::vector<float>> planar_;
+    size_t index_ = 0;          // 当前输出位置的整数部分（平面缓冲区下标）
+    uint32_t phase_ = 0;        // 小数部分（以 1/L 为单位）
+};
+
+} // namespace MusicApp
+
+#endif // RESAMPLER_H
@@ -0,0 +1,119 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace MusicApp {
+
+// 单生产者单消费者无锁环形缓冲区
+// 读写索引单调递增（64位不会回绕），容量向上取整为2的幂
+// 生产者线程只调用 write/writeAvailable，消费者线程只调用 read/readAvailable/skipTo
+template <typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(size_t capacity = 0) {
+        reset(capacity);
+    }
+
+    // 重新分配容量（不可与读写并发调用）
+    void reset(size_t capacity) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        buffer_.assign(cap, T());
+        mask_ = cap - 1;
+        writeIndex_.store(0, std::memory_order_relaxed);
+        readIndex_.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return buffer_.size(); }
+
+    // 生产者：可写入的元素数
+    size_t writeAvailable() const {
+        uint64_t w = writeIndex_.load(std::memory_order_relaxed);
+        uint64_t r = readIndex_.load(std::memory_order_acquire);
+        return buffer_.size() - static_cast<size_t>(w - r);
+    }
+
+    // 消费者：可读取的元素数
+    size_t readAvailable() const {
+        uint64_t r = readIndex_.load(std::memory_order_relaxed);
+        uint64_t w = writeIndex_.load(std::memory_order_acquire);
+        return static_cast<size_t>(w - r);
+    }
+
+    // 生产者：写入最多 count 个元素，返回实际写入数
+    size_t write(const T* data, size_t count) {
+        T* first;
+        size_t firstLen;
+        T* second;
+        size_t secondLen;
+        size_t n = prepareWrite(count, first, firstLen, second, secondLen);
+        std::memcpy(first, data, firstLen * sizeof(T));
+        if (secondLen > 0) {
+            std::memcpy(second, data + firstLen, secondLen * sizeof(T));
+        }
+        commitWrite(n);
+        return n;
+    }
+
+    // 生产者：获取可直接写入的两段连续区域（用于原地转换，避免中间缓冲）
+    size_t prepareWrite(size_t count, T*& first, size_t& firstLen,
+                        T*& second, size_t& secondLen) {
+        size_t n = std::min(count, writeAvailable());
+        size_t start = static_cast<size_t>(
+            writeIndex_.load(std::memory_order_relaxed) & mask_);
+        firstLen = std::min(n, buffer_.size() - start);
+        secondLen = n - firstLen;
+        first = buffer_.data() + start;
+        second = buffer_.data();
+        return n;
+    }
+
+    // 生产者：提交 prepareWrite 之后写入的元素
+    void commitWrite(size_t count) {
+        writeIndex_.store(writeIndex_.load(std::memory_order_relaxed) + count,
+                          std::memory_order_release);
+    }
+
+    // 消费者：读取最多 count 个元素，返回实际读取数
+    size_t read(T* out, size_t count) {
+        size_t n = std::min(count, readAvailable());
+        uint64_t r = readIndex_.load(std::memory_order_relaxed);
+        size_t start = static_cast<size_t>(r & mask_);
+        size_t firstLen = std::min(n, buffer_.size() - start);
+        std::memcpy(out, buffer_.data() + start, firstLen * sizeof(T));
+        if (n > firstLen) {
+            std::memcpy(out + firstLen, buffer_.data(), (n - firstLen) * sizeof(T));
+        }
+        readIndex_.store(r + n, std::memory_order_release);
+        return n;
+    }
+
+    // 消费者：丢弃 index 之前的所有数据（用于 seek/切换曲目后清空旧数据）
+    void skipTo(uint64_t index) {
+        uint64_t r = readIndex_.load(std::memory_order_relaxed);
+        uint64_t w = writeIndex_.load(std::memory_order_acquire);
+        if (index > w) index = w;
+        if (index > r) {
+            readIndex_.store(index, std::memory_order_release);
+        }
+    }
+
+    uint64_t writeIndex() const { return writeIndex_.load(std::memory_order_acquire); }
+    uint64_t readIndex() const { return readIndex_.load(std::memory_order_acquire); }
+
+private:
+    std::vector<T> buffer_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<uint64_t> writeIndex_{0};
+    alignas(64) std::atomic<uint64_t> readIndex_{0};
+};
+
+} // namespace MusicApp
+
+#endif // RING_BUFFER_H
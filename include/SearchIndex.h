@@ -0,0 +1,428 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include "TrackStore.h"
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace MusicApp {
+
+namespace SearchText {
+
+// 只折叠 ASCII 大小写，其余字节（UTF-8 多字节字符）原样比较
+inline char fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+inline std::string foldString(std::string_view text) {
+    std::string out(text);
+    for (auto& c : out) c = fold(c);
+    return out;
+}
+
+inline bool isSeparator(char c) {
+    return c == '/' || c == '\\';
+}
+
+// needle 须已折叠
+inline bool contains(std::string_view haystack, std::string_view needle) {
+    return std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+                       [](char h, char n) { return fold(h) == n; }) != haystack.end();
+}
+
+inline bool endsWith(std::string_view text, std::string_view suffix) {
+    if (suffix.size() > text.size()) return false;
+    text.remove_prefix(text.size() - suffix.size());
+    return std::equal(text.begin(), text.end(), suffix.begin(), [](char h, char n) { return fold(h) == n; });
+}
+
+// 近似子串匹配：haystack 中是否有子串与 needle 的编辑距离不超过 maxEdits。
+// needle 不超过 64 字节时用 Myers 位并行算法（每个字节几次字运算），否则逐列动态规划（Sellers）
+class ApproximatePattern {
+public:
+    // needle 须已折叠
+    ApproximatePattern(std::string_view needle, size_t maxEdits)
+        : needle_(needle), maxEdits_(maxEdits) {
+        std::fill(std::begin(peq_), std::end(peq_), 0);
+        if (needle_.size() <= 64) {
+            for (size_t i = 0; i < needle_.size(); i++) {
+                peq_[static_cast<uint8_t>(needle_[i])] |= uint64_t(1) << i;
+            }
+        }
+    }
+
+    bool matches(std::string_view haystack) const {
+        size_t m = needle_.size();
+        if (m <= maxEdits_) return true;
+        return m <= 64 ? matchBits(haystack) : matchColumns(haystack);
+    }
+
+private:
+    bool matchBits(std::string_view haystack) const {
+        size_t m = needle_.size();
+        uint64_t high = uint64_t(1) << (m - 1);
+        uint64_t pv = m == 64 ? ~uint64_t(0) : (high << 1) - 1;
+        uint64_t mv = 0;
+        size_t score = m;
+        for (char h : haystack) {
+            uint64_t eq = peq_[static_cast<uint8_t>(fold(h))];
+            uint64_t xv = eq | mv;
+            uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint64_t ph = mv | ~(xh | pv);
+            uint64_t mh = pv & xh;
+            if (ph & high) {
+                score++;
+            } else if (mh & high) {
+                score--;
+            }
+            // 第 0 行恒为 0（子串可以从任意位置开始），左移时不补 1
+            ph <<= 1;
+            mh <<= 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+            if (score <= maxEdits_) return true;
+        }
+        return false;
+    }
+
+    bool matchColumns(std::string_view haystack) const {
+        size_t m = needle_.size();
+        row_.resize(m + 1);
+        for (size_t i = 0; i <= m; i++) row_[i] = static_cast<uint32_t>(i);
+        for (char h : haystack) {
+            char c = fold(h);
+            uint32_t diagonal = 0;
+            for (size_t i = 1; i <= m; i++) {
+                uint32_t up = row_[i];
+                uint32_t value = diagonal + (needle_[i - 1] != c ? 1 : 0);
+                value = std::min(value, up + 1);
+                value = std::min(value, row_[i - 1] + 1);
+                diagonal = up;
+                row_[i] = value;
+            }
+            if (row_[m] <= maxEdits_) return true;
+        }
+        return false;
+    }
+
+    std::string needle_;
+    size_t maxEdits_;
+    uint64_t peq_[256];
+    mutable std::vector<uint32_t> row_;
+};
+
+} // namespace SearchText
+
+// 曲目全文搜索索引
+// 标题与文件名按三字节组（折叠大小写后）散列到若干桶，每个桶一张倒排表，曲目编号按添加顺序递增，
+// 以变长差值编码追加。艺术家与目录是去重后的小表，查询时直接扫描，再按列筛出曲目。
+// 索引在查询时追上新添加的曲目；移除的曲目由 TrackStore 的标记过滤；标题改动后新的三字节组记入补充表，
+// 旧标题留下的条目在核对时排除。所有候选都与原文逐一核对，散列冲突只会多出候选，不影响结果
+class SearchIndex {
+public:
+    SearchIndex() = default;
+    SearchIndex(const SearchIndex&) = delete;
+    SearchIndex& operator=(const SearchIndex&) = delete;
+
+    // 编号失效（清空或整理播放列表）时调用，下次查询重新建立
+    void clear() {
+        std::vector<Posting>().swap(postings_);
+        late_.clear();
+        lateCount_ = 0;
+        entries_ = 0;
+        indexed_ = 0;
+    }
+
+    // 标题被修改后调用；尚未建立索引的曲目无需处理
+    void retitle(const TrackStore& store, uint32_t id) {
+        if (id >= indexed_) return;
+        std::string_view title = store.title(id);
+        if (title.data() == store.fileName(id).data()) return;     // 与文件名主干相同，已在索引中
+        keys_.clear();
+        addKeys(title, keys_);
+        for (uint32_t key : keys_) {
+            late_[key].push_back(id);
+        }
+        lateCount_ += keys_.size();
+        // 补充表过大时整体重建，避免每次查询合并大量无序条目
+        if (lateCount_ > kMinRebuild && lateCount_ > entries_ / 4) {
+            clear();
+        }
+    }
+
+    // 子串匹配（标题、艺术家或完整路径），按编号升序返回
+    std::vector<uint32_t> find(const TrackStore& store, std::string_view query) {
+        std::string needle = SearchText::foldString(query);
+        std::vector<uint32_t> ids;
+        if (needle.empty()) return ids;
+        catchUp(store);
+
+        // 标题与文件名：取两个最短的倒排表求交，再逐一核对
+        keys_.clear();
+        addKeys(needle, keys_);
+        auto verify = [&](uint32_t id) {
+            if (!store.isRemoved(id) && matchesText(store, id, [&needle](std::string_view text) {
+                    return SearchText::contains(text, needle);
+                })) {
+                ids.push_back(id);
+            }
+        };
+        if (keys_.empty()) {
+            for (uint32_t id = 0; id < store.size(); id++) verify(id);
+        } else {
+            std::sort(keys_.begin(), keys_.end(), [this](uint32_t a, uint32_t b) {
+                return postingSize(a) < postingSize(b);
+            });
+            std::vector<uint32_t> candidates = idsFor(keys_[0]);
+            if (keys_.size() > 1 && !candidates.empty()) {
+                std::vector<uint32_t> other = idsFor(keys_[1]);
+                std::vector<uint32_t> both;
+                std::set_intersection(candidates.begin(), candidates.end(), other.begin(), other.end(),
+                                      std::back_inserter(both));
+                candidates.swap(both);
+            }
+            for (uint32_t id : candidates) {
+                if (id < store.size()) verify(id);
+            }
+        }
+
+        // 艺术家与目录：先扫描去重表，再按列筛选
+        std::vector<uint8_t> artistHit(store.artistCount() + 1, 0);
+        bool anyArtist = false;
+        for (uint32_t a = 1; a < artistHit.size(); a++) {
+            if (SearchText::contains(store.artistName(a), needle)) {
+                artistHit[a] = 1;
+                anyArtist = true;
+            }
+        }
+        std::vector<uint8_t> directoryHit = matchDirectories(store, needle);
+        bool anyDirectory = std::any_of(directoryHit.begin(), directoryHit.end(), [](uint8_t h) { return h != 0; });
+        if (anyArtist || anyDirectory) {
+            size_t matched = ids.size();
+            for (uint32_t id = 0; id < store.size(); id++) {
+                if (store.isRemoved(id)) continue;
+                uint8_t dir = directoryHit[store.directoryId(id)];
+                if (artistHit[store.artistId(id)] || dir == kDirectoryContains ||
+                    (dir == kDirectoryStraddles && SearchText::contains(store.filepath(id), needle))) {
+                    ids.push_back(id);
+                }
+            }
+            std::inplace_merge(ids.begin(), ids.begin() + matched, ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        }
+        return ids;
+    }
+
+    // 近似匹配：标题、艺术家或文件名中有子串与查询的编辑距离不超过 1（6 字节起）或 2（11 字节起）；
+    // 按 q-gram 引理，这样的曲目至少含有查询中 D - 3k 个桶，以此筛选候选。查询太短时返回空
+    std::vector<uint32_t> findApproximate(const TrackStore& store, std::string_view query) {
+        std::string needle = SearchText::foldString(query);
+        std::vector<uint32_t> ids;
+        size_t maxEdits = needle.size() >= 11 ? 2 : needle.size() >= 6 ? 1 : 0;
+        if (maxEdits == 0) return ids;
+        catchUp(store);
+        keys_.clear();
+        addKeys(needle, keys_);
+        if (keys_.size() <= 3 * maxEdits) return ids;
+        size_t threshold = std::min<size_t>(keys_.size() - 3 * maxEdits, 0xFF);
+
+        SearchText::ApproximatePattern pattern(needle, maxEdits);
+        std::vector<uint8_t> artistHit(store.artistCount() + 1, 0);
+        for (uint32_t a = 1; a < artistHit.size(); a++) {
+            artistHit[a] = pattern.matches(store.artistName(a));
+        }
+        std::vector<uint8_t> counts(store.size(), 0);
+        for (uint32_t key : keys_) {
+            forEachId(key, [&counts](uint32_t id) {
+                if (id < counts.size() && counts[id] < 0xFF) counts[id]++;
+            });
+        }
+        for (uint32_t id = 0; id < store.size(); id++) {
+            if (store.isRemoved(id)) continue;
+            if (artistHit[store.artistId(id)] ||
+                (counts[id] >= threshold && matchesText(store, id, [&pattern](std::string_view text) {
+                     return pattern.matches(text);
+                 }))) {
+                ids.push_back(id);
+            }
+        }
+        return ids;
+    }
+
+    // 已建立索引的编号上限
+    size_t indexedCount() const { return indexed_; }
+
+    size_t memoryUsage() const {
+        size_t bytes = postings_.capacity() * sizeof(Posting) + keys_.capacity() * sizeof(uint32_t);
+        for (const auto& p : postings_) {
+            bytes += p.bytes.capacity();
+        }
+        for (const auto& entry : late_) {
+            bytes += sizeof(entry) + 2 * sizeof(void*) + entry.second.capacity() * sizeof(uint32_t);
+        }
+        return bytes;
+    }
+
+private:
+    struct Posting {
+        std::vector<uint8_t> bytes;     // 变长编码的编号差值
+        uint32_t last = 0;
+        uint32_t count = 0;
+    };
+
+    static constexpr unsigned kMinBucketBits = 10;
+    static constexpr unsigned kMaxBucketBits = 17;
+    static constexpr size_t kMinRebuild = 1u << 16;
+    static constexpr uint8_t kDirectoryContains = 1;
+    static constexpr uint8_t kDirectoryStraddles = 2;     // 查询可能跨过目录与文件名的分隔符
+
+    uint32_t bucket(char a, char b, char c) const {
+        uint32_t key = (static_cast<uint32_t>(static_cast<uint8_t>(SearchText::fold(a))) << 16) |
+                       (static_cast<uint32_t>(static_cast<uint8_t>(SearchText::fold(b))) << 8) |
+                       static_cast<uint32_t>(static_cast<uint8_t>(SearchText::fold(c)));
+        return (key * 0x9E3779B1u) >> (32 - bucketBits_);
+    }
+
+    // 追加 text 中三字节组所在的桶（去重）
+    void addKeys(std::string_view text, std::vector<uint32_t>& keys) const {
+        size_t begin = keys.size();
+        for (size_t i = 0; i + 3 <= text.size(); i++) {
+            keys.push_back(bucket(text[i], text[i + 1], text[i + 2]));
+        }
+        std::sort(keys.begin() + begin, keys.end());
+        keys.erase(std::unique(keys.begin() + begin, keys.end()), keys.end());
+    }
+
+    // 桶数约为曲目数的 1/8（1024～131072）；曲目增加到桶数的 16 倍以上时按新的桶数重建
+    void catchUp(const TrackStore& store) {
+        if (indexed_ >= store.size()) return;
+        if (!postings_.empty() && bucketBits_ < kMaxBucketBits && store.size() > (postings_.size() << 4)) {
+            clear();
+        }
+        if (postings_.empty()) {
+            bucketBits_ = kMinBucketBits;
+            while (bucketBits_ < kMaxBucketBits && (size_t(8) << bucketBits_) < store.size()) bucketBits_++;
+            postings_.resize(size_t(1) << bucketBits_);
+        }
+        // 按曲目去重：桶上记录最近一次加入的编号，比逐曲目排序去重快得多
+        std::vector<uint32_t> seen(postings_.size(), 0xFFFFFFFFu);
+        auto add = [&](std::string_view text, uint32_t id) {
+            for (size_t i = 0; i + 3 <= text.size(); i++) {
+                uint32_t key = bucket(text[i], text[i + 1], text[i + 2]);
+                if (seen[key] != id) {
+                    seen[key] = id;
+                    append(postings_[key], id);
+                    entries_++;
+                }
+            }
+        };
+        for (; indexed_ < store.size(); indexed_++) {
+            uint32_t id = static_cast<uint32_t>(indexed_);
+            if (store.isRemoved(id)) continue;
+            std::string_view name = store.fileName(id);
+            std::string_view title = store.title(id);
+            add(name, id);
+            if (title.data() != name.data()) add(title, id);
+        }
+    }
+
+    // 在文件名与标题中匹配；标题与文件名主干相同时只需检查文件名
+    template <typename Match>
+    static bool matchesText(const TrackStore& store, uint32_t id, Match&& match) {
+        std::string_view name = store.fileName(id);
+        std::string_view title = store.title(id);
+        return match(name) || (title.data() != name.data() && match(title));
+    }
+
+    static void append(Posting& p, uint32_t id) {
+        uint32_t delta = id - p.last;
+        while (delta >= 0x80) {
+            p.bytes.push_back(static_cast<uint8_t>(delta | 0x80));
+            delta >>= 7;
+        }
+        p.bytes.push_back(static_cast<uint8_t>(delta));
+        p.last = id;
+        p.count++;
+    }
+
+    size_t postingSize(uint32_t key) const {
+        size_t size = postings_.empty() ? 0 : postings_[key].count;
+        auto it = late_.find(key);
+        return it == late_.end() ? size : size + it->second.size();
+    }
+
+    template <typename Fn>
+    void forEachId(uint32_t key, Fn&& fn) const {
+        if (!postings_.empty()) {
+            const std::vector<uint8_t>& bytes = postings_[key].bytes;
+            uint32_t id = 0;
+            for (size_t i = 0; i < bytes.size();) {
+                uint32_t delta = 0;
+                unsigned shift = 0;
+                uint8_t b;
+                do {
+                    b = bytes[i++];
+                    delta |= static_cast<uint32_t>(b & 0x7F) << shift;
+                    shift += 7;
+                } while (b & 0x80);
+                id += delta;
+                fn(id);
+            }
+        }
+        auto it = late_.find(key);
+        if (it != late_.end()) {
+            for (uint32_t id : it->second) fn(id);
+        }
+    }
+
+    // 桶内的编号（升序、去重）
+    std::vector<uint32_t> idsFor(uint32_t key) const {
+        std::vector<uint32_t> ids;
+        ids.reserve(postingSize(key));
+        forEachId(key, [&ids](uint32_t id) { ids.push_back(id); });
+        if (late_.count(key)) {
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        }
+        return ids;
+    }
+
+    // 目录表逐项匹配：包含查询，或以查询中某个分隔符之前（含分隔符）的部分结尾
+    static std::vector<uint8_t> matchDirectories(const TrackStore& store, std::string_view needle) {
+        std::vector<uint8_t> hits(store.directoryCount(), 0);
+        bool separator = std::any_of(needle.begin(), needle.end(), SearchText::isSeparator);
+        for (uint32_t d = 0; d < hits.size(); d++) {
+            std::string_view dir = store.directoryName(d);
+            if (SearchText::contains(dir, needle)) {
+                hits[d] = kDirectoryContains;
+                continue;
+            }
+            if (!separator) continue;
+            for (size_t i = 0; i + 1 < needle.size(); i++) {
+                if (SearchText::isSeparator(needle[i]) && SearchText::endsWith(dir, needle.substr(0, i + 1))) {
+                    hits[d] = kDirectoryStraddles;
+                    break;
+                }
+            }
+        }
+        return hits;
+    }
+
+    std::vector<Posting> postings_;                             // 首次查询时分配
+    std::unordered_map<uint32_t, std::vector<uint32_t>> late_;  // 改过标题的曲目，编号无序
+    size_t lateCount_ = 0;
+    size_t entries_ = 0;
+    size_t indexed_ = 0;            // 之前的编号均已建立索引
+    unsigned bucketBits_ = kMinBucketBits;
+    std::vector<uint32_t> keys_;
+};
+
+} // namespace MusicApp
+
+#endif // SEARCH_INDEX_H
@@ -0,0 +1,574 @@
+#ifndef SEEK_INDEX_H
+#define SEEK_INDEX_H
+
+#include "LibraryScanner.h"
+#include "MetadataReader.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace MusicApp {
+
+// 建有定位索引的压缩格式
+enum class SeekFormat {
+    Unknown,
+    Mpeg,       // MPEG-1/2/2.5 Layer I/II/III
+    Flac,
+    Ogg         // Vorbis / Opus
+};
+
+inline const char* seekFormatName(SeekFormat format) {
+    switch (format) {
+        case SeekFormat::Mpeg: return "mpeg";
+        case SeekFormat::Flac: return "flac";
+        case SeekFormat::Ogg: return "ogg";
+        case SeekFormat::Unknown: break;
+    }
+    return "unknown";
+}
+
+// 定位点：offset 处开始的 MPEG 帧 / FLAC 帧的第一个样本编号，Ogg 为该页的颗粒位置。
+// 样本编号按解码器的原始输出计算（含编码器延迟与 Opus 预跳过）
+struct SeekPoint {
+    uint64_t frame = 0;
+    uint64_t offset = 0;
+};
+
+// 定位结果：从 offset 开始解码，丢弃前 skip 帧后即为目标帧
+// Ogg 从 offset 处的页开始解码时，该页上完成的包只用于预热，输出从该页的颗粒位置算起
+struct SeekTarget {
+    uint64_t offset = 0;
+    uint64_t skip = 0;
+    uint32_t reads = 0;         // 本次定位的文件读取次数
+};
+
+namespace SeekScan {
+
+// 读取窗口：请求的范围不在缓冲区内时从该偏移重新读取一整块
+class ReadWindow {
+public:
+    ReadWindow(Metadata::SourceFile& file, size_t block) : file_(file), block_(block) {}
+
+    // [offset, offset + len) 的数据；超出文件末尾时返回 nullptr
+    const unsigned char* at(uint64_t offset, size_t len) {
+        if (offset < start_ || offset + len > start_ + buffer_.size()) {
+            buffer_.resize(std::max(block_, len));
+            buffer_.resize(file_.readAt(offset, buffer_.data(), buffer_.size()));
+            start_ = offset;
+            reads_++;
+            if (len > buffer_.size()) return nullptr;
+        }
+        return buffer_.data() + (offset - start_);
+    }
+
+    // offset 处缓冲区中可直接访问的字节数（不触发读取）
+    size_t buffered(uint64_t offset) const {
+        if (offset < start_ || offset >= start_ + buffer_.size()) return 0;
+        return static_cast<size_t>(start_ + buffer_.size() - offset);
+    }
+
+    uint32_t reads() const { return reads_; }
+
+private:
+    Metadata::SourceFile& file_;
+    size_t block_;
+    std::vector<unsigned char> buffer_;
+    uint64_t start_ = 0;
+    uint32_t reads_ = 0;
+};
+
+// FLAC 帧头的 CRC-8（多项式 0x07）
+inline uint8_t crc8(const unsigned char* p, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        for (int b = 0; b < 8; b++) crc = static_cast<uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+    }
+    return crc;
+}
+
+// Ogg 页校验和（多项式 0x04C11DB7，不反转，初值 0；校验和字段按 0 计算）
+inline uint32_t oggCrc(const unsigned char* p, size_t len) {
+    static const auto table = []() {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t r = i << 24;
+            for (int b = 0; b < 8; b++) r = (r & 0x80000000u) ? (r << 1) ^ 0x04C11DB7u : r << 1;
+            t[i] = r;
+        }
+        return t;
+    }();
+    uint32_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = (i >= 22 && i < 26) ? 0 : p[i];
+        crc = (crc << 8) ^ table[((crc >> 24) ^ byte) & 0xFF];
+    }
+    return crc;
+}
+
+// FLAC 帧头
+struct FlacFrameHeader {
+    uint64_t sample = 0;            // 第一个样本的编号
+    uint32_t blockSize = 0;
+    uint32_t sampleRate = 0;        // 0 表示见 STREAMINFO
+    uint8_t channelAssignment = 0;  // 0-7: 独立声道数 - 1；8-10: 左/侧、右/侧、中/侧
+    uint8_t sampleSizeCode = 0;     // 0 表示见 STREAMINFO
+    uint32_t headerBytes = 0;
+};
+
+// 解析 p 处的 FLAC 帧头并校验 CRC-8；fixedBlockSize 为固定块长流的块长（STREAMINFO 的最小块长）
+inline bool parseFlacFrameHeader(const unsigned char* p, size_t len, uint32_t fixedBlockSize,
+                                 FlacFrameHeader& h) {
+    if (len < 6 || p[0] != 0xFF || (p[1] & 0xFE) != 0xF8) return false;
+    bool variable = (p[1] & 1) != 0;
+    uint32_t blockCode = p[2] >> 4;
+    uint32_t rateCode = p[2] & 0x0F;
+    h.channelAssignment = static_cast<uint8_t>(p[3] >> 4);
+    h.sampleSizeCode = static_cast<uint8_t>((p[3] >> 1) & 7);
+    if (blockCode == 0 || rateCode == 15 || h.channelAssignment > 10 || h.sampleSizeCode == 3 || (p[3] & 1)) {
+        return false;
+    }
+
+    // UTF-8 方式编码的帧号（固定块长）或样本号（可变块长）
+    size_t pos = 4;
+    uint64_t number = p[pos];
+    size_t extra = 0;
+    if (number < 0x80) extra = 0;
+    else if ((number & 0xE0) == 0xC0) { number &= 0x1F; extra = 1; }
+    else if ((number & 0xF0) == 0xE0) { number &= 0x0F; extra = 2; }
+    else if ((number & 0xF8) == 0xF0) { number &= 0x07; extra = 3; }
+    else if ((number & 0xFC) == 0xF8) { number &= 0x03; extra = 4; }
+    else if ((number & 0xFE) == 0xFC) { number &= 0x01; extra = 5; }
+    else if (number == 0xFE && variable) { number = 0; extra = 6; }
+    else return false;
+    if (pos + 1 + extra + 5 > len) return false;
+    for (size_t i = 1; i <= extra; i++) {
+        if ((p[pos + i] & 0xC0) != 0x80) return false;
+        number = (number << 6) | (p[pos + i] & 0x3F);
+    }
+    pos += 1 + extra;
+
+    if (blockCode == 1) h.blockSize = 192;
+    else if (blockCode <= 5) h.blockSize = 576u << (blockCode - 2);
+    else if (blockCode == 6) h.blockSize = p[pos++] + 1u;
+    else if (blockCode == 7) { h.blockSize = ((p[pos] << 8) | p[pos + 1]) + 1u; pos += 2; }
+    else h.blockSize = 256u << (blockCode - 8);
+
+    static const uint32_t kRates[12] = { 0, 88200, 176400, 192000, 8000, 16000, 22050, 24000,
+                                         32000, 44100, 48000, 96000 };
+    if (rateCode < 12) h.sampleRate = kRates[rateCode];
+    else if (rateCode == 12) h.sampleRate = p[pos++] * 1000u;
+    else if (rateCode == 13) { h.sampleRate = (p[pos] << 8) | p[pos + 1]; pos += 2; }
+    else { h.sampleRate = ((p[pos] << 8) | p[pos + 1]) * 10u; pos += 2; }
+
+    if (crc8(p, pos) != p[pos]) return false;
+    h.headerBytes = static_cast<uint32_t>(pos + 1);
+    h.sample = variable ? number : number * fixedBlockSize;
+    return true;
+}
+
+// Ogg 页头
+struct OggPageHeader {
+    uint64_t granule = 0;       // 该页最后完成的包结束处的样本位置；无包结束时为全 1
+    uint32_t serial = 0;
+    uint32_t pageBytes = 0;     // 页头 + 段表 + 数据
+};
+
+// 解析 p 处的页头（需要页头与段表，共 27 + 段数 字节）
+inline bool parseOggPageHeader(const unsigned char* p, size_t len, OggPageHeader& h) {
+    if (len < 27 || std::memcmp(p, "OggS", 4) != 0 || p[4] != 0) return false;
+    size_t segments = p[26];
+    if (len < 27 + segments) return false;
+    h.granule = readLE32(p + 6) | (static_cast<uint64_t>(readLE32(p + 10)) << 32);
+    h.serial = readLE32(p + 14);
+    h.pageBytes = static_cast<uint32_t>(27 + segments);
+    for (size_t s = 0; s < segments; s++) h.pageBytes += p[27 + s];
+    return true;
+}
+
+} // namespace SeekScan
+
+// 压缩格式的定位索引：
+// MPEG 帧头不含位置信息，Xing TOC 只精确到时长的 1%，因此一次顺序扫描全部帧头，每 kMpegStride 帧记录一个点；
+// FLAC 采用 SEEKTABLE 中的点，Ogg 没有索引结构；两者的帧头 / 页头带有样本位置，定位时在相邻已知点之间
+// 按字节位置二分，直到间隔不超过 kBisectSpan，二分中探测到的点记入索引，之后附近的定位不再读文件。
+// 定位结果精确到样本：解码器从返回的偏移开始解码并丢弃 skip 帧；MPEG Layer III 的比特池与 Opus 的
+// 重叠窗口需要的预热帧已计入 skip
+class SeekIndex {
+public:
+    static constexpr uint32_t kMpegStride = 8;
+    static constexpr uint64_t kBisectSpan = 16 * 1024;
+    static constexpr size_t kScanBlock = 64 * 1024;
+    static constexpr size_t kProbeBlock = 16 * 1024;
+    static constexpr size_t kMaxPoints = 1 << 16;
+    static constexpr size_t kCacheEntries = 32;
+
+    SeekIndex() = default;
+    SeekIndex(const SeekIndex&) = delete;
+    SeekIndex& operator=(const SeekIndex&) = delete;
+
+    SeekFormat format() const { return format_; }
+    uint32_t sampleRate() const { return sampleRate_; }
+    uint64_t totalFrames() const { return totalFrames_; }       // 不含前导延迟与尾部填充
+    uint64_t leadingFrames() const { return leading_; }         // 解码输出开头需丢弃的帧数
+    uint32_t buildReads() const { return buildReads_; }
+
+    size_t pointCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return points_.size();
+    }
+
+    size_t memoryBytes() const { return pointCount() * sizeof(SeekPoint); }
+
+    bool build(const std::string& filepath) {
+        Metadata::SourceFile file;
+        return file.open(filepath) && build(file);
+    }
+
+    // 识别格式并建立索引；不是支持的压缩格式或无法解析时返回 false
+    bool build(Metadata::SourceFile& file) {
+        SeekScan::ReadWindow window(file, kScanBlock);
+        const unsigned char* head = window.at(0, 12);
+        if (!head) return false;
+        if (std::memcmp(head, "RIFF", 4) == 0 || std::memcmp(head + 4, "ftyp", 4) == 0) return false;
+        bool ok;
+        if (std::memcmp(head, "OggS", 4) == 0) {
+            ok = buildOgg(file, window);
+        } else {
+            uint64_t tagSize = Metadata::id3v2Size(head, window.buffered(0));
+            const unsigned char* magic = window.at(tagSize, 4);
+            ok = magic && std::memcmp(magic, "fLaC", 4) == 0 ? buildFlac(window, tagSize, file.size())
+                                                            : buildMpeg(file, window, tagSize);
+        }
+        buildReads_ = window.reads();
+        return ok;
+    }
+
+    // 定位到第 frame 帧（不含前导延迟）
+    SeekTarget locate(Metadata::SourceFile& file, uint64_t frame) const {
+        if (totalFrames_ > 0) frame = std::min(frame, totalFrames_);
+        uint64_t raw = frame + leading_;
+        uint64_t want = raw > preroll_ ? raw - preroll_ : 0;
+
+        SeekPoint lo{ 0, dataStart_ };
+        SeekPoint hi{ endFrame_, dataEnd_ };
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = std::upper_bound(points_.begin(), points_.end(), want,
+                                       [](uint64_t f, const SeekPoint& p) { return f < p.frame; });
+            if (it != points_.begin()) lo = *(it - 1);
+            if (it != points_.end()) hi = *it;
+        }
+
+        SeekTarget target;
+        if (format_ != SeekFormat::Mpeg) {
+            // 交替使用按样本位置插值与取中点，插值在码率平稳时几步即可收敛，取中点保证最坏情况
+            SeekScan::ReadWindow window(file, kProbeBlock);
+            std::vector<SeekPoint> learned;
+            for (int step = 0; hi.offset - lo.offset > kBisectSpan; step++) {
+                uint64_t span = hi.offset - lo.offset;
+                uint64_t probe = lo.offset + span / 2;
+                if (step % 2 == 0 && hi.frame > lo.frame) {
+                    double fraction = static_cast<double>(want - lo.frame) / static_cast<double>(hi.frame - lo.frame);
+                    probe = lo.offset + static_cast<uint64_t>(fraction * static_cast<double>(span));
+                }
+                probe = std::max(lo.offset + 1, std::min(probe, hi.offset - 1));
+                SeekPoint found;
+                if (!nextPoint(window, probe, hi.offset, found)) {
+                    hi.offset = probe;          // [probe, hi) 中没有帧头：其后第一帧仍是 hi
+                    continue;
+                }
+                learned.push_back(found);
+                if (found.frame <= want) lo = found;
+                else hi = found;
+            }
+            target.reads = window.reads();
+            if (!learned.empty()) learn(learned);
+        }
+        target.offset = lo.offset;
+        target.skip = raw - lo.frame;
+        return target;
+    }
+
+    // 进程内缓存的索引（按路径，文件大小或修改时间变化后重建）；不支持的格式返回 nullptr
+    static std::shared_ptr<const SeekIndex> get(const std::string& filepath) {
+        struct Entry {
+            std::string filepath;
+            uint64_t size;
+            int64_t mtimeNs;
+            std::shared_ptr<const SeekIndex> index;
+        };
+        static std::mutex mutex;
+        static std::list<Entry> cache;
+
+        uint64_t size = 0;
+        int64_t mtimeNs = 0;
+        if (!sourceFileStat(filepath, size, mtimeNs)) return nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto it = cache.begin(); it != cache.end(); ++it) {
+                if (it->filepath != filepath) continue;
+                if (it->size == size && it->mtimeNs == mtimeNs) {
+                    cache.splice(cache.begin(), cache, it);
+                    return cache.front().index;
+                }
+                cache.erase(it);
+                break;
+            }
+        }
+        auto index = std::make_shared<SeekIndex>();
+        if (!index->build(filepath)) return nullptr;
+        std::lock_guard<std::mutex> lock(mutex);
+        cache.push_front(Entry{ filepath, size, mtimeNs, index });
+        if (cache.size() > kCacheEntries) cache.pop_back();
+        return index;
+    }
+
+private:
+    bool buildMpeg(Metadata::SourceFile& file, SeekScan::ReadWindow& window, uint64_t audioStart) {
+        uint64_t audioEnd = file.size();
+        if (const unsigned char* v1 = audioEnd >= audioStart + 128 ? window.at(audioEnd - 128, 3) : nullptr) {
+            if (std::memcmp(v1, "TAG", 3) == 0) audioEnd -= 128;
+        }
+
+        uint64_t pos = audioStart;
+        uint64_t count = 0;
+        uint64_t padding = 0;
+        uint32_t samplesPerFrame = 0;
+        bool synced = false;
+        while (pos + 4 <= audioEnd) {
+            const unsigned char* p = window.at(pos, 4);
+            if (!p) break;
+            Metadata::MpegFrameHeader h;
+            bool ok = Metadata::parseMpegHeader(p, h) && pos + h.frameBytes <= audioEnd &&
+                      (sampleRate_ == 0 || (h.sampleRate == sampleRate_ && h.samplesPerFrame == samplesPerFrame));
+            if (ok && !synced && pos + h.frameBytes + 4 <= audioEnd) {
+                // 失步后要求紧跟着另一个有效帧头，避免把数据中的同步字误当作帧头
+                const unsigned char* q = window.at(pos + h.frameBytes, 4);
+                Metadata::MpegFrameHeader next;
+                ok = q && Metadata::parseMpegHeader(q, next) && next.sampleRate == h.sampleRate;
+            }
+            if (!ok) {
+                synced = false;
+                pos++;
+                continue;
+            }
+            synced = true;
+            if (sampleRate_ == 0) {
+                sampleRate_ = h.sampleRate;
+                samplesPerFrame = h.samplesPerFrame;
+                preroll_ = (h.sideInfoBytes > 0 ? 2u : 1u) * samplesPerFrame;
+                dataStart_ = pos;
+                if (const unsigned char* f = window.at(pos, h.frameBytes)) {
+                    if (parseInfoFrame(f, h, padding)) {
+                        pos += h.frameBytes;
+                        dataStart_ = pos;
+                        continue;
+                    }
+                }
+            }
+            if (count % kMpegStride == 0) points_.push_back(SeekPoint{ count * samplesPerFrame, pos });
+            count++;
+            pos += h.frameBytes;
+        }
+        if (count == 0) return false;
+        format_ = SeekFormat::Mpeg;
+        endFrame_ = count * samplesPerFrame;
+        totalFrames_ = endFrame_ > leading_ + padding ? endFrame_ - leading_ - padding : 0;
+        dataEnd_ = pos;
+        return true;
+    }
+
+    // 首帧为 Xing/Info/VBRI 信息帧时返回 true（不含音频）；LAME 标签中的编码器延迟与尾部填充
+    // 加上解码器固有的 529 个样本即为需要裁掉的前导与尾部
+    bool parseInfoFrame(const unsigned char* f, const Metadata::MpegFrameHeader& h, uint64_t& padding) {
+        size_t xing = 4 + h.sideInfoBytes;
+        if (xing + 8 <= h.frameBytes &&
+            (std::memcmp(f + xing, "Xing", 4) == 0 || std::memcmp(f + xing, "Info", 4) == 0)) {
+            uint32_t flags = Metadata::readBE32(f + xing + 4);
+            size_t lame = xing + 8 + ((flags & 1) ? 4 : 0) + ((flags & 2) ? 4 : 0) + ((flags & 4) ? 100 : 0) +
+                          ((flags & 8) ? 4 : 0);
+            if (lame + 24 <= h.frameBytes &&
+                (std::memcmp(f + lame, "LAME", 4) == 0 || std::memcmp(f + lame, "Lavc", 4) == 0 ||
+                 std::memcmp(f + lame, "Lavf", 4) == 0)) {
+                const unsigned char* d = f + lame + 21;
+                leading_ = ((static_cast<uint64_t>(d[0]) << 4) | (d[1] >> 4)) + 529;
+                uint64_t tail = (static_cast<uint64_t>(d[1] & 0x0F) << 8) | d[2];
+                padding = tail > 529 ? tail - 529 : 0;
+            }
+            return true;
+        }
+        return 4 + 32 + 4 <= h.frameBytes && std::memcmp(f + 4 + 32, "VBRI", 4) == 0;
+    }
+
+    bool buildFlac(SeekScan::ReadWindow& window, uint64_t start, uint64_t fileSize) {
+        uint64_t pos = start + 4;
+        bool haveInfo = false;
+        std::vector<SeekPoint> table;
+        while (true) {
+            const unsigned char* h = window.at(pos, 4);
+            if (!h) return false;
+            bool last = (h[0] & 0x80) != 0;
+            int type = h[0] & 0x7F;
+            uint32_t len = (h[1] << 16) | (h[2] << 8) | h[3];
+            if (type == 0 && len >= 34) {
+                // STREAMINFO：最小 / 最大块长各 16 位，采样率 20 位，总采样数 36 位
+                const unsigned char* b = window.at(pos + 4, 34);
+                if (!b) return false;
+                flacBlockSize_ = (b[0] << 8) | b[1];
+                flacMaxBlock_ = (b[2] << 8) | b[3];
+                sampleRate_ = (b[10] << 12) | (b[11] << 4) | (b[12] >> 4);
+                totalFrames_ = (static_cast<uint64_t>(b[13] & 0x0F) << 32) | Metadata::readBE32(b + 14);
+                haveInfo = true;
+            } else if (type == 3) {
+                // SEEKTABLE：每点 18 字节（样本号、相对首帧的偏移、样本数），占位点的样本号为全 1
+                const unsigned char* b = window.at(pos + 4, len);
+                if (!b) return false;
+                for (uint32_t i = 0; i + 18 <= len; i += 18) {
+                    uint64_t sample = Metadata::readBE64(b + i);
+                    if (sample == ~0ULL) continue;
+                    table.push_back(SeekPoint{ sample, Metadata::readBE64(b + i + 8) });
+                }
+            }
+            pos += 4 + len;
+            if (last) break;
+        }
+        const unsigned char* first = window.at(pos, 16);
+        SeekScan::FlacFrameHeader frame;
+        if (!haveInfo || sampleRate_ == 0 || !first || !SeekScan::parseFlacFrameHeader(first, 16, flacBlockSize_, frame)) {
+            return false;
+        }
+        format_ = SeekFormat::Flac;
+        flacVariable_ = (first[1] & 1) != 0;
+        dataStart_ = pos;
+        dataEnd_ = fileSize;
+        endFrame_ = totalFrames_ > 0 ? totalFrames_ : ~0ULL;
+        for (const SeekPoint& point : table) {
+            SeekPoint absolute{ point.frame, dataStart_ + point.offset };
+            bool ordered = points_.empty() || (absolute.frame > points_.back().frame &&
+                                               absolute.offset > points_.back().offset);
+            if (ordered && absolute.frame > 0 && absolute.frame < endFrame_ && absolute.offset < dataEnd_) {
+                points_.push_back(absolute);
+            }
+        }
+        return true;
+    }
+
+    bool buildOgg(Metadata::SourceFile& file, SeekScan::ReadWindow& window) {
+        const unsigned char* head = window.at(0, 27);
+        SeekScan::OggPageHeader page;
+        if (!head || !SeekScan::parseOggPageHeader(head, window.buffered(0), page)) return false;
+        size_t size = window.buffered(0);
+        std::vector<unsigned char> buf(head, head + size);
+        auto packets = Metadata::oggPackets(buf, 1);
+        if (packets.empty()) return false;
+        const auto& id = packets[0];
+        if (id.size() >= 16 && id[0] == 1 && std::memcmp(id.data() + 1, "vorbis", 6) == 0) {
+            sampleRate_ = readLE32(id.data() + 12);
+        } else if (id.size() >= 19 && std::memcmp(id.data(), "OpusHead", 8) == 0) {
+            // Opus 的颗粒位置固定为 48kHz 并含预跳过样本；解码需要 80ms 的预热
+            sampleRate_ = 48000;
+            leading_ = readLE16(id.data() + 10);
+            preroll_ = 3840;
+        } else {
+            return false;
+        }
+        format_ = SeekFormat::Ogg;
+        oggSerial_ = page.serial;
+        dataStart_ = 0;
+        dataEnd_ = file.size();
+        endFrame_ = Metadata::oggLastGranule(file);
+        totalFrames_ = endFrame_ > leading_ ? endFrame_ - leading_ : 0;
+        return sampleRate_ > 0;
+    }
+
+    // [from, limit) 中的第一个帧头 / 页头
+    bool nextPoint(SeekScan::ReadWindow& window, uint64_t from, uint64_t limit, SeekPoint& found) const {
+        const int sync = format_ == SeekFormat::Flac ? 0xFF : 'O';
+        uint64_t pos = from;
+        while (pos < limit) {
+            const unsigned char* p = window.at(pos, 1);
+            if (!p) return false;
+            size_t n = static_cast<size_t>(std::min<uint64_t>(window.buffered(pos), limit - pos));
+            const void* hit = std::memchr(p, sync, n);
+            if (!hit) {
+                pos += n;
+                continue;
+            }
+            pos += static_cast<uint64_t>(static_cast<const unsigned char*>(hit) - p);
+            if (matchAt(window, pos, found)) return true;
+            pos++;
+        }
+        return false;
+    }
+
+    bool matchAt(SeekScan::ReadWindow& window, uint64_t offset, SeekPoint& found) const {
+        if (format_ == SeekFormat::Flac) {
+            const unsigned char* p = window.at(offset, 16);
+            SeekScan::FlacFrameHeader frame;
+            if (!p || !SeekScan::parseFlacFrameHeader(p, 16, flacBlockSize_, frame)) return false;
+            // CRC-8 之外再核对与流一致的分块方式、块长与采样率，排除数据中偶然出现的同步字
+            bool variable = (p[1] & 1) != 0;
+            if (variable != flacVariable_ || frame.blockSize > flacMaxBlock_ || frame.sample >= endFrame_ ||
+                (frame.sampleRate != 0 && frame.sampleRate != sampleRate_) ||
+                (!variable && frame.blockSize != flacBlockSize_ && frame.sample + frame.blockSize < endFrame_)) {
+                return false;
+            }
+            found = SeekPoint{ frame.sample, offset };
+            return true;
+        }
+        const unsigned char* p = window.at(offset, 27);
+        SeekScan::OggPageHeader page;
+        if (!p || std::memcmp(p, "OggS", 4) != 0) return false;
+        p = window.at(offset, 27 + p[26]);
+        if (!p || !SeekScan::parseOggPageHeader(p, 27 + p[26], page) || page.serial != oggSerial_ ||
+            page.granule == ~0ULL) {
+            return false;
+        }
+        p = window.at(offset, page.pageBytes);
+        uint32_t stored = p ? readLE32(p + 22) : 0;
+        if (!p || SeekScan::oggCrc(p, page.pageBytes) != stored) return false;
+        found = SeekPoint{ page.granule, offset };
+        return true;
+    }
+
+    // 把二分中探测到的点并入索引（保持有序，数量有上限）
+    void learn(const std::vector<SeekPoint>& learned) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const SeekPoint& point : learned) {
+            if (points_.size() >= kMaxPoints) break;
+            auto it = std::lower_bound(points_.begin(), points_.end(), point.offset,
+                                       [](const SeekPoint& p, uint64_t offset) { return p.offset < offset; });
+            if (it != points_.end() && it->offset == point.offset) continue;
+            bool ordered = (it == points_.begin() || (it - 1)->frame <= point.frame) &&
+                           (it == points_.end() || it->frame >= point.frame);
+            if (ordered) points_.insert(it, point);
+        }
+    }
+
+    SeekFormat format_ = SeekFormat::Unknown;
+    uint32_t sampleRate_ = 0;
+    uint64_t totalFrames_ = 0;
+    uint64_t leading_ = 0;
+    uint64_t preroll_ = 0;
+    uint64_t dataStart_ = 0;
+    uint64_t dataEnd_ = 0;
+    uint64_t endFrame_ = 0;             // 原始输出的样本总数，二分的上界
+    uint32_t flacBlockSize_ = 0;
+    uint32_t flacMaxBlock_ = 0;
+    bool flacVariable_ = false;
+    uint32_t oggSerial_ = 0;
+    uint32_t buildReads_ = 0;
+
+    mutable std::mutex mutex_;
+    mutable std::vector<SeekPoint> points_;     // 样本号与偏移均递增
+};
+
+} // namespace MusicApp
+
+#endif // SEEK_INDEX_H
@@ -0,0 +1,240 @@
+#ifndef SESSION_MANAGER_H
+#define SESSION_MANAGER_H
+
+#include "MusicPlayer.h"
+#include "NativeAudioPlayer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MusicApp {
+
+// 一个会话：独立的播放器、播放列表与循环/随机状态，输出到自己的输出端
+// 引擎运行在托管模式，没有自己的线程；解码、DSP 与事件分发都由 SessionManager 在共享线程池上执行
+class PlayerSession {
+public:
+    PlayerSession(std::string name, std::unique_ptr<NativeAudioPlayer> engine, WorkStealingPool& pool)
+        : name_(std::move(name)), engine_(engine.get()), player_(std::move(engine), &pool) {
+        // 切歌时预先构建波形会在调度任务中读缓存文件并整曲解码，各会话重复解码同一曲目
+        player_.setWaveformAutoBuild(false);
+    }
+
+    PlayerSession(const PlayerSession&) = delete;
+    PlayerSession& operator=(const PlayerSession&) = delete;
+
+    const std::string& name() const { return name_; }
+
+    // 命令处理须持有 mutex()，与调度器的事件分发串行；持锁时可以等待共享线程池
+    MusicPlayer& player() { return player_; }
+    std::mutex& mutex() { return mutex_; }
+
+    const NativeAudioPlayer& engine() const { return *engine_; }
+
+    // 一个调度周期：渲染 periods 个周期，再分发本周期产生的事件（播放结束时切歌等）。
+    // 命令正持有会话锁时不等待，事件留到下一周期分发：命令（如 load -r）可能正在等待共享线程池，
+    // 而本任务占着其中一个工作线程，阻塞在锁上会互等
+    void process(uint32_t periods) {
+        engine_->renderPeriods(periods);
+        std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) return;
+        player_.update();
+    }
+
+private:
+    std::string name_;
+    NativeAudioPlayer* engine_;     // 由 player_ 持有
+    std::mutex mutex_;
+    MusicPlayer player_;
+};
+
+// 调度器统计
+struct SessionHostStats {
+    uint64_t ticks = 0;
+    uint64_t lateTicks = 0;         // 未能在下一个调度时刻之前完成的周期
+    double busySeconds = 0.0;       // 各调度周期的耗时之和
+    double maxTickSeconds = 0.0;
+};
+
+// 多会话宿主：一个进程内运行多个互不相关的播放器（区域、串流）。
+// 每个调度周期为每个会话向固定大小的工作窃取线程池提交一个任务，等全部完成后进入下一周期；
+// 线程数与会话数无关，会话只占用内存与各自的输出端
+class SessionManager {
+public:
+    // threads 为 0 时按硬件线程数；每个调度周期渲染 periodsPerTick 个引擎周期
+    explicit SessionManager(const NativeEngineConfig& config = NativeEngineConfig(),
+                            size_t threads = 0, uint32_t periodsPerTick = 4)
+        : pool_(threads), config_(config), periodsPerTick_(std::max<uint32_t>(1, periodsPerTick)) {
+        config_.hosted = true;
+    }
+
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    // 会话须在线程池之前析构（成员按声明的逆序析构）
+    ~SessionManager() {
+        stop();
+        std::lock_guard<std::mutex> lock(mutex_);
+        sessions_.clear();
+    }
+
+    // 创建会话；名称已存在时返回 nullptr。sink 为空时使用空输出端
+    std::shared_ptr<PlayerSession> create(const std::string& name, std::unique_ptr<AudioSink> sink = nullptr) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (sessions_.count(name)) return nullptr;
+        auto session = std::make_shared<PlayerSession>(
+            name, std::make_unique<NativeAudioPlayer>(std::move(sink), config_), pool_);
+        sessions_.emplace(name, session);
+        return session;
+    }
+
+    // 移除会话；正在进行的调度周期结束后才析构
+    bool remove(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return sessions_.erase(name) > 0;
+    }
+
+    std::shared_ptr<PlayerSession> find(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = sessions_.find(name);
+        return it != sessions_.end() ? it->second : nullptr;
+    }
+
+    // 全部会话（按名称排序）
+    std::vector<std::shared_ptr<PlayerSession>> sessions() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::shared_ptr<PlayerSession>> list;
+        list.reserve(sessions_.size());
+        for (const auto& entry : sessions_) list.push_back(entry.second);
+        return list;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return sessions_.size();
+    }
+
+    WorkStealingPool& getWorkerPool() { return pool_; }
+    const NativeEngineConfig& getConfig() const { return config_; }
+
+    // 一个调度周期对应的音频时长（秒）
+    double tickSeconds() const {
+        return static_cast<double>(periodsPerTick_) * config_.periodFrames / config_.sampleRate;
+    }
+
+    // 执行一个调度周期并等待全部会话完成（调度线程未运行时可由调用方直接驱动，例如离线渲染）
+    void tick() {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::shared_ptr<PlayerSession>> batch = sessions();
+        {
+            TaskGroup group(pool_);
+            for (const auto& session : batch) {
+                PlayerSession* s = session.get();
+                uint32_t periods = periodsPerTick_;
+                group.run([s, periods]() { s->process(periods); });
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.ticks++;
+        stats_.busySeconds += seconds;
+        stats_.maxTickSeconds = std::max(stats_.maxTickSeconds, seconds);
+    }
+
+    // 按实时节奏调度：每 tickSeconds() 执行一个调度周期
+    void start() {
+        if (running_) return;
+        running_ = true;
+        thread_ = std::thread(&SessionManager::run, this);
+    }
+
+    void stop() {
+        running_ = false;
+        if (thread_.joinable()) thread_.join();
+    }
+
+    bool isRunning() const { return running_; }
+
+    SessionHostStats getStats() const {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        return stats_;
+    }
+
+    // 每个会话一行：名称、状态、曲目与位置、音量；末尾为调度器负载
+    std::string formatSessions() const {
+        std::stringstream ss;
+        for (const auto& session : sessions()) {
+            std::lock_guard<std::mutex> lock(session->mutex());
+            const MusicPlayer& player = session->player();
+            const char* state = player.getState() == PlayState::Playing ? "playing"
+                              : player.getState() == PlayState::Paused ? "paused" : "stopped";
+            ss << std::left << std::setw(12) << session->name() << std::setw(8) << state << std::right;
+            TrackView track = player.getPlaylist().getCurrentTrack();
+            if (track) {
+                ss << " [" << player.getPlaylist().getCurrentIndex() + 1 << "/"
+                   << player.getPlaylist().size() << "] " << track->title() << " @ "
+                   << std::fixed << std::setprecision(1) << player.getCurrentTime() << "s";
+            }
+            ss << " vol " << static_cast<int>(std::lround(player.getVolume())) << '\n';
+        }
+        SessionHostStats stats = getStats();
+        double load = stats.ticks ? stats.busySeconds / (stats.ticks * tickSeconds()) : 0.0;
+        ss << size() << " sessions on " << pool_.size() << " threads, tick "
+           << std::fixed << std::setprecision(1) << tickSeconds() * 1000.0 << " ms, load "
+           << std::setprecision(0) << load * 100.0 << "%, late ticks " << stats.lateTicks << '\n';
+        return ss.str();
+    }
+
+private:
+    void run() {
+        MUSICAPP_STATS_THREAD();
+        const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(tickSeconds()));
+        auto next = std::chrono::steady_clock::now();
+        while (running_) {
+            tick();
+            next += period;
+            auto now = std::chrono::steady_clock::now();
+            if (now > next) {
+                // 过载：本周期超时。落后太多时放弃追赶，各会话的输出按时长顺延
+                std::lock_guard<std::mutex> lock(statsMutex_);
+                stats_.lateTicks++;
+                if (next + 4 * period < now) next = now;
+            }
+            std::this_thread::sleep_until(next);
+        }
+    }
+
+    WorkStealingPool pool_;
+    NativeEngineConfig config_;
+    uint32_t periodsPerTick_;
+
+    // 先按长度再按内容排序，数字名称按数值顺序列出
+    struct NameOrder {
+        bool operator()(const std::string& a, const std::string& b) const {
+            return a.size() != b.size() ? a.size() < b.size() : a < b;
+        }
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<PlayerSession>, NameOrder> sessions_;
+
+    mutable std::mutex statsMutex_;
+    SessionHostStats stats_;
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+} // namespace MusicApp
+
+#endif // SESSION_MANAGER_H
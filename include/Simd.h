@@ -0,0 +1,105 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// SIMD 指令集检测与运行时分派
+// x86 上按 CPU 能力在 SSE2/AVX2 之间选择，ARM64 上使用 NEON，其余平台回退到标量
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define MUSICAPP_X86 1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define MUSICAPP_TARGET_AVX2
+    #else
+        #define MUSICAPP_TARGET_AVX2 __attribute__((target("avx2,fma")))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define MUSICAPP_NEON 1
+    #include <arm_neon.h>
+#endif
+
+#include <cstdint>
+
+namespace MusicApp {
+
+// 指令集级别
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::SSE2: return "sse2";
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+// 检测当前 CPU 支持的最高指令集级别
+inline SimdLevel detectSimdLevel() {
+#if defined(MUSICAPP_X86)
+    #ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7) {
+            __cpuidex(info, 7, 0);
+            bool avx2 = (info[1] & (1 << 5)) != 0;
+            __cpuid(info, 1);
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            bool fma = (info[2] & (1 << 12)) != 0;
+            if (avx2 && fma && osxsave && (_xgetbv(0) & 0x6) == 0x6) {
+                return SimdLevel::AVX2;
+            }
+        }
+        return SimdLevel::SSE2;
+    #else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return SimdLevel::AVX2;
+        }
+        return SimdLevel::SSE2;
+    #endif
+#elif defined(MUSICAPP_NEON)
+    return SimdLevel::NEON;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+// 进程内缓存的检测结果
+inline SimdLevel hostSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+// 指定级别能否在当前 CPU 上运行
+inline bool simdLevelSupported(SimdLevel level) {
+    SimdLevel host = hostSimdLevel();
+    switch (level) {
+        case SimdLevel::Scalar: return true;
+        case SimdLevel::SSE2: return host == SimdLevel::SSE2 || host == SimdLevel::AVX2;
+        case SimdLevel::AVX2: return host == SimdLevel::AVX2;
+        case SimdLevel::NEON: return host == SimdLevel::NEON;
+    }
+    return false;
+}
+
+// 在当前线程开启非规格化数清零（FTZ/DAZ），避免衰减尾音在实时线程上变慢
+inline void enableFlushDenormals() {
+#if defined(MUSICAPP_X86)
+    _mm_setcsr(_mm_getcsr() | 0x8040);
+#elif defined(MUSICAPP_NEON) && defined(__GNUC__)
+    uint64_t fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | (1ULL << 24)));
+#endif
+}
+
+} // namespace MusicApp
+
+#endif // SIMD_H
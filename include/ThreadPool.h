@@ -0,0 +1,175 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "Instrumentation.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MusicApp {
+
+// 工作窃取线程池
+// 每个工作线程有自己的任务队列：从自己的队尾取（LIFO，缓存友好），从其他线程的队首窃取（FIFO）
+// 工作线程内提交的子任务进入本线程队列，外部提交的任务轮流分配
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(size_t threads = 0) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 0; i < threads; i++) {
+            queues_.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (size_t i = 0; i < threads; i++) {
+            workers_.emplace_back(&WorkStealingPool::run, this, i);
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            stop_ = true;
+        }
+        wakeCv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    void submit(Task task) {
+        size_t index = (currentPool() == this)
+            ? currentIndex()
+            : nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            queued_++;
+        }
+        wakeCv_.notify_one();
+    }
+
+    // 当前线程是否为本线程池的工作线程
+    bool isWorkerThread() const { return currentPool() == this; }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    static const WorkStealingPool*& currentPool() {
+        static thread_local const WorkStealingPool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t& currentIndex() {
+        static thread_local size_t index = 0;
+        return index;
+    }
+
+    bool tryPop(size_t self, Task& task) {
+        WorkerQueue& q = *queues_[self];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool trySteal(size_t self, Task& task) {
+        for (size_t k = 1; k < queues_.size(); k++) {
+            WorkerQueue& q = *queues_[(self + k) % queues_.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty()) {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(size_t index) {
+        MUSICAPP_STATS_THREAD();
+        currentPool() = this;
+        currentIndex() = index;
+        while (true) {
+            Task task;
+            if (tryPop(index, task) || trySteal(index, task)) {
+                {
+                    std::lock_guard<std::mutex> lock(wakeMutex_);
+                    queued_--;
+                }
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wakeCv_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+            if (stop_ && queued_ == 0) break;
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> nextQueue_{0};
+
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    size_t queued_ = 0;
+    bool stop_ = false;
+};
+
+// 一组相关任务：任务内可继续向同一组提交子任务，wait() 等待全部完成
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkStealingPool& pool) : pool_(pool) {}
+
+    ~TaskGroup() {
+        wait();
+    }
+
+    void run(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_++;
+        }
+        pool_.submit([this, task = std::move(task)]() {
+            task();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) {
+                done_.notify_all();
+            }
+        });
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return pending_ == 0; });
+    }
+
+private:
+    WorkStealingPool& pool_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+    size_t pending_ = 0;
+};
+
+} // namespace MusicApp
+
+#endif // THREAD_POOL_H
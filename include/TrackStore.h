@@ -0,0 +1,353 @@
+#ifndef TRACK_STORE_H
+#define TRACK_STORE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace MusicApp {
+
+class TrackStore;
+
+// 响度分析结果（EBU R128）
+struct TrackLoudness {
+    bool analyzed = false;
+    float loudness = 0.0f;      // 积分响度（LUFS）；无法测量（静音、无法解码）时为 -inf
+    float truePeak = 0.0f;      // 真峰值（dBTP）
+
+    bool measured() const { return analyzed && std::isfinite(loudness); }
+};
+
+// 分贝值以 0.01 dB 为单位存为 16 位整数，INT16_MIN 表示 -inf
+inline int16_t packDecibels(float db) {
+    if (!(db > -327.67f)) return std::numeric_limits<int16_t>::min();
+    return static_cast<int16_t>(std::lround(std::min(db, 327.67f) * 100.0f));
+}
+
+inline float unpackDecibels(int16_t value) {
+    if (value == std::numeric_limits<int16_t>::min()) return -std::numeric_limits<float>::infinity();
+    return value / 100.0f;
+}
+
+// 曲目的只读视图：不持有数据，字符串直接指向 TrackStore 内部
+// 提供 operator-> 与显式 bool 转换，调用方可以像使用原先的 const TrackInfo* 一样判空和访问
+class TrackView {
+public:
+    TrackView() = default;
+    TrackView(const TrackStore* store, uint32_t id) : store_(store), id_(id) {}
+
+    explicit operator bool() const { return store_ != nullptr; }
+    const TrackView* operator->() const { return this; }
+
+    uint32_t id() const { return id_; }
+
+    std::string filepath() const;
+    std::string_view directory() const;     // 含末尾分隔符
+    std::string_view fileName() const;
+    std::string_view title() const;
+    std::string_view artist() const;
+    float duration() const;
+    bool metadataRead() const;
+    TrackLoudness loudness() const;
+
+private:
+    const TrackStore* store_ = nullptr;
+    uint32_t id_ = 0;
+};
+
+// 内存占用（字节）
+struct TrackStoreMemory {
+    size_t tracks = 0;
+    size_t columns = 0;         // 每曲目的定长列
+    size_t strings = 0;         // 文件名与标题字符区
+    size_t directories = 0;     // 去重后的目录表
+    size_t artists = 0;         // 去重后的艺术家表
+
+    size_t total() const { return columns + strings + directories + artists; }
+    double bytesPerTrack() const { return tracks ? static_cast<double>(total()) / tracks : 0.0; }
+};
+
+// 列式曲目存储
+// 曲目以添加顺序的 32 位编号标识，编号在 clear() 之前保持不变（删除只做标记）；播放顺序由 Playlist 维护。
+// 目录前缀（含分隔符）与艺术家各只存一份，以 32 位编号引用；文件名与标题存放在同一字符区，
+// 与文件名主干相同的标题直接引用文件名的字节。每首曲目只占若干定长列，遍历时按列顺序访问
+class TrackStore {
+public:
+    TrackStore() {
+        resetArtists();
+    }
+
+    TrackStore(const TrackStore&) = delete;
+    TrackStore& operator=(const TrackStore&) = delete;
+    // deque 移动时元素地址不变，哈希表中的键仍然有效
+    TrackStore(TrackStore&&) = default;
+    TrackStore& operator=(TrackStore&&) = default;
+
+    // 编号总数（含已删除的曲目）
+    size_t size() const { return directory_.size(); }
+    bool empty() const { return directory_.empty(); }
+    size_t removedCount() const { return removed_; }
+
+    TrackView operator[](size_t id) const { return TrackView(this, static_cast<uint32_t>(id)); }
+
+    // 预留到 count 首曲目；extraChars 为新增曲目的文件名与标题字节数，批量加载时给出可避免字符区反复扩容复制
+    void reserve(size_t count, size_t extraChars = 0) {
+        if (extraChars) chars_.reserve(chars_.size() + extraChars);
+        directory_.reserve(count);
+        nameOffset_.reserve(count);
+        nameLength_.reserve(count);
+        titleOffset_.reserve(count);
+        titleLength_.reserve(count);
+        artist_.reserve(count);
+        duration_.reserve(count);
+        flags_.reserve(count);
+        loudness_.reserve(count);
+        truePeak_.reserve(count);
+    }
+
+    // 按完整路径添加；title 为空表示使用文件名主干
+    uint32_t add(std::string_view filepath, std::string_view title, std::string_view artist,
+                 float duration, bool metadataRead) {
+        size_t sep = filepath.find_last_of("/\\");
+        size_t split = sep == std::string_view::npos ? 0 : sep + 1;
+        return add(filepath.substr(0, split), filepath.substr(split), title, artist, duration, metadataRead);
+    }
+
+    // 按目录前缀（含末尾分隔符）与文件名添加
+    uint32_t add(std::string_view directory, std::string_view name, std::string_view title,
+                 std::string_view artist, float duration, bool metadataRead) {
+        uint32_t index = static_cast<uint32_t>(size());
+        directory_.push_back(internDirectory(directory));
+        name = name.substr(0, kMaxLength);
+        uint32_t offset = static_cast<uint32_t>(chars_.size());
+        chars_.append(name);
+        nameOffset_.push_back(offset);
+        nameLength_.push_back(static_cast<uint16_t>(name.size()));
+        titleOffset_.push_back(offset);
+        titleLength_.push_back(static_cast<uint16_t>(std::min(name.size(), name.find_last_of('.'))));
+        artist_.push_back(0);
+        duration_.push_back(duration);
+        flags_.push_back(metadataRead ? kMetadataRead : 0);
+        loudness_.push_back(0);
+        truePeak_.push_back(0);
+        if (!title.empty()) setTitle(index, title);
+        if (!artist.empty()) setArtist(index, artist);
+        return index;
+    }
+
+    // 修改标题：旧字节留在字符区中，直到 clear()
+    void setTitle(size_t index, std::string_view title) {
+        std::string_view name = fileName(index);
+        size_t stem = std::min(name.size(), name.find_last_of('.'));
+        if (title == name.substr(0, stem)) {
+            titleOffset_[index] = nameOffset_[index];
+            titleLength_[index] = static_cast<uint16_t>(stem);
+            return;
+        }
+        title = title.substr(0, kMaxLength);
+        titleOffset_[index] = static_cast<uint32_t>(chars_.size());
+        titleLength_[index] = static_cast<uint16_t>(title.size());
+        chars_.append(title);
+    }
+
+    void setArtist(size_t index, std::string_view artist) {
+        artist_[index] = internArtist(artist);
+    }
+
+    void setDuration(size_t index, float duration) { duration_[index] = duration; }
+
+    void setMetadataRead(size_t index) { flags_[index] |= kMetadataRead; }
+
+    void setLoudness(size_t index, const TrackLoudness& loudness) {
+        if (!loudness.analyzed) {
+            flags_[index] &= static_cast<uint8_t>(~kLoudnessAnalyzed);
+            return;
+        }
+        flags_[index] |= kLoudnessAnalyzed;
+        loudness_[index] = packDecibels(loudness.loudness);
+        truePeak_[index] = packDecibels(loudness.truePeak);
+    }
+
+    // 标记删除：编号不复用，空间在 clear() 或由调用方整体重建时回收
+    void erase(size_t index) {
+        if (!(flags_[index] & kRemoved)) {
+            flags_[index] |= kRemoved;
+            removed_++;
+        }
+    }
+
+    bool isRemoved(size_t index) const { return (flags_[index] & kRemoved) != 0; }
+
+    void clear() {
+        directory_.clear();
+        nameOffset_.clear();
+        nameLength_.clear();
+        titleOffset_.clear();
+        titleLength_.clear();
+        artist_.clear();
+        duration_.clear();
+        flags_.clear();
+        loudness_.clear();
+        truePeak_.clear();
+        removed_ = 0;
+        chars_.clear();
+        directories_.clear();
+        directoryViews_.clear();
+        directoryIds_.clear();
+        lastDirectory_ = kNoDirectory;
+        resetArtists();
+    }
+
+    std::string_view directory(size_t index) const { return directoryViews_[directory_[index]]; }
+
+    std::string_view fileName(size_t index) const {
+        return std::string_view(chars_.data() + nameOffset_[index], nameLength_[index]);
+    }
+
+    std::string_view title(size_t index) const {
+        return std::string_view(chars_.data() + titleOffset_[index], titleLength_[index]);
+    }
+
+    std::string_view artist(size_t index) const { return artistViews_[artist_[index]]; }
+    float duration(size_t index) const { return duration_[index]; }
+    bool metadataRead(size_t index) const { return (flags_[index] & kMetadataRead) != 0; }
+
+    TrackLoudness loudness(size_t index) const {
+        TrackLoudness result;
+        if (flags_[index] & kLoudnessAnalyzed) {
+            result.analyzed = true;
+            result.loudness = unpackDecibels(loudness_[index]);
+            result.truePeak = unpackDecibels(truePeak_[index]);
+        }
+        return result;
+    }
+
+    std::string filepath(size_t index) const {
+        std::string_view dir = directory(index);
+        std::string_view name = fileName(index);
+        std::string path;
+        path.reserve(dir.size() + name.size());
+        path.append(dir);
+        path.append(name);
+        return path;
+    }
+
+    size_t directoryCount() const { return directories_.size(); }
+    size_t artistCount() const { return artists_.size() - 1; }
+
+    // 去重表的编号与内容（编号 0 的艺术家为空），供按表扫描的查询使用
+    uint32_t directoryId(size_t index) const { return directory_[index]; }
+    uint32_t artistId(size_t index) const { return artist_[index]; }
+    std::string_view directoryName(uint32_t id) const { return directoryViews_[id]; }
+    std::string_view artistName(uint32_t id) const { return artistViews_[id]; }
+
+    // 按容量估算的内存占用；哈希表按每个节点两个指针加键值估算
+    TrackStoreMemory memoryUsage() const {
+        TrackStoreMemory m;
+        m.tracks = size();
+        m.columns = directory_.capacity() * sizeof(uint32_t) + nameOffset_.capacity() * sizeof(uint32_t) +
+                    nameLength_.capacity() * sizeof(uint16_t) + titleOffset_.capacity() * sizeof(uint32_t) +
+                    titleLength_.capacity() * sizeof(uint16_t) + artist_.capacity() * sizeof(uint32_t) +
+                    duration_.capacity() * sizeof(float) + flags_.capacity() * sizeof(uint8_t) +
+                    loudness_.capacity() * sizeof(int16_t) + truePeak_.capacity() * sizeof(int16_t);
+        m.strings = chars_.capacity();
+        m.directories = internedBytes(directories_, directoryViews_, directoryIds_);
+        m.artists = internedBytes(artists_, artistViews_, artistIds_);
+        return m;
+    }
+
+private:
+    using InternMap = std::unordered_map<std::string_view, uint32_t>;
+
+    static constexpr uint32_t kNoDirectory = 0xFFFFFFFFu;
+    static constexpr size_t kMaxLength = 0xFFFF;        // 文件名与标题的最大字节数
+    static constexpr uint8_t kMetadataRead = 1u << 0;
+    static constexpr uint8_t kRemoved = 1u << 1;
+    static constexpr uint8_t kLoudnessAnalyzed = 1u << 2;
+
+    void resetArtists() {
+        artists_.clear();
+        artistViews_.clear();
+        artistIds_.clear();
+        intern(artists_, artistViews_, artistIds_, std::string_view());    // 编号 0 为空艺术家
+    }
+
+    // 连续添加的曲目通常属于同一目录，先与上一个目录比较
+    uint32_t internDirectory(std::string_view directory) {
+        if (lastDirectory_ != kNoDirectory && directoryViews_[lastDirectory_] == directory) {
+            return lastDirectory_;
+        }
+        lastDirectory_ = intern(directories_, directoryViews_, directoryIds_, directory);
+        return lastDirectory_;
+    }
+
+    uint32_t internArtist(std::string_view artist) {
+        return intern(artists_, artistViews_, artistIds_, artist);
+    }
+
+    // deque 追加时不移动已有元素，哈希表的键与按编号访问的视图可以直接引用其中的字符串
+    static uint32_t intern(std::deque<std::string>& table, std::vector<std::string_view>& views,
+                           InternMap& ids, std::string_view value) {
+        auto it = ids.find(value);
+        if (it != ids.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(table.size());
+        table.emplace_back(value);
+        views.push_back(table.back());
+        ids.emplace(table.back(), id);
+        return id;
+    }
+
+    static size_t internedBytes(const std::deque<std::string>& table,
+                                const std::vector<std::string_view>& views, const InternMap& ids) {
+        size_t bytes = ids.bucket_count() * sizeof(void*) +
+                       ids.size() * (sizeof(InternMap::value_type) + 2 * sizeof(void*)) +
+                       views.capacity() * sizeof(std::string_view);
+        for (const auto& s : table) {
+            bytes += sizeof(std::string) + (s.capacity() > 15 ? s.capacity() + 1 : 0);
+        }
+        return bytes;
+    }
+
+    // 每曲目的列
+    std::vector<uint32_t> directory_;
+    std::vector<uint32_t> nameOffset_;
+    std::vector<uint16_t> nameLength_;
+    std::vector<uint32_t> titleOffset_;         // 与文件名主干相同时指向文件名
+    std::vector<uint16_t> titleLength_;
+    std::vector<uint32_t> artist_;
+    std::vector<float> duration_;
+    std::vector<uint8_t> flags_;
+    std::vector<int16_t> loudness_;             // 0.01 LUFS
+    std::vector<int16_t> truePeak_;             // 0.01 dBTP
+
+    size_t removed_ = 0;
+
+    std::string chars_;                         // 文件名与标题字符区
+    std::deque<std::string> directories_;
+    std::vector<std::string_view> directoryViews_;
+    InternMap directoryIds_;
+    uint32_t lastDirectory_ = kNoDirectory;
+    std::deque<std::string> artists_;
+    std::vector<std::string_view> artistViews_;
+    InternMap artistIds_;
+};
+
+inline std::string TrackView::filepath() const { return store_->filepath(id_); }
+inline std::string_view TrackView::directory() const { return store_->directory(id_); }
+inline std::string_view TrackView::fileName() const { return store_->fileName(id_); }
+inline std::string_view TrackView::title() const { return store_->title(id_); }
+inline std::string_view TrackView::artist() const { return store_->artist(id_); }
+inline float TrackView::duration() const { return store_->duration(id_); }
+inline bool TrackView::metadataRead() const { return store_->metadataRead(id_); }
+inline TrackLoudness TrackView::loudness() const { return store_->loudness(id_); }
+
+} // namespace MusicApp
+
+#endif // TRACK_STORE_H
@@ -0,0 +1,164 @@
+#ifndef WAV_DECODER_H
+#define WAV_DECODER_H
+
+#include "AudioDecoder.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace MusicApp {
+
+// WAV 格式信息
+struct WavFormat {
+    PcmEncoding encoding = PcmEncoding::Unknown;
+    uint32_t sampleRate = 0;
+    uint16_t channels = 0;
+    uint16_t blockAlign = 0;    // 每帧字节数
+    uint64_t dataOffset = 0;    // data 块起始偏移
+    uint64_t dataSize = 0;      // data 块字节数
+};
+
+// 解析 fmt 块内容
+inline bool parseWavFmtChunk(const unsigned char* p, uint32_t size, WavFormat& fmt) {
+    if (size < 16) return false;
+    uint16_t tag = readLE16(p);
+    fmt.channels = readLE16(p + 2);
+    fmt.sampleRate = readLE32(p + 4);
+    fmt.blockAlign = readLE16(p + 12);
+    uint16_t bits = readLE16(p + 14);
+    // WAVE_FORMAT_EXTENSIBLE：子格式 GUID 的前两个字节即格式标签
+    if (tag == 0xFFFE && size >= 40) {
+        tag = readLE16(p + 24);
+    }
+    if (tag == 1) {
+        if (bits == 16) fmt.encoding = PcmEncoding::Int16;
+        else if (bits == 24) fmt.encoding = PcmEncoding::Int24;
+        else if (bits == 32) fmt.encoding = PcmEncoding::Int32;
+    } else if (tag == 3 && bits == 32) {
+        fmt.encoding = PcmEncoding::Float32;
+    }
+    return fmt.encoding != PcmEncoding::Unknown && fmt.channels > 0 &&
+           fmt.sampleRate > 0 && fmt.blockAlign == fmt.channels * (bits / 8);
+}
+
+// 原地解析内存中的 RIFF/WAVE 头，定位 fmt 与 data 块
+inline bool parseWavHeader(const unsigned char* data, uint64_t size, WavFormat& fmt) {
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 ||
+        std::memcmp(data + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    bool haveFmt = false;
+    uint64_t pos = 12;
+    while (pos + 8 <= size) {
+        const unsigned char* chunk = data + pos;
+        uint64_t chunkSize = readLE32(chunk + 4);
+        uint64_t body = pos + 8;
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            if (body + chunkSize > size) return false;
+            haveFmt = parseWavFmtChunk(data + body, static_cast<uint32_t>(chunkSize), fmt);
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!haveFmt) return false;
+            fmt.dataOffset = body;
+            // 容忍声明长度超出文件实际大小（未完成写入的录音文件）
+            fmt.dataSize = std::min(chunkSize, size - body);
+            return true;
+        }
+        pos = body + chunkSize + (chunkSize & 1);
+    }
+    return false;
+}
+
+// 基于文件流的 WAV 解码器
+class WavDecoder : public AudioDecoder {
+public:
+    bool open(const std::string& filepath) override {
+        file_.open(filepath, std::ios::binary);
+        if (!file_) return false;
+
+        unsigned char header[12];
+        if (!file_.read(reinterpret_cast<char*>(header), 12) ||
+            std::memcmp(header, "RIFF", 4) != 0 ||
+            std::memcmp(header + 8, "WAVE", 4) != 0) {
+            return false;
+        }
+
+        file_.seekg(0, std::ios::end);
+        uint64_t fileSize = static_cast<uint64_t>(file_.tellg());
+        file_.seekg(12);
+
+        // 遍历 RIFF 块，查找 fmt 与 data
+        bool haveFmt = false;
+        unsigned char chunk[8];
+        while (file_.read(reinterpret_cast<char*>(chunk), 8)) {
+            uint32_t size = readLE32(chunk + 4);
+            if (std::memcmp(chunk, "fmt ", 4) == 0) {
+                // 块大小来自文件：超出文件的直接拒绝，只读取 WAVE_FORMAT_EXTENSIBLE 所需的 40 字节，其余跳过
+                uint64_t body = static_cast<uint64_t>(file_.tellg());
+                if (size > fileSize - body) return false;
+                unsigned char fmt[40];
+                uint32_t length = std::min<uint32_t>(size, sizeof(fmt));
+                if (!file_.read(reinterpret_cast<char*>(fmt), length)) return false;
+                haveFmt = parseWavFmtChunk(fmt, length, format_);
+                file_.seekg(static_cast<std::streamoff>(body + size + (size & 1)));
+            } else if (std::memcmp(chunk, "data", 4) == 0) {
+                if (!haveFmt) return false;
+                format_.dataOffset = static_cast<uint64_t>(file_.tellg());
+                format_.dataSize = size;
+                totalFrames_ = size / format_.blockAlign;
+                framePos_ = 0;
+                return true;
+            } else {
+                file_.seekg(size + (size & 1), std::ios::cur);
+            }
+        }
+        return false;
+    }
+
+    uint32_t getSampleRate() const override { return format_.sampleRate; }
+    uint16_t getChannels() const override { return format_.channels; }
+    uint64_t getTotalFrames() const override { return totalFrames_; }
+
+    size_t read(float* out, size_t frames) override {
+        uint64_t remaining = totalFrames_ - framePos_;
+        if (frames > remaining) frames = static_cast<size_t>(remaining);
+        if (frames == 0) return 0;
+
+        size_t bytes = frames * format_.blockAlign;
+        if (raw_.size() < bytes) raw_.resize(bytes);
+        file_.read(reinterpret_cast<char*>(raw_.data()), bytes);
+        size_t got = static_cast<size_t>(file_.gcount()) / format_.blockAlign;
+
+        convertPcmSamples(raw_.data(), format_.encoding, got * format_.channels, out);
+        framePos_ += got;
+        bytesCopied_ += got * format_.blockAlign;
+        return got;
+    }
+
+    bool seek(uint64_t frame) override {
+        if (frame > totalFrames_) frame = totalFrames_;
+        file_.clear();
+        file_.seekg(static_cast<std::streamoff>(
+            format_.dataOffset + frame * format_.blockAlign));
+        framePos_ = frame;
+        return static_cast<bool>(file_);
+    }
+
+    uint64_t tell() const override { return framePos_; }
+
+    uint64_t getBytesCopied() const override { return bytesCopied_; }
+
+    const WavFormat& getFormat() const { return format_; }
+
+private:
+    std::ifstream file_;
+    WavFormat format_;
+    uint64_t totalFrames_ = 0;
+    uint64_t framePos_ = 0;
+    uint64_t bytesCopied_ = 0;
+    std::vector<unsigned char> raw_;
+};
+
+} // namespace MusicApp
+
+#endif // WAV_DECODER_H
@@ -0,0 +1,577 @@
+#ifndef WAVEFORM_CACHE_H
+#define WAVEFORM_CACHE_H
+
+#include "DecoderFactory.h"
+#include "LibraryScanner.h"
+#include "Simd.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace MusicApp {
+
+// 峰值归约内核：n 个样本（交错的各声道一并计入）的最小值与最大值，累积到 lo/hi
+namespace PeakKernels {
+
+using MinMaxFn = void (*)(const float* samples, size_t n, float& lo, float& hi);
+
+inline void minMaxScalar(const float* samples, size_t n, float& lo, float& hi) {
+    float a = lo, b = hi;
+    for (size_t i = 0; i < n; i++) {
+        a = std::min(a, samples[i]);
+        b = std::max(b, samples[i]);
+    }
+    lo = a;
+    hi = b;
+}
+
+#if defined(MUSICAPP_X86)
+inline void minMaxSse2(const float* samples, size_t n, float& lo, float& hi) {
+    __m128 lo0 = _mm_set1_ps(lo), lo1 = lo0;
+    __m128 hi0 = _mm_set1_ps(hi), hi1 = hi0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 a = _mm_loadu_ps(samples + i);
+        __m128 b = _mm_loadu_ps(samples + i + 4);
+        lo0 = _mm_min_ps(lo0, a);
+        hi0 = _mm_max_ps(hi0, a);
+        lo1 = _mm_min_ps(lo1, b);
+        hi1 = _mm_max_ps(hi1, b);
+    }
+    lo0 = _mm_min_ps(lo0, lo1);
+    hi0 = _mm_max_ps(hi0, hi1);
+    float l[4], h[4];
+    _mm_storeu_ps(l, lo0);
+    _mm_storeu_ps(h, hi0);
+    lo = std::min(std::min(l[0], l[1]), std::min(l[2], l[3]));
+    hi = std::max(std::max(h[0], h[1]), std::max(h[2], h[3]));
+    minMaxScalar(samples + i, n - i, lo, hi);
+}
+
+MUSICAPP_TARGET_AVX2
+inline void minMaxAvx2(const float* samples, size_t n, float& lo, float& hi) {
+    __m256 lo0 = _mm256_set1_ps(lo), lo1 = lo0;
+    __m256 hi0 = _mm256_set1_ps(hi), hi1 = hi0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a = _mm256_loadu_ps(samples + i);
+        __m256 b = _mm256_loadu_ps(samples + i + 8);
+        lo0 = _mm256_min_ps(lo0, a);
+        hi0 = _mm256_max_ps(hi0, a);
+        lo1 = _mm256_min_ps(lo1, b);
+        hi1 = _mm256_max_ps(hi1, b);
+    }
+    lo0 = _mm256_min_ps(lo0, lo1);
+    hi0 = _mm256_max_ps(hi0, hi1);
+    __m128 l = _mm_min_ps(_mm256_castps256_ps128(lo0), _mm256_extractf128_ps(lo0, 1));
+    __m128 h = _mm_max_ps(_mm256_castps256_ps128(hi0), _mm256_extractf128_ps(hi0, 1));
+    l = _mm_min_ps(l, _mm_movehl_ps(l, l));
+    h = _mm_max_ps(h, _mm_movehl_ps(h, h));
+    l = _mm_min_ss(l, _mm_shuffle_ps(l, l, 1));
+    h = _mm_max_ss(h, _mm_shuffle_ps(h, h, 1));
+    lo = _mm_cvtss_f32(l);
+    hi = _mm_cvtss_f32(h);
+    minMaxScalar(samples + i, n - i, lo, hi);
+}
+#endif
+
+#if defined(MUSICAPP_NEON)
+inline void minMaxNeon(const float* samples, size_t n, float& lo, float& hi) {
+    float32x4_t lo0 = vdupq_n_f32(lo), lo1 = lo0;
+    float32x4_t hi0 = vdupq_n_f32(hi), hi1 = hi0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vld1q_f32(samples + i);
+        float32x4_t b = vld1q_f32(samples + i + 4);
+        lo0 = vminq_f32(lo0, a);
+        hi0 = vmaxq_f32(hi0, a);
+        lo1 = vminq_f32(lo1, b);
+        hi1 = vmaxq_f32(hi1, b);
+    }
+    lo = vminvq_f32(vminq_f32(lo0, lo1));
+    hi = vmaxvq_f32(vmaxq_f32(hi0, hi1));
+    minMaxScalar(samples + i, n - i, lo, hi);
+}
+#endif
+
+// 按指令集级别取内核（不支持的级别回退到标量）
+inline MinMaxFn select(SimdLevel level) {
+    if (!simdLevelSupported(level)) level = SimdLevel::Scalar;
+    switch (level) {
+#if defined(MUSICAPP_X86)
+        case SimdLevel::AVX2: return minMaxAvx2;
+        case SimdLevel::SSE2: return minMaxSse2;
+#endif
+#if defined(MUSICAPP_NEON)
+        case SimdLevel::NEON: return minMaxNeon;
+#endif
+        default: break;
+    }
+    return minMaxScalar;
+}
+
+} // namespace PeakKernels
+
+// 多分辨率的最小/最大值金字塔
+// 第 0 层每个区间 kBaseBinFrames 帧，之后每层的区间是上一层的 kLevelFactor 倍，直到只剩一个区间。
+// 每个区间存一对量化到 int8 的 (最小值, 最大值)，最小值向下、最大值向上取整，包络不会比原信号窄。
+// 任意时间范围的峰值由不超过范围长度的最粗一层上的几个区间合并得到，与曲目长度无关
+struct WaveformPyramid {
+    static constexpr uint32_t kBaseBinFrames = 1024;
+    static constexpr uint32_t kLevelFactor = 4;
+
+    uint32_t sampleRate = 0;
+    uint64_t totalFrames = 0;
+    std::vector<std::vector<int8_t>> levels;    // levels[l][2 * i] 为最小值，[2 * i + 1] 为最大值
+
+    static uint64_t binFrames(size_t level) {
+        uint64_t frames = kBaseBinFrames;
+        for (size_t l = 0; l < level; l++) frames *= kLevelFactor;
+        return frames;
+    }
+
+    double seconds() const { return sampleRate ? static_cast<double>(totalFrames) / sampleRate : 0.0; }
+
+    size_t memoryBytes() const {
+        size_t bytes = 0;
+        for (const auto& level : levels) bytes += level.size();
+        return bytes;
+    }
+
+    // [begin, end) 帧范围内的峰值（-1..1）；范围为空时 lo = hi = 0
+    void range(uint64_t begin, uint64_t end, float& lo, float& hi) const {
+        end = std::min(end, totalFrames);
+        lo = hi = 0.0f;
+        if (begin >= end || levels.empty()) return;
+        size_t level = 0;
+        while (level + 1 < levels.size() && binFrames(level + 1) <= end - begin) level++;
+        uint64_t frames = binFrames(level);
+        const std::vector<int8_t>& bins = levels[level];
+        int lowest = 127, highest = -127;
+        for (uint64_t i = begin / frames; i * frames < end && 2 * i + 1 < bins.size(); i++) {
+            lowest = std::min<int>(lowest, bins[2 * i]);
+            highest = std::max<int>(highest, bins[2 * i + 1]);
+        }
+        lo = static_cast<float>(lowest) / 127.0f;
+        hi = static_cast<float>(highest) / 127.0f;
+    }
+
+    static int8_t quantizeMin(float x) {
+        return static_cast<int8_t>(std::max(-127.0f, std::min(127.0f, std::floor(x * 127.0f))));
+    }
+
+    static int8_t quantizeMax(float x) {
+        return static_cast<int8_t>(std::max(-127.0f, std::min(127.0f, std::ceil(x * 127.0f))));
+    }
+
+    // buildUpperLevels 为 totalFrames 帧生成的层数，bytes 返回各层字节数之和
+    static uint32_t levelCount(uint64_t totalFrames, uint64_t& bytes) {
+        uint64_t bins = std::max<uint64_t>((totalFrames + kBaseBinFrames - 1) / kBaseBinFrames, 1);
+        uint32_t count = 1;
+        bytes = 2 * bins;
+        while (bins > 1) {
+            bins = (bins + kLevelFactor - 1) / kLevelFactor;
+            bytes += 2 * bins;
+            count++;
+        }
+        return count;
+    }
+
+    // 由第 0 层逐层合并出上层
+    void buildUpperLevels() {
+        levels.resize(1);
+        while (levels.back().size() > 2) {
+            const std::vector<int8_t>& below = levels.back();
+            size_t count = (below.size() / 2 + kLevelFactor - 1) / kLevelFactor;
+            std::vector<int8_t> level(2 * count);
+            for (size_t i = 0; i < count; i++) {
+                int8_t lo = 127, hi = -127;
+                for (size_t j = i * kLevelFactor; j < std::min(below.size() / 2, (i + 1) * kLevelFactor); j++) {
+                    lo = std::min(lo, below[2 * j]);
+                    hi = std::max(hi, below[2 * j + 1]);
+                }
+                level[2 * i] = lo;
+                level[2 * i + 1] = hi;
+            }
+            levels.push_back(std::move(level));
+        }
+    }
+};
+
+// 流式构建：一次解码，每块 kChunkBins 个区间，内存只有一个解码块与金字塔本身
+class WaveformBuilder {
+public:
+    static constexpr size_t kChunkBins = 16;
+
+    explicit WaveformBuilder(SimdLevel level = hostSimdLevel())
+        : minMax_(PeakKernels::select(level)) {}
+
+    bool build(AudioDecoder& decoder, WaveformPyramid& pyramid) {
+        return build(decoder, pyramid, []() { return false; });
+    }
+
+    // 每解码一块询问一次 cancelled()，返回 true 时中止；无法解码或被中止时返回 false
+    template <typename Cancelled>
+    bool build(AudioDecoder& decoder, WaveformPyramid& pyramid, Cancelled&& cancelled) {
+        const uint16_t channels = decoder.getChannels();
+        const size_t binFrames = WaveformPyramid::kBaseBinFrames;
+        pyramid.sampleRate = decoder.getSampleRate();
+        pyramid.totalFrames = 0;
+        pyramid.levels.assign(1, std::vector<int8_t>());
+        std::vector<int8_t>& base = pyramid.levels[0];
+        base.reserve(2 * (decoder.getTotalFrames() / binFrames + 1));
+        buffer_.resize(kChunkBins * binFrames * channels);
+        size_t got;
+        while ((got = readFull(decoder, kChunkBins * binFrames)) > 0) {
+            for (size_t f = 0; f < got; f += binFrames) {
+                size_t n = std::min(binFrames, got - f);
+                float lo = 0.0f, hi = 0.0f;
+                minMax_(buffer_.data() + f * channels, n * channels, lo, hi);
+                base.push_back(WaveformPyramid::quantizeMin(lo));
+                base.push_back(WaveformPyramid::quantizeMax(hi));
+            }
+            pyramid.totalFrames += got;
+            if (cancelled()) return false;
+        }
+        if (base.empty()) {
+            base.push_back(0);
+            base.push_back(0);
+        }
+        pyramid.buildUpperLevels();
+        return true;
+    }
+
+private:
+    // 解码器一次可能返回不足请求的帧数：补满一块，使区间边界与曲目起点对齐
+    size_t readFull(AudioDecoder& decoder, size_t frames) {
+        const uint16_t channels = decoder.getChannels();
+        size_t total = 0;
+        while (total < frames) {
+            size_t got = decoder.read(buffer_.data() + total * channels, frames - total);
+            if (got == 0) break;
+            total += got;
+        }
+        return total;
+    }
+
+    PeakKernels::MinMaxFn minMax_;
+    std::vector<float> buffer_;
+};
+
+// 波形缓存文件格式（小端）：[WaveformFileHeader][源文件路径][各层的 (最小值, 最大值) 对]
+// 源文件的大小或修改时间变化后缓存失效；文件名取路径的 64 位 FNV-1a 散列，路径存于文件中以排除碰撞
+const char kWaveformMagic[4] = { 'M', 'P', 'W', 'F' };
+const uint32_t kWaveformVersion = 1;
+
+struct WaveformFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceMtimeNs;
+    uint64_t totalFrames;
+    uint32_t sampleRate;
+    uint32_t baseBinFrames;
+    uint32_t levelFactor;
+    uint32_t levelCount;
+    uint32_t pathLength;
+    uint32_t reserved;
+};
+
+// 默认缓存目录：$XDG_CACHE_HOME/musicplayer/waveforms，其次 ~/.cache/...，都没有时用临时目录
+inline std::string defaultWaveformCacheDirectory() {
+    std::filesystem::path root;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        root = xdg;
+    } else if (const char* home = std::getenv("HOME"); home && *home) {
+        root = std::filesystem::path(home) / ".cache";
+    } else {
+        std::error_code ec;
+        root = std::filesystem::temp_directory_path(ec);
+    }
+    return (root / "musicplayer" / "waveforms").string();
+}
+
+// 批量构建的进度
+struct WaveformScanProgress {
+    bool running = false;
+    size_t total = 0;           // 本次开始时播放列表中的曲目数
+    size_t built = 0;
+    size_t cached = 0;          // 已有有效的缓存文件
+    size_t failed = 0;          // 无法解码
+    double seconds = 0.0;
+
+    size_t remaining() const {
+        size_t done = built + cached + failed;
+        return total > done ? total - done : 0;
+    }
+};
+
+// 一次后台构建的结果
+struct WaveformBuild {
+    std::string filepath;
+    std::shared_ptr<const WaveformPyramid> pyramid;     // 只有请求保留时才有
+    bool ok = false;
+    bool built = false;         // false：已有有效的缓存文件
+    bool cancelled = false;
+    uint64_t batch = 0;         // 提交该任务的批量构建编号，0 表示单独提交
+};
+
+// 波形缓存：磁盘上的缓存文件 + 内存中最近使用的几个金字塔
+// 构建任务在共享线程池上并行，每首曲目一个任务；在途任务数有上限，每个任务只持有一个解码块，
+// 构建期间的内存与曲库大小无关。结果由调用方在自己的线程中取回
+class WaveformCache {
+public:
+    WaveformCache(WorkStealingPool& pool, std::string directory, size_t capacity = 16)
+        : pool_(pool), group_(pool), directory_(std::move(directory)), capacity_(capacity) {}
+
+    WaveformCache(const WaveformCache&) = delete;
+    WaveformCache& operator=(const WaveformCache&) = delete;
+
+    ~WaveformCache() {
+        cancel();
+        group_.wait();
+    }
+
+    const std::string& directory() const { return directory_; }
+
+    size_t available() const {
+        size_t used = outstanding_.load();
+        return used < capacity_ ? capacity_ - used : 0;
+    }
+
+    size_t outstanding() const { return outstanding_.load(); }
+
+    // 中止正在进行的构建（之后提交的任务照常执行）
+    void cancel() { cancelGen_++; }
+
+    // 开始新一批批量构建并返回其编号，之前批次未完成的任务随之中止
+    uint64_t startBatch() { return ++batchGen_; }
+
+    // 只中止批量构建提交的任务，单独提交的构建（如正在播放的曲目）照常完成
+    void cancelBatch() { batchGen_++; }
+
+    // 内存中或磁盘上的有效金字塔，没有时返回 nullptr；只读取几十 KB 的缓存文件，不解码
+    std::shared_ptr<const WaveformPyramid> find(const std::string& filepath) {
+        for (auto it = recent_.begin(); it != recent_.end(); ++it) {
+            if (it->first == filepath) {
+                recent_.splice(recent_.begin(), recent_, it);
+                return recent_.front().second;
+            }
+        }
+        auto pyramid = std::make_shared<WaveformPyramid>();
+        if (!load(filepath, *pyramid)) return nullptr;
+        remember(filepath, pyramid);
+        return pyramid;
+    }
+
+    // 该曲目是否正在构建
+    bool pending(const std::string& filepath) const { return inFlight_.count(filepath) != 0; }
+
+    // 后台构建：已有有效缓存文件时任务只做校验；keep 为 true 时结果带回金字塔并放入内存
+    // batch 为 startBatch 返回的编号时任务属于该批次，可由 cancelBatch 中止
+    // 已在构建中的曲目不重复提交，返回 false
+    bool submit(const std::string& filepath, bool keep, uint64_t batch = 0) {
+        if (!inFlight_.insert(filepath).second) return false;
+        outstanding_++;
+        uint64_t gen = cancelGen_.load();
+        group_.run([this, path = filepath, keep, gen, batch]() {
+            auto cancelled = [this, gen, batch]() {
+                return cancelGen_.load(std::memory_order_relaxed) != gen ||
+                       (batch != 0 && batchGen_.load(std::memory_order_relaxed) != batch);
+            };
+            WaveformBuild result;
+            result.filepath = path;
+            result.batch = batch;
+            if (cancelled()) {
+                result.cancelled = true;
+            } else {
+                auto pyramid = std::make_shared<WaveformPyramid>();
+                if (keep ? load(path, *pyramid) : valid(path)) {
+                    result.ok = true;
+                } else {
+                    result.ok = build(path, *pyramid, cancelled);
+                    result.built = result.ok;
+                    result.cancelled = !result.ok && cancelled();
+                }
+                if (result.ok && keep) result.pyramid = std::move(pyramid);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            completed_.push_back(std::move(result));
+        });
+        return true;
+    }
+
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        std::vector<WaveformBuild> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batch.swap(completed_);
+        }
+        for (auto& result : batch) {
+            inFlight_.erase(result.filepath);
+            if (result.pyramid) remember(result.filepath, result.pyramid);
+            fn(result);
+        }
+        outstanding_ -= batch.size();
+        return batch.size();
+    }
+
+    // 缓存文件路径
+    std::string cachePath(const std::string& filepath) const {
+        uint64_t hash = 1469598103934665603ULL;
+        for (unsigned char c : filepath) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        char name[24];
+        std::snprintf(name, sizeof(name), "%016llx.wf", static_cast<unsigned long long>(hash));
+        return (std::filesystem::path(directory_) / name).string();
+    }
+
+    // 读取并校验缓存文件；源文件已变化或缓存损坏时返回 false
+    // 层数须与帧数相符、各层数据须在文件长度之内，损坏的文件头不会引起大块分配
+    bool load(const std::string& filepath, WaveformPyramid& pyramid) const {
+        std::string cacheFile = cachePath(filepath);
+        std::ifstream in(cacheFile, std::ios::binary);
+        WaveformFileHeader header;
+        if (!readHeader(in, filepath, header)) return false;
+        uint64_t levelBytes;
+        if (WaveformPyramid::levelCount(header.totalFrames, levelBytes) != header.levelCount) return false;
+        std::error_code ec;
+        uint64_t fileSize = std::filesystem::file_size(cacheFile, ec);
+        if (ec || fileSize < sizeof(header) + header.pathLength ||
+            levelBytes > fileSize - sizeof(header) - header.pathLength) {
+            return false;
+        }
+        pyramid.sampleRate = header.sampleRate;
+        pyramid.totalFrames = header.totalFrames;
+        pyramid.levels.assign(header.levelCount, std::vector<int8_t>());
+        uint64_t bins = (header.totalFrames + WaveformPyramid::kBaseBinFrames - 1) / WaveformPyramid::kBaseBinFrames;
+        for (uint32_t l = 0; l < header.levelCount; l++) {
+            pyramid.levels[l].resize(2 * std::max<uint64_t>(bins, 1));
+            in.read(reinterpret_cast<char*>(pyramid.levels[l].data()),
+                    static_cast<std::streamsize>(pyramid.levels[l].size()));
+            bins = (bins + WaveformPyramid::kLevelFactor - 1) / WaveformPyramid::kLevelFactor;
+        }
+        return static_cast<bool>(in);
+    }
+
+private:
+    // 只校验文件头与源文件路径
+    bool valid(const std::string& filepath) const {
+        std::ifstream in(cachePath(filepath), std::ios::binary);
+        WaveformFileHeader header;
+        return readHeader(in, filepath, header);
+    }
+
+    static bool readHeader(std::ifstream& in, const std::string& filepath, WaveformFileHeader& header) {
+        uint64_t size;
+        int64_t mtimeNs;
+        if (!in || !sourceFileStat(filepath, size, mtimeNs)) return false;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+        if (std::memcmp(header.magic, kWaveformMagic, 4) != 0 || header.version != kWaveformVersion ||
+            header.baseBinFrames != WaveformPyramid::kBaseBinFrames ||
+            header.levelFactor != WaveformPyramid::kLevelFactor || header.levelCount > 64 ||
+            header.sourceSize != size || header.sourceMtimeNs != mtimeNs ||
+            header.pathLength != filepath.size()) {
+            return false;
+        }
+        std::string path(header.pathLength, '\0');
+        in.read(&path[0], static_cast<std::streamsize>(path.size()));
+        return in && path == filepath;
+    }
+
+    template <typename Cancelled>
+    bool build(const std::string& filepath, WaveformPyramid& pyramid, Cancelled&& cancelled) {
+        uint64_t size;
+        int64_t mtimeNs;
+        if (!sourceFileStat(filepath, size, mtimeNs)) return false;
+        std::unique_ptr<AudioDecoder> decoder = openAudioDecoder(filepath, &pool_);
+        if (!decoder) return false;
+        WaveformBuilder builder;
+        bool ok = builder.build(*decoder, pyramid, cancelled);
+        if (!ok) return false;
+        return write(filepath, pyramid, size, mtimeNs);
+    }
+
+    // 先写临时文件再替换，并发构建或中途失败都不会留下不完整的缓存文件
+    bool write(const std::string& filepath, const WaveformPyramid& pyramid, uint64_t size, int64_t mtimeNs) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory_, ec);
+        WaveformFileHeader header = {};
+        std::memcpy(header.magic, kWaveformMagic, 4);
+        header.version = kWaveformVersion;
+        header.sourceSize = size;
+        header.sourceMtimeNs = mtimeNs;
+        header.totalFrames = pyramid.totalFrames;
+        header.sampleRate = pyramid.sampleRate;
+        header.baseBinFrames = WaveformPyramid::kBaseBinFrames;
+        header.levelFactor = WaveformPyramid::kLevelFactor;
+        header.levelCount = static_cast<uint32_t>(pyramid.levels.size());
+        header.pathLength = static_cast<uint32_t>(filepath.size());
+        std::string target = cachePath(filepath);
+        std::string tmpPath = target + "." + std::to_string(tmpSerial_++) + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(filepath.data(), static_cast<std::streamsize>(filepath.size()));
+            for (const auto& level : pyramid.levels) {
+                out.write(reinterpret_cast<const char*>(level.data()), static_cast<std::streamsize>(level.size()));
+            }
+            if (!out) {
+                out.close();
+                std::remove(tmpPath.c_str());
+                return false;
+            }
+        }
+        std::filesystem::rename(tmpPath, target, ec);
+        if (ec) std::remove(tmpPath.c_str());
+        return !ec;
+    }
+
+    void remember(const std::string& filepath, std::shared_ptr<const WaveformPyramid> pyramid) {
+        for (auto it = recent_.begin(); it != recent_.end(); ++it) {
+            if (it->first == filepath) {
+                recent_.erase(it);
+                break;
+            }
+        }
+        recent_.emplace_front(filepath, std::move(pyramid));
+        if (recent_.size() > kRecentCount) recent_.pop_back();
+    }
+
+    static constexpr size_t kRecentCount = 8;
+
+    WorkStealingPool& pool_;
+    TaskGroup group_;
+    const std::string directory_;
+    const size_t capacity_;
+    std::atomic<uint64_t> cancelGen_{ 0 };
+    std::atomic<uint64_t> batchGen_{ 0 };
+    std::atomic<size_t> outstanding_{ 0 };
+    std::atomic<uint64_t> tmpSerial_{ 0 };
+    std::mutex mutex_;
+    std::vector<WaveformBuild> completed_;
+
+    // 调用方线程的状态
+    std::unordered_set<std::string> inFlight_;
+    std::list<std::pair<std::string, std::shared_ptr<const WaveformPyramid>>> recent_;
+};
+
+} // namespace MusicApp
+
+#endif // WAVEFORM_CACHE_H
@@ -0,0 +1,140 @@
+#ifndef WAVEFORM_RENDERER_H
+#define WAVEFORM_RENDERER_H
+
+#include "WaveformCache.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MusicApp {
+
+// 波形的字符画渲染
+// 每一列的峰值由金字塔中不超过该列时长的最粗一层合并得到，一次渲染只访问 O(列数) 个区间，
+// 不解码音频；输出写入复用的缓冲区，与 PlaylistRenderer 一样容量够用之后没有堆分配
+class WaveformRenderer {
+public:
+    // [from, to) 秒范围内的波形，rows 行（取奇数，中间一行为零线），position 处画出位置标记
+    // 返回的引用在下一次渲染前有效
+    const std::string& render(const WaveformPyramid& pyramid, double from, double to, double position,
+                              size_t width, size_t rows) {
+        auto start = std::chrono::steady_clock::now();
+        buffer_.clear();
+        width = std::max<size_t>(width, 16);
+        rows = std::max<size_t>(rows | 1, 3);
+        to = std::min(to, pyramid.seconds());
+        from = std::max(0.0, std::min(from, to));
+        computeColumns(pyramid, from, to, width);
+        size_t marker = markerColumn(from, to, position, width);
+
+        buffer_ += "\n=== Waveform ";
+        appendTime(from);
+        buffer_ += " - ";
+        appendTime(to);
+        buffer_ += " ===\n";
+        for (size_t r = 0; r < rows; r++) {
+            float bandHigh = 1.0f - 2.0f * static_cast<float>(r) / static_cast<float>(rows);
+            float bandLow = 1.0f - 2.0f * static_cast<float>(r + 1) / static_cast<float>(rows);
+            bool axis = r == rows / 2;
+            buffer_ += ' ';
+            for (size_t c = 0; c < width; c++) {
+                if (hi_[c] >= bandLow && lo_[c] <= bandHigh) {
+                    buffer_ += '#';
+                } else if (c == marker) {
+                    buffer_ += '|';
+                } else {
+                    buffer_ += axis ? '-' : ' ';
+                }
+            }
+            buffer_ += '\n';
+        }
+        if (marker < width) {
+            buffer_.append(marker + 1, ' ');
+            buffer_ += '^';
+            buffer_ += ' ';
+            appendTime(position);
+            buffer_ += '\n';
+        }
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        buffer_ += " (";
+        appendNumber(width);
+        buffer_ += " columns, ";
+        appendNumber(static_cast<uint64_t>(micros + 0.5));
+        buffer_ += " us)\n";
+        return buffer_;
+    }
+
+    // 单行预览：每列按峰值幅度取一个字符，position 处为 '|'（定位预览用）
+    const std::string& renderStrip(const WaveformPyramid& pyramid, double from, double to, double position,
+                                   size_t width) {
+        static const char kLevels[] = " .:-=+*#";
+        buffer_.clear();
+        width = std::max<size_t>(width, 8);
+        to = std::min(to, pyramid.seconds());
+        from = std::max(0.0, std::min(from, to));
+        computeColumns(pyramid, from, to, width);
+        size_t marker = markerColumn(from, to, position, width);
+        appendTime(from);
+        buffer_ += " [";
+        for (size_t c = 0; c < width; c++) {
+            if (c == marker) {
+                buffer_ += '|';
+                continue;
+            }
+            float peak = std::max(std::fabs(lo_[c]), std::fabs(hi_[c]));
+            size_t level = std::min<size_t>(7, static_cast<size_t>(std::ceil(peak * 7.0f)));
+            buffer_ += kLevels[level];
+        }
+        buffer_ += "] ";
+        appendTime(to);
+        return buffer_;
+    }
+
+private:
+    void computeColumns(const WaveformPyramid& pyramid, double from, double to, size_t width) {
+        lo_.resize(width);
+        hi_.resize(width);
+        double framesPerColumn = (to - from) * pyramid.sampleRate / static_cast<double>(width);
+        double base = from * pyramid.sampleRate;
+        for (size_t c = 0; c < width; c++) {
+            auto begin = static_cast<uint64_t>(base + framesPerColumn * static_cast<double>(c));
+            auto end = static_cast<uint64_t>(base + framesPerColumn * static_cast<double>(c + 1));
+            pyramid.range(begin, std::max(end, begin + 1), lo_[c], hi_[c]);
+        }
+    }
+
+    // 范围外时返回 width
+    static size_t markerColumn(double from, double to, double position, size_t width) {
+        if (position < from || position > to || to <= from) return width;
+        return std::min(width - 1, static_cast<size_t>((position - from) / (to - from) * static_cast<double>(width)));
+    }
+
+    void appendNumber(uint64_t value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer_.append(digits, result.ptr);
+    }
+
+    // mm:ss，与状态行的格式相同
+    void appendTime(double seconds) {
+        int total = static_cast<int>(std::max(0.0, seconds));
+        int mins = total / 60;
+        int secs = total % 60;
+        if (mins < 10) buffer_ += '0';
+        appendNumber(static_cast<uint64_t>(mins));
+        buffer_ += ':';
+        buffer_ += static_cast<char>('0' + secs / 10);
+        buffer_ += static_cast<char>('0' + secs % 10);
+    }
+
+    std::string buffer_;
+    std::vector<float> lo_;
+    std::vector<float> hi_;
+};
+
+} // namespace MusicApp
+
+#endif // WAVEFORM_RENDERER_H
@@ -35,11 +35,14 @@ public:
         currentFile_ = filepath;
         
         // 打开音频文件（使用 ANSI 版本 API，在 MinGW 环境下兼容性更好）
+        // 所有格式统一用 mpegvideo 设备打开：按扩展名自动选择时 .wav/.mid 会落到
+        // waveaudio/sequencer 驱动，它们不支持 MCI_SETAUDIO，音量设置会被静默忽略
         MCI_OPEN_PARMSA openParms = {};
+        openParms.lpstrDeviceType = "mpegvideo";
         openParms.lpstrElementName = filepath.c_str();
         
         DWORD result = mciSendCommandA(0, MCI_OPEN, 
-            MCI_OPEN_ELEMENT | MCI_WAIT,
+            MCI_OPEN_TYPE | MCI_OPEN_ELEMENT | MCI_WAIT,
             reinterpret_cast<DWORD_PTR>(&openParms));
         
         if (result != 0) {
@@ -90,15 +93,19 @@ public:
     
     void seek(float seconds) override {
         if (deviceId_ != 0) {
-            bool wasPlaying = (state_ == PlayState::Playing);
-            
-            MCI_SEEK_PARMS seekParms = {};
-            seekParms.dwTo = static_cast<DWORD>(seconds * 1000);
-            mciSendCommand(deviceId_, MCI_SEEK, MCI_TO | MCI_WAIT,
-                reinterpret_cast<DWORD_PTR>(&seekParms));
-            
-            if (wasPlaying) {
-                play();
+            DWORD position = static_cast<DWORD>(std::max(0.0f, std::min(seconds, duration_)) * 1000);
+            if (state_ == PlayState::Playing) {
+                // 播放中直接从新位置播放：一条异步命令，不等待定位完成后再重新开始播放
+                MCI_PLAY_PARMS playParms = {};
+                playParms.dwFrom = position;
+                mciSendCommand(deviceId_, MCI_PLAY, MCI_FROM,
+                    reinterpret_cast<DWORD_PTR>(&playParms));
+            } else {
+                // 暂停或停止时只移动位置，不等待设备完成；下一条命令由 MCI 排在其后
+                MCI_SEEK_PARMS seekParms = {};
+                seekParms.dwTo = position;
+                mciSendCommand(deviceId_, MCI_SEEK, MCI_TO,
+                    reinterpret_cast<DWORD_PTR>(&seekParms));
             }
         }
     }
@@ -177,9 +184,14 @@ private:
     
     void applyVolume() {
         if (deviceId_ != 0) {
-            // 使用waveOutSetVolume设置系统音量
-            DWORD vol = static_cast<DWORD>((volume_ / 100.0f) * 0xFFFF);
-            waveOutSetVolume(0, vol | (vol << 16));
+            // 通过 MCI_SETAUDIO 只设置本设备（本播放器）的音量 (0-1000)，
+            // 不再用 waveOutSetVolume 修改整个输出设备的音量
+            MCI_DGV_SETAUDIO_PARMS audioParms = {};
+            audioParms.dwItem = MCI_DGV_SETAUDIO_VOLUME;
+            audioParms.dwValue = static_cast<DWORD>(volume_ * 10.0f);
+            mciSendCommand(deviceId_, MCI_SETAUDIO,
+                MCI_DGV_SETAUDIO_ITEM | MCI_DGV_SETAUDIO_VALUE | MCI_WAIT,
+                reinterpret_cast<DWORD_PTR>(&audioParms));
         }
     }
     
@@ -1,56 +1,39 @@
+#include <charconv>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <stdexcept>
 #include <thread>
 #include <chrono>
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
 
 // 根据平台选择音频后端
 #ifdef USE_SFML
     #include "SFMLAudioPlayer.h"
     using AudioPlayerImpl = MusicApp::SFMLAudioPlayer;
+#elif defined(USE_NATIVE)
+    #include "NativeAudioPlayer.h"
+    using AudioPlayerImpl = MusicApp::NativeAudioPlayer;
 #else
     #include "WindowsAudioPlayer.h"
     using AudioPlayerImpl = MusicApp::WindowsAudioPlayer;
 #endif
 
+#include "CommandProcessor.h"
+#include "ControlServer.h"
 #include "MusicPlayer.h"
+#include "EventLoop.h"
+#include "LibraryScanner.h"
+#include "SessionManager.h"
+#include <filesystem>
+#include <mutex>
 
 using namespace MusicApp;
 
-void printHelp() {
-    std::cout << R"(
-=== Music Player Commands ===
-  play, p          - Play/Resume
-  pause, pa        - Pause
-  stop, s          - Stop
-  next, n          - Next track
-  prev, pr         - Previous track
-  
-  seek <seconds>   - Seek to position
-  ff               - Fast forward 10s
-  rw               - Rewind 10s
-  
-  vol <0-100>      - Set volume
-  vol+ / vol-      - Volume up/down
-  
-  loop             - Toggle loop mode (Off/All/Single)
-  shuffle          - Toggle shuffle mode
-  
-  add <file>       - Add file to playlist
-  load <directory> - Load all audio files from directory
-  list, ls         - Show playlist
-  goto <number>    - Jump to track number
-  remove <number>  - Remove track from playlist
-  clear            - Clear playlist
-  
-  status, st       - Show current status
-  help, h          - Show this help
-  quit, q          - Exit player
-
-)";
-}
-
 void printBanner() {
     std::cout << R"(
   __  __           _        ____  _                       
@@ -63,197 +46,367 @@ void printBanner() {
 )" << std::endl;
 }
 
-std::vector<std::string> parseCommand(const std::string& input) {
-    std::vector<std::string> tokens;
-    // 移除可能的\r字符和BOM
-    std::string cleanInput = input;
-    // 移除\r
-    cleanInput.erase(std::remove(cleanInput.begin(), cleanInput.end(), '\r'), cleanInput.end());
-    // 移除UTF-8 BOM (0xEF 0xBB 0xBF)
-    if (cleanInput.size() >= 3 && 
-        (unsigned char)cleanInput[0] == 0xEF && 
-        (unsigned char)cleanInput[1] == 0xBB && 
-        (unsigned char)cleanInput[2] == 0xBF) {
-        cleanInput = cleanInput.substr(3);
-    }
-    // 移除前导空白
-    size_t start = cleanInput.find_first_not_of(" \t");
-    if (start != std::string::npos) {
-        cleanInput = cleanInput.substr(start);
-    }
-    
-    std::istringstream iss(cleanInput);
-    std::string token;
-    
-    while (iss >> token) {
-        tokens.push_back(token);
+// 命令行选项
+struct Options {
+    std::string wavOut;                 // --wav-out <文件>: 原生引擎输出到 WAV 文件
+    float gainRampMs = 20.0f;           // --gain-ramp <毫秒>: 原生引擎音量插值时长
+    uint32_t sampleRate = 44100;        // --rate <Hz>: 原生引擎输出采样率 (8000-384000)，其他采样率的曲目重采样到此
+    ResamplerQuality resampler = ResamplerQuality::Balanced; // --resampler fast|balanced|best: 重采样质量预设
+    std::string libraryPath;            // --library <文件>: 曲库索引，启动时加载、退出时保存
+    std::string waveCache;              // --wave-cache <目录>: 波形缓存目录
+    std::string statsDump;              // --stats-dump <文件>: 周期性追加一行 JSON 格式的统计
+    double statsInterval = 10.0;        // --stats-interval <秒>: 统计转储间隔
+    std::string batch;                  // --batch <文件|->: 非交互地执行文件或标准输入中的命令
+    std::string control;                // --control <套接字>: 在 Unix 域套接字上接受控制命令
+    size_t sessions = 0;                // --sessions <数量>: 多会话宿主，每个会话一个独立的播放器
+    std::string sessionOut;             // --session-out <目录>: 各会话输出到 <目录>/<会话>.wav
+    size_t prefetch = 3;                // --prefetch <数量>: 预读接下来几首曲目的开头，0 为关闭
+    double prefetchRate = 32.0;         // --prefetch-rate <MB/s>: 预读带宽上限，0 为不限
+    std::vector<std::string> files;     // 启动时加入播放列表的文件
+};
+
+// 解析数值选项：整个参数须是 [min, max] 内的数字，否则抛出 std::invalid_argument，
+// 由 main 报告用法错误后退出，不带着无效配置启动引擎
+template <typename T>
+T parseOptionValue(const std::string& option, const std::string& text, T min, T max) {
+    T value{};
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    if (text.empty() || result.ec != std::errc() || result.ptr != end || !(value >= min && value <= max)) {
+        std::ostringstream message;
+        message << "invalid value for " << option << ": '" << text << "' (expected " << min << "-" << max << ")";
+        throw std::invalid_argument(message.str());
     }
-    
-    return tokens;
+    return value;
 }
 
-void processCommand(MusicPlayer& player, const std::vector<std::string>& args) {
-    if (args.empty()) return;
-    
-    const std::string& cmd = args[0];
-    
-    if (cmd == "play" || cmd == "p") {
-        player.play();
-        std::cout << "Playing..." << std::endl;
-    }
-    else if (cmd == "pause" || cmd == "pa") {
-        player.pause();
-        std::cout << "Paused" << std::endl;
-    }
-    else if (cmd == "stop" || cmd == "s") {
-        player.stop();
-        std::cout << "Stopped" << std::endl;
-    }
-    else if (cmd == "next" || cmd == "n") {
-        player.next();
-        std::cout << "Next track" << std::endl;
-    }
-    else if (cmd == "prev" || cmd == "pr") {
-        player.previous();
-        std::cout << "Previous track" << std::endl;
-    }
-    else if (cmd == "seek" && args.size() > 1) {
-        float seconds = std::stof(args[1]);
-        player.seek(seconds);
-        std::cout << "Seeking to " << seconds << "s" << std::endl;
-    }
-    else if (cmd == "ff") {
-        player.seekForward();
-        std::cout << "Fast forward 10s" << std::endl;
-    }
-    else if (cmd == "rw") {
-        player.seekBackward();
-        std::cout << "Rewind 10s" << std::endl;
-    }
-    else if (cmd == "vol" && args.size() > 1) {
-        float vol = std::stof(args[1]);
-        player.setVolume(vol);
-        std::cout << "Volume set to " << vol << "%" << std::endl;
-    }
-    else if (cmd == "vol+") {
-        player.volumeUp();
-        std::cout << "Volume: " << player.getVolume() << "%" << std::endl;
-    }
-    else if (cmd == "vol-") {
-        player.volumeDown();
-        std::cout << "Volume: " << player.getVolume() << "%" << std::endl;
-    }
-    else if (cmd == "loop") {
-        player.toggleLoopMode();
-        std::cout << "Loop mode: ";
-        switch (player.getLoopMode()) {
-            case LoopMode::None: std::cout << "Off"; break;
-            case LoopMode::Single: std::cout << "Single"; break;
-            case LoopMode::All: std::cout << "All"; break;
+Options parseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--wav-out" && i + 1 < argc) {
+            options.wavOut = argv[++i];
+        } else if (arg == "--gain-ramp" && i + 1 < argc) {
+            options.gainRampMs = parseOptionValue(arg, argv[++i], 0.0f, 10000.0f);
+        } else if (arg == "--rate" && i + 1 < argc) {
+            options.sampleRate = parseOptionValue<uint32_t>(arg, argv[++i], 8000, 384000);
+        } else if (arg == "--resampler" && i + 1 < argc) {
+            std::string preset = argv[++i];
+            if (!parseResamplerQuality(preset, options.resampler)) {
+                throw std::invalid_argument("invalid value for --resampler: '" + preset +
+                                            "' (expected fast, balanced or best)");
+            }
+        } else if (arg == "--library" && i + 1 < argc) {
+            options.libraryPath = argv[++i];
+        } else if (arg == "--wave-cache" && i + 1 < argc) {
+            options.waveCache = argv[++i];
+        } else if (arg == "--batch" && i + 1 < argc) {
+            options.batch = argv[++i];
+        } else if (arg == "--control" && i + 1 < argc) {
+            options.control = argv[++i];
+        } else if (arg == "--sessions" && i + 1 < argc) {
+            options.sessions = parseOptionValue<size_t>(arg, argv[++i], 1, 10000);
+        } else if (arg == "--session-out" && i + 1 < argc) {
+            options.sessionOut = argv[++i];
+        } else if (arg == "--prefetch" && i + 1 < argc) {
+            options.prefetch = parseOptionValue<size_t>(arg, argv[++i], 0, PrefetchConfig().capacity);
+        } else if (arg == "--prefetch-rate" && i + 1 < argc) {
+            options.prefetchRate = parseOptionValue(arg, argv[++i], 0.0, 100000.0);
+        } else if (arg == "--stats-dump" && i + 1 < argc) {
+            options.statsDump = argv[++i];
+        } else if (arg == "--stats-interval" && i + 1 < argc) {
+            options.statsInterval = parseOptionValue(arg, argv[++i], 0.1, 86400.0);
+        } else {
+            options.files.push_back(arg);
         }
-        std::cout << std::endl;
     }
-    else if (cmd == "shuffle") {
-        player.toggleShuffle();
-        std::cout << "Shuffle: " 
-                  << (player.getPlaylist().isShuffleEnabled() ? "On" : "Off") 
-                  << std::endl;
+    return options;
+}
+
+// 原生引擎配置；单播放器与多会话宿主共用
+NativeEngineConfig engineConfig(const Options& options) {
+    NativeEngineConfig config;
+    config.gainRampMs = options.gainRampMs;
+    config.sampleRate = options.sampleRate;
+    config.resampler = options.resampler;
+    return config;
+}
+
+// 根据后端与选项创建音频播放器
+std::unique_ptr<AudioPlayer> createAudioPlayer(const Options& options) {
+#ifdef USE_NATIVE
+    std::unique_ptr<AudioSink> sink;
+    if (!options.wavOut.empty()) {
+        sink = std::make_unique<WavFileAudioSink>(options.wavOut);
+    } else {
+        sink = std::make_unique<NullAudioSink>();
     }
-    else if (cmd == "add" && args.size() > 1) {
-        // 重新拼接文件路径（可能包含空格）
-        std::string filepath;
-        for (size_t i = 1; i < args.size(); i++) {
-            if (i > 1) filepath += " ";
-            filepath += args[i];
+    return std::make_unique<AudioPlayerImpl>(std::move(sink), engineConfig(options));
+#else
+    (void)options;
+    return std::make_unique<AudioPlayerImpl>();
+#endif
+}
+
+// 批处理：逐行执行命令，不显示横幅与提示符；空行与 # 开头的行跳过。
+// 结束后向标准错误报告命令数与每秒命令数，标准输出只有命令本身的输出
+bool runBatch(MusicPlayer& player, std::mutex& playerMutex, const std::string& source) {
+    std::ifstream file;
+    if (source != "-") {
+        file.open(source);
+        if (!file) {
+            std::cerr << "Cannot open batch file " << source << std::endl;
+            return false;
         }
-        player.getPlaylist().addTrack(filepath);
-        std::cout << "Added: " << filepath << std::endl;
     }
-    else if (cmd == "load" && args.size() > 1) {
-        std::string dirPath;
-        for (size_t i = 1; i < args.size(); i++) {
-            if (i > 1) dirPath += " ";
-            dirPath += args[i];
+    std::istream& in = source == "-" ? std::cin : file;
+
+    uint64_t commands = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::string line;
+    while (std::getline(in, line)) {
+        CommandArgs args = tokenizeCommand(line);
+        if (args.empty() || args[0][0] == '#') continue;
+        commands++;
+        std::unique_lock<std::mutex> lock(playerMutex);
+        try {
+            processCommand(player, args, lock);
+        } catch (const std::exception& e) {
+            std::cout << "Error: " << e.what() << '\n';
         }
-        int count = player.getPlaylist().loadFromDirectory(dirPath);
-        std::cout << "Loaded " << count << " tracks from " << dirPath << std::endl;
+        if (!player.isRunning()) break;
     }
-    else if (cmd == "list" || cmd == "ls") {
-        std::cout << player.getPlaylistString();
+    std::cout.flush();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Batch: " << commands << " commands in " << std::fixed << std::setprecision(3) << seconds
+              << "s (" << std::setprecision(0) << (seconds > 0.0 ? commands / seconds : 0.0)
+              << " commands/s)" << std::endl;
+    return true;
+}
+
+// 多会话宿主：运行 options.sessions 个互不相关的会话，解码与 DSP 在共享线程池上调度。
+// 命令行中的文件加入每个会话的播放列表，第 i 个会话从第 i 首开始并循环整个列表。
+// 控制台命令 "@<会话> <命令>" 发给一个会话，"@all <命令>" 发给全部会话，"sessions" 列出会话
+int runSessionHost(const Options& options) {
+    SessionManager manager(engineConfig(options));
+    for (size_t i = 1; i <= options.sessions; i++) {
+        std::string name = std::to_string(i);
+        std::unique_ptr<AudioSink> sink;
+        if (!options.sessionOut.empty()) {
+            sink = std::make_unique<WavFileAudioSink>(
+                (std::filesystem::path(options.sessionOut) / (name + ".wav")).string());
+        }
+        auto session = manager.create(name, std::move(sink));
+        std::lock_guard<std::mutex> lock(session->mutex());
+        MusicPlayer& player = session->player();
+        for (const auto& file : options.files) {
+            player.getPlaylist().addTrack(file);
+        }
+        player.setLoopMode(LoopMode::All);
+        if (!options.files.empty()) {
+            player.jumpTo((i - 1) % options.files.size());
+        }
     }
-    else if (cmd == "goto" && args.size() > 1) {
-        size_t index = std::stoul(args[1]) - 1;
-        if (player.jumpTo(index)) {
-            std::cout << "Jumping to track " << (index + 1) << std::endl;
+    manager.start();
+    std::cout << "Hosting " << manager.size() << " sessions on " << manager.getWorkerPool().size()
+              << " threads. Use @<session> <command>, @all <command>, sessions or quit.\n" << std::endl;
+
+    // 执行一个会话的命令；会话退出（q）后移除
+    auto runOn = [&](const std::shared_ptr<PlayerSession>& session, std::string_view command) {
+        bool closed;
+        {
+            std::unique_lock<std::mutex> lock(session->mutex());
+            try {
+                processCommand(session->player(), tokenizeCommand(command), lock);
+            } catch (const std::exception& e) {
+                std::cout << "Error: " << e.what() << '\n';
+            }
+            closed = !session->player().isRunning();
+        }
+        if (closed) {
+            manager.remove(session->name());
+            std::cout << "Session " << session->name() << " closed\n";
+        }
+    };
+
+    std::string input;
+    while (true) {
+        std::cout << "> " << std::flush;
+        if (!std::getline(std::cin, input)) {
+            break;
+        }
+        CommandArgs args = tokenizeCommand(input);
+        if (args.empty()) continue;
+        std::string_view head = args[0];
+        if (head == "q" || head == "quit" || head == "exit") {
+            break;
+        } else if (head == "sessions") {
+            std::cout << manager.formatSessions();
+        } else if (head.size() > 1 && head[0] == '@' && args.size() > 1) {
+            std::string_view target = head.substr(1);
+            if (target == "all") {
+                for (const auto& session : manager.sessions()) {
+                    std::cout << "[" << session->name() << "] ";
+                    runOn(session, args.rest(1));
+                }
+            } else if (auto session = manager.find(std::string(target))) {
+                runOn(session, args.rest(1));
+            } else {
+                std::cout << "No session named " << target << '\n';
+            }
         } else {
-            std::cout << "Invalid track number" << std::endl;
+            std::cout << "Use @<session> <command>, @all <command>, sessions or quit\n";
         }
     }
-    else if (cmd == "remove" && args.size() > 1) {
-        size_t index = std::stoul(args[1]) - 1;
-        player.getPlaylist().removeTrack(index);
-        std::cout << "Removed track " << (index + 1) << std::endl;
+
+    manager.stop();
+    SessionHostStats stats = manager.getStats();
+    std::cout << "Rendered " << stats.ticks << " ticks for " << manager.size() << " sessions, "
+              << stats.lateTicks << " late" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    MUSICAPP_STATS_THREAD();
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Usage error: " << e.what() << std::endl;
+        return 2;
     }
-    else if (cmd == "clear") {
-        player.getPlaylist().clear();
-        player.stop();
-        std::cout << "Playlist cleared" << std::endl;
+    if (options.sessions > 0) {
+        printBanner();
+        return runSessionHost(options);
     }
-    else if (cmd == "status" || cmd == "st") {
-        std::cout << "\n" << player.getStatusString() << "\n" << std::endl;
+    bool batch = !options.batch.empty();
+    // 只有主线程写标准输出：关闭与 C stdio 的同步，输出按块缓冲；
+    // 控制服务运行时 cin 也需要自己的缓冲，才能在等待输入前判断是否还有已读入的行
+    if (batch || !options.control.empty()) {
+        std::ios::sync_with_stdio(false);
     }
-    else if (cmd == "help" || cmd == "h") {
-        printHelp();
+    if (batch) {
+        std::cin.tie(nullptr);
+    } else {
+        printBanner();
     }
-    else if (cmd == "quit" || cmd == "q" || cmd == "exit") {
-        player.quit();
-        std::cout << "Goodbye!" << std::endl;
+    
+    // 创建音频播放器
+    MusicPlayer player(createAudioPlayer(options));
+    if (!options.waveCache.empty()) {
+        player.setWaveformCacheDirectory(options.waveCache);
+        player.setWaveformAutoBuild(true);
     }
-    else {
-        std::cout << "Unknown command: " << cmd << ". Type 'help' for commands." << std::endl;
+    PrefetchConfig prefetch;
+    prefetch.lookahead = options.prefetch;
+    prefetch.maxBytesPerSecond = options.prefetchRate * 1e6;
+    player.setPrefetch(prefetch);
+    
+    if (!batch) {
+        std::cout << "Type 'help' for available commands.\n" << std::endl;
     }
-}
-
-int main(int argc, char* argv[]) {
-    printBanner();
     
-    // 创建音频播放器
-    auto audioPlayer = std::make_unique<AudioPlayerImpl>();
-    MusicPlayer player(std::move(audioPlayer));
+    // 统计转储
+    Stats::Dumper statsDumper;
+    if (!options.statsDump.empty()) {
+        if (!statsDumper.start(options.statsDump, options.statsInterval)) {
+            std::cout << "Cannot open stats dump file " << options.statsDump << std::endl;
+        }
+    }
     
-    std::cout << "Type 'help' for available commands.\n" << std::endl;
+    // 加载曲库索引
+    if (!options.libraryPath.empty()) {
+        LibraryLoadStats stats;
+        if (player.openLibrary(options.libraryPath, &stats)) {
+            std::cout << "Library: " << stats.tracks << " tracks in " << stats.directories
+                      << " directories (" << static_cast<int>(stats.seconds * 1000.0 + 0.5)
+                      << " ms, " << stats.changedDirectories << " changed, "
+                      << stats.newDirectories << " new, " << stats.removedDirectories
+                      << " removed)" << std::endl;
+        } else {
+            std::cout << "Library: " << options.libraryPath
+                      << " not found or unreadable, a new index will be written on exit" << std::endl;
+        }
+    }
     
     // 如果命令行提供了文件，添加到播放列表
-    for (int i = 1; i < argc; i++) {
-        player.getPlaylist().addTrack(argv[i]);
-        std::cout << "Added: " << argv[i] << std::endl;
+    for (const auto& file : options.files) {
+        player.getPlaylist().addTrack(file);
+        std::cout << "Added: " << file << std::endl;
     }
     
     // 如果有文件，自动开始播放
-    if (argc > 1) {
+    if (!options.files.empty()) {
         player.playCurrentTrack();
     }
     
-    // 主循环
-    std::string input;
-    while (player.isRunning()) {
-        std::cout << "> ";
-        
-        if (!std::getline(std::cin, input)) {
-            break;
+    // 事件循环在独立线程中分发播放结束等事件，命令处理与其共用同一把锁
+    std::mutex playerMutex;
+    PlayerEventLoop eventLoop(player, playerMutex);
+    eventLoop.start();
+    
+    // 本地控制服务，与控制台共用播放器锁
+    ControlServer controlServer(player, playerMutex);
+    if (!options.control.empty()) {
+        if (controlServer.start(options.control)) {
+            std::cout << "Control server listening on " << options.control << std::endl;
+        } else {
+            std::cout << "Cannot start control server on " << options.control << ": "
+                      << controlServer.lastError() << std::endl;
         }
-        
-        auto args = parseCommand(input);
-        
-        try {
-            processCommand(player, args);
-        } catch (const std::exception& e) {
-            std::cout << "Error: " << e.what() << std::endl;
+    }
+    
+    int exitCode = 0;
+    if (batch) {
+        exitCode = runBatch(player, playerMutex, options.batch) ? 0 : 1;
+    } else {
+        // 主循环
+        std::string input;
+        while (true) {
+            std::cout << "> " << std::flush;
+            
+            // 等待输入期间客户端可能请求 shutdown
+            if (controlServer.isRunning() && !controlServer.waitForConsoleInput()) {
+                break;
+            }
+            if (!std::getline(std::cin, input)) {
+                break;
+            }
+            
+            CommandArgs args = tokenizeCommand(input);
+            
+            std::unique_lock<std::mutex> lock(playerMutex);
+            try {
+                processCommand(player, args, lock);
+            } catch (const std::exception& e) {
+                std::cout << "Error: " << e.what() << std::endl;
+            }
+            
+            if (!player.isRunning()) {
+                break;
+            }
         }
         
-        // 更新播放器状态
-        player.update();
+        // 控制台输入关闭（例如作为后台服务运行）时继续为客户端服务，直到有客户端请求 shutdown
+        bool running;
+        {
+            std::lock_guard<std::mutex> lock(playerMutex);
+            running = player.isRunning();
+        }
+        if (running && controlServer.isRunning()) {
+            controlServer.waitForShutdown();
+        }
     }
     
-    return 0;
+    controlServer.stop();
+    eventLoop.stop();
+    
+    if (player.hasLibrary()) {
+        if (player.saveLibrary()) {
+            std::cout << "Library index saved to " << player.getLibraryPath() << std::endl;
+        } else {
+            std::cout << "Failed to save library index " << player.getLibraryPath() << std::endl;
+        }
+    }
+    return exitCode;
 }